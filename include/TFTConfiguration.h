@@ -10,10 +10,24 @@
 #include <lvgl.h>
 #include <NS2009.h>
 
+// Height of each LVGL draw buffer in display lines (override with -D UI_DRAW_BUF_LINES=n).
+// 24 lines = 1/10 of the 240 line panel; larger bands mean fewer, longer transfers.
+#ifndef UI_DRAW_BUF_LINES
+#define UI_DRAW_BUF_LINES 24
+#endif
+
+// 1: two draw buffers, flushed by SPI DMA while LVGL renders into the other one.
+// 0: single buffer with the blocking pushColors flush (for A/B timing comparison).
+#ifndef UI_DISPLAY_DMA
+#define UI_DISPLAY_DMA 1
+#endif
+
 extern const uint16_t screenWidth;
 extern const uint16_t screenHeight;
 extern const size_t lvglBufferSizePixels;
-extern lv_color_t buf[];
+// RGB565 draw buffers in internal (DMA-capable) RAM; drawBuf2 only exists with UI_DISPLAY_DMA
+extern uint16_t drawBuf1[];
+extern uint16_t drawBuf2[];
 extern TFT_eSPI tft;
 extern NS2009 TS;
 
@@ -0,0 +1,140 @@
+#include "can_busload.h"
+
+//Reference values for worst case stuffed frame lengths as tabulated in the classic CAN response time
+//analysis literature (Davis, Burns, Bril, Lukkien - "Controller Area Network schedulability analysis").
+//If the formula in classicFrameBits is ever touched these will catch it at compile time.
+static_assert(CANBusLoad::classicFrameBits(false, 0, false) == 55, "11 bit ID, 0 data bytes");
+static_assert(CANBusLoad::classicFrameBits(false, 8, false) == 135, "11 bit ID, 8 data bytes");
+static_assert(CANBusLoad::classicFrameBits(true, 0, false) == 80, "29 bit ID, 0 data bytes");
+static_assert(CANBusLoad::classicFrameBits(true, 8, false) == 160, "29 bit ID, 8 data bytes");
+static_assert(CANBusLoad::classicFrameBits(false, 4, false) == 95, "11 bit ID, 4 data bytes");
+static_assert(CANBusLoad::classicFrameBits(false, 8, true) == 55, "RTR frames carry no data field");
+static_assert(CANBusLoad::classicFrameBits(false, 15, false) == 135, "DLC above 8 still means 8 bytes");
+
+CANBusLoad::CANBusLoad()
+{
+    portMUX_INITIALIZE(&mux);
+    reset();
+}
+
+uint32_t CANBusLoad::fdFrameBits(bool extended, uint8_t dataBytes, bool brs, uint32_t nominalRate, uint32_t dataRate)
+{
+    if (dataBytes > 64) dataBytes = 64;
+
+    //SOF, ID, RRS/SRR, IDE, FDF, res, BRS - all sent at the nominal rate
+    uint32_t arbBits = extended ? 36 : 17;
+    //ACK slot + delimiter, EOF, intermission
+    uint32_t nominalBits = arbBits + (arbBits - 1) / 4 + 12;
+
+    //ESI, DLC and data use dynamic stuffing. The stuff count + CRC use fixed stuff bits, one
+    //every 4 bits, and the CRC is 17 bits up to 16 data bytes and 21 bits above that.
+    uint32_t dynBits = 5 + 8ul * dataBytes;
+    uint32_t crcBits = 4 + ((dataBytes > 16) ? 21 : 17);
+    uint32_t dataBits = dynBits + (dynBits - 1) / 4 + crcBits + (crcBits + 3) / 4 + 1; //+1 for CRC delimiter
+
+    if (brs && dataRate > nominalRate && nominalRate > 0)
+    {
+        //express the data phase in nominal bit times, rounded up
+        dataBits = (uint32_t)(((uint64_t)dataBits * nominalRate + dataRate - 1) / dataRate);
+    }
+    return nominalBits + dataBits;
+}
+
+void CANBusLoad::reset()
+{
+    portENTER_CRITICAL(&mux);
+    for (int i = 0; i < BUSLOAD_BUCKETS; i++) buckets[i] = 0;
+    bucketHead = 0;
+    currentBits = 0;
+    bucketStartUs = 0;
+    lastBits = 0;
+    sum1s = 0;
+    sum10s = 0;
+    peakBits100ms = 0;
+    peakBits1s = 0;
+    peakBits10s = 0;
+    frames = 0;
+    started = false;
+    portEXIT_CRITICAL(&mux);
+}
+
+//Must be called with mux held
+void CANBusLoad::closeBucket()
+{
+    //the bucket 10 slots back drops out of the 1s window, the oldest one out of the 10s window
+    uint16_t leaving1s = (bucketHead + BUSLOAD_BUCKETS - BUSLOAD_BUCKETS_1S) % BUSLOAD_BUCKETS;
+    sum1s = sum1s + currentBits - buckets[leaving1s];
+    sum10s = sum10s + currentBits - buckets[bucketHead];
+    buckets[bucketHead] = currentBits;
+    bucketHead = (bucketHead + 1) % BUSLOAD_BUCKETS;
+    lastBits = currentBits;
+    currentBits = 0;
+
+    if (lastBits > peakBits100ms) peakBits100ms = lastBits;
+    if (sum1s > peakBits1s) peakBits1s = sum1s;
+    if (sum10s > peakBits10s) peakBits10s = sum10s;
+}
+
+//Must be called with mux held
+void CANBusLoad::advance(uint32_t nowUs)
+{
+    if (!started)
+    {
+        bucketStartUs = nowUs;
+        started = true;
+        return;
+    }
+    uint32_t elapsed = (nowUs - bucketStartUs) / BUSLOAD_BUCKET_US;
+    //after a long quiet period everything older than the ring is zero anyway, so cap the work
+    if (elapsed > BUSLOAD_BUCKETS + 1)
+    {
+        bucketStartUs += (elapsed - (BUSLOAD_BUCKETS + 1)) * BUSLOAD_BUCKET_US;
+        elapsed = BUSLOAD_BUCKETS + 1;
+    }
+    while (elapsed--)
+    {
+        closeBucket();
+        bucketStartUs += BUSLOAD_BUCKET_US;
+    }
+}
+
+void CANBusLoad::recordFrame(uint32_t bits, uint32_t nowUs)
+{
+    portENTER_CRITICAL(&mux);
+    advance(nowUs);
+    currentBits += bits;
+    frames++;
+    portEXIT_CRITICAL(&mux);
+}
+
+uint16_t CANBusLoad::toLoad(uint32_t bits, uint32_t numBuckets, uint32_t bitRate)
+{
+    if (bitRate == 0) return 0;
+    //capacity of the window in bits is bitRate * numBuckets / 10, result is in 0.01% units
+    uint64_t load = ((uint64_t)bits * 100000ull) / ((uint64_t)bitRate * numBuckets);
+    if (load > 10000) load = 10000;
+    return (uint16_t)load;
+}
+
+void CANBusLoad::getStats(CAN_BUSLOAD_STATS &stats, uint32_t bitRate, uint32_t nowUs)
+{
+    uint32_t last, s1, s10, p100, p1, p10;
+
+    portENTER_CRITICAL(&mux);
+    if (started) advance(nowUs);
+    last = lastBits;
+    s1 = sum1s;
+    s10 = sum10s;
+    p100 = peakBits100ms;
+    p1 = peakBits1s;
+    p10 = peakBits10s;
+    stats.frames = frames;
+    portEXIT_CRITICAL(&mux);
+
+    stats.load100ms = toLoad(last, 1, bitRate);
+    stats.load1s = toLoad(s1, BUSLOAD_BUCKETS_1S, bitRate);
+    stats.load10s = toLoad(s10, BUSLOAD_BUCKETS, bitRate);
+    stats.peak100ms = toLoad(p100, 1, bitRate);
+    stats.peak1s = toLoad(p1, BUSLOAD_BUCKETS_1S, bitRate);
+    stats.peak10s = toLoad(p10, BUSLOAD_BUCKETS, bitRate);
+}
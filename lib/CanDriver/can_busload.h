@@ -0,0 +1,82 @@
+#ifndef _CAN_BUSLOAD_
+#define _CAN_BUSLOAD_
+
+#include <Arduino.h>
+
+/*
+Bus load estimation from observed traffic. Every received frame is converted to the number
+of bit times it occupied on the wire (worst case bit stuffing, so the figure is an upper bound)
+and accumulated in 100ms buckets. A ring of buckets gives the 100ms, 1s and 10s sliding windows.
+
+Load figures are in hundredths of a percent (10000 = 100%) so they fit a uint16_t and can be
+printed without floating point.
+*/
+
+#define BUSLOAD_BUCKET_US       100000ul    //width of one bucket, also the shortest window
+#define BUSLOAD_BUCKETS         100         //100 x 100ms = 10 second history
+#define BUSLOAD_BUCKETS_1S      10
+
+typedef struct
+{
+    uint16_t load100ms;     //last complete 100ms bucket
+    uint16_t load1s;        //last 10 complete buckets
+    uint16_t load10s;       //last 100 complete buckets
+    uint16_t peak100ms;     //highest value of each window since reset
+    uint16_t peak1s;
+    uint16_t peak10s;
+    uint32_t frames;        //frames counted since reset
+} CAN_BUSLOAD_STATS;
+
+class CANBusLoad
+{
+public:
+    CANBusLoad();
+
+    /*
+    Worst case bit count of a classic CAN 2.0 frame including SOF, CRC delimiter, ACK, EOF and
+    the 3 bit intermission. Stuffing applies from SOF to the end of the CRC (34 bits + data for
+    standard IDs, 54 bits + data for extended IDs) and adds at most one bit per 4 after the first.
+    RTR frames carry no data bytes whatever their DLC says.
+    */
+    static constexpr uint32_t classicFrameBits(bool extended, uint8_t dataBytes, bool rtr)
+    {
+        return stuffedRegionBits(extended, rtr ? 0 : (dataBytes > 8 ? 8 : dataBytes))
+             + (stuffedRegionBits(extended, rtr ? 0 : (dataBytes > 8 ? 8 : dataBytes)) - 1) / 4
+             + 13;
+    }
+
+    //CAN-FD frame length expressed in nominal bit times. With bit rate switching the data phase
+    //runs at dataRate so it is scaled down accordingly. Estimate, worst case stuffing is assumed.
+    static uint32_t fdFrameBits(bool extended, uint8_t dataBytes, bool brs, uint32_t nominalRate, uint32_t dataRate);
+
+    void reset();
+    //Account one frame of the given length (in nominal bit times) received at nowUs (micros())
+    void recordFrame(uint32_t bits, uint32_t nowUs);
+    //Close any buckets that elapsed by nowUs and return the current figures for the given bitrate
+    void getStats(CAN_BUSLOAD_STATS &stats, uint32_t bitRate, uint32_t nowUs);
+
+private:
+    static constexpr uint32_t stuffedRegionBits(bool extended, uint8_t dataBytes)
+    {
+        return (extended ? 54 : 34) + 8u * dataBytes;
+    }
+    void advance(uint32_t nowUs);
+    void closeBucket();
+    static uint16_t toLoad(uint32_t bits, uint32_t buckets, uint32_t bitRate);
+
+    uint32_t buckets[BUSLOAD_BUCKETS]; //closed buckets, bucketHead is the oldest
+    uint16_t bucketHead;
+    uint32_t currentBits;   //bucket still being filled
+    uint32_t bucketStartUs;
+    uint32_t lastBits;      //most recently closed bucket
+    uint32_t sum1s;         //running sums of the newest 10 and 100 closed buckets
+    uint32_t sum10s;
+    uint32_t peakBits100ms; //peaks are kept in bits so they stay valid if the bitrate changes
+    uint32_t peakBits1s;
+    uint32_t peakBits10s;
+    uint32_t frames;
+    bool started;
+    portMUX_TYPE mux;
+};
+
+#endif
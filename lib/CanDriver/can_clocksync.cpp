@@ -0,0 +1,142 @@
+#include "can_clocksync.h"
+
+#define RATE_ONE (1ul << 24) //1.0 in Q24, the nominal 1 host us per TBC tick
+
+CANClockSync::CANClockSync()
+{
+    portMUX_INITIALIZE(&mux);
+    reset();
+}
+
+void CANClockSync::reset()
+{
+    portENTER_CRITICAL(&mux);
+    head = 0;
+    count = 0;
+    valid = false;
+    lastTbc = 0;
+    refTbc = 0;
+    refHost = 0;
+    rateQ24 = RATE_ONE;
+    residualUs = 0;
+    accepted = 0;
+    resyncs = 0;
+    portEXIT_CRITICAL(&mux);
+}
+
+void CANClockSync::addSample(uint32_t tbc, int64_t hostUs)
+{
+    //TBC only counts up, so the unsigned distance from the last sample is the elapsed ticks even across a wrap
+    int64_t ext = (count == 0) ? tbc : lastTbc + (uint32_t)(tbc - (uint32_t)lastTbc);
+    bool restart = false;
+    if (count > 0)
+    {
+        int64_t predicted = refHost + (((ext - refTbc) * (int64_t)rateQ24) >> 24);
+        int64_t error = hostUs - predicted;
+        //TBC restarted or jumped: the old samples describe a different line
+        if (error > CLOCKSYNC_STEP_US || error < -CLOCKSYNC_STEP_US) restart = true;
+    }
+    if (restart)
+    {
+        count = 0;
+        head = 0;
+        ext = tbc;
+    }
+    sampleTbc[head] = ext;
+    sampleHost[head] = hostUs;
+    head = (head + 1) % CLOCKSYNC_SAMPLES;
+    if (count < CLOCKSYNC_SAMPLES) count++;
+
+    //the window is only touched here, so the fit can run outside the lock
+    int64_t newRefTbc, newRefHost;
+    uint32_t newRate, newResidual;
+    fit(newRefTbc, newRefHost, newRate, newResidual);
+
+    portENTER_CRITICAL(&mux);
+    lastTbc = ext;
+    refTbc = newRefTbc;
+    refHost = newRefHost;
+    rateQ24 = newRate;
+    residualUs = newResidual;
+    valid = true;
+    accepted++;
+    if (restart) resyncs++;
+    portEXIT_CRITICAL(&mux);
+}
+
+//Least squares over the window, in coordinates relative to the oldest sample so the doubles
+//only have to hold a few seconds worth of microseconds.
+void CANClockSync::fit(int64_t &outRefTbc, int64_t &outRefHost, uint32_t &outRate, uint32_t &outResidual)
+{
+    uint8_t first = (head + CLOCKSYNC_SAMPLES - count) % CLOCKSYNC_SAMPLES;
+    int64_t x0 = sampleTbc[first];
+    int64_t y0 = sampleHost[first];
+    double mx = 0, my = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t n = (first + i) % CLOCKSYNC_SAMPLES;
+        mx += (double)(sampleTbc[n] - x0);
+        my += (double)(sampleHost[n] - y0);
+    }
+    mx /= count;
+    my /= count;
+
+    double sxx = 0, sxy = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t n = (first + i) % CLOCKSYNC_SAMPLES;
+        double dx = (double)(sampleTbc[n] - x0) - mx;
+        double dy = (double)(sampleHost[n] - y0) - my;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+    //a single sample only fixes the offset, assume the nominal rate until there is a second one
+    double rate = (sxx > 0) ? sxy / sxx : 1.0;
+    if (rate <= 0) rate = 1.0;
+
+    double worst = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint8_t n = (first + i) % CLOCKSYNC_SAMPLES;
+        double r = (double)(sampleHost[n] - y0) - my - rate * ((double)(sampleTbc[n] - x0) - mx);
+        if (r < 0) r = -r;
+        if (r > worst) worst = r;
+    }
+
+    outRefTbc = x0 + (int64_t)mx;
+    outRefHost = y0 + (int64_t)(my - rate * (mx - (double)(int64_t)mx)); //line value at the truncated refTbc
+    outRate = (uint32_t)(rate * RATE_ONE + 0.5);
+    outResidual = (uint32_t)(worst + 0.5);
+}
+
+bool CANClockSync::toHostUs(uint32_t tbc, uint32_t &hostUs)
+{
+    portENTER_CRITICAL(&mux);
+    if (!valid)
+    {
+        portEXIT_CRITICAL(&mux);
+        return false;
+    }
+    //frames are stamped shortly before they are read, so take the signed distance to the newest sample
+    int64_t ext = lastTbc + (int32_t)(tbc - (uint32_t)lastTbc);
+    int64_t host = refHost + (((ext - refTbc) * (int64_t)rateQ24) >> 24);
+    portEXIT_CRITICAL(&mux);
+    hostUs = (uint32_t)host;
+    return true;
+}
+
+void CANClockSync::getStats(CAN_CLOCKSYNC_STATS &stats)
+{
+    uint32_t rate;
+
+    portENTER_CRITICAL(&mux);
+    stats.valid = valid;
+    stats.samples = count;
+    stats.accepted = accepted;
+    stats.resyncs = resyncs;
+    stats.residualUs = residualUs;
+    rate = rateQ24;
+    portEXIT_CRITICAL(&mux);
+
+    stats.driftPpb = (rate > 0) ? (int32_t)((((int64_t)RATE_ONE - (int64_t)rate) * 1000000000ll) / rate) : 0;
+}
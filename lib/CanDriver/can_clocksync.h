@@ -0,0 +1,63 @@
+#ifndef _CAN_CLOCKSYNC_
+#define _CAN_CLOCKSYNC_
+
+#include <Arduino.h>
+
+/*
+Maps a controller's free running time base counter (TBC) onto host time (esp_timer / micros()).
+The driver feeds in (TBC, host us) pairs every so often; a least squares line through the newest
+CLOCKSYNC_SAMPLES pairs gives the offset and the rate (drift) between the two clocks. TBC values
+are extended to 64 bits as samples come in so the 32 bit wrap is invisible to the fit.
+
+A sample that lands more than CLOCKSYNC_STEP_US away from the current line means the TBC was
+reset or jumped (controller reset, mode change). The window is then restarted from that sample.
+*/
+
+#define CLOCKSYNC_SAMPLES   16      //fit window, 16 samples at 250ms = 4 seconds
+#define CLOCKSYNC_STEP_US   2000    //prediction error that counts as a TBC discontinuity
+
+typedef struct
+{
+    bool valid;             //at least one sample since reset
+    uint8_t samples;        //samples in the current fit window
+    uint32_t accepted;      //samples taken since reset
+    uint32_t resyncs;       //window restarts after a TBC discontinuity
+    int32_t driftPpb;       //TBC rate against host time, parts per billion, positive = TBC runs fast
+    uint32_t residualUs;    //worst distance of a window sample from the fitted line
+} CAN_CLOCKSYNC_STATS;
+
+class CANClockSync
+{
+public:
+    CANClockSync();
+
+    void reset();
+    //One correlation point: TBC value read from the controller and the host time (esp_timer_get_time)
+    //at which it was read. Samples must all come from the same task.
+    void addSample(uint32_t tbc, int64_t hostUs);
+    //Convert a TBC value from around the latest sample (within half a wrap, ~35 minutes at 1us)
+    //into host time, low 32 bits like micros(). False until the first sample.
+    bool toHostUs(uint32_t tbc, uint32_t &hostUs);
+    void getStats(CAN_CLOCKSYNC_STATS &stats);
+
+private:
+    void fit(int64_t &outRefTbc, int64_t &outRefHost, uint32_t &outRate, uint32_t &outResidual);
+
+    int64_t sampleTbc[CLOCKSYNC_SAMPLES]; //extended TBC values
+    int64_t sampleHost[CLOCKSYNC_SAMPLES];
+    uint8_t head;           //next slot to write
+    uint8_t count;
+    //below here shared with readers, under mux
+    bool valid;
+    int64_t lastTbc;        //newest extended TBC value, anchor for extending later values
+    //fitted line: host = refHost + (tbc - refTbc) * rateQ24 / 2^24
+    int64_t refTbc;
+    int64_t refHost;
+    uint32_t rateQ24;
+    uint32_t residualUs;
+    uint32_t accepted;
+    uint32_t resyncs;
+    portMUX_TYPE mux;
+};
+
+#endif
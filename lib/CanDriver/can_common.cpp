@@ -213,6 +213,37 @@ uint32_t CAN_COMMON::getDataSpeedFD()
 	return 0;
 }
 
+/**
+ * \brief Returns the bus load estimated from frames this interface has received.
+ *
+ * \param stats Filled with 100ms, 1s and 10s loads and their peaks in 0.01% units
+ *
+ * \note Only traffic seen by the receive path is counted. Frames dropped by hardware filters
+ * are invisible, so open the filters (watchFor()) for a whole-bus figure.
+ */
+void CAN_COMMON::getBusLoad(CAN_BUSLOAD_STATS &stats)
+{
+	busLoad.getStats(stats, busSpeed, micros());
+}
+
+void CAN_COMMON::resetBusLoad()
+{
+	busLoad.reset();
+}
+
+void CAN_COMMON::recordBusLoad(CAN_FRAME &frame, uint32_t nowUs)
+{
+	busLoad.recordFrame(CANBusLoad::classicFrameBits(frame.extended, frame.length, frame.rtr), nowUs);
+}
+
+void CAN_COMMON::recordBusLoad(CAN_FRAME_FD &frame, uint32_t nowUs)
+{
+	uint32_t bits;
+	if (frame.fdMode) bits = CANBusLoad::fdFrameBits(frame.extended, frame.length, true, busSpeed, fd_DataSpeed);
+	else bits = CANBusLoad::classicFrameBits(frame.extended, frame.length, false);
+	busLoad.recordFrame(bits, nowUs);
+}
+
 boolean CAN_COMMON::attachObj(CANListener *listener)
 {
 	for (int i = 0; i < SIZE_LISTENERS; i++)
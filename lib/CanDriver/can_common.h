@@ -2,6 +2,7 @@
 #define _CAN_COMMON_
 
 #include <Arduino.h>
+#include "can_busload.h"
 
 /** Define the typical baudrate for CAN communication. */
 #ifdef CAN_BPS_500K
@@ -243,6 +244,8 @@ public:
     bool hasRXFault();
     bool hasTXFault();
     void setDebuggingMode(bool mode);
+    void getBusLoad(CAN_BUSLOAD_STATS &stats); //estimated bus utilization from received traffic
+    void resetBusLoad();
 
     //pubic API for CAN-FD mode
     inline uint32_t readFD(CAN_FRAME_FD &msg) { return get_rx_buffFD(msg); }
@@ -273,6 +276,9 @@ protected:
     bool faulted;
     bool rxFault;
     bool txFault;    
+    CANBusLoad busLoad;
+    void recordBusLoad(CAN_FRAME &frame, uint32_t nowUs);
+    void recordBusLoad(CAN_FRAME_FD &frame, uint32_t nowUs);
 };
 
 #endif
@@ -314,6 +314,7 @@ uint32_t ESP32CAN::set_baudrate(uint32_t ul_baudrate)
         if (valid_timings[idx].speed == ul_baudrate)
         {
             twai_speed_cfg = valid_timings[idx].cfg;
+            busSpeed = ul_baudrate;
             enable();
             return ul_baudrate;
         }
@@ -370,11 +371,16 @@ bool ESP32CAN::processFrame(twai_message_t &frame)
 
     cyclesSinceTraffic = 0; //reset counter to show that we are receiving traffic
 
+    //TWAI doesn't hand us a hardware timestamp so capture the arrival time here, right after
+    //twai_receive returned. Microseconds on the same timebase as micros()/esp_timer.
+    msg.timestamp = micros();
     msg.id = frame.identifier;
     msg.length = frame.data_length_code;
     msg.rtr = frame.rtr;
     msg.extended = frame.extd;
     for (int i = 0; i < 8; i++) msg.data.byte[i] = frame.data[i];
+    //everything TWAI accepted counts towards bus load, even if no filter below wants it
+    recordBusLoad(msg, msg.timestamp);
     
     for (int i = 0; i < BI_NUM_FILTERS; i++)
     {
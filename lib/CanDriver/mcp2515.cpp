@@ -32,9 +32,8 @@
 #include "SPI.h"
 #include "mcp2515.h"
 #include "mcp2515_defs.h"
-#include "esp32_can.h"
 
-SPISettings mcpSPISettings(8000000, MSBFIRST, SPI_MODE0);
+SPISettings mcpSPISettings(MCP_SPI_SPEED, MSBFIRST, SPI_MODE0);
 
 static TaskHandle_t intDelegateTask = NULL;
 
@@ -120,6 +119,10 @@ MCP2515::MCP2515(uint8_t CS_Pin, uint8_t INT_Pin) : CAN_COMMON(6) {
   running = 0; 
   inhibitTransactions = false;
   initializedResources = false;
+  rolloverBUKT = true;
+  rxb1Older = false;
+  rxFramesRead = 0;
+  rxOverflows = 0;
 }
 
 void MCP2515::initializeResources()
@@ -169,6 +172,7 @@ int MCP2515::Init(uint32_t CAN_Bus_Speed, uint8_t Freq) {
   if(CAN_Bus_Speed>0) {
     if(_init(CAN_Bus_Speed, Freq, 1, false)) {
 		savedBaud = CAN_Bus_Speed;
+		busSpeed = CAN_Bus_Speed;
 		savedFreq = Freq;
 		running = 1;
 	    return CAN_Bus_Speed;
@@ -188,6 +192,7 @@ int MCP2515::Init(uint32_t CAN_Bus_Speed, uint8_t Freq) {
 		    // to get here we must have received something without errors
 		    Mode(MODE_NORMAL);
 			savedBaud = i;
+			busSpeed = i;
 			savedFreq = Freq;	
 			running = 1;
 			return i;
@@ -205,6 +210,7 @@ int MCP2515::Init(uint32_t CAN_Bus_Speed, uint8_t Freq, uint8_t SJW) {
   if(CAN_Bus_Speed>0) {
     if(_init(CAN_Bus_Speed, Freq, SJW, false)) {
 		savedBaud = CAN_Bus_Speed;
+		busSpeed = CAN_Bus_Speed;
 		savedFreq = Freq;
 		running = 1;
 	    return CAN_Bus_Speed;
@@ -224,6 +230,7 @@ int MCP2515::Init(uint32_t CAN_Bus_Speed, uint8_t Freq, uint8_t SJW) {
 		    // to get here we must have received something without errors
 		    Mode(MODE_NORMAL);
 			savedBaud = i;
+			busSpeed = i;
 			savedFreq = Freq;
 			running = 1;
 			return i;
@@ -238,7 +245,7 @@ int MCP2515::Init(uint32_t CAN_Bus_Speed, uint8_t Freq, uint8_t SJW) {
 bool MCP2515::_init(uint32_t CAN_Bus_Speed, uint8_t Freq, uint8_t SJW, bool autoBaud) {
 
   SPI.begin(SCK, MISO, MOSI, SS);       //Set up Serial Peripheral Interface Port for CAN2
-  SPI.setClockDivider(SPI_CLOCK_DIV32);
+  SPI.setClockDivider(spiFrequencyToClockDiv(MCP_SPI_SPEED)); //transactions use mcpSPISettings anyway, keep the two the same
   SPI.setDataMode(SPI_MODE0);
   SPI.setBitOrder(MSBFIRST);
 
@@ -337,6 +344,10 @@ bool MCP2515::_init(uint32_t CAN_Bus_Speed, uint8_t Freq, uint8_t SJW, bool auto
   delay(1);
 
   InitFilters(false);
+  //let a frame roll over into RXB1 when RXB0 is still full instead of dropping it. That gives two
+  //frame times to read RXB0 out rather than one
+  Write(RXB0CTRL, rolloverBUKT ? RXB0BUKT : 0);
+  rxb1Older = false;
   
   if(!autoBaud) {
     // Return to Normal mode
@@ -463,6 +474,9 @@ void MCP2515::setListenOnlyMode(bool state)
 }
 
 void MCP2515::setBuffer0RolloverBUKT(bool enable) {
+    rolloverBUKT = enable;
+    if (!initializedResources) return; //nothing to talk to yet, _init applies it
+
     const byte oldMode = Read(CANSTAT);
 
     if (oldMode != MODE_CONFIG) {
@@ -519,46 +533,37 @@ void MCP2515::Reset() {
   if (!inhibitTransactions) SPI.endTransaction();
 }
 
+//The register and buffer paths below build the whole SPI transaction in a local buffer and clock
+//it out with one transferBytes/writeBytes call instead of a transfer() per byte.
 uint8_t MCP2515::Read(uint8_t address) {
+  uint8_t buf[3] = {CAN_READ, address, 0};
   if (!inhibitTransactions) SPI.beginTransaction(mcpSPISettings);
   digitalWrite(_CS,LOW);
-  SPI.transfer(CAN_READ);
-  SPI.transfer(address);
-  uint8_t data = SPI.transfer(0x00);
+  SPI.transferBytes(buf, buf, 3);
   digitalWrite(_CS,HIGH);
   if (!inhibitTransactions) SPI.endTransaction();
-  return data;
+  return buf[2];
 }
 
 void MCP2515::Read(uint8_t address, uint8_t data[], uint8_t bytes) {
   // allows for sequential reading of registers starting at address - see data sheet
-  uint8_t i;
+  uint8_t cmd[2] = {CAN_READ, address};
+  memset(data, 0, bytes);
   if (!inhibitTransactions) SPI.beginTransaction(mcpSPISettings);
   digitalWrite(_CS,LOW);
-  SPI.transfer(CAN_READ);
-  SPI.transfer(address);
-  for(i=0;i<bytes;i++) {
-    data[i] = SPI.transfer(0x00);
-  }
+  SPI.writeBytes(cmd, 2);
+  SPI.transferBytes(data, data, bytes);
   digitalWrite(_CS,HIGH);
   if (!inhibitTransactions) SPI.endTransaction();
 }
 
-CAN_FRAME MCP2515::ReadBuffer(uint8_t buffer) {
- 
-  // Reads an entire RX buffer.
-  // buffer should be either RXB0 or RXB1
-  
-  CAN_FRAME message;
-  
-  if (!inhibitTransactions) SPI.beginTransaction(mcpSPISettings);
-  digitalWrite(_CS,LOW);
-  SPI.transfer(CAN_READ_BUFFER | (buffer<<1));
-  uint8_t byte1 = SPI.transfer(0x00); // RXBnSIDH
-  uint8_t byte2 = SPI.transfer(0x00); // RXBnSIDL
-  uint8_t byte3 = SPI.transfer(0x00); // RXBnEID8
-  uint8_t byte4 = SPI.transfer(0x00); // RXBnEID0
-  uint8_t byte5 = SPI.transfer(0x00); // RXBnDLC
+//regs points at RXBnSIDH: SIDH, SIDL, EID8, EID0, DLC then 8 data bytes
+void MCP2515::decodeBuffer(const uint8_t *regs, CAN_FRAME &message) {
+  uint8_t byte1 = regs[0]; // RXBnSIDH
+  uint8_t byte2 = regs[1]; // RXBnSIDL
+  uint8_t byte3 = regs[2]; // RXBnEID8
+  uint8_t byte4 = regs[3]; // RXBnEID0
+  uint8_t byte5 = regs[4]; // RXBnDLC
 
   message.extended = (byte2 & B00001000);
 
@@ -573,35 +578,49 @@ CAN_FRAME MCP2515::ReadBuffer(uint8_t buffer) {
 
   message.rtr=(byte5 & B01000000);
   message.length = (byte5 & B00001111);  // Number of data bytes
+  if (message.length > 8) message.length = 8; //DLC 9-15 still means 8 bytes on classic CAN
   for(int i=0; i<message.length; i++) {
-    message.data.byte[i] = SPI.transfer(0x00);
+    message.data.byte[i] = regs[5 + i];
   }
+}
+
+CAN_FRAME MCP2515::ReadBuffer(uint8_t buffer) {
+ 
+  // Reads an entire RX buffer.
+  // buffer should be either RXB0 or RXB1
+  // The READ RX BUFFER instruction clears the buffer's RXnIF when CS goes high
+  
+  CAN_FRAME message;
+  uint8_t buf[14];
+
+  memset(buf, 0, sizeof(buf));
+  buf[0] = CAN_READ_BUFFER | (buffer<<1);
+  if (!inhibitTransactions) SPI.beginTransaction(mcpSPISettings);
+  digitalWrite(_CS,LOW);
+  SPI.transferBytes(buf, buf, 14);
   digitalWrite(_CS,HIGH);
   if (!inhibitTransactions) SPI.endTransaction();
 
+  decodeBuffer(&buf[1], message);
   return message;
 }
 
 void MCP2515::Write(uint8_t address, uint8_t data) {
+  uint8_t buf[3] = {CAN_WRITE, address, data};
   if (!inhibitTransactions) SPI.beginTransaction(mcpSPISettings);
   digitalWrite(_CS,LOW);
-  SPI.transfer(CAN_WRITE);
-  SPI.transfer(address);
-  SPI.transfer(data);
+  SPI.writeBytes(buf, 3);
   digitalWrite(_CS,HIGH);
   if (!inhibitTransactions) SPI.endTransaction();
 }
 
 void MCP2515::Write(uint8_t address, uint8_t data[], uint8_t bytes) {
   // allows for sequential writing of registers starting at address - see data sheet
-  uint8_t i;
+  uint8_t cmd[2] = {CAN_WRITE, address};
   if (!inhibitTransactions) SPI.beginTransaction(mcpSPISettings);
   digitalWrite(_CS,LOW);
-  SPI.transfer(CAN_WRITE);
-  SPI.transfer(address);
-  for(i=0;i<bytes;i++) {
-    SPI.transfer(data[i]);
-  }
+  SPI.writeBytes(cmd, 2);
+  SPI.writeBytes(data, bytes);
   digitalWrite(_CS,HIGH);
   if (!inhibitTransactions) SPI.endTransaction();
 }
@@ -620,54 +639,45 @@ void MCP2515::LoadBuffer(uint8_t buffer, CAN_FRAME *message) {
   // buffer should be one of TXB0, TXB1 or TXB2
   if(buffer==TXB0) buffer = 0; //the values we need are 0, 2, 4 TXB1 and TXB2 are already 2 / 4
 
-  uint8_t byte1=0; // TXBnSIDH
-  uint8_t byte2=0; // TXBnSIDL
-  uint8_t byte3=0; // TXBnEID8
-  uint8_t byte4=0; // TXBnEID0
-  uint8_t byte5=0; // TXBnDLC
+  uint8_t buf[14]; // command, TXBnSIDH, TXBnSIDL, TXBnEID8, TXBnEID0, TXBnDLC, data
+  uint8_t length = message->length;
+  if (length > 8) length = 8;
 
+  buf[0] = CAN_LOAD_BUFFER | buffer;
   if(message->extended) {
-    byte1 = byte((message->id<<3)>>24); // 8 MSBits of SID
-	byte2 = byte((message->id<<11)>>24) & B11100000; // 3 LSBits of SID
-	byte2 = byte2 | byte((message->id<<14)>>30); // 2 MSBits of EID
-	byte2 = byte2 | B00001000; // EXIDE
-    byte3 = byte((message->id<<16)>>24); // EID Bits 15-8
-    byte4 = byte((message->id<<24)>>24); // EID Bits 7-0
+    buf[1] = byte((message->id<<3)>>24); // 8 MSBits of SID
+	buf[2] = byte((message->id<<11)>>24) & B11100000; // 3 LSBits of SID
+	buf[2] = buf[2] | byte((message->id<<14)>>30); // 2 MSBits of EID
+	buf[2] = buf[2] | B00001000; // EXIDE
+    buf[3] = byte((message->id<<16)>>24); // EID Bits 15-8
+    buf[4] = byte((message->id<<24)>>24); // EID Bits 7-0
   } else {
-    byte1 = byte((message->id<<21)>>24); // 8 MSBits of SID
-	byte2 = byte((message->id<<29)>>24) & B11100000; // 3 LSBits of SID
-    byte3 = 0; // TXBnEID8
-    byte4 = 0; // TXBnEID0
+    buf[1] = byte((message->id<<21)>>24); // 8 MSBits of SID
+	buf[2] = byte((message->id<<29)>>24) & B11100000; // 3 LSBits of SID
+    buf[3] = 0; // TXBnEID8
+    buf[4] = 0; // TXBnEID0
   }
-  byte5 = message->length;
+  buf[5] = length;
   if(message->rtr) {
-    byte5 = byte5 | B01000000;
+    buf[5] = buf[5] | B01000000;
   }
+  memcpy(&buf[6], message->data.byte, length);
   
   if (!inhibitTransactions) SPI.beginTransaction(mcpSPISettings);
   digitalWrite(_CS,LOW);
-  SPI.transfer(CAN_LOAD_BUFFER | buffer);  
-  SPI.transfer(byte1);
-  SPI.transfer(byte2);
-  SPI.transfer(byte3);
-  SPI.transfer(byte4);
-  SPI.transfer(byte5);
- 
-  for(int i=0;i<message->length;i++) {
-    SPI.transfer(message->data.byte[i]);
-  }
+  SPI.writeBytes(buf, 6 + length);
   digitalWrite(_CS,HIGH);
   if (!inhibitTransactions) SPI.endTransaction();
 }
 
 uint8_t MCP2515::Status() {
+  uint8_t buf[2] = {CAN_STATUS, 0};
   if (!inhibitTransactions) SPI.beginTransaction(mcpSPISettings);
   digitalWrite(_CS,LOW);
-  SPI.transfer(CAN_STATUS);
-  uint8_t data = SPI.transfer(0x00);
+  SPI.transferBytes(buf, buf, 2);
   digitalWrite(_CS,HIGH);
   if (!inhibitTransactions) SPI.endTransaction();
-  return data;
+  return buf[1];
   /*
   bit 7 - CANINTF.TX2IF
   bit 6 - TXB2CNTRL.TXREQ
@@ -681,13 +691,13 @@ uint8_t MCP2515::Status() {
 }
 
 uint8_t MCP2515::RXStatus() {
+  uint8_t buf[2] = {CAN_RX_STATUS, 0};
   if (!inhibitTransactions) SPI.beginTransaction(mcpSPISettings);
   digitalWrite(_CS,LOW);
-  SPI.transfer(CAN_RX_STATUS);
-  uint8_t data = SPI.transfer(0x00);
+  SPI.transferBytes(buf, buf, 2);
   digitalWrite(_CS,HIGH);
   if (!inhibitTransactions) SPI.endTransaction();
-  return data;
+  return buf[1];
   /*
   bit 7 - CANINTF.RX1IF
   bit 6 - CANINTF.RX0IF
@@ -709,12 +719,10 @@ uint8_t MCP2515::RXStatus() {
 
 void MCP2515::BitModify(uint8_t address, uint8_t mask, uint8_t data) {
   // see data sheet for explanation
+  uint8_t buf[4] = {CAN_BIT_MODIFY, address, mask, data};
   if (!inhibitTransactions) SPI.beginTransaction(mcpSPISettings);
   digitalWrite(_CS,LOW);
-  SPI.transfer(CAN_BIT_MODIFY);
-  SPI.transfer(address);
-  SPI.transfer(mask);
-  SPI.transfer(data);
+  SPI.writeBytes(buf, 4);
   digitalWrite(_CS,HIGH);
   if (!inhibitTransactions) SPI.endTransaction();
 }
@@ -889,15 +897,20 @@ bool MCP2515::GetRXFrame(CAN_FRAME &frame) {
 	return false;
 }
 
+//Each pass takes one STATUS snapshot, reads out whichever RX buffers are full and refills free TX
+//buffers. Only the flags that were actually handled get cleared: clearing all of CANINTF would also
+//clear the flag of a frame that landed after the snapshot and it would be overwritten unread.
+//INT is edge triggered, so the handler goes round again while the pin stays low and, if it runs
+//out of passes, notifies itself to carry on after other tasks have had a go.
 void MCP2515::intHandler(void) {
     CAN_FRAME message;
-    uint32_t ctrlVal;
+    uint8_t status;
     inhibitTransactions = true;
     SPI.beginTransaction(mcpSPISettings);
-    // determine which interrupt flags have been set
-    uint8_t interruptFlags = Read(CANINTF);
-    uint8_t status = Status();
-    //Serial.println(status);
+
+    for (int pass = 0; pass < MCP_SERVICE_PASSES; pass++)
+    {
+      status = Status();
       /*
   bit 7 - CANINTF.TX2IF             128
   bit 6 - TXB2CNTRL.TXREQ           64
@@ -908,57 +921,99 @@ void MCP2515::intHandler(void) {
   bit 1 - CANINTF.RX1IF            2
   bit 0 - CANINTF.RX0IF             1
   */
-    
-    if((status & 1)) //RX buff 0 full
-    {
-      // read from RX buffer 0
-      message = ReadBuffer(RXB0);
-      ctrlVal = Read(RXB0CTRL);
-      handleFrameDispatch(&message, ctrlVal & 1);
-    }
-    if((status & 2)) //RX buff 1 full
-    {
-      // read from RX buffer 1
-      message = ReadBuffer(RXB1);
-      ctrlVal = Read(RXB1CTRL);
-      handleFrameDispatch(&message, ctrlVal & 7);
-    }
-    if((status & 4) == 0) //TX buffer 0 is not pending a transaction
-    {
-      if (uxQueueMessagesWaitingFromISR(txQueue)) {
-        xQueueReceiveFromISR(txQueue, &message, 0);
-			  LoadBuffer(TXB0, &message);
-		   	SendBuffer(TXB0);
-	    }
-    }
-    if((status & 16) == 0) //TX buffer 1 not pending any message to send 
-    {
-      if (uxQueueMessagesWaitingFromISR(txQueue)) {
-        xQueueReceiveFromISR(txQueue, &message, 0);
-			  LoadBuffer(TXB1, &message);
-		   	SendBuffer(TXB1);
-	    }
+      uint8_t rxBits = status & (RX0IF | RX1IF); //same bit positions as in CANINTF
+      if (rxBits) readRXBuffers(rxBits);
+
+      if((status & 4) == 0) //TX buffer 0 is not pending a transaction
+      {
+        if (uxQueueMessagesWaitingFromISR(txQueue)) {
+          xQueueReceiveFromISR(txQueue, &message, 0);
+          LoadBuffer(TXB0, &message);
+          SendBuffer(TXB0);
+        }
+      }
+      if((status & 16) == 0) //TX buffer 1 not pending any message to send 
+      {
+        if (uxQueueMessagesWaitingFromISR(txQueue)) {
+          xQueueReceiveFromISR(txQueue, &message, 0);
+          LoadBuffer(TXB1, &message);
+          SendBuffer(TXB1);
+        }
+      }
+      if((status & 64) == 0) //TX buffer 2 not pending any message to send 
+      {
+        if (uxQueueMessagesWaitingFromISR(txQueue)) {
+          xQueueReceiveFromISR(txQueue, &message, 0);
+          LoadBuffer(TXB2, &message);
+          SendBuffer(TXB2);
+        }
+      }
+
+      //acknowledge what this pass saw: the TX done flags from the snapshot plus the error/wake
+      //flags. RX flags were already cleared as their buffers were read
+      uint8_t txDone = ((status & 8) ? TX0IF : 0) | ((status & 32) ? TX1IF : 0) | ((status & 128) ? TX2IF : 0);
+      BitModify(CANINTF, txDone | ERRIF | WAKIF | MERRF, 0);
+
+      if (!Interrupt()) break; //INT released, nothing new came in
     }
-    if((status & 64) == 0) //TX buffer 2 not pending any message to send 
+
+    uint8_t errFlags = Read(EFLG);
+    if (errFlags & (RX0OVR | RX1OVR))
     {
-      if (uxQueueMessagesWaitingFromISR(txQueue)) {
-        xQueueReceiveFromISR(txQueue, &message, 0);
-			  LoadBuffer(TXB2, &message);
-		   	SendBuffer(TXB2);
-	    }
+      if (errFlags & RX0OVR) rxOverflows++;
+      if (errFlags & RX1OVR) rxOverflows++;
+      BitModify(EFLG, RX0OVR | RX1OVR, 0); //clear RX overflow flags
     }
-    if(interruptFlags & ERRIF) {
-      //Serial.println("E");
-    }
-    if(interruptFlags & MERRF) {
-      //Serial.println("M");
-    }
-
-    Write(CANINTF, 0); //Now, acknowledge the interrupts by clearing the intf bits
-    Write(EFLG, 0); //clear RX overflow flags
 
     inhibitTransactions = false;
     SPI.endTransaction();
+
+    //still asserted after all passes: no new falling edge will come, so queue another round
+    if (Interrupt()) xTaskNotifyGive(intDelegateTask);
+}
+
+//Read out the RX buffers flagged in rxBits. Each read starts at RXBnCTRL so the filter hit comes
+//from the same transaction as the frame, then the flags are cleared once the frames are copied out.
+//RXB0 and RXB1 sit 16 bytes apart (RXB0CTRL 0x60 to RXB1D7 0x7D) so with both full a single 30 byte
+//read gets both frames.
+//Which of the two is older depends on history. A frame only rolls over into RXB1 while RXB0 is
+//full, so if that RXB0 frame is still there it is the older one. But if RXB0 was read and freed
+//on its own while RXB1 was already full, the next frame into RXB0 is newer than RXB1. So after
+//freeing RXB0 alone, one STATUS read checks RX1IF. Short of this task being preempted right there,
+//two frames can't arrive between the clear and that read, so a set flag means RXB1 filled before
+//RXB0 was freed and is dispatched first.
+//Frames that filters send straight to RXB1 (RXF2-RXF5) carry no ordering against RXB0.
+//Only called from intHandler, which already holds the SPI transaction.
+void MCP2515::readRXBuffers(uint8_t rxBits) {
+    uint8_t buf[2 + 30];
+    uint8_t start = (rxBits & RX0IF) ? RXB0CTRL : RXB1CTRL;
+    uint8_t bytes = (rxBits == (RX0IF | RX1IF)) ? 30 : 14;
+
+    memset(buf, 0, 2 + bytes);
+    buf[0] = CAN_READ;
+    buf[1] = start;
+    digitalWrite(_CS,LOW);
+    SPI.transferBytes(buf, buf, 2 + bytes);
+    digitalWrite(_CS,HIGH);
+    BitModify(CANINTF, rxBits, 0); //buffers are free for the chip again
+
+    bool rxb1First = rxb1Older;
+    rxb1Older = (rxBits == RX0IF) && (Status() & RX1IF);
+
+    uint32_t nowUs = micros();
+    const uint8_t *rxb1 = &buf[2 + RXB1CTRL - start];
+    if ((rxBits & RX1IF) && rxb1First) dispatchRXBuffer(rxb1, 7, nowUs);
+    if (rxBits & RX0IF) dispatchRXBuffer(&buf[2], 1, nowUs);
+    if ((rxBits & RX1IF) && !rxb1First) dispatchRXBuffer(rxb1, 7, nowUs);
+}
+
+//regs starts at RXBnCTRL, whose low bits (filterBits) are the filter hit
+void MCP2515::dispatchRXBuffer(const uint8_t *regs, uint8_t filterBits, uint32_t nowUs) {
+    CAN_FRAME message;
+    decodeBuffer(&regs[1], message);
+    recordBusLoad(message, nowUs);
+    rxFramesRead++;
+    handleFrameDispatch(&message, regs[0] & filterBits);
 }
 
 void MCP2515::handleFrameDispatch(CAN_FRAME *frame, int filterHit)
@@ -39,6 +39,8 @@
 
 #define MCP_RX_BUFFER_SIZE	32
 #define MCP_TX_BUFFER_SIZE  16
+#define MCP_SPI_SPEED 10000000 //fastest SPI clock the MCP2515 supports
+#define MCP_SERVICE_PASSES 8 //status/readout rounds per interrupt before the task yields
 
 class MCP2515 : public CAN_COMMON
 {
@@ -90,13 +92,21 @@ class MCP2515 : public CAN_COMMON
     void GetRXFilter(uint8_t filter, uint32_t &filterVal, boolean &isExtended);
     void GetRXMask(uint8_t mask, uint32_t &filterVal);
 	void sendCallback(CAN_FRAME *frame);
-    void setBuffer0RolloverBUKT(bool enable);
+    void setBuffer0RolloverBUKT(bool enable); //on by default, kept across re-init
+
+    //RX counters. Sample rxFramesRead over time for frames/sec. rxOverflows counts the times a
+    //buffer overflowed (EFLG RXnOVR), each one is at least one frame the chip had to drop
+    volatile uint32_t rxFramesRead;
+    volatile uint32_t rxOverflows;
 
 	void InitFilters(bool permissive);
 	void intHandler();
   private:
 	bool _init(uint32_t baud, uint8_t freq, uint8_t sjw, bool autoBaud);
     void handleFrameDispatch(CAN_FRAME *frame, int filterHit);
+    void readRXBuffers(uint8_t rxBits);
+    void dispatchRXBuffer(const uint8_t *regs, uint8_t filterBits, uint32_t nowUs);
+    void decodeBuffer(const uint8_t *regs, CAN_FRAME &message);
     void initializeResources();
     // Pin variables
 	uint8_t _CS;
@@ -108,6 +118,8 @@ class MCP2515 : public CAN_COMMON
 	volatile uint8_t running; //1 if out of init code, 0 if still trying to initialize (auto baud detecting)
 	volatile bool inhibitTransactions;
     bool initializedResources;
+    bool rolloverBUKT;
+    bool rxb1Older; //RXB1 filled before RXB0 was last freed, so it goes out first (see readRXBuffers)
     // Definitions for software buffers
 };
 
@@ -60,6 +60,9 @@
 #define ERRIF			0x20
 #define WAKIF			0x40
 #define MERRF			0x80
+// EFLG
+#define RX0OVR			0x40
+#define RX1OVR			0x80
 
 // Configuration Registers
 #define CANSTAT         0x0E
@@ -3,12 +3,37 @@
 #include "mcp2517fd.h"
 #include "mcp2517fd_defines.h"
 #include "mcp2517fd_regs.h"
+#include "esp_timer.h"
 
 //20Mhz is the fastest we can go (because of the MCP2517/18 chip. The ESP32 or ESP32S3 can go much faster)
 #define FD_SPI_SPEED 10000000
 
+//Message RAM layout (TEF and TXQ disabled): FIFOs are allocated in index order. The bulk RX FIFO
+//(FIFO1) comes first, then the TX FIFO, then one RX FIFO per higher priority class (FIFO3 up).
+//TX uses a plain FIFO rather than the TXQ because the TXQ sends by ID and frees its slots out of
+//order, which rules out writing several frames into consecutive objects.
+#define FD_RX_FIFO_DEPTH 18
+#define FD_RX_CLASS_DEPTH 4 //default depth of the higher priority RX FIFOs
+#define FD_TX_FIFO 2
+#define FD_TX_FIFO_DEPTH 9
+#define FD_MESSAGE_RAM 2048
+
+//RX class 0 is FIFO1, the others sit past the TX FIFO
+static inline uint8_t rxClassFifo(uint8_t rxClass)
+{
+    return (rxClass == 0) ? 1 : FD_TX_FIFO + rxClass;
+}
+
 SPISettings fdSPISettings(FD_SPI_SPEED, MSBFIRST, SPI_MODE0);
 
+//DLC codes 9-15 select the longer FD payload sizes
+static uint8_t dlcToLength(uint8_t dlc)
+{
+    static const uint8_t fdLengths[7] = {12, 16, 20, 24, 32, 48, 64};
+    if (dlc <= 8) return dlc;
+    return fdLengths[dlc - 9];
+}
+
 //Modified to loop, waiting for 1ms then pretending an interrupt came in
 //basically switches to a polled system where we do not pay attention to actual interrupts
 void task_MCPIntFD( void *pvParameters )
@@ -179,6 +204,27 @@ MCP2517FD::MCP2517FD(uint8_t CS_Pin, uint8_t INT_Pin) : CAN_COMMON(32) {
     txBufferSize = FD_TX_BUFFER_SIZE;
     rxBufferSize = FD_RX_BUFFER_SIZE;
     initializedResources = false;
+    rxFramesRead = 0;
+    rxBurstReads = 0;
+    rxFifoCount = 1;
+    rxFifoMask = 1 << 1;
+    for (int c = 0; c < FD_RX_FIFOS_MAX; c++)
+    {
+        rxFifoDepthCfg[c] = (c == 0) ? FD_RX_FIFO_DEPTH : FD_RX_CLASS_DEPTH;
+        rxFifoDepth[c] = rxFifoDepthCfg[c];
+        rxFifoAddr[c] = 0;
+        rxOverflows[c] = 0;
+    }
+    for (int f = 0; f < FD_NUM_FILTERS; f++) filterClass[f] = 0;
+    pendingFilterClass = 0;
+    portMUX_INITIALIZE(&filterClassMux);
+    rxPayloadBytes = 64;
+    rxObjectSize = 12 + 64;
+    txFifoAddr = 0;
+    txFifoDepth = FD_TX_FIFO_DEPTH;
+    txObjectSize = 8 + 64;
+    lastClockSampleUs = 0;
+    hostTimestamps = true;
 }
 
 void MCP2517FD::setRXBufferSize(int newSize)
@@ -191,6 +237,28 @@ void MCP2517FD::setTXBufferSize(int newSize)
     txBufferSize = newSize;
 }
 
+void MCP2517FD::setHostTimestamps(bool state)
+{
+    hostTimestamps = state;
+}
+
+void MCP2517FD::getClockSync(CAN_CLOCKSYNC_STATS &stats)
+{
+    clockSync.getStats(stats);
+}
+
+//Read the TBC bracketed by two host timestamps and feed the midpoint to the correlator.
+//Called from the polling task like all other SPI traffic.
+void MCP2517FD::sampleClock()
+{
+    int64_t before = esp_timer_get_time();
+    uint32_t tbc = Read(ADDR_CiTBC);
+    int64_t after = esp_timer_get_time();
+    lastClockSampleUs = after;
+    if (after - before > FD_CLOCKSYNC_MAX_READ_US) return; //got preempted, the midpoint means little
+    clockSync.addSample(tbc, before + (after - before) / 2);
+}
+
 
 void MCP2517FD::initializeResources()
 {
@@ -309,6 +377,7 @@ int MCP2517FD::Init(uint32_t CAN_Bus_Speed, uint8_t Freq, uint8_t SJW) {
         if(_init(CAN_Bus_Speed, Freq, SJW, false)) 
         {
             savedNominalBaud = CAN_Bus_Speed;
+            busSpeed = CAN_Bus_Speed;
             savedFreq = Freq;
             running = 1;
             errorFlags = 0;
@@ -336,6 +405,7 @@ int MCP2517FD::Init(uint32_t CAN_Bus_Speed, uint8_t Freq, uint8_t SJW) {
 		                // to get here we must have received something without errors
 		                Mode(CAN_NORMAL_MODE);
 			            savedNominalBaud = i;
+			            busSpeed = i;
 			            savedFreq = Freq;
 			            running = 1;
                         errorFlags = 0;
@@ -363,7 +433,9 @@ uint32_t MCP2517FD::initFD(uint32_t nominalRate, uint32_t dataRate)
         if(_initFD(nominalRate, dataRate, 40, 4, false)) 
         {
             savedNominalBaud = nominalRate;
+            busSpeed = nominalRate;
             savedDataBaud = dataRate;
+            fd_DataSpeed = dataRate;
             savedFreq = 40;
             running = 1;
             errorFlags = 0;
@@ -391,7 +463,9 @@ uint32_t MCP2517FD::initFD(uint32_t nominalRate, uint32_t dataRate)
 		                // to get here we must have received something without errors
 		                Mode(CAN_NORMAL_MODE);
 			            savedNominalBaud = i;
+			            busSpeed = i;
                         savedDataBaud = dataRate;
+                        fd_DataSpeed = dataRate;
 			            savedFreq = 40;
 			            running = 1;
                         errorFlags = 0;
@@ -411,27 +485,29 @@ uint32_t MCP2517FD::initFD(uint32_t nominalRate, uint32_t dataRate)
 void MCP2517FD::txQueueSetup()
 {
     uint32_t debugVal;
-    REG_CiTXQCON txQCon;
+    REG_CiFIFOCON txCon;
     const TickType_t xDelay = 1;
+    const uint16_t conAddr = ADDR_CiFIFOCON + (CiFIFO_OFFSET * FD_TX_FIFO);
 
-    Write8(ADDR_CiFIFOCON + 1, 0); //Unset TXREQ which should abort all pending TX frames in queue
+    Write8(conAddr + 1, 0); //Unset TXREQ which should abort all pending TX frames in queue
     vTaskDelay(xDelay); //wait a bit for that to work
 
-    txQCon.word = 0x400; //set FRESET to reset this FIFO
-    Write(ADDR_CiTXQCON, txQCon.word);
+    txCon.word = 0x400; //set FRESET to reset this FIFO
+    Write(conAddr, txCon.word);
     vTaskDelay(xDelay);
 
-    //transmit queue set up
-    txQCon.word = 0;
-    txQCon.txBF.PayLoadSize = 7; //64 bytes
-    txQCon.txBF.FifoSize = 8; //9 frame long FIFO
-    txQCon.txBF.TxAttempts = 0; //No retries. One and done. It works or we throw it away
-    txQCon.txBF.TxPriority = 15; //middle priority
-    txQCon.txBF.TxEmptyIE = 0;
-    Write(ADDR_CiTXQCON, txQCon.word);
+    //transmit FIFO set up
+    txCon.word = 0;
+    txCon.txBF.TxEnable = 1;
+    txCon.txBF.PayLoadSize = inFDMode ? 7 : 0; //64 bytes for FD, 8 is all classic frames need
+    txCon.txBF.FifoSize = FD_TX_FIFO_DEPTH - 1; //9 frame long FIFO
+    txCon.txBF.TxAttempts = 0; //No retries. One and done. It works or we throw it away
+    txCon.txBF.TxPriority = 15; //middle priority
+    txCon.txBF.TxEmptyIE = 0;
+    Write(conAddr, txCon.word);
     if (debuggingMode)
     {
-        debugVal = Read(ADDR_CiTXQCON);
+        debugVal = Read(conAddr);
         Serial.println(debugVal, BIN);
     }
 }
@@ -451,22 +527,126 @@ void MCP2517FD::commonInit()
     //builtin timerstamping setup
     tsCon.bF.TBCPrescaler = 39; //40x slow down means 1us resolution
     tsCon.bF.TBCEnable = 1;
+    tsCon.bF.TimeStampEOF = 1; //stamp frames when they become valid, closest to when CAN0 sees them
     Write(ADDR_CiTSCON ,tsCon.word);
+    //the TBC starts over, so does the mapping to host time
+    clockSync.reset();
+    lastClockSampleUs = 0;
     if (debuggingMode) 
     {
         debugVal = Read(ADDR_CiTSCON);
         Serial.println(debugVal, BIN);
     }
 
-    //Last FIFO we'll set up is receive fifo
-    fifoCon.word = 0; //clear it all out to start fresh
-    fifoCon.rxBF.TxEnable = 0; //Make FIFO1 a RX FIFO
-    fifoCon.rxBF.FifoSize = 17; //18 frames long
-    fifoCon.rxBF.PayLoadSize = 7; //64 byte payload possible
-    fifoCon.rxBF.RxFullIE = 1; //if the FIFO fills up let the code know (hopefully never happens!)
-    fifoCon.rxBF.RxNotEmptyIE = 1; //if the FIFO isn't empty let the code know 
-    fifoCon.rxBF.RxTimeStampEnable = 1; //time stamp each frame as it comes in
-    Write(ADDR_CiFIFOCON + (CiFIFO_OFFSET * 1), fifoCon.word); //Write to FIFO1
+    //64 byte payload possible in FD mode. Classic frames only need 8, which keeps the objects
+    //at 20 bytes so the bulk readout in handleRXFifo doesn't clock out 56 unused bytes per frame
+    rxPayloadBytes = inFDMode ? 64 : 8;
+    rxObjectSize = 12 + rxPayloadBytes; //ID, flags and timestamp words then the payload
+    txFifoDepth = FD_TX_FIFO_DEPTH;
+    txObjectSize = 8 + (inFDMode ? 64 : 8); //TX objects have no timestamp word
+
+    //Share out message RAM. Every RX FIFO gets at least one object, then the highest class gets
+    //its requested depth first and the bulk FIFO takes what is left. Nine TX objects plus 18 RX
+    //objects of 64 bytes nearly fill the 2K, so in FD mode extra classes come out of the bulk FIFO
+    uint16_t ramLeft = FD_MESSAGE_RAM - txFifoDepth * txObjectSize - rxFifoCount * rxObjectSize;
+    for (int c = rxFifoCount - 1; c >= 0; c--)
+    {
+        uint8_t extra = rxFifoDepthCfg[c] - 1;
+        if (extra > ramLeft / rxObjectSize) extra = ramLeft / rxObjectSize;
+        rxFifoDepth[c] = 1 + extra;
+        ramLeft -= extra * rxObjectSize;
+        if (debuggingMode && rxFifoDepth[c] < rxFifoDepthCfg[c])
+        {
+            char buf[64];
+            snprintf(buf, sizeof(buf), "RX class %i trimmed to %i frames", c, rxFifoDepth[c]);
+            Serial.println(buf);
+        }
+    }
+
+    //Last FIFOs we'll set up are the receive FIFOs
+    rxFifoMask = 0;
+    for (int c = 0; c < rxFifoCount; c++)
+    {
+        fifoCon.word = 0; //clear it all out to start fresh
+        fifoCon.rxBF.TxEnable = 0; //RX FIFO
+        fifoCon.rxBF.FifoSize = rxFifoDepth[c] - 1;
+        fifoCon.rxBF.PayLoadSize = inFDMode ? 7 : 0;
+        fifoCon.rxBF.RxFullIE = 1; //if the FIFO fills up let the code know (hopefully never happens!)
+        fifoCon.rxBF.RxNotEmptyIE = 1; //if the FIFO isn't empty let the code know 
+        fifoCon.rxBF.RxOverFlowIE = 1; //counted per class in intHandler
+        fifoCon.rxBF.RxTimeStampEnable = 1; //time stamp each frame as it comes in
+        Write(ADDR_CiFIFOCON + (CiFIFO_OFFSET * rxClassFifo(c)), fifoCon.word);
+        rxFifoMask |= 1ul << rxClassFifo(c);
+    }
+
+    //objects are laid out in FIFO index order: FIFO1, TX FIFO2, then the higher RX classes
+    rxFifoAddr[0] = 0;
+    txFifoAddr = rxFifoDepth[0] * rxObjectSize;
+    uint16_t addr = txFifoAddr + txFifoDepth * txObjectSize;
+    for (int c = 1; c < rxFifoCount; c++)
+    {
+        rxFifoAddr[c] = addr;
+        addr += rxFifoDepth[c] * rxObjectSize;
+    }
+}
+
+bool MCP2517FD::setRXFifos(uint8_t count, const uint8_t depths[])
+{
+    if (count < 1 || count > FD_RX_FIFOS_MAX) return false;
+    for (int c = 0; c < count; c++)
+    {
+        if (depths[c] < 1 || depths[c] > 32) return false;
+    }
+    for (int c = 0; c < count; c++) rxFifoDepthCfg[c] = depths[c];
+    rxFifoCount = count;
+    return true;
+}
+
+bool MCP2517FD::setFilterClass(uint8_t filter, uint8_t rxClass)
+{
+    if (filter >= FD_NUM_FILTERS || rxClass >= FD_RX_FIFOS_MAX) return false;
+    filterClass[filter] = rxClass;
+    if (running)
+    {
+        //all SPI goes through the polling task, so just flag the filter for intHandler
+        portENTER_CRITICAL(&filterClassMux);
+        pendingFilterClass |= 1ul << filter;
+        portEXIT_CRITICAL(&filterClassMux);
+    }
+    return true;
+}
+
+//point enabled filters whose class changed at their new FIFO. A filter has to be disabled to change it
+void MCP2517FD::applyFilterClasses()
+{
+    portENTER_CRITICAL(&filterClassMux);
+    uint32_t pending = pendingFilterClass;
+    pendingFilterClass = 0;
+    portEXIT_CRITICAL(&filterClassMux);
+
+    for (int f = 0; f < FD_NUM_FILTERS; f++)
+    {
+        if (!(pending & (1ul << f))) continue;
+        if (Read8(ADDR_CiFLTCON + f) & 0x80)
+        {
+            Write8(ADDR_CiFLTCON + f, 0);
+            Write8(ADDR_CiFLTCON + f, 0x80 + filterFifo(f));
+        }
+    }
+}
+
+uint32_t MCP2517FD::getRXOverflows(uint8_t rxClass)
+{
+    if (rxClass >= FD_RX_FIFOS_MAX) return 0;
+    return rxOverflows[rxClass];
+}
+
+//a class that isn't configured falls back to the bulk FIFO
+uint8_t MCP2517FD::filterFifo(uint8_t filter)
+{
+    uint8_t rxClass = filterClass[filter];
+    if (rxClass >= rxFifoCount) rxClass = 0;
+    return rxClassFifo(rxClass);
 }
 
 bool MCP2517FD::_init(uint32_t CAN_Bus_Speed, uint8_t Freq, uint8_t SJW, bool autoBaud) {
@@ -545,7 +725,7 @@ bool MCP2517FD::_init(uint32_t CAN_Bus_Speed, uint8_t Freq, uint8_t SJW, bool au
     canConfig.bF.EsiInGatewayMode = 0; //ESI reflects error status
     canConfig.bF.SystemErrorToListenOnly = 0; //Don't automatically switch to listen only on system error
     canConfig.bF.StoreInTEF = 0; // Don't store transmitted messages back into RAM
-    canConfig.bF.TXQEnable = 1; //But, do enable the transmission queue and save space for it in RAM
+    canConfig.bF.TXQEnable = 0; //TX goes through FIFO2 so the queue doesn't need any RAM
     canConfig.bF.TxBandWidthSharing = 4; //wait 16 bit times before trying to send another frame. Allows other nodes a bit of room to butt in
     canConfig.bF.RequestOpMode = CAN_CONFIGURATION_MODE;
     Write(ADDR_CiCON, canConfig.word);
@@ -700,7 +880,7 @@ bool MCP2517FD::_initFD(uint32_t nominalSpeed, uint32_t dataSpeed, uint8_t freq,
     canConfig.bF.EsiInGatewayMode = 0; //ESI reflects error status
     canConfig.bF.SystemErrorToListenOnly = 1; //Auto switch to listen only on system err bit
     canConfig.bF.StoreInTEF = 0; // Don't store transmitted messages back into RAM
-    canConfig.bF.TXQEnable = 1; //But, do enable the transmission queue and save space for it in RAM
+    canConfig.bF.TXQEnable = 0; //TX goes through FIFO2 so the queue doesn't need any RAM
     canConfig.bF.TxBandWidthSharing = 4; //wait 16 bit times before trying to send another frame. Allows other nodes a bit of room to butt in
     canConfig.bF.RequestOpMode = CAN_CONFIGURATION_MODE;
     Write(ADDR_CiCON, canConfig.word);
@@ -801,7 +981,7 @@ int MCP2517FD::_setFilterSpecific(uint8_t mailbox, uint32_t id, uint32_t mask, b
     if (extended) packedID |= 1 << 30; //only allow extended frames to match
     Write(ADDR_CiFLTOBJ + (CiFILTER_OFFSET * mailbox), packedID);
     Write(ADDR_CiMASK + (CiFILTER_OFFSET * mailbox), packedMask);
-    Write8(ADDR_CiFLTCON + mailbox, 0x80 + 1); //Enable the filter and send it to FIFO1 which is the RX FIFO
+    Write8(ADDR_CiFLTCON + mailbox, 0x80 + filterFifo(mailbox)); //Enable the filter and send it to the RX FIFO of its class
     return mailbox;
 }
 
@@ -919,21 +1099,19 @@ void MCP2517FD::printDebug()
     Serial.print("  TDC: ");
     Serial.println(Read(ADDR_CiTDC), HEX);
 
-    Serial.print("TxqCon: ");
-    Serial.print(Read(ADDR_CiTXQCON), HEX);
-    Serial.print("  TsCon: ");
+    Serial.print("TsCon: ");
     Serial.print(Read(ADDR_CiTSCON), HEX);
     Serial.print("  Int: ");
     Serial.println(Read(ADDR_CiINT), HEX);
 
-    Serial.print("F0Ctrl: ");
-    Serial.print(Read(ADDR_CiFIFOCON), HEX);
-    Serial.print("  F0 Status: ");
-    Serial.print(Read(ADDR_CiFIFOSTA), HEX);
-    Serial.print("  F1Ctrl: ");
+    Serial.print("F1Ctrl: ");
     Serial.print(Read(ADDR_CiFIFOCON + CiFIFO_OFFSET), HEX);
     Serial.print("  F1 Status: ");
-    Serial.println(Read(ADDR_CiFIFOSTA + CiFIFO_OFFSET), HEX);
+    Serial.print(Read(ADDR_CiFIFOSTA + CiFIFO_OFFSET), HEX);
+    Serial.print("  F2Ctrl: ");
+    Serial.print(Read(ADDR_CiFIFOCON + (CiFIFO_OFFSET * FD_TX_FIFO)), HEX);
+    Serial.print("  F2 Status: ");
+    Serial.println(Read(ADDR_CiFIFOSTA + (CiFIFO_OFFSET * FD_TX_FIFO)), HEX);
 }
 
 void MCP2517FD::Reset() {
@@ -1030,65 +1208,51 @@ uint32_t MCP2517FD::ReadFrameBuffer(uint16_t address, CAN_FRAME_FD &message) {
     //Then we check to see if we really need to read more.
     //This prevents having to read 64 data bytes if we were just receiving normal frames.
     SPI.transferBytes(out_buff, in_buff, 22);
-    message.length = ptr_buff[1] & 0xF;
-    switch (message.length)
-    {
-    case 9:
-        message.length = 12;
-        break;
-    case 10:
-        message.length = 16;
-        break;
-    case 11:
-        message.length = 20;
-        break;
-    case 12:
-        message.length = 24;
-        break;
-    case 13:
-        message.length = 32;
-        break;
-    case 14:
-        message.length = 48;
-        break;
-    case 15:
-        message.length = 64;
-        break;
-    }
-    int neededBytes = message.length - 8;
+    int neededBytes = dlcToLength(ptr_buff[1] & 0xF) - 8;
     if (neededBytes > 0) SPI.transferBytes(&out_buff[22], &in_buff[22], neededBytes);
     digitalWrite(_CS,HIGH);
     SPI.endTransaction();
-  /*message in RAM is as follows:
-    The first 32 bits are the message ID, either 11 or 29 bit (12 bit not handled yet), then bit 29 is RRS
-    The next 32 bits have:
-       first 4 bits are DLC
-       Then
-       IDE (extended address) (bit 4)
-       RTR (Remote request) (bit 5)
-       BRS (Baud rate switch for data) (bit 6)
-       FDF (FD mode) (Bit 7)
-       ESI (1 = tx node error passive, 0 = tx node error active) (bit 8)
-       Bits 11 - 15 = Filter hit (0-31)
-    The next 32 bits are all the timestamp (in microseconds for us)
-    Then each additional byte is a data byte (up to 64 bytes)
-  */
-    message.extended = (ptr_buff[1] >> 4) & 1;
-    if (message.extended) message.id = unpackExtValue(ptr_buff[0] & 0x1FFFFFFFull);
-    else message.id = ptr_buff[0] & 0x7FF;
+    return decodeFrameObject(&in_buff[2], 64, message);
+}
+
+/*message in RAM is as follows:
+  The first 32 bits are the message ID, either 11 or 29 bit (12 bit not handled yet), then bit 29 is RRS
+  The next 32 bits have:
+     first 4 bits are DLC
+     Then
+     IDE (extended address) (bit 4)
+     RTR (Remote request) (bit 5)
+     BRS (Baud rate switch for data) (bit 6)
+     FDF (FD mode) (Bit 7)
+     ESI (1 = tx node error passive, 0 = tx node error active) (bit 8)
+     Bits 11 - 15 = Filter hit (0-31)
+  The next 32 bits are all the timestamp (TBC ticks, microseconds for us)
+  Then each additional byte is a data byte (up to 64 bytes)
+  payloadBytes is what the object has room for. A longer FD frame stored in a smaller object
+  is truncated by the chip so the length is clamped to match.
+*/
+uint32_t MCP2517FD::decodeFrameObject(const uint8_t *obj, uint8_t payloadBytes, CAN_FRAME_FD &message) {
+    uint32_t header[3];
+    memcpy(header, obj, sizeof(header));
+
+    message.length = dlcToLength(header[1] & 0xF);
+    message.extended = (header[1] >> 4) & 1;
+    if (message.extended) message.id = unpackExtValue(header[0] & 0x1FFFFFFFull);
+    else message.id = header[0] & 0x7FF;
     message.fid = 0;
     message.priority = 0;
-    message.fdMode = (ptr_buff[1] >> 7) & 1;
+    message.fdMode = (header[1] >> 7) & 1;
     if (message.fdMode)
-        message.rrs = ptr_buff[0] >> 29 & 1;
+        message.rrs = header[0] >> 29 & 1;
     else
-        message.rrs = ptr_buff[1] >> 5 & 1;
-    message.timestamp = ptr_buff[2];
+        message.rrs = header[1] >> 5 & 1;
+    message.timestamp = header[2];
     if (!message.fdMode && message.length > 8) message.length = 8;
+    if (message.length > payloadBytes) message.length = payloadBytes;
     //only copy the number of words we really have to.
     int copyWords = (message.length + 3) / 4;
-    for (int j = 0; j < copyWords; j++) message.data.uint32[j] = ptr_buff[3 + j];
-    return (ptr_buff[1] >> 11) & 31; //return which filter produced this message
+    memcpy(message.data.uint32, obj + 12, copyWords * 4);
+    return (header[1] >> 11) & 31; //return which filter produced this message
 }
 
 void MCP2517FD::Write8(uint16_t address, uint8_t data) {
@@ -1155,56 +1319,12 @@ void MCP2517FD::LoadFrameBuffer(uint16_t address, CAN_FRAME_FD &message)
 {
     uint8_t buffer[76];
     uint32_t *buffPtr;
-    int dataBytes;
-    /*message in RAM is as follows (same as RX but without the timestamp):
-    The first 32 bits are the message ID, either 11 or 29 bit (12 bit not handled yet), then bit 29 is RRS
-    The next 32 bits have:
-       first 4 bits are DLC
-       Then
-       IDE (extended address) (bit 4)
-       RTR (Remote request) (bit 5)
-       BRS (Baud rate switch for data) (bit 6)
-       FDF (FD mode) (Bit 7)
-       ESI (1 = tx node error passive, 0 = tx node error active) (bit 8)
-       SEQ (sequence number) (Bits 9-15) - Optional sequence number for your reference
-    Then each additional byte is a data byte (up to 64 bytes)
-    */
+    int objBytes;
+
     buffer[0] = (CMD_WRITE << 4) | ((address >> 8) & 0xF);
     buffer[1] = address & 0xFF;
     buffPtr = (uint32_t *)&buffer[2];
-
-    if (message.extended) buffPtr[0] = packExtValue(message.id);
-    else buffPtr[0] = message.id & 0x7FF;
-
-    buffPtr[1] = (message.extended) ? (1 << 4) : 0;
-    buffPtr[1] |= (message.fdMode) ? (3 << 6) : 0; //set both the BRS and FDF bits at once
-    if (message.fdMode)
-        buffPtr[0] |= (message.rrs) ? (1 << 29) : 0;
-    else
-        buffPtr[1] |= (message.rrs) ? (1 << 5) : 0;
-    if (!message.fdMode && message.length > 8) message.length = 8;
-    dataBytes = message.length;
-
-    //promote requested frame length to the next allowable size
-    if (message.length > 8 && message.length < 13) buffPtr[1] |= 9;
-    else if (message.length > 12 && message.length < 17) buffPtr[1] |= 10;
-    else if (message.length > 16 && message.length < 21) buffPtr[1] |= 11;
-    else if (message.length > 20 && message.length < 25) buffPtr[1] |= 12;
-    else if (message.length > 24 && message.length < 33) buffPtr[1] |= 13;
-    else if (message.length > 32 && message.length < 49) buffPtr[1] |= 14;
-    else if (message.length > 48 && message.length < 65) buffPtr[1] |= 15;
-    else
-    {
-        if (message.length < 9) buffPtr[1] |= message.length;
-        else buffPtr[1] |= 8;
-    }
-
-    //only copy the number of data words we really have to.
-    int copyWords = (dataBytes + 3) / 4;
-    for (int j = 0; j < copyWords; j++)
-    {
-        buffPtr[2 + j] = message.data.uint32[j];
-    }
+    objBytes = encodeFrameObject(message, &buffer[2]);
 
     if (debuggingMode)
     {
@@ -1219,20 +1339,73 @@ void MCP2517FD::LoadFrameBuffer(uint16_t address, CAN_FRAME_FD &message)
     //taskDISABLE_INTERRUPTS();
     SPI.beginTransaction(fdSPISettings);
     digitalWrite(_CS,LOW);
-    SPI.writeBytes((uint8_t *) &buffer[0], 10 + (copyWords * 4)); //and only write just as many bytes as we need to for this frame
+    SPI.writeBytes((uint8_t *) &buffer[0], 2 + objBytes); //and only write just as many bytes as we need to for this frame
     digitalWrite(_CS,HIGH);
     SPI.endTransaction();
     //taskENABLE_INTERRUPTS();
-    Write8(ADDR_CiFIFOCON + 1, 3); //Set UINC and TX_Request
+    Write8(ADDR_CiFIFOCON + (CiFIFO_OFFSET * FD_TX_FIFO) + 1, 3); //Set UINC and TX_Request
     if (debuggingMode)
     {
         Serial.write('_');
-        uint32_t cnf = Read(ADDR_CiFIFOCON);
+        uint32_t cnf = Read(ADDR_CiFIFOCON + (CiFIFO_OFFSET * FD_TX_FIFO));
         Serial.printf("FIFOCON: 0x%x\n", cnf);
     }
     
 }
 
+/*message in RAM is as follows (same as RX but without the timestamp):
+The first 32 bits are the message ID, either 11 or 29 bit (12 bit not handled yet), then bit 29 is RRS
+The next 32 bits have:
+   first 4 bits are DLC
+   Then
+   IDE (extended address) (bit 4)
+   RTR (Remote request) (bit 5)
+   BRS (Baud rate switch for data) (bit 6)
+   FDF (FD mode) (Bit 7)
+   ESI (1 = tx node error passive, 0 = tx node error active) (bit 8)
+   SEQ (sequence number) (Bits 9-15) - Optional sequence number for your reference
+Then each additional byte is a data byte (up to 64 bytes)
+Returns how many bytes of the object are in use (8 + the data words)
+*/
+int MCP2517FD::encodeFrameObject(CAN_FRAME_FD &message, uint8_t *obj)
+{
+    uint32_t header[2];
+    int dataBytes;
+
+    if (message.extended) header[0] = packExtValue(message.id);
+    else header[0] = message.id & 0x7FF;
+
+    header[1] = (message.extended) ? (1 << 4) : 0;
+    header[1] |= (message.fdMode) ? (3 << 6) : 0; //set both the BRS and FDF bits at once
+    if (message.fdMode)
+        header[0] |= (message.rrs) ? (1 << 29) : 0;
+    else
+        header[1] |= (message.rrs) ? (1 << 5) : 0;
+    if (!message.fdMode && message.length > 8) message.length = 8;
+    dataBytes = message.length;
+
+    //promote requested frame length to the next allowable size
+    if (message.length > 8 && message.length < 13) header[1] |= 9;
+    else if (message.length > 12 && message.length < 17) header[1] |= 10;
+    else if (message.length > 16 && message.length < 21) header[1] |= 11;
+    else if (message.length > 20 && message.length < 25) header[1] |= 12;
+    else if (message.length > 24 && message.length < 33) header[1] |= 13;
+    else if (message.length > 32 && message.length < 49) header[1] |= 14;
+    else if (message.length > 48 && message.length < 65) header[1] |= 15;
+    else
+    {
+        if (message.length < 9) header[1] |= message.length;
+        else header[1] |= 8;
+        if (dataBytes > 64) dataBytes = 64;
+    }
+    memcpy(obj, header, sizeof(header));
+
+    //only copy the number of data words we really have to.
+    int copyWords = (dataBytes + 3) / 4;
+    memcpy(obj + 8, message.data.uint32, copyWords * 4);
+    return 8 + copyWords * 4;
+}
+
 bool MCP2517FD::Interrupt() {
     return (digitalRead(_INT)==LOW);
 }
@@ -1290,11 +1463,11 @@ void IRAM_ATTR MCP2517FD::EnqueueRX(CAN_FRAME& newFrame) {
 //Places the given frame either into a hardware FIFO (if there is space)
 //or into the software side queue if there was no room
 void MCP2517FD::EnqueueTX(CAN_FRAME_FD& newFrame) {
-    handleTXFifo(0, newFrame);
+    handleTXFifo(FD_TX_FIFO, newFrame);
 }
 
 void MCP2517FD::EnqueueTX(CAN_FRAME& newFrame) {
-    handleTXFifo(0, newFrame);
+    handleTXFifo(FD_TX_FIFO, newFrame);
 }
 
 bool MCP2517FD::GetRXFrame(CAN_FRAME_FD &frame) {
@@ -1312,54 +1485,62 @@ bool MCP2517FD::GetRXFrame(CAN_FRAME &frame) {
 //Not truly an interrupt handler in the sense that it does NOT run in interrupt context
 //but it does handle the MCP2517FD interrupt still.
 void MCP2517FD::intHandler(void) {
-    CAN_FRAME_FD messageFD;
-    CAN_FRAME message;
-    uint32_t ctrlVal;
-    uint32_t status;
-    uint16_t addr;
-    uint32_t filtHit;
-
     if (!running) return;
 
-    // determine which interrupt flags have been set
-    uint32_t interruptFlags = Read(ADDR_CiINT);
+    //filter class changes made from other tasks since the last pass
+    if (pendingFilterClass) applyFilterClasses();
+
+    //keep the TBC to host time mapping fresh before any frame timestamps get converted
+    if (esp_timer_get_time() - lastClockSampleUs >= FD_CLOCKSYNC_PERIOD_US) sampleClock();
+
+    // determine which interrupt flags have been set. CiINT, CiRXIF, CiTXIF and CiRXOVIF are
+    // consecutive so one read gets the per FIFO flags too
+    uint8_t intRegs[16];
+    uint32_t interruptFlags, rxFlags, rxOverflowFlags;
+    Read(ADDR_CiINT, intRegs, 16);
+    memcpy(&interruptFlags, &intRegs[0], 4);
+    memcpy(&rxFlags, &intRegs[4], 4);
+    memcpy(&rxOverflowFlags, &intRegs[12], 4);
 
     //if(interruptFlags & 1)  //Transmit FIFO interrupt
     //{
-      //Only FIFO0 is TX so no need to ask for which FIFO.
+      //Only FIFO2 is TX so no need to ask for which FIFO.
       //Write8(ADDR_CiFIFOCON, 0x80); //Keep FIFO as TX but disable Queue Empty Interrupt
       //handleTXFifoISR(0);
     //}
     //else //didn't get TX interrupt but check if we've got msgs in FIFO and see if we can queue them into hardware
     {
-      if (uxQueueMessagesWaiting(txQueue) > 0) handleTXFifoISR(0); //if we have messages to send then try to queue them in the TX fifo
+      if (uxQueueMessagesWaiting(txQueue) > 0) handleTXFifoISR(FD_TX_FIFO); //if we have messages to send then try to queue them in the TX fifo
     }
 
-    if(interruptFlags & 2)  //Receive FIFO interrupt
+    //Receive FIFOs, highest class first. Each readout only takes what its FIFO held when it looked,
+    //then the flags are read again, so a higher class that received in the meantime goes ahead of
+    //the rest of a bulk flood. Bounded so a saturated bus can't hold this task; the next poll resumes
+    rxFlags &= rxFifoMask;
+    for (int pass = 0; pass < FD_RX_SERVICE_PASSES && rxFlags; pass++)
     {
-        //no need to ask which FIFO matched, there is only one RX FIFO configured in this library
-        //So, ask for frames out of the FIFO until it no longer has any
-        status = Read( ADDR_CiFIFOSTA + (CiFIFO_OFFSET * 1) );
-        while (status & 1) // there is at least one message waiting to be received
+        for (int c = rxFifoCount - 1; c >= 0; c--)
         {
-            //Get address to read from
-            addr = Read(ADDR_CiFIFOUA + (CiFIFO_OFFSET * 1));
-            //Then use that address to read the frame
-            filtHit = ReadFrameBuffer(addr + 0x400, messageFD); //stupidly the returned address from FIFOUA needs an offset
-            Write8(ADDR_CiFIFOCON + (CiFIFO_OFFSET * 1) + 1, 1); //set UINC (it's at bit 8 in the register so we move one byte into register and write 8 bits)
-            status = Read( ADDR_CiFIFOSTA + (CiFIFO_OFFSET * 1) ); //read the register again to see if there are more frames waiting
-            if (inFDMode)
-                handleFrameDispatch(messageFD, filtHit);
-            else
+            if (rxFlags & (1ul << rxClassFifo(c)))
             {
-                fdToCan(messageFD, message);
-                handleFrameDispatch(message, filtHit);
+                handleRXFifo(c);
+                break;
             }
         }
+        rxFlags = Read(ADDR_CiRXIF) & rxFifoMask;
     }
-    if (interruptFlags & (1 << 11)) //Receive Object Overflow
+    rxOverflowFlags &= rxFifoMask;
+    if (rxOverflowFlags) //Receive Object Overflow
     {
-        //once again, we know which FIFO must have overflowed - what to do about it though?
+        //the chip doesn't say how many frames were lost, only which FIFO dropped at least one
+        for (int c = 0; c < rxFifoCount; c++)
+        {
+            if (rxOverflowFlags & (1ul << rxClassFifo(c)))
+            {
+                rxOverflows[c]++;
+                Write8(ADDR_CiFIFOSTA + (CiFIFO_OFFSET * rxClassFifo(c)), 0); //clear RXOVIF, the other bits are read only
+            }
+        }
         errorFlags |= 1;
     }
     if (interruptFlags & (1 << 12)) //System error
@@ -1422,54 +1603,205 @@ void MCP2517FD::intHandler(void) {
     Write16(ADDR_CiINT, 0);
 }
 
-//TX fifo is 0
-void MCP2517FD::handleTXFifoISR(int fifo)
+//Read out what an RX FIFO holds with as few SPI transactions as possible. One read of
+//FIFOCON/FIFOSTA/FIFOUA gives both ends of the ring (FIFOCI is where the next received frame goes,
+//FIFOUA the oldest unread one) so the fill level is known up front. Then each run of consecutive
+//objects is read out of message RAM in one transaction; a run that wraps around the end of the ring
+//is split in two. UINC only ever advances the FIFO by one object per write so those can't be merged,
+//but they are issued back to back under one SPI transaction before the frames are dispatched.
+//Frames that arrive during the readout are left for the next call so intHandler can look at the
+//higher classes in between. Returns the number of frames read.
+int MCP2517FD::handleRXFifo(uint8_t rxClass)
 {
+    CAN_FRAME_FD messageFD;
+    CAN_FRAME message;
+    uint8_t regs[12];
     uint32_t status;
-    uint16_t addr;
+    uint32_t tailAddr;
+    uint32_t filtHit;
+    const int fifo = rxClassFifo(rxClass);
+    const uint16_t fifoAddr = rxFifoAddr[rxClass];
+    const uint8_t fifoDepth = rxFifoDepth[rxClass];
+    int total = 0;
+
+    Read(ADDR_CiFIFOCON + (CiFIFO_OFFSET * fifo), regs, 12);
+    memcpy(&status, &regs[4], 4);
+    memcpy(&tailAddr, &regs[8], 4);
+    if (!(status & 1)) return 0; //nothing waiting
+
+    uint8_t run;
+    uint8_t head = (status >> 8) & 0x1F;
+    uint16_t tail = (tailAddr >= fifoAddr) ? (tailAddr - fifoAddr) / rxObjectSize : 0xFFFF;
+    uint8_t pending;
+    if (tail < fifoDepth)
+    {
+        pending = (head + fifoDepth - tail) % fifoDepth;
+        if (pending == 0) pending = fifoDepth; //not empty and both ends equal means full
+    }
+    else
+    {
+        //FIFOUA outside the ring we expect: read just that one object like the old path did
+        pending = 1;
+    }
+
+    while (pending > 0)
+    {
+        run = pending;
+        if (tail < fifoDepth && run > fifoDepth - tail) run = fifoDepth - tail;
+        if (run > FD_RX_BURST_BYTES / rxObjectSize) run = FD_RX_BURST_BYTES / rxObjectSize;
+        //stupidly the address from FIFOUA needs an offset to be a RAM address
+        uint16_t address = 0x400 + ((tail < fifoDepth) ? fifoAddr + tail * rxObjectSize : tailAddr);
+        uint16_t bytes = run * rxObjectSize;
+
+        memset(rxBurst, 0, bytes + 2);
+        rxBurst[0] = (CMD_READ << 4) | ((address >> 8) & 0xF);
+        rxBurst[1] = address & 0xFF;
+        SPI.beginTransaction(fdSPISettings);
+        digitalWrite(_CS,LOW);
+        SPI.transfer(rxBurst, bytes + 2); //in place, streamed through the SPI hardware FIFO with CS held low
+        digitalWrite(_CS,HIGH);
+        SPI.endTransaction();
+
+        //the objects are copied out now so hand the slots back to the chip before dispatching
+        incrementFifo(fifo, run, false);
+        rxBurstReads++;
+        rxFramesRead += run;
+
+        //bus load uses host time, the frame timestamp is in TBC ticks until converted
+        uint32_t nowUs = micros();
+        for (int i = 0; i < run; i++)
+        {
+            filtHit = decodeFrameObject(&rxBurst[2 + i * rxObjectSize], rxPayloadBytes, messageFD);
+            //no mapping yet (first poll after init): the readout time is the best there is
+            if (hostTimestamps && !clockSync.toHostUs(messageFD.timestamp, messageFD.timestamp)) messageFD.timestamp = nowUs;
+            recordBusLoad(messageFD, nowUs);
+            if (inFDMode)
+                handleFrameDispatch(messageFD, filtHit);
+            else
+            {
+                fdToCan(messageFD, message);
+                handleFrameDispatch(message, filtHit);
+            }
+        }
+
+        pending -= run;
+        total += run;
+        if (tail < fifoDepth) tail = (tail + run) % fifoDepth;
+    }
+    return total;
+}
+
+//set UINC count times. It's at bit 8 in FIFOCON so write the second byte of the register.
+//For a TX FIFO the last write also sets TXREQ (bit 9): it asks the chip to send everything the
+//FIFO holds and clears itself once the FIFO is empty, so once per batch is enough
+void MCP2517FD::incrementFifo(int fifo, uint8_t count, bool requestTX)
+{
+    uint16_t address = ADDR_CiFIFOCON + (CiFIFO_OFFSET * fifo) + 1;
+    uint8_t buf[3];
+    buf[0] = (CMD_WRITE << 4) | ((address >> 8) & 0xF);
+    buf[1] = address & 0xFF;
+    buf[2] = 1;
+    SPI.beginTransaction(fdSPISettings);
+    for (int i = 0; i < count; i++)
+    {
+        if (requestTX && i == count - 1) buf[2] = 3;
+        digitalWrite(_CS,LOW);
+        SPI.writeBytes(buf, 3);
+        digitalWrite(_CS,HIGH);
+    }
+    SPI.endTransaction();
+}
+
+//Move frames from txQueue into the TX FIFO. One read of FIFOCON/FIFOSTA/FIFOUA says how many
+//objects are free (FIFOCI is the next one to go out, FIFOUA the next one to fill). The frames for
+//each run of consecutive free objects are serialized into txBurst and written with one SPI
+//transaction; a run that would wrap around the end of the ring is split in two. UINC only advances
+//one object per write, so each object still gets its own byte write; the last one of the run also
+//carries TXREQ. Those go back to back under one SPI transaction setup.
+void MCP2517FD::handleTXFifoISR(int fifo)
+{
     CAN_FRAME_FD frameFD;
     CAN_FRAME frame;
+    uint8_t regs[12];
+    uint32_t status;
+    uint32_t headAddr;
     uint8_t wroteFrames = 0;
 
-    //if (fifo < 0) return;
-    //if (fifo > 2) return;
-
     //taskDISABLE_INTERRUPTS();
 
-    status = Read( ADDR_CiFIFOSTA + (CiFIFO_OFFSET * fifo) );
-    //Write8(ADDR_CiFIFOSTA + (CiFIFO_OFFSET * fifo), 0); //reset all the fault bits in the FIFO (TXABT, TXLARB, TXERR)
-    //Write8(ADDR_CiBDIAG0 + (CiFIFO_OFFSET * fifo) + 1, 0); //Clear TX error counter
-    //Write8(ADDR_CiBDIAG1 + (CiFIFO_OFFSET * fifo) + 2, 0); //clear bits 16-23 in diag1 register
+    Read(ADDR_CiFIFOCON + (CiFIFO_OFFSET * fifo), regs, 12);
+    memcpy(&status, &regs[4], 4);
+    memcpy(&headAddr, &regs[8], 4);
     if ((status & 0x20) == 0x20) needTXFIFOReset = true; //if the queue registered a fault then set flag to have it reset
-    //While the FIFO has room and we still have frames to send
-    while ( (status & 1) && (uxQueueMessagesWaiting(txQueue) > 0) ) //while fifo is not full and we have messages waiting
+    if (!(status & 1)) return; //FIFO full
+
+    uint8_t run;
+    uint8_t tail = (status >> 8) & 0x1F;
+    uint16_t head = (headAddr >= txFifoAddr) ? (headAddr - txFifoAddr) / txObjectSize : 0xFFFF;
+    uint8_t room;
+    if (head < txFifoDepth)
     {
-        if (debuggingMode)
-        {
-            Serial.write('~');
-        }
-        //get address to write to
-        addr = Read( ADDR_CiFIFOUA + (CiFIFO_OFFSET * fifo) );
-        if (inFDMode) 
+        room = (tail + txFifoDepth - head) % txFifoDepth;
+        if (room == 0) room = txFifoDepth; //not full and both ends equal means empty
+    }
+    else
+    {
+        //FIFOUA outside the ring we expect: load just the object it points at like the old path did
+        room = 1;
+    }
+    UBaseType_t waiting = uxQueueMessagesWaiting(txQueue);
+    if (room > waiting) room = waiting;
+
+    //While the FIFO has room and we still have frames to send
+    while (room > 0)
+    {
+        run = room;
+        if (head < txFifoDepth && run > txFifoDepth - head) run = txFifoDepth - head;
+        if (run > FD_TX_BURST_BYTES / txObjectSize) run = FD_TX_BURST_BYTES / txObjectSize;
+        //the address from FIFOUA needs an offset to be a RAM address
+        uint16_t address = 0x400 + ((head < txFifoDepth) ? txFifoAddr + head * txObjectSize : headAddr);
+
+        //serialize the run. Objects before the last are padded out to the full object size
+        //(leftovers from earlier frames there don't matter, the DLC says how much is data)
+        uint8_t loaded = 0;
+        uint16_t bytes = 0;
+        while (loaded < run)
         {
-            //if (debuggingMode) Serial.write('F');
-            if (xQueueReceive(txQueue, &frameFD, 0) != pdTRUE) return; //abort if we can't load a frame from the queue!
+            if (inFDMode) 
+            {
+                if (xQueueReceive(txQueue, &frameFD, 0) != pdTRUE) break;
+            }
+            else
+            {
+                if (xQueueReceive(txQueue, &frame, 0) != pdTRUE) break;
+                //hardware loading below always uses the same buffer save whether CAN or CANFD
+                if (!canToFD(frame, frameFD)) break;
+            }
+            bytes = loaded * txObjectSize + encodeFrameObject(frameFD, &txBurst[2 + loaded * txObjectSize]);
+            loaded++;
         }
-        else
+        if (loaded == 0) break;
+
+        if (debuggingMode)
         {
-            //if (debuggingMode) Serial.write('S');
-            if (xQueueReceive(txQueue, &frame, 0) != pdTRUE) return;
-            //hardware loading below always uses the same buffer save whether CAN or CANFD
-            if (!canToFD(frame, frameFD)) return;
+            Serial.write('~');
         }
-        LoadFrameBuffer( addr + 0x400, frameFD );
+        txBurst[0] = (CMD_WRITE << 4) | ((address >> 8) & 0xF);
+        txBurst[1] = address & 0xFF;
+        SPI.beginTransaction(fdSPISettings);
+        digitalWrite(_CS,LOW);
+        SPI.writeBytes(txBurst, bytes + 2);
+        digitalWrite(_CS,HIGH);
+        SPI.endTransaction();
+        incrementFifo(fifo, loaded, true);
         wroteFrames = 1;
-        status = Read(ADDR_CiFIFOSTA + (CiFIFO_OFFSET * fifo));
-        //if (debuggingMode) Serial.printf("After write Status: %x\n", status);
+
+        room -= loaded;
+        if (loaded < run) break; //queue ran dry
+        if (head < txFifoDepth) head = (head + loaded) % txFifoDepth;
     }
     if (wroteFrames != 0)
     {
-        //Write8(ADDR_CiFIFOCON + (CiFIFO_OFFSET * fifo), 0x84); //Keep as TX queue and enable interrupt for queue empty
         if (debuggingMode) Serial.write('\"');
     }
   //taskENABLE_INTERRUPTS();
@@ -4,11 +4,18 @@
 #include "Arduino.h"
 #include "mcp2517fd_defines.h"
 #include <can_common.h>
+#include "can_clocksync.h"
 
 //#define DEBUG_SETUP
 #define FD_RX_BUFFER_SIZE	64
 #define FD_TX_BUFFER_SIZE  32
 #define FD_NUM_FILTERS 32
+#define FD_RX_BURST_BYTES 768 //message RAM read in one SPI transaction when draining the RX FIFO
+#define FD_TX_BURST_BYTES 648 //message RAM written in one SPI transaction when loading the TX FIFO
+#define FD_CLOCKSYNC_PERIOD_US 250000 //how often the TBC is sampled against esp_timer
+#define FD_CLOCKSYNC_MAX_READ_US 100 //TBC reads that took longer than this (preempted) are not used
+#define FD_RX_FIFOS_MAX 4 //RX priority classes: the bulk FIFO plus up to three higher ones
+#define FD_RX_SERVICE_PASSES 8 //FIFO readouts per intHandler call, the rest waits for the next poll
 
 class MCP2517FD : public CAN_COMMON
 {
@@ -81,6 +88,19 @@ class MCP2517FD : public CAN_COMMON
 	void txQueueSetup();
     void setRXBufferSize(int newSize);
     void setTXBufferSize(int newSize);
+    //true (default): frame timestamps are converted from TBC ticks to host micros() time so they
+    //line up with CAN0. false: raw TBC values as the chip stamped them
+    void setHostTimestamps(bool state);
+    void getClockSync(CAN_CLOCKSYNC_STATS &stats);
+    //RX FIFOs by priority class. Class 0 is the bulk FIFO that every filter feeds by default, each
+    //higher class gets its own FIFO which is read out first. depths[] holds count entries (1-32
+    //frames each). Call before init; if message RAM runs short the bulk FIFO is trimmed first
+    bool setRXFifos(uint8_t count, const uint8_t depths[]);
+    //send what a filter matches to an RX class. Works before or after the filter itself is set.
+    //No SPI from the caller: once running, the polling task repoints the filter on its next pass
+    bool setFilterClass(uint8_t filter, uint8_t rxClass);
+    //times the class's FIFO overflowed (one or more frames lost each time)
+    uint32_t getRXOverflows(uint8_t rxClass);
 
     QueueHandle_t callbackQueueMCP;
     TaskHandle_t intTaskFD = NULL;
@@ -89,6 +109,10 @@ class MCP2517FD : public CAN_COMMON
     bool needMCPReset = false;
     bool needTXFIFOReset = false;
     bool inFDMode;
+    //RX readout counters. Sample rxFramesRead over time for frames/sec; frames per burst read
+    //shows how well the bulk readout is batching
+    volatile uint32_t rxFramesRead;
+    volatile uint32_t rxBurstReads;
 
   private:
 	bool _init(uint32_t baud, uint8_t freq, uint8_t sjw, bool autoBaud);
@@ -97,6 +121,11 @@ class MCP2517FD : public CAN_COMMON
 	void commonInit();	
     void handleFrameDispatch(CAN_FRAME_FD &frame, int filterHit);
     void handleFrameDispatch(CAN_FRAME &frame, int filterHit);
+	int handleRXFifo(uint8_t rxClass);
+	uint8_t filterFifo(uint8_t filter);
+	void incrementFifo(int fifo, uint8_t count, bool requestTX);
+	int encodeFrameObject(CAN_FRAME_FD &message, uint8_t *obj);
+	uint32_t decodeFrameObject(const uint8_t *obj, uint8_t payloadBytes, CAN_FRAME_FD &message);
 	void handleTXFifoISR(int fifo);
 	void handleTXFifo(int fifo, CAN_FRAME_FD &newFrame);
 	void handleTXFifo(int fifo, CAN_FRAME &newFrame);
@@ -107,6 +136,8 @@ class MCP2517FD : public CAN_COMMON
 	uint32_t getCIBDIAG0();
 	uint32_t getCIBDIAG1();
 	uint32_t getBitConfig();
+	void sampleClock();
+	void applyFilterClasses();
 
     // Pin variables
 	uint8_t _CS;
@@ -122,6 +153,27 @@ class MCP2517FD : public CAN_COMMON
 	QueueHandle_t	txQueue;
 	uint32_t errorFlags;
     uint32_t cachedDiag1;
+    //RX FIFO geometry in message RAM per class, set by commonInit
+    uint8_t rxFifoCount;
+    uint8_t rxFifoDepthCfg[FD_RX_FIFOS_MAX]; //requested, rxFifoDepth is what fit in message RAM
+    uint16_t rxFifoAddr[FD_RX_FIFOS_MAX]; //offset of the first RX object (same base as FIFOUA)
+    uint8_t rxFifoDepth[FD_RX_FIFOS_MAX];
+    uint32_t rxFifoMask; //CiRXIF / CiRXOVIF bits of the configured RX FIFOs
+    volatile uint32_t rxOverflows[FD_RX_FIFOS_MAX];
+    uint8_t filterClass[FD_NUM_FILTERS];
+    volatile uint32_t pendingFilterClass; //filters whose class changed while running, applied by intHandler
+    portMUX_TYPE filterClassMux;
+    uint8_t rxPayloadBytes;
+    uint8_t rxObjectSize;
+    uint8_t rxBurst[FD_RX_BURST_BYTES + 2]; //command bytes + message objects
+    //TX FIFO geometry, set by commonInit
+    uint16_t txFifoAddr;
+    uint8_t txFifoDepth;
+    uint8_t txObjectSize;
+    uint8_t txBurst[FD_TX_BURST_BYTES + 2];
+    CANClockSync clockSync; //TBC to host time
+    int64_t lastClockSampleUs;
+    bool hostTimestamps;
 };
 
 extern MCP2517FD CAN1;
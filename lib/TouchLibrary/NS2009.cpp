@@ -95,6 +95,11 @@ bool NS2009::CheckTouched ()
 void NS2009::Scan ()
 {
   CheckTouched ();
+  ScanXY ();
+}
+
+void NS2009::ScanXY ()
+{
   RawX = ReadRegister(NS2009_READ_X);
   X = Map_Data (RawX, MinX, MaxX, 0, SCREEN_SIZE_X);
   RawY = ReadRegister(NS2009_READ_Y);
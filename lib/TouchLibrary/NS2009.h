@@ -41,6 +41,7 @@ public:
   void Calibrate (int _MinX, int _MaxX, int _MinY, int _MaxY);
   bool CheckTouched ();
   void Scan ();
+  void ScanXY ();  // X/Y only, for callers that already read Z with CheckTouched ()
   void ScanBlocking ();
 };
 #endif
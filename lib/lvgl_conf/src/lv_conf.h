@@ -46,8 +46,13 @@
 
 
 #if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
-    /*Size of the memory available for `lv_malloc()` in bytes (>= 2kB)*/
-    #define LV_MEM_SIZE (64 * 1024U)          /*[bytes]*/
+    /*Size of the memory available for `lv_malloc()` in bytes (>= 2kB)
+     *Size it from the `[LVGL] mem ... max` high-water mark printed by the RX firmware*/
+    #ifdef UI_BENCH
+        #define LV_MEM_SIZE (128 * 1024U)     /*[bytes] 64-bit pointers make every object larger on the host*/
+    #else
+        #define LV_MEM_SIZE (64 * 1024U)          /*[bytes]*/
+    #endif
 
     /*Size of the memory expand for `lv_malloc()` in bytes*/
     #define LV_MEM_POOL_EXPAND_SIZE 0
@@ -83,7 +88,11 @@
  * - LV_OS_RTTHREAD
  * - LV_OS_WINDOWS
  * - LV_OS_CUSTOM */
-#define LV_USE_OS   LV_OS_FREERTOS
+#ifdef UI_BENCH
+    #define LV_USE_OS   LV_OS_NONE      /*Host render benchmark (env:ui_bench) is single threaded*/
+#else
+    #define LV_USE_OS   LV_OS_FREERTOS
+#endif
 
 #if LV_USE_OS == LV_OS_CUSTOM
     #define LV_OS_CUSTOM_INCLUDE <stdint.h>
@@ -901,7 +910,11 @@
 #define LV_USE_LINUX_DRM        0
 
 /*Interface for TFT_eSPI*/
-#define LV_USE_TFT_ESPI         1
+#ifdef UI_BENCH
+    #define LV_USE_TFT_ESPI     0       /*Host render benchmark flushes into memory, no TFT_eSPI on the host*/
+#else
+    #define LV_USE_TFT_ESPI     1
+#endif
 
 /*Driver for evdev input devices*/
 #define LV_USE_EVDEV    0
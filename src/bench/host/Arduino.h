@@ -0,0 +1,95 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the parts of the Arduino core the tested units use.
+ *
+ * Only on the include path of the host envs. There is deliberately no
+ * millis()/micros(): RX timing goes through Clock, so a unit that still reads
+ * the Arduino clock fails to link instead of silently using wall time.
+ *
+ * Pin setup and LEDC calls are no-ops: digital outputs are observed through
+ * an OutputEngine backend or the GPIO registers in soc/gpio_struct.h.
+ * attachInterrupt() is a no-op as well; tests call a driver's interrupt task
+ * body themselves. digitalWrite()/digitalRead() go to an optional
+ * HostPinHook, which is how a host model of an SPI chip sees its chip select
+ * and drives its INT line. Serial output is dropped.
+ */
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define BIN 2
+#define HEX 16
+#define IRAM_ATTR
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+// The binary.h constants the CAN drivers use
+#define B00000011 3
+#define B00001000 8
+#define B00001111 15
+#define B01000000 64
+#define B10000000 128
+#define B11100000 224
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+/** Observer for pin writes and source for pin reads; install with HostPins() = &hook. */
+class HostPinHook
+{
+public:
+  virtual ~HostPinHook() = default;
+  virtual void Write(uint8_t pin, uint8_t level) = 0;
+  virtual int Read(uint8_t pin) = 0;
+};
+
+inline HostPinHook*& HostPins()
+{
+  static HostPinHook* hook = nullptr;
+  return hook;
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t level)
+{
+  if (HostPins() != nullptr) HostPins()->Write(pin, level);
+}
+
+inline int digitalRead(uint8_t pin)
+{
+  return (HostPins() != nullptr) ? HostPins()->Read(pin) : HIGH;
+}
+
+inline void delay(uint32_t /*ms*/) {}
+
+class HardwareSerial
+{
+public:
+  template <typename... Args> size_t print(const Args&...) { return 0; }
+  template <typename... Args> size_t println(const Args&...) { return 0; }
+  template <typename... Args> size_t printf(const char*, const Args&...) { return 0; }
+  size_t write(uint8_t) { return 1; }
+};
+
+inline HardwareSerial Serial;
+
+inline void pinMode(uint8_t /*pin*/, uint8_t /*mode*/) {}
+inline void attachInterrupt(uint8_t /*pin*/, void (*/*isr*/)(), int /*mode*/) {}
+inline void detachInterrupt(uint8_t /*pin*/) {}
+inline uint32_t ledcSetup(uint8_t /*channel*/, uint32_t freq, uint8_t /*resolutionBits*/) { return freq; }
+inline void ledcAttachPin(uint8_t /*pin*/, uint8_t /*channel*/) {}
+inline void ledcWrite(uint8_t /*channel*/, uint32_t /*duty*/) {}
+
+#endif // HOST_ARDUINO_H
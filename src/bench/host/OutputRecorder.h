@@ -0,0 +1,89 @@
+/**
+ * @file OutputRecorder.h
+ * @brief Host-side OutputEngine backend that records the pin waveform.
+ *
+ * Install with `engine.SetBackend(&OutputRecorder::Commit, &recorder)` before
+ * `Init()`, advance `SetTimeMs()` along with the virtual time passed to
+ * `Update()`, then inspect `Edges()`. Edges produced by the same backend call
+ * share a commit index, i.e. they would switch on one register write.
+ */
+#ifndef OUTPUT_RECORDER_H
+#define OUTPUT_RECORDER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/**
+ * @class OutputRecorder
+ * @brief Pin level tracker; one Edge per level change.
+ */
+class OutputRecorder
+{
+public:
+  struct Edge
+  {
+    uint32_t tMs;
+    uint32_t commit; // backend call that produced the edge
+    uint8_t pin;
+    bool level;
+  };
+
+  /** OutputEngine::CommitFn; @p ctx is the recorder. */
+  static void Commit(uint64_t setPins, uint64_t clearPins, void* ctx)
+  {
+    auto* self = static_cast<OutputRecorder*>(ctx);
+    if (!self) return;
+    self->Apply_(setPins, clearPins);
+  }
+
+  void SetTimeMs(uint32_t nowMs) { nowMs_ = nowMs; }
+
+  bool Level(uint8_t pin) const { return ((levels_ >> pin) & 1ULL) != 0ULL; }
+  const std::vector<Edge>& Edges() const { return edges_; }
+  /** Number of backend calls, i.e. register write groups on the target. */
+  uint32_t Commits() const { return commits_; }
+
+  void Clear()
+  {
+    edges_.clear();
+    commits_ = 0;
+  }
+
+  /** One "t_ms commit pin level" line per edge. */
+  void Print(FILE* out) const
+  {
+    for (const Edge& e : edges_)
+    {
+      fprintf(out, "%lu %lu %u %u\n", static_cast<unsigned long>(e.tMs), static_cast<unsigned long>(e.commit),
+              static_cast<unsigned>(e.pin), e.level ? 1U : 0U);
+    }
+  }
+
+private:
+  void Apply_(uint64_t setPins, uint64_t clearPins)
+  {
+    ++commits_;
+    for (uint8_t pin = 0; pin < 64; ++pin)
+    {
+      const uint64_t bit = 1ULL << pin;
+      bool level;
+      if (setPins & bit) level = true;
+      else if (clearPins & bit) level = false;
+      else continue;
+
+      // The first write to a pin is its initial state, not an edge
+      if ((known_ & bit) && Level(pin) != level) edges_.push_back(Edge{nowMs_, commits_, pin, level});
+      known_ |= bit;
+      if (level) levels_ |= bit; else levels_ &= ~bit;
+    }
+  }
+
+  std::vector<Edge> edges_;
+  uint64_t levels_ = 0;
+  uint64_t known_ = 0;
+  uint32_t nowMs_ = 0;
+  uint32_t commits_ = 0;
+};
+
+#endif // OUTPUT_RECORDER_H
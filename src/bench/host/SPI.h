@@ -0,0 +1,73 @@
+/**
+ * @file SPI.h
+ * @brief Host stand-in for the Arduino-ESP32 SPIClass.
+ *
+ * Every byte clocked goes to the HostSpiDevice installed in HostSpi(), full
+ * duplex; chip select stays with digitalWrite() (see HostPinHook in Arduino.h).
+ * Without a device reads return 0xFF, like an empty bus.
+ */
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include "Arduino.h"
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+#define SCK 18
+#define MISO 19
+#define MOSI 23
+#define SS 5
+
+/** A chip on the host SPI bus: one call per byte, MOSI in, MISO out. */
+class HostSpiDevice
+{
+public:
+  virtual ~HostSpiDevice() = default;
+  virtual uint8_t Transfer(uint8_t mosi) = 0;
+};
+
+inline HostSpiDevice*& HostSpi()
+{
+  static HostSpiDevice* device = nullptr;
+  return device;
+}
+
+struct SPISettings
+{
+  SPISettings() {}
+  SPISettings(uint32_t /*clock*/, uint8_t /*bitOrder*/, uint8_t /*dataMode*/) {}
+};
+
+inline uint32_t spiFrequencyToClockDiv(uint32_t /*freq*/) { return 0; }
+
+class SPIClass
+{
+public:
+  void begin(int8_t = -1, int8_t = -1, int8_t = -1, int8_t = -1) {}
+  void beginTransaction(SPISettings) {}
+  void endTransaction() {}
+  void setHwCs(bool) {}
+  void setClockDivider(uint32_t) {}
+  void setFrequency(uint32_t) {}
+  void setDataMode(uint8_t) {}
+  void setBitOrder(uint8_t) {}
+
+  uint8_t transfer(uint8_t b) { return Clock_(b); }
+  void transfer(void* data, uint32_t size) { transferBytes(static_cast<uint8_t*>(data), static_cast<uint8_t*>(data), size); }
+  void transferBytes(const uint8_t* out, uint8_t* in, uint32_t size)
+  {
+    for (uint32_t i = 0; i < size; ++i)
+    {
+      const uint8_t r = Clock_((out != nullptr) ? out[i] : 0xFF);
+      if (in != nullptr) in[i] = r;
+    }
+  }
+  void writeBytes(const uint8_t* data, uint32_t size) { transferBytes(data, nullptr, size); }
+
+private:
+  static uint8_t Clock_(uint8_t mosi) { return (HostSpi() != nullptr) ? HostSpi()->Transfer(mosi) : 0xFF; }
+};
+
+inline SPIClass SPI;
+
+#endif // HOST_SPI_H
@@ -0,0 +1,28 @@
+/**
+ * @file esp_heap_caps.h
+ * @brief Host stand-in for the ESP-IDF capability allocator used by GaugeSprite.
+ *
+ * The host has one heap, so every capability set maps to malloc()/free().
+ */
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#define MALLOC_CAP_8BIT (1U << 2)
+#define MALLOC_CAP_SPIRAM (1U << 10)
+#define MALLOC_CAP_INTERNAL (1U << 11)
+
+inline void* heap_caps_malloc(size_t size, uint32_t /*caps*/)
+{
+  return malloc(size);
+}
+
+inline void heap_caps_free(void* ptr)
+{
+  free(ptr);
+}
+
+#endif // HOST_ESP_HEAP_CAPS_H
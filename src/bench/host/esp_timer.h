@@ -0,0 +1,20 @@
+/**
+ * @file esp_timer.h
+ * @brief Host stand-in for the esp_timer clock behind Clock's default source.
+ *
+ * Tests normally install a virtual source with Clock::SetSource(); this only
+ * keeps the default path linking, counting from the first call.
+ */
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <chrono>
+#include <cstdint>
+
+inline int64_t esp_timer_get_time()
+{
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+#endif // HOST_ESP_TIMER_H
@@ -0,0 +1,32 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stand-in for the few FreeRTOS primitives shared RX code uses.
+ *
+ * Only on the include path of the host envs (ui_bench, native). Both are
+ * single threaded, so critical sections compile to nothing.
+ */
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+#define portMAX_DELAY (static_cast<TickType_t>(0xFFFFFFFFUL))
+
+typedef struct
+{
+  int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZE(mux) ((void)(mux))
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+#endif // HOST_FREERTOS_H
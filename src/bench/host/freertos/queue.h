@@ -0,0 +1,75 @@
+/**
+ * @file queue.h
+ * @brief Host stand-in for FreeRTOS queues: a fixed-size copy ring.
+ *
+ * Nothing ever blocks on the host, so timeouts are ignored: a full queue
+ * rejects the item and an empty one returns pdFALSE straight away.
+ */
+#ifndef HOST_FREERTOS_QUEUE_H
+#define HOST_FREERTOS_QUEUE_H
+
+#include <cstring>
+#include "FreeRTOS.h"
+
+struct HostQueue
+{
+  uint8_t* storage;
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  UBaseType_t head;
+  UBaseType_t count;
+};
+typedef HostQueue* QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+  if (length == 0 || itemSize == 0) return nullptr;
+  return new HostQueue{new uint8_t[length * itemSize], length, itemSize, 0, 0};
+}
+
+inline void vQueueDelete(QueueHandle_t q)
+{
+  delete[] q->storage;
+  delete q;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t /*wait*/)
+{
+  if (q->count == q->length) return pdFALSE;
+  memcpy(q->storage + ((q->head + q->count) % q->length) * q->itemSize, item, q->itemSize);
+  ++q->count;
+  return pdTRUE;
+}
+
+inline BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* woken)
+{
+  if (woken != nullptr) *woken = pdFALSE;
+  return xQueueSend(q, item, 0);
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t /*wait*/)
+{
+  if (q->count == 0) return pdFALSE;
+  memcpy(item, q->storage + q->head * q->itemSize, q->itemSize);
+  q->head = (q->head + 1) % q->length;
+  --q->count;
+  return pdTRUE;
+}
+
+inline BaseType_t xQueueReceiveFromISR(QueueHandle_t q, void* item, BaseType_t* woken)
+{
+  if (woken != nullptr) *woken = pdFALSE;
+  return xQueueReceive(q, item, 0);
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+  return q->count;
+}
+
+inline UBaseType_t uxQueueMessagesWaitingFromISR(QueueHandle_t q)
+{
+  return q->count;
+}
+
+#endif // HOST_FREERTOS_QUEUE_H
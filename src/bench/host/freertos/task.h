@@ -0,0 +1,58 @@
+/**
+ * @file task.h
+ * @brief Host stand-in for FreeRTOS tasks: creation succeeds, nothing runs.
+ *
+ * Host tests call a driver's task body (e.g. MCP2517FD::intHandler) themselves,
+ * one pass at a time, so there are no threads and no races to reason about.
+ * Task notifications only count the gives, so a test can see that a handler
+ * asked to run again.
+ */
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+#ifndef pdPASS
+#define pdPASS pdTRUE
+#endif
+#define portTICK_PERIOD_MS 1
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t /*fn*/, const char* /*name*/, uint32_t /*stack*/,
+                                          void* /*params*/, UBaseType_t /*priority*/, TaskHandle_t* handle,
+                                          BaseType_t /*core*/)
+{
+  static int dummy;
+  if (handle != nullptr) *handle = &dummy;
+  return pdPASS;
+}
+
+inline void vTaskDelay(TickType_t /*ticks*/) {}
+
+/** Notifications given to any task since the counter was last reset. */
+inline uint32_t& HostTaskNotifies()
+{
+  static uint32_t gives = 0;
+  return gives;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t /*task*/)
+{
+  ++HostTaskNotifies();
+  return pdPASS;
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken)
+{
+  if (woken != nullptr) *woken = pdFALSE;
+  xTaskNotifyGive(task);
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t /*clearOnExit*/, TickType_t /*wait*/)
+{
+  return 0;
+}
+
+#endif // HOST_FREERTOS_TASK_H
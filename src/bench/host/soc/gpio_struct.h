@@ -0,0 +1,43 @@
+/**
+ * @file gpio_struct.h
+ * @brief Host stand-in for the ESP32 GPIO register block (write-1-to-set/clear only).
+ *
+ * Each register remembers the last value written and counts its writes, so a
+ * host test can check which bank a pin lands in and how many register writes
+ * one OutputEngine pass costs. Reset with `GPIO = gpio_dev_t{}`.
+ */
+#ifndef HOST_SOC_GPIO_STRUCT_H
+#define HOST_SOC_GPIO_STRUCT_H
+
+#include <cstdint>
+
+struct HostGpioReg
+{
+  uint32_t val = 0;    // last value written
+  uint32_t writes = 0; // number of writes
+
+  HostGpioReg& operator=(uint32_t v)
+  {
+    val = v;
+    ++writes;
+    return *this;
+  }
+};
+
+// GPIO 32..39 registers are unions on the target, written through .val
+struct HostGpioBankReg
+{
+  HostGpioReg val;
+};
+
+struct gpio_dev_t
+{
+  HostGpioReg out_w1ts;      // GPIO 0..31 set
+  HostGpioReg out_w1tc;      // GPIO 0..31 clear
+  HostGpioBankReg out1_w1ts; // GPIO 32..39 set
+  HostGpioBankReg out1_w1tc; // GPIO 32..39 clear
+};
+
+inline gpio_dev_t GPIO;
+
+#endif // HOST_SOC_GPIO_STRUCT_H
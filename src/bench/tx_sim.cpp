@@ -0,0 +1,324 @@
+/**
+ * @file tx_sim.cpp
+ * @brief Host replay of the TX traffic scenarios (env:tx_sim).
+ *
+ * Runs TrafficGenerator plus a 100 ms Cluster frame on the development PC.
+ * Without --iface the frames go through a virtual 500 kbit/s bus (a small TX
+ * queue drained at the bit rate) in simulated time, and the receive side is
+ * a TrafficSeq::Tracker, so a scenario's loss/reorder accounting is checked
+ * end to end in milliseconds. With --iface the frames are written in real
+ * time to a Linux SocketCAN interface (vcan0, or a USB adapter on the real
+ * bus); --listen runs the receiving end on an interface instead.
+ *
+ * Usage: program [--scenario N] [--seconds S] [--drop PERMILLE]
+ *        program --iface IF [--scenario N] [--seconds S]
+ *        program --listen --iface IF [--seconds S]
+ */
+#include "TrafficScenario.h"
+#include "common/TrafficSeq.h"
+#include "lecture.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/can.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr uint32_t kBitRate = 500000;
+constexpr uint32_t kClusterPeriodMs = 100;
+constexpr std::size_t kTxQueueDepth = 16; // tx_queue_len the CAN0 driver installs (BI_TX_BUFFER_SIZE)
+// Worst case stuffed lengths, see CANBusLoad::classicFrameBits (11 bit ID, 3 and 8 data bytes)
+constexpr uint32_t kClusterBits = 95;
+constexpr uint32_t kFillerBits = 135;
+
+struct Options
+{
+  int scenario = 0;
+  uint32_t seconds = 20;
+  uint32_t dropPermille = 0;
+  std::string iface;
+  bool listen = false;
+};
+
+struct Totals
+{
+  uint32_t clusterSent = 0;
+  uint32_t clusterRefused = 0;
+  uint64_t busBits = 0;
+};
+
+TrafficGenerator::Frame PackCluster(const TrafficGenerator::ClusterValues& v)
+{
+  Cluster_t cluster = {};
+  cluster.speed = v.speed;
+  cluster.Left_Turn_Signal = v.leftTurn ? 1 : 0;
+  cluster.Right_Turn_Signal = v.rightTurn ? 1 : 0;
+  TrafficGenerator::Frame frame = {};
+  uint8_t dlc = 0;
+  uint8_t ide = 0;
+  Pack_Cluster_lecture(&cluster, frame.data, &dlc, &ide);
+  frame.id = Cluster_CANID;
+  frame.length = dlc;
+  return frame;
+}
+
+// ---- Virtual bus: bounded TX queue drained at the bit rate ----
+
+struct VirtualBus
+{
+  std::deque<TrafficGenerator::Frame> queue;
+  uint32_t bitCredit = 0;
+  uint32_t dropPermille = 0;
+  uint32_t seed = 1;
+  TrafficSeq::Tracker tracker;
+  uint32_t clusterReceived = 0;
+  Totals totals;
+
+  static bool Send(const TrafficGenerator::Frame& frame, void* ctx)
+  {
+    auto* self = static_cast<VirtualBus*>(ctx);
+    if (self->queue.size() >= kTxQueueDepth) return false;
+    self->queue.push_back(frame);
+    return true;
+  }
+
+  void Drain1Ms()
+  {
+    bitCredit += kBitRate / 1000U;
+    while (!queue.empty())
+    {
+      const TrafficGenerator::Frame& f = queue.front();
+      const uint32_t bits = TrafficSeq::IsFillerId(f.id) ? kFillerBits : kClusterBits;
+      if (bits > bitCredit) return;
+      bitCredit -= bits;
+      totals.busBits += bits;
+      Receive(f);
+      queue.pop_front();
+    }
+    bitCredit = 0; // an idle bus does not bank capacity
+  }
+
+  void Receive(const TrafficGenerator::Frame& f)
+  {
+    seed = seed * 1103515245U + 12345U;
+    if (dropPermille != 0U && ((seed >> 16) % 1000U) < dropPermille) return;
+    uint32_t seq;
+    if (TrafficSeq::IsFillerId(f.id) && TrafficSeq::Decode(f.data, f.length, seq)) tracker.OnSequence(seq);
+    else if (f.id == Cluster_CANID) ++clusterReceived;
+  }
+};
+
+void PrintSummary(const TrafficGenerator& gen, const Totals& t, uint32_t elapsedMs)
+{
+  const TrafficGenerator::Counters& c = gen.Stats();
+  printf("scenario          %s (%u loops)\n", TrafficGenerator::Scenario(gen.ScenarioIndex())->name,
+         static_cast<unsigned>(c.loops));
+  printf("cluster sent      %u (refused %u)\n", static_cast<unsigned>(t.clusterSent),
+         static_cast<unsigned>(t.clusterRefused));
+  printf("filler sent       %u (refused %u)\n", static_cast<unsigned>(c.fillerSent),
+         static_cast<unsigned>(c.fillerRefused));
+  if (t.busBits != 0U && elapsedMs != 0U)
+  {
+    printf("bus load          %.1f %%\n", 100.0 * static_cast<double>(t.busBits) /
+                                              (static_cast<double>(kBitRate) * elapsedMs / 1000.0));
+  }
+}
+
+void PrintTracker(const TrafficSeq::Tracker& tr, uint32_t clusterReceived)
+{
+  printf("rx cluster        %u\n", static_cast<unsigned>(clusterReceived));
+  printf("rx filler         %u lost %u reordered %u duplicates %u\n", static_cast<unsigned>(tr.received),
+         static_cast<unsigned>(tr.lost), static_cast<unsigned>(tr.reordered), static_cast<unsigned>(tr.duplicates));
+}
+
+int RunVirtual(const Options& opt)
+{
+  VirtualBus bus;
+  bus.dropPermille = opt.dropPermille;
+  TrafficGenerator gen;
+  if (!gen.Start(static_cast<uint8_t>(opt.scenario), 0)) return 2;
+
+  const uint32_t endMs = opt.seconds * 1000U;
+  for (uint32_t t = 0; t < endMs; ++t)
+  {
+    // Cluster first: on the board the scheduler task outranks the traffic task
+    if (t % kClusterPeriodMs == 0U)
+    {
+      if (VirtualBus::Send(PackCluster(gen.Values()), &bus)) ++bus.totals.clusterSent;
+      else ++bus.totals.clusterRefused;
+    }
+    gen.Tick(t, &VirtualBus::Send, &bus);
+    bus.Drain1Ms();
+  }
+  // Let the queue empty so every accepted frame reaches the receiver
+  for (int i = 0; i < 10; ++i) bus.Drain1Ms();
+
+  PrintSummary(gen, bus.totals, endMs);
+  PrintTracker(bus.tracker, bus.clusterReceived);
+  const uint32_t expectedLost = gen.Stats().fillerSent - bus.tracker.received;
+  printf("check             %s (sent - received = %u)\n",
+         (bus.tracker.lost == expectedLost && bus.tracker.reordered == 0U) ? "ok" : "MISMATCH",
+         static_cast<unsigned>(expectedLost));
+  return (bus.tracker.lost == expectedLost) ? 0 : 1;
+}
+
+#ifdef __linux__
+int OpenCan(const std::string& iface)
+{
+  const int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+  if (fd < 0) return -1;
+  ifreq ifr = {};
+  strncpy(ifr.ifr_name, iface.c_str(), IFNAMSIZ - 1);
+  sockaddr_can addr = {};
+  if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0)
+  {
+    close(fd);
+    return -1;
+  }
+  addr.can_family = AF_CAN;
+  addr.can_ifindex = ifr.ifr_ifindex;
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+  {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool SocketSend(const TrafficGenerator::Frame& f, void* ctx)
+{
+  const int fd = *static_cast<int*>(ctx);
+  can_frame frame = {};
+  frame.can_id = f.id;
+  frame.can_dlc = f.length;
+  memcpy(frame.data, f.data, sizeof(frame.data));
+  // ENOBUFS when the interface queue is full counts as a refusal, like a full TWAI queue
+  return write(fd, &frame, sizeof(frame)) == static_cast<ssize_t>(sizeof(frame));
+}
+
+uint32_t NowMs(std::chrono::steady_clock::time_point start)
+{
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+int RunSocketTx(const Options& opt)
+{
+  int fd = OpenCan(opt.iface);
+  if (fd < 0)
+  {
+    fprintf(stderr, "cannot open %s\n", opt.iface.c_str());
+    return 2;
+  }
+  TrafficGenerator gen;
+  Totals totals;
+  const auto start = std::chrono::steady_clock::now();
+  if (!gen.Start(static_cast<uint8_t>(opt.scenario), 0)) return 2;
+
+  uint32_t nextClusterMs = 0;
+  uint32_t nowMs = 0;
+  while ((nowMs = NowMs(start)) < opt.seconds * 1000U)
+  {
+    if (static_cast<int32_t>(nowMs - nextClusterMs) >= 0)
+    {
+      if (SocketSend(PackCluster(gen.Values()), &fd)) ++totals.clusterSent;
+      else ++totals.clusterRefused;
+      nextClusterMs += kClusterPeriodMs;
+    }
+    gen.Tick(nowMs, &SocketSend, &fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  close(fd);
+  PrintSummary(gen, totals, nowMs);
+  return 0;
+}
+
+int RunSocketListen(const Options& opt)
+{
+  int fd = OpenCan(opt.iface);
+  if (fd < 0)
+  {
+    fprintf(stderr, "cannot open %s\n", opt.iface.c_str());
+    return 2;
+  }
+  timeval timeout = {0, 100000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  TrafficSeq::Tracker tracker;
+  uint32_t clusterReceived = 0;
+  const auto start = std::chrono::steady_clock::now();
+  uint32_t nextReportMs = 1000;
+  uint32_t nowMs = 0;
+  while ((nowMs = NowMs(start)) < opt.seconds * 1000U)
+  {
+    can_frame frame;
+    if (read(fd, &frame, sizeof(frame)) == static_cast<ssize_t>(sizeof(frame)))
+    {
+      uint32_t seq;
+      if (TrafficSeq::IsFillerId(frame.can_id) && TrafficSeq::Decode(frame.data, frame.can_dlc, seq))
+      {
+        tracker.OnSequence(seq);
+      }
+      else if (frame.can_id == Cluster_CANID)
+      {
+        ++clusterReceived;
+      }
+    }
+    if (static_cast<int32_t>(nowMs - nextReportMs) >= 0)
+    {
+      nextReportMs += 1000;
+      PrintTracker(tracker, clusterReceived);
+    }
+  }
+  close(fd);
+  return 0;
+}
+#endif
+
+bool ParseArgs(int argc, char** argv, Options& opt)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    const bool hasValue = (i + 1 < argc);
+    if (arg == "--scenario" && hasValue) opt.scenario = atoi(argv[++i]);
+    else if (arg == "--seconds" && hasValue) opt.seconds = static_cast<uint32_t>(atoi(argv[++i]));
+    else if (arg == "--drop" && hasValue) opt.dropPermille = static_cast<uint32_t>(atoi(argv[++i]));
+    else if (arg == "--iface" && hasValue) opt.iface = argv[++i];
+    else if (arg == "--listen") opt.listen = true;
+    else return false;
+  }
+  return opt.scenario >= 0 && opt.scenario < TrafficGenerator::ScenarioCount();
+}
+}
+
+int main(int argc, char** argv)
+{
+  Options opt;
+  if (!ParseArgs(argc, argv, opt))
+  {
+    fprintf(stderr, "usage: %s [--scenario 0..%u] [--seconds S] [--drop PERMILLE] [--iface IF [--listen]]\n",
+            argv[0], static_cast<unsigned>(TrafficGenerator::ScenarioCount() - 1U));
+    return 2;
+  }
+  if (opt.iface.empty()) return RunVirtual(opt);
+#ifdef __linux__
+  return opt.listen ? RunSocketListen(opt) : RunSocketTx(opt);
+#else
+  fprintf(stderr, "--iface needs Linux SocketCAN\n");
+  return 2;
+#endif
+}
@@ -0,0 +1,649 @@
+/**
+ * @file ui_bench.cpp
+ * @brief Headless LVGL render benchmark for the SquareLine screens (env:ui_bench).
+ *
+ * Links LVGL 9.1, the generated UI in lib/Ui and the board's DashboardView
+ * against a memory-backed display. A script of UiData samples and UiMessage
+ * commands is replayed in virtual time (one LVGL refresh period per step) and
+ * every rendered frame is measured: wall-clock render time, invalidated
+ * areas/pixels, draw tasks (draw calls) and flushed pixels. `snap` commands
+ * checksum the framebuffer (CRC-32) and optionally write a PNG, so a
+ * SquareLine re-export that changes pixels or render cost shows up as numbers.
+ *
+ * After the script, single arc value changes are rendered with the live and
+ * with the cached (GaugeSprite) arc background and the per-update render time
+ * and speedup are printed; the run exits 1 if the two leave different pixels.
+ *
+ * Usage: program [--script FILE] [--csv FILE|-] [--png-dir DIR]
+ *                [--golden FILE] [--write-golden FILE] [--no-draw-tasks]
+ *                [--arc-updates N]
+ *
+ * Script commands (one per line, '#' starts a comment):
+ *   data <arc 0..240> <left 0|1> <right 0|1>   queue a UiData sample
+ *   anim <fps> <tau ms>                          speed arc animation settings (fps 0: jump)
+ *   sprite <0|1>                                 live or cached speed arc background
+ *   dashboard | log | degraded | fault | redraw UiMessage commands
+ *   logline <text>                               UiMessage AddLogLine
+ *   burst <n>                                    n AddLogLine messages back to back
+ *   wait <ms>                                    advance virtual time frame by frame
+ *   snap <name>                                  checksum (and PNG) of the framebuffer
+ * Without --script a built-in scenario covering both screens is replayed.
+ */
+#include <lvgl.h>
+#include "ui.h"
+#include "DashboardView.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr int32_t kWidth = 320;
+constexpr int32_t kHeight = 240;
+// Same band height as the board (TFTConfiguration.h) so render work splits the same way
+#ifndef UI_DRAW_BUF_LINES
+#define UI_DRAW_BUF_LINES 24
+#endif
+constexpr std::size_t kBufPixels = static_cast<std::size_t>(kWidth) * UI_DRAW_BUF_LINES;
+constexpr uint32_t kFramePeriodMs = LV_DEF_REFR_PERIOD;
+
+uint16_t g_framebuffer[kWidth * kHeight];
+alignas(4) uint16_t g_drawBuf1[kBufPixels];
+alignas(4) uint16_t g_drawBuf2[kBufPixels];
+uint32_t g_nowMs = 0; // virtual LVGL tick
+
+struct FrameCounters
+{
+  uint32_t invalAreas;
+  uint32_t invalPixels;
+  uint32_t drawTasks;
+  uint32_t flushes;
+  uint32_t flushedPixels;
+};
+FrameCounters g_frame;
+
+struct FrameRecord
+{
+  uint32_t tMs;
+  uint32_t renderUs;
+  FrameCounters counters;
+};
+
+// ---- CRC-32 (IEEE), shared by framebuffer checksums and PNG chunks ----
+uint32_t g_crcTable[256];
+
+void InitCrc()
+{
+  for (uint32_t n = 0; n < 256; ++n)
+  {
+    uint32_t c = n;
+    for (int k = 0; k < 8; ++k) c = (c & 1U) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+    g_crcTable[n] = c;
+  }
+}
+
+uint32_t Crc32(uint32_t crc, const uint8_t* data, std::size_t len)
+{
+  crc = ~crc;
+  for (std::size_t i = 0; i < len; ++i) crc = g_crcTable[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8);
+  return ~crc;
+}
+
+uint32_t FramebufferCrc()
+{
+  return Crc32(0, reinterpret_cast<const uint8_t*>(g_framebuffer), sizeof(g_framebuffer));
+}
+
+// ---- Minimal PNG writer (RGB888, stored deflate blocks, no compression) ----
+void PutBe32(std::vector<uint8_t>& v, uint32_t x)
+{
+  v.push_back(static_cast<uint8_t>(x >> 24));
+  v.push_back(static_cast<uint8_t>(x >> 16));
+  v.push_back(static_cast<uint8_t>(x >> 8));
+  v.push_back(static_cast<uint8_t>(x));
+}
+
+void PutChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+{
+  PutBe32(out, static_cast<uint32_t>(data.size()));
+  std::vector<uint8_t> body(type, type + 4);
+  body.insert(body.end(), data.begin(), data.end());
+  out.insert(out.end(), body.begin(), body.end());
+  PutBe32(out, Crc32(0, body.data(), body.size()));
+}
+
+bool WritePng(const std::string& path)
+{
+  // Raw scanlines: filter byte 0 + RGB888 expanded from RGB565
+  std::vector<uint8_t> raw;
+  raw.reserve(static_cast<std::size_t>(kHeight) * (1 + kWidth * 3));
+  for (int32_t y = 0; y < kHeight; ++y)
+  {
+    raw.push_back(0);
+    for (int32_t x = 0; x < kWidth; ++x)
+    {
+      const uint16_t p = g_framebuffer[y * kWidth + x];
+      raw.push_back(static_cast<uint8_t>(((p >> 11) & 0x1FU) * 255U / 31U));
+      raw.push_back(static_cast<uint8_t>(((p >> 5) & 0x3FU) * 255U / 63U));
+      raw.push_back(static_cast<uint8_t>((p & 0x1FU) * 255U / 31U));
+    }
+  }
+
+  std::vector<uint8_t> z = {0x78, 0x01};
+  uint32_t a = 1, b = 0;
+  for (std::size_t off = 0; off < raw.size();)
+  {
+    const std::size_t n = std::min<std::size_t>(65535U, raw.size() - off);
+    z.push_back(off + n == raw.size() ? 1 : 0);
+    z.push_back(static_cast<uint8_t>(n));
+    z.push_back(static_cast<uint8_t>(n >> 8));
+    z.push_back(static_cast<uint8_t>(~n));
+    z.push_back(static_cast<uint8_t>(~n >> 8));
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      a = (a + raw[off + i]) % 65521U;
+      b = (b + a) % 65521U;
+    }
+    z.insert(z.end(), raw.begin() + static_cast<std::ptrdiff_t>(off),
+             raw.begin() + static_cast<std::ptrdiff_t>(off + n));
+    off += n;
+  }
+  PutBe32(z, (b << 16) | a);
+
+  std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  std::vector<uint8_t> ihdr;
+  PutBe32(ihdr, kWidth);
+  PutBe32(ihdr, kHeight);
+  const uint8_t ihdrTail[5] = {8, 2, 0, 0, 0}; // 8 bit, truecolor, deflate, no filter, no interlace
+  ihdr.insert(ihdr.end(), ihdrTail, ihdrTail + 5);
+  PutChunk(png, "IHDR", ihdr);
+  PutChunk(png, "IDAT", z);
+  PutChunk(png, "IEND", std::vector<uint8_t>());
+
+  std::ofstream f(path.c_str(), std::ios::binary);
+  if (!f) return false;
+  f.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+  return static_cast<bool>(f);
+}
+
+// ---- LVGL display driver backed by g_framebuffer ----
+uint32_t TickCb()
+{
+  return g_nowMs;
+}
+
+void FlushCb(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map)
+{
+  const int32_t w = lv_area_get_width(area);
+  const uint16_t* src = reinterpret_cast<const uint16_t*>(px_map);
+  for (int32_t y = area->y1; y <= area->y2; ++y)
+  {
+    memcpy(&g_framebuffer[y * kWidth + area->x1], src, static_cast<std::size_t>(w) * sizeof(uint16_t));
+    src += w;
+  }
+  g_frame.flushes++;
+  g_frame.flushedPixels += static_cast<uint32_t>(w * lv_area_get_height(area));
+  lv_display_flush_ready(disp);
+}
+
+void DisplayEventCb(lv_event_t* e)
+{
+  const lv_area_t* area = static_cast<const lv_area_t*>(lv_event_get_param(e));
+  g_frame.invalAreas++;
+  if (area != nullptr) g_frame.invalPixels += lv_area_get_size(area);
+}
+
+void DrawTaskCb(lv_event_t* /*e*/)
+{
+  g_frame.drawTasks++;
+}
+
+void InstrumentTree(lv_obj_t* obj)
+{
+  if (obj == nullptr) return;
+  lv_obj_add_flag(obj, LV_OBJ_FLAG_SEND_DRAW_TASK_EVENTS);
+  lv_obj_add_event_cb(obj, DrawTaskCb, LV_EVENT_DRAW_TASK_ADDED, nullptr);
+  const uint32_t n = lv_obj_get_child_count(obj);
+  for (uint32_t i = 0; i < n; ++i) InstrumentTree(lv_obj_get_child(obj, static_cast<int32_t>(i)));
+}
+
+// ---- Scenario ----
+const char* const kBuiltinScript =
+  "# boot: log screen fills while the display comes up\n"
+  "log\n"
+  "logline System booting...\n"
+  "logline Initializing display...\n"
+  "logline Initializing CAN...\n"
+  "logline Waiting for CAN data...\n"
+  "wait 200\n"
+  "snap boot_log\n"
+  "# dashboard at rest, then a full redraw\n"
+  "dashboard\n"
+  "data 0 0 0\n"
+  "wait 200\n"
+  "snap dashboard_idle\n"
+  "redraw\n"
+  "wait 100\n"
+  "# arc animates to 120, then steady speed should render nothing\n"
+  "data 120 0 0\n"
+  "wait 1000\n"
+  "snap dashboard_120\n"
+  "wait 1000\n"
+  "# 10 Hz samples: the arc is animated between them at UI_ARC_ANIM_FPS\n"
+  "data 150 0 0\n"
+  "wait 100\n"
+  "data 180 0 0\n"
+  "wait 100\n"
+  "data 210 0 0\n"
+  "wait 100\n"
+  "data 240 0 0\n"
+  "wait 1000\n"
+  "snap sweep_240\n"
+  "data 120 0 0\n"
+  "wait 1000\n"
+  "# indicators\n"
+  "data 120 1 0\n"
+  "wait 1000\n"
+  "data 120 0 1\n"
+  "wait 1000\n"
+  "data 120 1 1\n"
+  "wait 240\n"
+  "snap hazard_on\n"
+  "wait 1000\n"
+  "data 120 0 0\n"
+  "# stale data overlay\n"
+  "degraded\n"
+  "wait 100\n"
+  "snap degraded\n"
+  "# log burst\n"
+  "log\n"
+  "burst 40\n"
+  "wait 200\n"
+  "snap log_burst\n"
+  "dashboard\n"
+  "fault\n"
+  "wait 100\n"
+  "snap fault\n";
+
+struct Bench
+{
+  DashboardView view;
+  UiData data{0, false, false, 0};
+  std::vector<FrameRecord> frames;
+  std::map<std::string, uint32_t> snaps;
+  std::vector<std::string> snapOrder;
+  FILE* csv = nullptr;
+  std::string pngDir;
+
+  // One LVGL refresh at g_nowMs; returns its wall-clock time, counters are in g_frame
+  uint32_t RenderOnce()
+  {
+    memset(&g_frame, 0, sizeof(g_frame));
+    const auto t0 = std::chrono::steady_clock::now();
+    view.Animate(g_nowMs);
+    view.UpdateBlink(data, g_nowMs);
+    lv_timer_handler();
+    const auto t1 = std::chrono::steady_clock::now();
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+  }
+
+  void Step()
+  {
+    const uint32_t renderUs = RenderOnce();
+    if (g_frame.flushes != 0)
+    {
+      FrameRecord r{g_nowMs, renderUs, g_frame};
+      frames.push_back(r);
+      if (csv != nullptr)
+      {
+        fprintf(csv, "%lu,%lu,%lu,%lu,%lu,%lu,%lu,%08lx\n",
+                static_cast<unsigned long>(r.tMs), static_cast<unsigned long>(r.renderUs),
+                static_cast<unsigned long>(r.counters.invalAreas),
+                static_cast<unsigned long>(r.counters.invalPixels),
+                static_cast<unsigned long>(r.counters.drawTasks),
+                static_cast<unsigned long>(r.counters.flushes),
+                static_cast<unsigned long>(r.counters.flushedPixels),
+                static_cast<unsigned long>(FramebufferCrc()));
+      }
+    }
+    g_nowMs += kFramePeriodMs;
+  }
+
+  void Wait(uint32_t ms)
+  {
+    const uint32_t steps = (ms + kFramePeriodMs - 1U) / kFramePeriodMs;
+    for (uint32_t i = 0; i < (steps == 0 ? 1U : steps); ++i) Step();
+  }
+
+  void Snap(const std::string& name)
+  {
+    const uint32_t crc = FramebufferCrc();
+    if (snaps.find(name) == snaps.end()) snapOrder.push_back(name);
+    snaps[name] = crc;
+    if (!pngDir.empty())
+    {
+      const std::string path = pngDir + "/" + name + ".png";
+      if (!WritePng(path)) fprintf(stderr, "cannot write %s\n", path.c_str());
+    }
+  }
+
+  bool Run(std::istream& script)
+  {
+    std::string line;
+    unsigned lineNo = 0;
+    while (std::getline(script, line))
+    {
+      ++lineNo;
+      const std::size_t hash = line.find('#');
+      if (hash != std::string::npos) line.erase(hash);
+      std::istringstream in(line);
+      std::string cmd;
+      if (!(in >> cmd)) continue;
+
+      if (cmd == "data")
+      {
+        unsigned arc = 0, left = 0, right = 0;
+        if (!(in >> arc >> left >> right)) return Fail(lineNo, "data <arc> <left> <right>");
+        data = UiData{static_cast<uint16_t>(arc), left != 0, right != 0, 0};
+        view.ApplyData(data, g_nowMs);
+      }
+      else if (cmd == "anim")
+      {
+        unsigned fps = 0, tauMs = 0;
+        if (!(in >> fps >> tauMs)) return Fail(lineNo, "anim <fps> <tau ms>");
+        view.SetArcAnimation(GaugeAnimator::Config{static_cast<uint16_t>(fps), static_cast<uint16_t>(tauMs)});
+      }
+      else if (cmd == "sprite")
+      {
+        unsigned on = 0;
+        if (!(in >> on)) return Fail(lineNo, "sprite <0|1>");
+        if (!view.SetArcSprite(on != 0)) fprintf(stderr, "arc sprite cache off: %s\n", view.ArcSprite().FailReason());
+      }
+      else if (cmd == "dashboard") view.HandleMessage(UiMessage::MakeShowDashboard());
+      else if (cmd == "log") view.HandleMessage(UiMessage::MakeShowLog());
+      else if (cmd == "degraded") view.HandleMessage(UiMessage::MakeShowDegraded());
+      else if (cmd == "fault") view.HandleMessage(UiMessage::MakeShowFault());
+      else if (cmd == "redraw") view.HandleMessage(UiMessage::MakeForceRedraw());
+      else if (cmd == "logline")
+      {
+        std::string text;
+        std::getline(in >> std::ws, text);
+        view.HandleMessage(UiMessage::MakeAddLog(text.c_str()));
+      }
+      else if (cmd == "burst")
+      {
+        // <n> log lines without rendering in between (fault/boot storm)
+        unsigned n = 0;
+        if (!(in >> n)) return Fail(lineNo, "burst <lines>");
+        char text[64];
+        for (unsigned i = 0; i < n; ++i)
+        {
+          snprintf(text, sizeof(text), "burst line %u of %u", i + 1U, n);
+          view.HandleMessage(UiMessage::MakeAddLog(text));
+        }
+      }
+      else if (cmd == "wait")
+      {
+        unsigned ms = 0;
+        if (!(in >> ms)) return Fail(lineNo, "wait <ms>");
+        Wait(ms);
+      }
+      else if (cmd == "snap")
+      {
+        std::string name;
+        if (!(in >> name)) return Fail(lineNo, "snap <name>");
+        Wait(0); // render pending invalidations first
+        Snap(name);
+      }
+      else
+      {
+        return Fail(lineNo, ("unknown command '" + cmd + "'").c_str());
+      }
+    }
+    return true;
+  }
+
+  struct ArcCost
+  {
+    uint64_t sumUs;
+    uint32_t updates;
+    uint32_t crc;  // framebuffer after a fixed final value, must match between modes
+  };
+
+  // Render @p updates single arc value changes (no animation) with the live or cached background
+  bool MeasureArcUpdates(bool sprite, unsigned updates, ArcCost& cost)
+  {
+    cost = ArcCost{0, 0, 0};
+    if (!view.SetArcSprite(sprite)) return false;
+    view.SetArcAnimation(GaugeAnimator::Config{0, 0});
+    view.HandleMessage(UiMessage::MakeShowDashboard());
+    view.HideDegraded();
+    data = UiData{0, false, false, 0};
+    view.ApplyData(data, g_nowMs);
+    lv_obj_invalidate(lv_screen_active());
+    Wait(0);
+
+    // Sweep up and down the range in steps of 3 arc units (one update per refresh)
+    int value = 0;
+    int dir = 3;
+    for (unsigned i = 0; i < updates; ++i)
+    {
+      if (value + dir > 240 || value + dir < 0) dir = -dir;
+      value += dir;
+      data.speedArc = static_cast<uint16_t>(value);
+      view.ApplyData(data, g_nowMs);
+      cost.sumUs += RenderOnce();
+      cost.updates++;
+      g_nowMs += kFramePeriodMs;
+    }
+    data.speedArc = 137;
+    view.ApplyData(data, g_nowMs);
+    RenderOnce();
+    g_nowMs += kFramePeriodMs;
+    cost.crc = FramebufferCrc();
+    return true;
+  }
+
+  static bool Fail(unsigned lineNo, const char* what)
+  {
+    fprintf(stderr, "script line %u: %s\n", lineNo, what);
+    return false;
+  }
+};
+
+uint32_t Percentile(std::vector<uint32_t> v, unsigned pct)
+{
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[(v.size() - 1U) * pct / 100U];
+}
+
+void PrintSummary(const Bench& bench)
+{
+  std::vector<uint32_t> render;
+  uint64_t sumRender = 0, sumInval = 0, sumDraw = 0, sumFlushed = 0;
+  for (const FrameRecord& f : bench.frames)
+  {
+    render.push_back(f.renderUs);
+    sumRender += f.renderUs;
+    sumInval += f.counters.invalPixels;
+    sumDraw += f.counters.drawTasks;
+    sumFlushed += f.counters.flushedPixels;
+  }
+  const std::size_t n = bench.frames.size();
+  printf("frames rendered   %zu (virtual time %lu ms)\n", n, static_cast<unsigned long>(g_nowMs));
+  if (n != 0)
+  {
+    printf("render us         avg %llu  p50 %lu  p95 %lu  max %lu\n",
+           static_cast<unsigned long long>(sumRender / n), static_cast<unsigned long>(Percentile(render, 50)),
+           static_cast<unsigned long>(Percentile(render, 95)), static_cast<unsigned long>(Percentile(render, 100)));
+    printf("invalidated px    %llu (%llu per frame)\n", static_cast<unsigned long long>(sumInval),
+           static_cast<unsigned long long>(sumInval / n));
+    printf("draw tasks        %llu (%llu per frame)\n", static_cast<unsigned long long>(sumDraw),
+           static_cast<unsigned long long>(sumDraw / n));
+    printf("flushed px        %llu (%llu per frame)\n", static_cast<unsigned long long>(sumFlushed),
+           static_cast<unsigned long long>(sumFlushed / n));
+  }
+  for (const std::string& name : bench.snapOrder)
+  {
+    printf("snap %-16s %08lx\n", name.c_str(), static_cast<unsigned long>(bench.snaps.at(name)));
+  }
+}
+
+// False if the cached background renders different pixels than live drawing
+bool PrintArcUpdateCost(Bench& bench, unsigned updates)
+{
+  Bench::ArcCost live, cached;
+  bench.MeasureArcUpdates(false, updates, live);
+  const uint64_t liveAvg = live.sumUs / live.updates;
+  if (!bench.MeasureArcUpdates(true, updates, cached))
+  {
+    printf("arc update us     live avg %llu (sprite cache off: %s)\n", static_cast<unsigned long long>(liveAvg),
+           bench.view.ArcSprite().FailReason());
+    return true;
+  }
+  const uint64_t cachedAvg = cached.sumUs / cached.updates;
+  printf("arc update us     live avg %llu  sprite avg %llu  speedup %.2fx (%u updates, pixels %s)\n",
+         static_cast<unsigned long long>(liveAvg), static_cast<unsigned long long>(cachedAvg),
+         (cached.sumUs != 0) ? static_cast<double>(live.sumUs) / static_cast<double>(cached.sumUs) : 0.0,
+         updates, (live.crc == cached.crc) ? "identical" : "DIFFER");
+  return live.crc == cached.crc;
+}
+
+// Golden file format: one "<name> <crc hex>" per line
+bool CheckGolden(const Bench& bench, const std::string& path)
+{
+  std::ifstream f(path.c_str());
+  if (!f)
+  {
+    fprintf(stderr, "cannot read golden file %s\n", path.c_str());
+    return false;
+  }
+  bool ok = true;
+  std::string name, hex;
+  while (f >> name >> hex)
+  {
+    const uint32_t expected = static_cast<uint32_t>(strtoul(hex.c_str(), nullptr, 16));
+    const auto it = bench.snaps.find(name);
+    if (it == bench.snaps.end())
+    {
+      printf("GOLDEN MISSING  %s\n", name.c_str());
+      ok = false;
+    }
+    else if (it->second != expected)
+    {
+      printf("GOLDEN MISMATCH %s: expected %08lx got %08lx\n", name.c_str(),
+             static_cast<unsigned long>(expected), static_cast<unsigned long>(it->second));
+      ok = false;
+    }
+  }
+  printf("golden %s\n", ok ? "OK" : "FAILED");
+  return ok;
+}
+
+bool WriteGolden(const Bench& bench, const std::string& path)
+{
+  FILE* f = fopen(path.c_str(), "w");
+  if (f == nullptr) return false;
+  for (const std::string& name : bench.snapOrder)
+  {
+    fprintf(f, "%s %08lx\n", name.c_str(), static_cast<unsigned long>(bench.snaps.at(name)));
+  }
+  fclose(f);
+  return true;
+}
+}
+
+int main(int argc, char** argv)
+{
+  std::string scriptPath, csvPath, goldenPath, writeGoldenPath, pngDir;
+  bool drawTasks = true;
+  unsigned arcUpdates = 240;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    const bool hasValue = (i + 1 < argc);
+    if (arg == "--script" && hasValue) scriptPath = argv[++i];
+    else if (arg == "--csv" && hasValue) csvPath = argv[++i];
+    else if (arg == "--png-dir" && hasValue) pngDir = argv[++i];
+    else if (arg == "--golden" && hasValue) goldenPath = argv[++i];
+    else if (arg == "--write-golden" && hasValue) writeGoldenPath = argv[++i];
+    else if (arg == "--no-draw-tasks") drawTasks = false;
+    else if (arg == "--arc-updates" && hasValue) arcUpdates = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+    else
+    {
+      fprintf(stderr, "usage: %s [--script FILE] [--csv FILE|-] [--png-dir DIR] "
+                      "[--golden FILE] [--write-golden FILE] [--no-draw-tasks] [--arc-updates N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  InitCrc();
+  lv_init();
+  lv_tick_set_cb(TickCb);
+  lv_display_t* disp = lv_display_create(kWidth, kHeight);
+  lv_display_set_flush_cb(disp, FlushCb);
+  lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565);
+  lv_display_set_buffers(disp, g_drawBuf1, g_drawBuf2, sizeof(g_drawBuf1), LV_DISPLAY_RENDER_MODE_PARTIAL);
+  lv_display_add_event_cb(disp, DisplayEventCb, LV_EVENT_INVALIDATE_AREA, nullptr);
+
+  Bench bench;
+  ui_init();
+  bench.view.Build();
+  if (drawTasks)
+  {
+    InstrumentTree(ui_Screen1);
+    InstrumentTree(ui_Screen2);
+  }
+
+  if (!csvPath.empty())
+  {
+    bench.csv = (csvPath == "-") ? stdout : fopen(csvPath.c_str(), "w");
+    if (bench.csv == nullptr)
+    {
+      fprintf(stderr, "cannot write %s\n", csvPath.c_str());
+      return 2;
+    }
+    fprintf(bench.csv, "t_ms,render_us,inval_areas,inval_px,draw_tasks,flushes,flushed_px,fb_crc\n");
+  }
+  bench.pngDir = pngDir;
+
+  bool ok;
+  if (scriptPath.empty())
+  {
+    std::istringstream script(kBuiltinScript);
+    ok = bench.Run(script);
+  }
+  else
+  {
+    std::ifstream script(scriptPath.c_str());
+    if (!script)
+    {
+      fprintf(stderr, "cannot read %s\n", scriptPath.c_str());
+      return 2;
+    }
+    ok = bench.Run(script);
+  }
+  if (bench.csv != nullptr && bench.csv != stdout) fclose(bench.csv);
+  if (!ok) return 2;
+
+  PrintSummary(bench);
+  // Runs after the script so it cannot shift the blink phase of any snap
+  const bool arcPixelsMatch = (arcUpdates == 0) || PrintArcUpdateCost(bench, arcUpdates);
+  if (!writeGoldenPath.empty() && !WriteGolden(bench, writeGoldenPath))
+  {
+    fprintf(stderr, "cannot write %s\n", writeGoldenPath.c_str());
+    return 2;
+  }
+  if (!goldenPath.empty() && !CheckGolden(bench, goldenPath)) return 1;
+  return arcPixelsMatch ? 0 : 1;
+}
@@ -22,6 +22,13 @@ bool MessageRouter::Init(std::size_t maxClusterSubs)
   statusSubCount_ = 0;
   haveStatus_ = false;
   lastStatusTsMs_ = 0;
+
+  maxTelemetrySubs_ = maxClusterSubs_;
+  telemetrySubs_ = new UiTelemetrySub[maxTelemetrySubs_];
+  if (!telemetrySubs_) return false;
+  telemetrySubCount_ = 0;
+  haveTelemetry_ = false;
+  lastTelemetryTsMs_ = 0;
   return true;
 }
 
@@ -134,3 +141,53 @@ bool MessageRouter::GetLastSystemStatus(SystemStatus& out, uint32_t& tsMs) const
   tsMs = lastStatusTsMs_;
   return true;
 }
+
+bool MessageRouter::SubscribeUiTelemetry(UiTelemetryCallback cb, void* ctx)
+{
+  if (!cb || !telemetrySubs_ || telemetrySubCount_ >= maxTelemetrySubs_) return false;
+  for (std::size_t i = 0; i < telemetrySubCount_; ++i)
+  {
+    if (telemetrySubs_[i].cb == cb && telemetrySubs_[i].ctx == ctx) return true;
+  }
+  telemetrySubs_[telemetrySubCount_++] = UiTelemetrySub{cb, ctx};
+  return true;
+}
+
+void MessageRouter::UnsubscribeUiTelemetry(UiTelemetryCallback cb, void* ctx)
+{
+  if (!telemetrySubs_ || telemetrySubCount_ == 0) return;
+  for (std::size_t i = 0; i < telemetrySubCount_; ++i)
+  {
+    if (telemetrySubs_[i].cb == cb && telemetrySubs_[i].ctx == ctx)
+    {
+      for (std::size_t j = i + 1; j < telemetrySubCount_; ++j)
+      {
+        telemetrySubs_[j - 1] = telemetrySubs_[j];
+      }
+      --telemetrySubCount_;
+      break;
+    }
+  }
+}
+
+void MessageRouter::PublishUiTelemetry(const UiTelemetry& telemetry, uint32_t tsMs)
+{
+  lastTelemetry_ = telemetry;
+  lastTelemetryTsMs_ = tsMs;
+  haveTelemetry_ = true;
+  for (std::size_t i = 0; i < telemetrySubCount_; ++i)
+  {
+    if (telemetrySubs_[i].cb)
+    {
+      telemetrySubs_[i].cb(telemetry, tsMs, telemetrySubs_[i].ctx);
+    }
+  }
+}
+
+bool MessageRouter::GetLastUiTelemetry(UiTelemetry& out, uint32_t& tsMs) const
+{
+  if (!haveTelemetry_) return false;
+  out = lastTelemetry_;
+  tsMs = lastTelemetryTsMs_;
+  return true;
+}
@@ -5,6 +5,7 @@
  * Responsibilities:
  * - Fan-out of the DBC-generated Cluster_t payload to interested consumers (sticky last value)
  * - Optional publication of system status snapshots to gate IO and UI safely
+ * - Periodic LVGL memory/render telemetry from the UI for field diagnostics
  *
  * Design notes:
  * - All subscription and publish calls are intended from task/loop context (not ISR)
@@ -39,6 +40,26 @@ public:
   };
   /** Callback signature for SystemStatus topic subscribers */
   using SystemStatusCallback = void(*)(const SystemStatus& status, uint32_t tsMs, void* ctx);
+  /** LVGL heap and render timing snapshot (plain integers, no LVGL types) */
+  struct UiTelemetry {
+    uint32_t windowMs;          // render window the frame/flush fields cover
+    uint32_t memTotal;          // LVGL heap size (LV_MEM_SIZE) in bytes
+    uint32_t memFree;
+    uint32_t memFreeBiggest;    // largest free block
+    uint32_t memMaxUsed;        // high-water mark since boot
+    uint8_t memUsedPct;
+    uint8_t memFragPct;
+    uint32_t frames;            // refresh cycles that rendered in the window
+    uint32_t frameUsAvg;
+    uint32_t frameUsMax;
+    uint32_t flushes;
+    uint32_t flushUsAvg;
+    uint32_t flushUsMax;
+    uint32_t invalidatedPixels; // summed invalidated area (before LVGL joins areas)
+    uint32_t flushedPixels;
+  };
+  /** Callback signature for UiTelemetry topic subscribers */
+  using UiTelemetryCallback = void(*)(const UiTelemetry& telemetry, uint32_t tsMs, void* ctx);
 
   /** Construct an empty router (allocate subscribers via Init). */
   MessageRouter();
@@ -78,6 +99,16 @@ public:
   /** Retrieve last published SystemStatus if available. */
   bool GetLastSystemStatus(SystemStatus& out, uint32_t& tsMs) const;
 
+  // UiTelemetry topic
+  /** Register a callback for UiTelemetry snapshots. */
+  bool SubscribeUiTelemetry(UiTelemetryCallback cb, void* ctx);
+  /** Unregister a previously registered UiTelemetry callback. */
+  void UnsubscribeUiTelemetry(UiTelemetryCallback cb, void* ctx);
+  /** Publish a new UiTelemetry snapshot to all subscribers. */
+  void PublishUiTelemetry(const UiTelemetry& telemetry, uint32_t tsMs);
+  /** Retrieve last published UiTelemetry if available. */
+  bool GetLastUiTelemetry(UiTelemetry& out, uint32_t& tsMs) const;
+
 private:
   struct ClusterSub {
     ClusterCallback cb;
@@ -89,6 +120,11 @@ private:
     void* ctx;
   };
 
+  struct UiTelemetrySub {
+    UiTelemetryCallback cb;
+    void* ctx;
+  };
+
   ClusterSub* clusterSubs_ = nullptr;
   std::size_t maxClusterSubs_ = 0;
   std::size_t clusterSubCount_ = 0;
@@ -105,6 +141,14 @@ private:
   bool haveStatus_ = false;
   SystemStatus lastStatus_{};
   uint32_t lastStatusTsMs_ = 0;
+
+  // UiTelemetry storage
+  UiTelemetrySub* telemetrySubs_ = nullptr;
+  std::size_t maxTelemetrySubs_ = 8;
+  std::size_t telemetrySubCount_ = 0;
+  bool haveTelemetry_ = false;
+  UiTelemetry lastTelemetry_{};
+  uint32_t lastTelemetryTsMs_ = 0;
 };
 
 #endif // MESSAGE_ROUTER_H
@@ -3,7 +3,10 @@
 #include <lvgl.h>
 const uint16_t screenWidth = 320;
 const uint16_t screenHeight = 240;
-const size_t lvglBufferSizePixels = static_cast<size_t>(screenWidth) * static_cast<size_t>(screenHeight) / 10U;
-lv_color_t buf[lvglBufferSizePixels];
+const size_t lvglBufferSizePixels = static_cast<size_t>(screenWidth) * static_cast<size_t>(UI_DRAW_BUF_LINES);
+alignas(4) uint16_t drawBuf1[lvglBufferSizePixels];
+#if UI_DISPLAY_DMA
+alignas(4) uint16_t drawBuf2[lvglBufferSizePixels];
+#endif
 TFT_eSPI tft = TFT_eSPI(screenWidth, screenHeight);
 NS2009 TS(false, false);
\ No newline at end of file
@@ -0,0 +1,129 @@
+/**
+ * @file TrafficSeq.h
+ * @brief Filler frame format for TX load scenarios and a receive-side loss tracker.
+ *
+ * Scenario filler frames carry a 32-bit sequence number that counts every
+ * filler frame the transmitter handed to the bus. A receiver feeding each
+ * filler into Tracker gets loss, reordering and duplicate counts that are
+ * exact as long as no frame arrives more than 64 sequence numbers late.
+ *
+ * Layout (8 bytes): [0..3] sequence (little endian), [4] scenario index,
+ * [5] step index, [6..7] marker 0x5A 0xA5. IDs are kFillerBaseId plus the
+ * sequence modulo kFillerIdCount, all below Cluster priority.
+ */
+#ifndef TRAFFIC_SEQ_H
+#define TRAFFIC_SEQ_H
+
+#include <cstdint>
+
+namespace TrafficSeq
+{
+constexpr uint32_t kFillerBaseId = 0x700;
+constexpr uint8_t kFillerIdCount = 16;
+constexpr uint8_t kFillerLength = 8;
+constexpr uint8_t kMarker0 = 0x5A;
+constexpr uint8_t kMarker1 = 0xA5;
+
+inline uint32_t FillerId(uint32_t seq)
+{
+  return kFillerBaseId + (seq % kFillerIdCount);
+}
+
+inline bool IsFillerId(uint32_t id)
+{
+  return id >= kFillerBaseId && id < kFillerBaseId + kFillerIdCount;
+}
+
+inline void Encode(uint8_t* data, uint32_t seq, uint8_t scenario, uint8_t step)
+{
+  data[0] = static_cast<uint8_t>(seq);
+  data[1] = static_cast<uint8_t>(seq >> 8);
+  data[2] = static_cast<uint8_t>(seq >> 16);
+  data[3] = static_cast<uint8_t>(seq >> 24);
+  data[4] = scenario;
+  data[5] = step;
+  data[6] = kMarker0;
+  data[7] = kMarker1;
+}
+
+/** @return false if the payload is not a filler frame. */
+inline bool Decode(const uint8_t* data, uint8_t length, uint32_t& seq)
+{
+  if (length != kFillerLength || data[6] != kMarker0 || data[7] != kMarker1) return false;
+  seq = static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+        (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+  return true;
+}
+
+/**
+ * @class Tracker
+ * @brief Counts received, lost, late (reordered) and duplicate sequence numbers.
+ *
+ * A gap counts as lost until the missing numbers arrive; numbers that arrive
+ * late within the last 64 are moved from lost to reordered, repeats count as
+ * duplicates.
+ *
+ * Only the newest 64 sequence numbers are remembered. A number older than
+ * that is always counted as reordered (and taken off lost), so a duplicate
+ * of it is not recognized; the counts are exact only while every late frame
+ * is within the 64-sequence window.
+ */
+class Tracker
+{
+public:
+  void Reset()
+  {
+    started_ = false;
+    highest_ = 0;
+    window_ = 0;
+    received = lost = reordered = duplicates = 0;
+  }
+
+  void OnSequence(uint32_t seq)
+  {
+    ++received;
+    if (!started_)
+    {
+      started_ = true;
+      highest_ = seq;
+      window_ = 1;
+      return;
+    }
+    const int32_t ahead = static_cast<int32_t>(seq - highest_);
+    if (ahead > 0)
+    {
+      lost += static_cast<uint32_t>(ahead - 1);
+      window_ = (ahead >= 64) ? 1ULL : ((window_ << ahead) | 1ULL);
+      highest_ = seq;
+      return;
+    }
+    // Bit n of window_ is sequence highest_ - n
+    const uint32_t behind = static_cast<uint32_t>(-ahead);
+    if (behind < 64)
+    {
+      const uint64_t bit = 1ULL << behind;
+      if (window_ & bit)
+      {
+        ++duplicates;
+        --received;
+        return;
+      }
+      window_ |= bit;
+    }
+    ++reordered;
+    if (lost > 0) --lost;
+  }
+
+  uint32_t received = 0;   ///< distinct sequence numbers seen
+  uint32_t lost = 0;       ///< numbers skipped and not (yet) seen
+  uint32_t reordered = 0;  ///< numbers that arrived after a higher one
+  uint32_t duplicates = 0;
+
+private:
+  bool started_ = false;
+  uint32_t highest_ = 0;
+  uint64_t window_ = 0;
+};
+}
+
+#endif // TRAFFIC_SEQ_H
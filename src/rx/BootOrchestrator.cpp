@@ -0,0 +1,159 @@
+#include "BootOrchestrator.h"
+#include <Arduino.h>
+
+namespace
+{
+constexpr uint8_t Bit(Subsystem sys)
+{
+  return static_cast<uint8_t>(1U << static_cast<uint8_t>(sys));
+}
+
+// Subsystems that must be ready before each one counts as ready (indexed by Subsystem)
+constexpr uint8_t kDependsOn[BootOrchestrator::kSubsystemCount] = {
+  /* CAN     */ 0U,
+  /* Display */ 0U,
+  /* Touch   */ Bit(Subsystem::LVGL),                        // indev needs an LVGL display
+  /* LVGL    */ Bit(Subsystem::Display),                     // flush target is the TFT
+  /* UI      */ Bit(Subsystem::LVGL) | Bit(Subsystem::Touch) // generated screens + input
+};
+
+constexpr const char* kSubsystemNames[BootOrchestrator::kSubsystemCount] = {
+  "CAN", "Display", "Touch", "LVGL", "UI"
+};
+
+// No subsystem may depend on itself (deeper cycles would also show up as never-ready)
+constexpr bool NoSelfDependency(std::size_t i = 0)
+{
+  return (i == BootOrchestrator::kSubsystemCount) ||
+         (((kDependsOn[i] >> i) & 1U) == 0U && NoSelfDependency(i + 1));
+}
+static_assert(NoSelfDependency(), "boot dependency table has a self-dependency");
+}
+
+BootOrchestrator::BootOrchestrator()
+{
+  portMUX_INITIALIZE(&mux_);
+  for (std::size_t i = 0; i < kSubsystemCount; ++i)
+  {
+    steps_[i].startUs = 0;
+    steps_[i].doneUs = 0;
+    steps_[i].state = StepState::Pending;
+  }
+}
+
+void BootOrchestrator::Begin(uint32_t nowUs)
+{
+  portENTER_CRITICAL(&mux_);
+  bootStartUs_ = nowUs;
+  portEXIT_CRITICAL(&mux_);
+}
+
+void BootOrchestrator::MarkStarted(Subsystem sys, uint32_t nowUs)
+{
+  const std::size_t idx = static_cast<std::size_t>(sys);
+  if (idx >= kSubsystemCount) return;
+  portENTER_CRITICAL(&mux_);
+  steps_[idx].startUs = nowUs;
+  steps_[idx].state = StepState::Running;
+  portEXIT_CRITICAL(&mux_);
+}
+
+void BootOrchestrator::MarkDone(Subsystem sys, bool ok, uint32_t nowUs)
+{
+  const std::size_t idx = static_cast<std::size_t>(sys);
+  if (idx >= kSubsystemCount) return;
+  portENTER_CRITICAL(&mux_);
+  steps_[idx].doneUs = nowUs;
+  steps_[idx].state = ok ? StepState::Ready : StepState::Failed;
+  portEXIT_CRITICAL(&mux_);
+}
+
+bool BootOrchestrator::IsReadyLocked_(std::size_t idx) const
+{
+  if (steps_[idx].state != StepState::Ready) return false;
+  for (std::size_t dep = 0; dep < kSubsystemCount; ++dep)
+  {
+    if (((kDependsOn[idx] >> dep) & 1U) != 0U && !IsReadyLocked_(dep)) return false;
+  }
+  return true;
+}
+
+bool BootOrchestrator::IsReady(Subsystem sys) const
+{
+  const std::size_t idx = static_cast<std::size_t>(sys);
+  if (idx >= kSubsystemCount) return false;
+  portENTER_CRITICAL(&mux_);
+  const bool ready = IsReadyLocked_(idx);
+  portEXIT_CRITICAL(&mux_);
+  return ready;
+}
+
+bool BootOrchestrator::AllReady() const
+{
+  bool ready = true;
+  portENTER_CRITICAL(&mux_);
+  for (std::size_t i = 0; i < kSubsystemCount && ready; ++i)
+  {
+    ready = IsReadyLocked_(i);
+  }
+  portEXIT_CRITICAL(&mux_);
+  return ready;
+}
+
+bool BootOrchestrator::AnyFailed() const
+{
+  bool failed = false;
+  portENTER_CRITICAL(&mux_);
+  for (std::size_t i = 0; i < kSubsystemCount; ++i)
+  {
+    if (steps_[i].state == StepState::Failed) failed = true;
+  }
+  portEXIT_CRITICAL(&mux_);
+  return failed;
+}
+
+bool BootOrchestrator::PrintProfileOnce()
+{
+  if (profilePrinted_ || !(AllReady() || AnyFailed()))
+  {
+    return false;
+  }
+  profilePrinted_ = true;
+
+  // Copy under the lock, print outside it
+  Step steps[kSubsystemCount];
+  uint32_t bootStartUs;
+  portENTER_CRITICAL(&mux_);
+  for (std::size_t i = 0; i < kSubsystemCount; ++i) steps[i] = steps_[i];
+  bootStartUs = bootStartUs_;
+  portEXIT_CRITICAL(&mux_);
+
+  uint32_t lastDoneUs = bootStartUs;
+  char line[96];
+  Serial.println("[BOOT] step       start(us)    done(us)    took(us)");
+  for (std::size_t i = 0; i < kSubsystemCount; ++i)
+  {
+    const Step& s = steps[i];
+    if (s.state == StepState::Pending)
+    {
+      snprintf(line, sizeof(line), "[BOOT] %-8s   not started", kSubsystemNames[i]);
+    }
+    else
+    {
+      const char* result = (s.state == StepState::Ready) ? "" : (s.state == StepState::Failed) ? " FAILED" : " running";
+      snprintf(line, sizeof(line), "[BOOT] %-8s %10lu  %10lu  %10lu%s", kSubsystemNames[i],
+               static_cast<unsigned long>(s.startUs - bootStartUs),
+               static_cast<unsigned long>(s.doneUs - bootStartUs),
+               static_cast<unsigned long>(s.doneUs - s.startUs), result);
+      if (s.state != StepState::Running && static_cast<int32_t>(s.doneUs - lastDoneUs) > 0)
+      {
+        lastDoneUs = s.doneUs;
+      }
+    }
+    Serial.println(line);
+  }
+  snprintf(line, sizeof(line), "[BOOT] %s after %lu us", AnyFailed() ? "failed" : "all ready",
+           static_cast<unsigned long>(lastDoneUs - bootStartUs));
+  Serial.println(line);
+  return true;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file BootOrchestrator.h
+ * @brief Readiness tracking and per-step timing for the concurrent RX boot.
+ *
+ * CAN comes up on the setup thread while display, LVGL, touch and the generated
+ * UI come up in the UI task. Each subsystem reports start/done times here; a
+ * static dependency table decides when a subsystem counts as ready, so state
+ * machine guards can ask whether a subsystem is usable yet. The boot profile is
+ * printed to Serial once everything has reported.
+ */
+#ifndef BOOT_ORCHESTRATOR_H
+#define BOOT_ORCHESTRATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "EventQueue.h"
+
+/**
+ * @class BootOrchestrator
+ * @brief Thread-safe boot step recorder with a subsystem dependency graph.
+ */
+class BootOrchestrator
+{
+public:
+  /** Number of Subsystem values (keep UI last in the enum). */
+  static constexpr std::size_t kSubsystemCount = static_cast<std::size_t>(Subsystem::UI) + 1;
+
+  BootOrchestrator();
+
+  /** Start the boot clock; all step times are reported relative to this. */
+  void Begin(uint32_t nowUs);
+  /** Record that a subsystem began initializing. Safe from any task. */
+  void MarkStarted(Subsystem sys, uint32_t nowUs);
+  /** Record the result of a subsystem's initialization. Safe from any task. */
+  void MarkDone(Subsystem sys, bool ok, uint32_t nowUs);
+
+  /** True when the subsystem and everything it depends on initialized successfully. */
+  bool IsReady(Subsystem sys) const;
+  /** True when every subsystem is ready. */
+  bool AllReady() const;
+  /** True when any subsystem reported a failure. */
+  bool AnyFailed() const;
+
+  /**
+   * @brief Print the per-step profile once boot finished (all ready or any failed).
+   * @return true if the profile was printed by this call.
+   */
+  bool PrintProfileOnce();
+
+private:
+  enum class StepState : uint8_t
+  {
+    Pending,
+    Running,
+    Ready,
+    Failed
+  };
+
+  struct Step
+  {
+    uint32_t startUs;
+    uint32_t doneUs;
+    StepState state;
+  };
+
+  bool IsReadyLocked_(std::size_t idx) const;
+
+  mutable portMUX_TYPE mux_;
+  uint32_t bootStartUs_ = 0;
+  Step steps_[kSubsystemCount];
+  bool profilePrinted_ = false;
+};
+
+#endif // BOOT_ORCHESTRATOR_H
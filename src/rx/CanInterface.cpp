@@ -1,7 +1,9 @@
 #include "CanInterface.h"
+#include "Clock.h"
 
 // Static member initialization
 EventQueue* CanInterface::eventQueuePtr_ = nullptr;
+TrafficSeq::Tracker CanInterface::fillerTracker_;
 
 CanInterface::CanInterface()
 {
@@ -30,6 +32,18 @@ bool CanInterface::Init(EventQueue& eventQueue)
     CAN0.setGeneralCallback(CanMsgHandler);
   }
 
+  // TX load scenario fillers 0x700-0x70F; without this filter they would be dropped
+  const int fillerMailbox = CAN0.watchForRange(TrafficSeq::kFillerBaseId,
+                                               TrafficSeq::kFillerBaseId + TrafficSeq::kFillerIdCount - 1U);
+  if (fillerMailbox >= 0)
+  {
+    CAN0.setCallback(static_cast<uint8_t>(fillerMailbox), CanMsgHandler);
+  }
+  else if (clusterMailbox >= 0)
+  {
+    CAN0.setGeneralCallback(CanMsgHandler);
+  }
+
   return true;
 }
 
@@ -40,6 +54,12 @@ void CanInterface::CanMsgHandler(CAN_FRAME* frame)
     return;
   }
 
+  if (!frame->extended && TrafficSeq::IsFillerId(frame->id))
+  {
+    OnFiller_(*frame);
+    return;
+  }
+
   // Validate frame ID, DLC, and IDE before parsing
   if ((frame->id != Cluster_CANID) || 
       (frame->length < Cluster_DLC) || 
@@ -52,7 +72,37 @@ void CanInterface::CanMsgHandler(CAN_FRAME* frame)
   Cluster_t cluster{};
   Unpack_Cluster_lecture(&cluster, frame->data.bytes, frame->length);
 
+  // The driver stamps the frame with micros() as soon as twai_receive() returns, before
+  // the hop through its callback queue to this task, so queueing delay stays out of the
+  // period and jitter figures. micros() is the esp_timer counter Clock reads, so HealthMonitor's
+  // deadlines and this stamp share a timebase; with a virtual clock installed the
+  // stamp comes from Clock instead.
+  const uint32_t rxTimestampUs = Clock::CaptureUs(frame->timestamp);
+
   // Push event to queue from ISR context
-  Event event = Event::MakeClusterFrame(cluster);
+  Event event = Event::MakeClusterFrame(cluster, rxTimestampUs);
   eventQueuePtr_->PushFromISR(event);
 }
+
+void CanInterface::OnFiller_(const CAN_FRAME& frame)
+{
+  uint32_t seq = 0;
+  if (!TrafficSeq::Decode(frame.data.bytes, frame.length, seq))
+  {
+    return;
+  }
+  fillerTracker_.OnSequence(seq);
+}
+
+void CanInterface::GetBusLoad(CAN_BUSLOAD_STATS& stats) const
+{
+  CAN0.getBusLoad(stats);
+}
+
+void CanInterface::GetFillerStats(FillerStats& stats) const
+{
+  stats.received = fillerTracker_.received;
+  stats.lost = fillerTracker_.lost;
+  stats.reordered = fillerTracker_.reordered;
+  stats.duplicates = fillerTracker_.duplicates;
+}
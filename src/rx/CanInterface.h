@@ -4,6 +4,10 @@
  *
  * Sets up filters and the ISR callback to receive frames, unpacks DBC Cluster and
  * forwards as EventQueue entries for task-level processing.
+ *
+ * TX load scenario filler frames (IDs 0x700-0x70F, see TrafficSeq.h) get their
+ * own filter and feed a TrafficSeq::Tracker, so the board reports loss and
+ * reordering of the filler stream while a scenario runs.
  */
 #ifndef CAN_INTERFACE_H
 #define CAN_INTERFACE_H
@@ -11,6 +15,7 @@
 #include <esp32_can.h>
 #include "lecture.h"
 #include "EventQueue.h"
+#include "common/TrafficSeq.h"
 
 /**
  * @class CanInterface
@@ -28,8 +33,25 @@ public:
   /** ISR entrypoint registered with the CAN driver. */
   static void CanMsgHandler(CAN_FRAME* frame);
 
+  /** Snapshot of the driver's bus load estimate (loads in 0.01 % units). */
+  void GetBusLoad(CAN_BUSLOAD_STATS& stats) const;
+
+  /** Filler stream counters (TrafficSeq::Tracker), exact within its 64-sequence window. */
+  struct FillerStats
+  {
+    uint32_t received;
+    uint32_t lost;
+    uint32_t reordered;
+    uint32_t duplicates;
+  };
+  /** Snapshot of the filler counters; each field is read atomically, not the set. */
+  void GetFillerStats(FillerStats& stats) const;
+
 private:
+  static void OnFiller_(const CAN_FRAME& frame);
+
   static EventQueue* eventQueuePtr_;
+  static TrafficSeq::Tracker fillerTracker_; // written only from the driver's RX callback
 };
 
 #endif // CAN_INTERFACE_H
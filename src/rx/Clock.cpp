@@ -0,0 +1,26 @@
+#include "Clock.h"
+#include "esp_timer.h"
+
+Clock::SourceFn Clock::source_ = &Clock::HardwareNowUs_;
+void* Clock::sourceCtx_ = nullptr;
+
+void Clock::SetSource(SourceFn fn, void* ctx)
+{
+  source_ = (fn != nullptr) ? fn : &Clock::HardwareNowUs_;
+  sourceCtx_ = (fn != nullptr) ? ctx : nullptr;
+}
+
+uint64_t Clock::NowUs64()
+{
+  return source_(sourceCtx_);
+}
+
+uint32_t Clock::CaptureUs(uint32_t driverStampUs)
+{
+  return (source_ == &Clock::HardwareNowUs_) ? driverStampUs : NowUs();
+}
+
+uint64_t Clock::HardwareNowUs_(void* /*ctx*/)
+{
+  return static_cast<uint64_t>(esp_timer_get_time());
+}
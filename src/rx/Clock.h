@@ -0,0 +1,58 @@
+/**
+ * @file Clock.h
+ * @brief Single injectable time source for all RX timing logic.
+ *
+ * HealthMonitor slots, IO blink cadence, UI blink phase, transition trace
+ * stamps, the LVGL tick and the TEST_HOOKS delays all read time through here
+ * instead of calling millis()/micros() directly. On target the source is the
+ * 64-bit esp_timer; host tests install a virtual clock and advance it from a
+ * discrete-event scheduler (test/harness), so hours of traffic run in
+ * milliseconds.
+ */
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <cstdint>
+
+/**
+ * @class Clock
+ * @brief Static time accessors backed by a replaceable microsecond source.
+ */
+class Clock
+{
+public:
+  /** Time source signature: monotonic microseconds since boot. */
+  using SourceFn = uint64_t(*)(void* ctx);
+
+  /**
+   * @brief Replace the time source.
+   * @param fn Source to call, or nullptr to restore the hardware timer.
+   * @param ctx Opaque pointer handed back to @p fn.
+   * @note Install before any task that reads the clock is started.
+   */
+  static void SetSource(SourceFn fn, void* ctx);
+
+  /** Full-width microseconds; never wraps in practice. */
+  static uint64_t NowUs64();
+  /** Microseconds truncated to 32 bits (same wrap behaviour as micros()). */
+  static uint32_t NowUs() { return static_cast<uint32_t>(NowUs64()); }
+  /** Milliseconds truncated to 32 bits (same wrap behaviour as millis()). */
+  static uint32_t NowMs() { return static_cast<uint32_t>(NowUs64() / 1000ULL); }
+
+  /**
+   * @brief Receive stamp for a frame captured by the CAN driver.
+   * @param driverStampUs The driver's capture stamp (micros(), i.e. the esp_timer
+   *        counter truncated to 32 bits, the same counter as NowUs()).
+   * @return @p driverStampUs with the hardware source; NowUs() when a test has
+   *         installed its own source, since the driver stamp is not on that timebase.
+   */
+  static uint32_t CaptureUs(uint32_t driverStampUs);
+
+private:
+  static uint64_t HardwareNowUs_(void* ctx);
+
+  static SourceFn source_;
+  static void* sourceCtx_;
+};
+
+#endif // CLOCK_H
@@ -0,0 +1,272 @@
+#include "DashboardView.h"
+
+DashboardView::DashboardView()
+  : arcAnimator_(GaugeAnimator::Config{UI_ARC_ANIM_FPS, UI_ARC_ANIM_TAU_MS})
+{
+}
+
+void DashboardView::Build()
+{
+  // Initialize UI widgets defaults (fresh widgets: the view model must not assume anything)
+  viewModel_.Reset();
+  viewModel_.SetLabelOpa(UiViewModel::Label::LeftTurn, ui_LeftTurnLabel, kOpacityOff);
+  viewModel_.SetLabelOpa(UiViewModel::Label::RightTurn, ui_RightTurnLabel, kOpacityOff);
+  viewModel_.SetArcValue(ui_Arc1, 0);
+  arcAnimator_.Jump(0);
+  arcInputPending_ = false;
+  SetArcSprite(UI_ARC_SPRITE != 0);
+
+  // Create overlays
+  degradedLabel_ = lv_label_create(lv_screen_active());
+  if (degradedLabel_ != nullptr)
+  {
+    lv_label_set_text(degradedLabel_, "STALE DATA");
+    lv_obj_set_style_text_color(degradedLabel_, lv_color_hex(0xFFFF00), LV_PART_MAIN);
+    lv_obj_set_style_text_font(degradedLabel_, &lv_font_montserrat_20, LV_PART_MAIN);
+    lv_obj_align(degradedLabel_, LV_ALIGN_TOP_MID, 0, 10);
+    lv_obj_add_flag(degradedLabel_, LV_OBJ_FLAG_HIDDEN);
+  }
+  faultLabel_ = lv_label_create(lv_screen_active());
+  if (faultLabel_ != nullptr)
+  {
+    lv_label_set_text(faultLabel_, "SYSTEM FAULT");
+    lv_obj_set_style_text_color(faultLabel_, lv_color_hex(0xFF0000), LV_PART_MAIN);
+    lv_obj_set_style_text_font(faultLabel_, &lv_font_montserrat_28, LV_PART_MAIN);
+    lv_obj_align(faultLabel_, LV_ALIGN_CENTER, 0, 0);
+    lv_obj_add_flag(faultLabel_, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+void DashboardView::ApplyData(const UiData& data, uint32_t nowMs)
+{
+  // Speed only moves the animation target; Animate() writes the arc
+  const int32_t speedArc = static_cast<int32_t>(data.speedArc);
+  if (speedArc != arcAnimator_.Target())
+  {
+    arcAnimator_.SetTarget(speedArc, nowMs);
+    arcInputUs_ = data.enqueueUs;
+    arcInputPending_ = true;
+    if (arcAnimator_.Settled())
+    {
+      WriteArc_(arcAnimator_.Value()); // animation disabled: value jumped
+    }
+  }
+
+  viewModel_.BeginInput(data.enqueueUs);
+
+  // If not active, ensure indicators are off immediately
+  if (!data.leftActive)
+  {
+    viewModel_.SetLabelOpa(UiViewModel::Label::LeftTurn, ui_LeftTurnLabel, kOpacityOff);
+  }
+  if (!data.rightActive)
+  {
+    viewModel_.SetLabelOpa(UiViewModel::Label::RightTurn, ui_RightTurnLabel, kOpacityOff);
+  }
+
+  viewModel_.EndInput();
+}
+
+void DashboardView::Animate(uint32_t nowMs)
+{
+  int32_t value;
+  if (arcAnimator_.Step(nowMs, value))
+  {
+    WriteArc_(value);
+  }
+}
+
+void DashboardView::FinishAnimations()
+{
+  arcAnimator_.Jump(arcAnimator_.Target());
+  WriteArc_(arcAnimator_.Value());
+}
+
+uint32_t DashboardView::MsToNextAnimation(uint32_t nowMs) const
+{
+  return arcAnimator_.MsToNextStep(nowMs);
+}
+
+void DashboardView::SetArcAnimation(const GaugeAnimator::Config& config)
+{
+  arcAnimator_.Configure(config);
+  if (arcAnimator_.Settled())
+  {
+    WriteArc_(arcAnimator_.Value());
+  }
+}
+
+bool DashboardView::SetArcSprite(bool enable)
+{
+  if (!enable)
+  {
+    arcSprite_.Detach();
+    return true;
+  }
+  return arcSprite_.Attach(ui_Arc1, UI_ARC_TICKS);
+}
+
+void DashboardView::WriteArc_(int32_t value)
+{
+  // The first frame after a new sample closes that sample's input-to-widget latency
+  if (arcInputPending_)
+  {
+    viewModel_.BeginInput(arcInputUs_);
+  }
+  viewModel_.SetArcValue(ui_Arc1, value);
+  if (arcInputPending_)
+  {
+    viewModel_.EndInput();
+    arcInputPending_ = false;
+  }
+}
+
+void DashboardView::UpdateBlink(const UiData& data, uint32_t nowMs)
+{
+  // Use a shared time-based phase so both indicators stay perfectly in sync
+  // when active at the same time, regardless of individual toggle history.
+  const bool phaseOn = ((nowMs / kBlinkPeriodMs_) % 2U) == 0U;
+
+  // Called every loop iteration; the view model only reaches LVGL on a phase edge.
+  viewModel_.SetLabelOpa(UiViewModel::Label::LeftTurn, ui_LeftTurnLabel,
+                         (data.leftActive && phaseOn) ? kOpacityOn : kOpacityOff);
+  viewModel_.SetLabelOpa(UiViewModel::Label::RightTurn, ui_RightTurnLabel,
+                         (data.rightActive && phaseOn) ? kOpacityOn : kOpacityOff);
+}
+
+uint32_t DashboardView::MsToBlinkEdge(const UiData& data, uint32_t nowMs) const
+{
+  if (!data.leftActive && !data.rightActive)
+  {
+    return UINT32_MAX;
+  }
+  return kBlinkPeriodMs_ - (nowMs % kBlinkPeriodMs_);
+}
+
+void DashboardView::HandleMessage(const UiMessage& msg)
+{
+  switch (msg.type)
+  {
+    case UiMessageType::ShowDashboard:
+      ShowDashboardScreen();
+      break;
+    case UiMessageType::ShowLog:
+      ShowLogScreen();
+      break;
+    case UiMessageType::AddLogLine:
+      AddLogLine(msg.text);
+      break;
+    case UiMessageType::ShowDegraded:
+      ShowDegraded();
+      break;
+    case UiMessageType::ShowFault:
+      ShowFault();
+      break;
+    case UiMessageType::ForceRedraw:
+      lv_obj_invalidate(lv_screen_active());
+      break;
+    default:
+      break;
+  }
+}
+
+void DashboardView::ShowDashboardScreen()
+{
+  // Load the main dashboard screen (Screen1)
+  if (ui_Screen1 != nullptr)
+  {
+    lv_disp_load_scr(ui_Screen1);
+  }
+}
+
+void DashboardView::ShowLogScreen()
+{
+  // Load the log screen (Screen2) and ensure LogBox shows current lines
+  if (ui_Screen2 != nullptr)
+  {
+    lv_disp_load_scr(ui_Screen2);
+    UpdateLogBox_();
+  }
+}
+
+void DashboardView::ShowDegraded()
+{
+  if (degradedLabel_ != nullptr)
+  {
+    lv_obj_clear_flag(degradedLabel_, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+void DashboardView::HideDegraded()
+{
+  if (degradedLabel_ != nullptr)
+  {
+    lv_obj_add_flag(degradedLabel_, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+void DashboardView::ShowFault()
+{
+  if (faultLabel_ != nullptr)
+  {
+    lv_obj_clear_flag(faultLabel_, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+void DashboardView::AddLogLine(const char* line)
+{
+  LogRing::Change change;
+  if (!logRing_.Append(line, change)) return;
+
+  if (ui_LogBox == nullptr) return;
+  if (ui_LogBox != syncedLogBox_)
+  {
+    // LogBox (re)created since the last sync: one full rebuild, incremental afterwards
+    UpdateLogBox_();
+    return;
+  }
+
+  // Incremental update: drop evicted lines from the head, append the new one at the tail
+  if (change.cutHeadChars != 0U)
+  {
+    lv_label_cut_text(logLabel_, 0, change.cutHeadChars);
+  }
+  if (change.separator)
+  {
+    lv_label_ins_text(logLabel_, LV_LABEL_POS_LAST, "\n");
+  }
+  lv_label_ins_text(logLabel_, LV_LABEL_POS_LAST, change.text);
+  ScrollLogToEnd_();
+}
+
+void DashboardView::UpdateLogBox_()
+{
+  if (ui_LogBox == nullptr || ui_LogBox == syncedLogBox_) return;
+
+  // SquareLine generates LogBox as a textarea. The log is read-only, so the textarea only
+  // marks the spot: it is hidden and a scrollable box with a plain label takes its place,
+  // which lv_label_cut_text()/lv_label_ins_text() edit by character index. Both are
+  // children of the generated container and go away with the screen.
+  lv_obj_add_flag(ui_LogBox, LV_OBJ_FLAG_HIDDEN);
+  logView_ = lv_obj_create(lv_obj_get_parent(ui_LogBox));
+  lv_obj_set_size(logView_, lv_pct(100), lv_pct(100));
+  lv_obj_set_align(logView_, LV_ALIGN_CENTER);
+  lv_obj_set_scroll_dir(logView_, LV_DIR_VER);
+  logLabel_ = lv_label_create(logView_);
+  lv_obj_set_width(logLabel_, lv_pct(100));
+  lv_label_set_long_mode(logLabel_, LV_LABEL_LONG_WRAP);
+
+  // Full rebuild, only needed when the LogBox widget is new to us
+  char text[LogRing::kArenaBytes];
+  logRing_.CopyText(text, sizeof(text));
+  lv_label_set_text(logLabel_, text);
+  syncedLogBox_ = ui_LogBox;
+  ScrollLogToEnd_();
+}
+
+void DashboardView::ScrollLogToEnd_()
+{
+  // Newest line at the bottom, like the textarea's cursor-follow did
+  lv_obj_update_layout(logView_);
+  lv_obj_scroll_to_y(logView_, LV_COORD_MAX, LV_ANIM_OFF);
+}
@@ -0,0 +1,173 @@
+/**
+ * @file DashboardView.h
+ * @brief Hardware-independent presentation layer on top of the SquareLine screens.
+ *
+ * Turns UiData samples and UiMessage commands into LVGL widget state: arc and
+ * indicator updates through UiViewModel, the shared blink phase, the log ring
+ * and the STALE DATA / SYSTEM FAULT overlays. It depends only on LVGL and the
+ * generated UI (no FreeRTOS queues, no TFT), so the UI task on the board and
+ * the host render benchmark (`env:ui_bench`) drive the same code.
+ *
+ * The speed arc is animated: ApplyData() only moves the target and Animate()
+ * steps a GaugeAnimator toward it at a capped frame rate, so the needle moves
+ * smoothly whatever the CAN update rate. lv_arc_set_value() invalidates just
+ * the swept segment, which keeps each animation frame to the arc region.
+ * With UI_ARC_SPRITE the arc's static background comes from a GaugeSprite
+ * cache, so those frames only blit cached pixels and draw the indicator.
+ */
+#ifndef DASHBOARD_VIEW_H
+#define DASHBOARD_VIEW_H
+
+#include <cstdint>
+#include <cstring>
+#include <lvgl.h>
+#include "ui.h"
+#include "UiViewModel.h"
+#include "LogRing.h"
+#include "GaugeAnimator.h"
+#include "GaugeSprite.h"
+
+// Speed arc animation defaults (override with -D); UI_ARC_ANIM_FPS=0 makes the arc jump
+#ifndef UI_ARC_ANIM_FPS
+#define UI_ARC_ANIM_FPS 30
+#endif
+#ifndef UI_ARC_ANIM_TAU_MS
+#define UI_ARC_ANIM_TAU_MS 80
+#endif
+
+// 1: draw the speed arc background from a pre-rendered RGB565 cache (see GaugeSprite.h)
+#ifndef UI_ARC_SPRITE
+#define UI_ARC_SPRITE 1
+#endif
+// Tick marks baked into the cached arc background (0: none, as in the SquareLine design)
+#ifndef UI_ARC_TICKS
+#define UI_ARC_TICKS 0
+#endif
+
+// Lightweight data payload for UI updates (overwrite-queue semantics)
+/**
+ * @struct UiData
+ * @brief Current dashboard state mapped for LVGL widgets.
+ */
+struct UiData
+{
+  uint16_t speedArc;   // 0..240 mapped arc value
+  bool leftActive;     // left turn signal active
+  bool rightActive;    // right turn signal active
+  uint32_t enqueueUs;  // Clock::NowUs() when queued (set by EnqueueUiData)
+};
+
+/** UI message command types. */
+enum class UiMessageType : uint8_t
+{
+  ShowDashboard,
+  ShowLog,
+  AddLogLine,
+  ShowDegraded,
+  ShowFault,
+  ForceRedraw  // invalidate the whole active screen and print the frame timing
+};
+
+/**
+ * @struct UiMessage
+ * @brief UI command with optional text payload (for logs).
+ */
+struct UiMessage
+{
+  UiMessageType type;
+  char text[96]; // for AddLogLine
+
+  static UiMessage MakeShowDashboard() { return UiMessage{UiMessageType::ShowDashboard, {0}}; }
+  static UiMessage MakeShowLog() { return UiMessage{UiMessageType::ShowLog, {0}}; }
+  static UiMessage MakeShowDegraded() { return UiMessage{UiMessageType::ShowDegraded, {0}}; }
+  static UiMessage MakeShowFault() { return UiMessage{UiMessageType::ShowFault, {0}}; }
+  static UiMessage MakeForceRedraw() { return UiMessage{UiMessageType::ForceRedraw, {0}}; }
+  static UiMessage MakeAddLog(const char* s)
+  {
+    UiMessage m{UiMessageType::AddLogLine, {0}};
+    if (s)
+    {
+      strncpy(m.text, s, sizeof(m.text) - 1);
+      m.text[sizeof(m.text) - 1] = '\0';
+    }
+    return m;
+  }
+};
+
+/**
+ * @class DashboardView
+ * @brief Applies dashboard data and UI commands to the generated screens.
+ *
+ * Single-threaded: call only from the thread that runs lv_timer_handler().
+ */
+class DashboardView
+{
+public:
+  DashboardView();
+
+  /** Apply widget defaults and create the overlays; call once after ui_init(). */
+  void Build();
+
+  /** Apply a data sample (arc target, indicators forced off when inactive). */
+  void ApplyData(const UiData& data, uint32_t nowMs);
+  /** Step widget animations due at @p nowMs; call every loop iteration. */
+  void Animate(uint32_t nowMs);
+  /** Jump animated widgets to their targets (for callers without an animation loop). */
+  void FinishAnimations();
+  /** Milliseconds until Animate() has work, or UINT32_MAX when everything is settled. */
+  uint32_t MsToNextAnimation(uint32_t nowMs) const;
+  /** Replace the speed arc animation settings. */
+  void SetArcAnimation(const GaugeAnimator::Config& config);
+  /**
+   * @brief Switch the speed arc between cached and live background drawing.
+   * @return true if the requested mode is active (enabling can fail, see GaugeSprite).
+   */
+  bool SetArcSprite(bool enable);
+  const GaugeSprite& ArcSprite() const { return arcSprite_; }
+  /** Set indicator opacity from the shared blink phase at @p nowMs. */
+  void UpdateBlink(const UiData& data, uint32_t nowMs);
+  /** Milliseconds until the next blink phase edge, or UINT32_MAX if no indicator is active. */
+  uint32_t MsToBlinkEdge(const UiData& data, uint32_t nowMs) const;
+
+  /** Execute a UI command (ForceRedraw invalidates the active screen). */
+  void HandleMessage(const UiMessage& msg);
+
+  void ShowDashboardScreen();  // Loads Screen1 (dashboard)
+  void ShowLogScreen();        // Loads Screen2 (LogBox)
+  void ShowDegraded();
+  void HideDegraded();
+  void ShowFault();
+  void AddLogLine(const char* line);
+
+  /** Widget diff layer and render counters. */
+  UiViewModel& Model() { return viewModel_; }
+  const UiViewModel& Model() const { return viewModel_; }
+
+private:
+  void UpdateLogBox_();
+  void ScrollLogToEnd_();
+  void WriteArc_(int32_t value);
+
+  static constexpr uint8_t kOpacityOn = 255U;
+  static constexpr uint8_t kOpacityOff = 0U;
+  static constexpr uint32_t kBlinkPeriodMs_ = 500;
+
+  // Last applied widget state; all dashboard widget writes go through here
+  UiViewModel viewModel_;
+
+  GaugeAnimator arcAnimator_;
+  uint32_t arcInputUs_ = 0;        // enqueue time of the sample that set the current arc target
+  bool arcInputPending_ = false;   // latency not yet recorded for that sample
+  GaugeSprite arcSprite_;
+
+  lv_obj_t* degradedLabel_ = nullptr;
+  lv_obj_t* faultLabel_ = nullptr;
+
+  // Last N log lines displayed in Screen2 LogBox (fixed arena, no heap use)
+  LogRing logRing_;
+  lv_obj_t* syncedLogBox_ = nullptr; // generated LogBox instance the widgets below replace
+  lv_obj_t* logView_ = nullptr;      // scrollable box in LogBox's place
+  lv_obj_t* logLabel_ = nullptr;     // its text mirrors logRing_
+};
+
+#endif // DASHBOARD_VIEW_H
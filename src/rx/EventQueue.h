@@ -13,13 +13,14 @@
 #include "freertos/queue.h"
 #include "lecture.h"
 
-/** High-level event categories transported through EventQueue. */
+/** High-level event categories transported through EventQueue (keep Error last; see SystemController). */
 enum class EventType : uint8_t
 {
   InitOk,
   InitFail,
   ClusterFrame,
   FrameTimeout,
+  FrameRecovered,
   Error
 };
 
@@ -40,13 +41,14 @@ enum class Subsystem : uint8_t
 struct Event
 {
   EventType type;
+  uint32_t rxTimestampUs;      // Receive time for ClusterFrame (Clock::NowUs() timebase), 0 otherwise
   union {
     Subsystem subsystem;       // For InitOk/InitFail/Error
     Cluster_t clusterData;     // For ClusterFrame
     uint32_t errorCode;        // For Error
   } payload;
 
-  Event() : type(EventType::InitOk) { payload.subsystem = Subsystem::CAN; }
+  Event() : type(EventType::InitOk), rxTimestampUs(0) { payload.subsystem = Subsystem::CAN; }
   
   static Event MakeInitOk(Subsystem sys)
   {
@@ -64,10 +66,11 @@ struct Event
     return e;
   }
 
-  static Event MakeClusterFrame(const Cluster_t& cluster)
+  static Event MakeClusterFrame(const Cluster_t& cluster, uint32_t rxTimestampUs = 0)
   {
     Event e;
     e.type = EventType::ClusterFrame;
+    e.rxTimestampUs = rxTimestampUs;
     e.payload.clusterData = cluster;
     return e;
   }
@@ -79,6 +82,13 @@ struct Event
     return e;
   }
 
+  static Event MakeFrameRecovered()
+  {
+    Event e;
+    e.type = EventType::FrameRecovered;
+    return e;
+  }
+
   static Event MakeError(uint32_t code)
   {
     Event e;
@@ -0,0 +1,139 @@
+#include "GaugeAnimator.h"
+
+namespace
+{
+constexpr int64_t kOne = static_cast<int64_t>(1) << 16;
+// Settled once within a quarter unit of the target and slower than 2 units/s
+constexpr int64_t kSettlePos = kOne / 4;
+constexpr int64_t kSettleVel = 2 * kOne / 1000;
+
+int64_t Abs64(int64_t v)
+{
+  return (v < 0) ? -v : v;
+}
+
+int32_t RoundQ16(int64_t q)
+{
+  return static_cast<int32_t>((q + (kOne / 2)) >> 16);
+}
+
+// exp(-1/tauMs) in Q2.30 from its Taylor series; the argument is at most 1, so 14 terms
+// are well below one LSB
+int64_t DecayPerMsQ30(uint32_t tauMs)
+{
+  int64_t term = static_cast<int64_t>(1) << 30;
+  int64_t sum = term;
+  for (int64_t n = 1; n <= 14; ++n)
+  {
+    term = -term / (static_cast<int64_t>(tauMs) * n);
+    sum += term;
+  }
+  return sum;
+}
+}
+
+GaugeAnimator::GaugeAnimator(const Config& config)
+  : config_(config)
+{
+  Configure(config);
+}
+
+void GaugeAnimator::Configure(const Config& config)
+{
+  config_ = config;
+  uint32_t tauMs = config.timeConstantMs;
+  if (tauMs < kMinTimeConstantMs_) tauMs = kMinTimeConstantMs_;
+  if (tauMs > kMaxTimeConstantMs_) tauMs = kMaxTimeConstantMs_;
+
+  // Critically damped spring e'' = -w^2 e - 2 w e' with e = value - target. With
+  // k = w * 1 ms = 1/tauMs and a = exp(-k), one millisecond maps (e, v) exactly to
+  //   e' = a (1 + k) e + a v
+  //   v' = -a k^2 e + a (1 - k) v       (v in value/ms)
+  const int64_t a = DecayPerMsQ30(tauMs);
+  const int64_t t = static_cast<int64_t>(tauMs);
+  errFromErrQ_ = a + a / t;
+  errFromVelQ_ = a;
+  velFromErrQ_ = -(a / t) / t;
+  velFromVelQ_ = a - a / t;
+  if (config_.maxFps == 0)
+  {
+    Jump(Target());
+  }
+}
+
+uint32_t GaugeAnimator::FrameMs_() const
+{
+  return (config_.maxFps == 0) ? 0U : (1000U + config_.maxFps - 1U) / config_.maxFps;
+}
+
+void GaugeAnimator::Jump(int32_t value)
+{
+  targetQ_ = static_cast<int64_t>(value) * kOne;
+  posQ_ = targetQ_;
+  velQ_ = 0;
+  output_ = value;
+  running_ = false;
+}
+
+void GaugeAnimator::SetTarget(int32_t target, uint32_t nowMs)
+{
+  const int64_t targetQ = static_cast<int64_t>(target) * kOne;
+  if (config_.maxFps == 0)
+  {
+    Jump(target);
+    return;
+  }
+  if (targetQ == targetQ_ && !running_ && output_ == target)
+  {
+    return;
+  }
+  targetQ_ = targetQ;
+  if (!running_)
+  {
+    running_ = true;
+    lastStepMs_ = nowMs - FrameMs_(); // first step is due immediately
+  }
+}
+
+bool GaugeAnimator::Step(uint32_t nowMs, int32_t& value)
+{
+  if (!running_) return false;
+  uint32_t elapsedMs = nowMs - lastStepMs_;
+  if (elapsedMs < FrameMs_()) return false;
+  lastStepMs_ = nowMs;
+  // After a long stall, replay a bounded gap rather than spinning through all of it
+  if (elapsedMs > kMaxCatchUpMs_) elapsedMs = kMaxCatchUpMs_;
+
+  // Exact update, so no step size can make it overshoot or diverge
+  int64_t errQ = posQ_ - targetQ_;
+  int64_t velQ = velQ_;
+  for (uint32_t ms = 0; ms < elapsedMs; ++ms)
+  {
+    const int64_t nextErrQ = (errFromErrQ_ * errQ + errFromVelQ_ * velQ) >> kCoefBits_;
+    velQ = (velFromErrQ_ * errQ + velFromVelQ_ * velQ) >> kCoefBits_;
+    errQ = nextErrQ;
+  }
+  posQ_ = targetQ_ + errQ;
+  velQ_ = velQ;
+
+  if (Abs64(targetQ_ - posQ_) < kSettlePos && Abs64(velQ_) < kSettleVel)
+  {
+    posQ_ = targetQ_;
+    velQ_ = 0;
+    running_ = false;
+  }
+
+  const int32_t out = RoundQ16(posQ_);
+  if (out == output_) return false;
+  output_ = out;
+  value = out;
+  return true;
+}
+
+uint32_t GaugeAnimator::MsToNextStep(uint32_t nowMs) const
+{
+  if (!running_) return UINT32_MAX;
+  const uint32_t elapsedMs = nowMs - lastStepMs_;
+  const uint32_t frameMs = FrameMs_();
+  return (elapsedMs >= frameMs) ? 0U : (frameMs - elapsedMs);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file GaugeAnimator.h
+ * @brief Fixed-point, critically damped follower for gauge widget values.
+ *
+ * Data samples only move the target; the displayed value follows it as a
+ * critically damped spring (no overshoot, settles in about 5 time constants)
+ * stepped at most maxFps times per second. Smoothness no longer depends on the
+ * CAN rate, and a fast bus cannot cause more than maxFps widget updates.
+ *
+ * Each frame applies the exact solution of the spring over the elapsed time,
+ * one millisecond at a time, so the follower is stable for every time
+ * constant and frame rate (explicit integration diverges once a step gets
+ * longer than about twice the time constant).
+ */
+#ifndef GAUGE_ANIMATOR_H
+#define GAUGE_ANIMATOR_H
+
+#include <cstdint>
+
+/**
+ * @class GaugeAnimator
+ * @brief Integer-in/integer-out animator for one widget value (Q16.16 inside).
+ */
+class GaugeAnimator
+{
+public:
+  /** Per-widget animation settings. */
+  struct Config
+  {
+    uint16_t maxFps;          // step rate cap; 0 disables animation (values jump)
+    uint16_t timeConstantMs;  // spring time constant 1/omega, clamped to 1..2000 ms; larger is smoother
+  };
+
+  explicit GaugeAnimator(const Config& config);
+
+  /** Change settings; an animation in progress continues with the new ones. */
+  void Configure(const Config& config);
+  const Config& GetConfig() const { return config_; }
+
+  /** Move the target (|value| <= 32767); animation starts, or the value jumps when disabled. */
+  void SetTarget(int32_t target, uint32_t nowMs);
+  /** Place value and target at @p value with no motion. */
+  void Jump(int32_t value);
+
+  /**
+   * @brief Advance the animation to @p nowMs if a frame is due.
+   * @param value Receives the new output when the function returns true.
+   * @return true if the integer output changed.
+   */
+  bool Step(uint32_t nowMs, int32_t& value);
+
+  /** Milliseconds until Step() has work, or UINT32_MAX when settled. */
+  uint32_t MsToNextStep(uint32_t nowMs) const;
+
+  /** Current integer output. */
+  int32_t Value() const { return output_; }
+  /** Target set by the last SetTarget()/Jump(). */
+  int32_t Target() const { return static_cast<int32_t>(targetQ_ >> kFracBits); }
+  /** True when the value rests at the target. */
+  bool Settled() const { return !running_; }
+
+private:
+  static constexpr int kFracBits = 16;
+  static constexpr int kCoefBits_ = 30;
+  // 1 ms resolution bounds tau from below; the Q2.30 spring term k^2 from above
+  static constexpr uint32_t kMinTimeConstantMs_ = 1;
+  static constexpr uint32_t kMaxTimeConstantMs_ = 2000;
+  static constexpr uint32_t kMaxCatchUpMs_ = 200; // longest gap replayed after a stall
+
+  uint32_t FrameMs_() const;
+
+  Config config_;
+  // Exact 1 ms transition of (error, velocity) for the configured tau, Q2.30
+  int64_t errFromErrQ_ = 0;
+  int64_t errFromVelQ_ = 0;
+  int64_t velFromErrQ_ = 0;
+  int64_t velFromVelQ_ = 0;
+  int64_t posQ_ = 0;     // value, Q16.16
+  int64_t velQ_ = 0;     // value/ms, Q16.16
+  int64_t targetQ_ = 0;
+  int32_t output_ = 0;
+  uint32_t lastStepMs_ = 0;
+  bool running_ = false;
+};
+
+#endif // GAUGE_ANIMATOR_H
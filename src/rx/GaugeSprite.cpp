@@ -0,0 +1,270 @@
+#include "GaugeSprite.h"
+#include <cstring>
+#include <esp_heap_caps.h>
+
+namespace
+{
+constexpr lv_style_prop_t kOverrideProps[] = {
+  LV_STYLE_ARC_OPA,      // background arc comes from the cache
+  LV_STYLE_BG_OPA,       // so do the widget's own background ...
+  LV_STYLE_BORDER_OPA,   // ... and border
+  LV_STYLE_RADIUS,       // cache is a plain rectangle
+  LV_STYLE_BG_IMAGE_SRC,
+  LV_STYLE_BG_IMAGE_OPA
+};
+
+constexpr int32_t kTickLength = 8;
+constexpr int32_t kTickGap = 3;   // between the background arc and the ticks
+constexpr int32_t kTickWidth = 2;
+
+// True if a visible child of @p parent below index @p endIdx overlaps @p area
+bool LowerSiblingOverlaps(lv_obj_t* parent, int32_t endIdx, const lv_area_t& area)
+{
+  for (int32_t i = 0; i < endIdx; ++i)
+  {
+    lv_obj_t* sibling = lv_obj_get_child(parent, i);
+    if (sibling == nullptr || lv_obj_has_flag(sibling, LV_OBJ_FLAG_HIDDEN)) continue;
+    lv_area_t coords;
+    lv_obj_get_coords(sibling, &coords);
+    if (lv_area_is_on(&coords, &area)) return true;
+  }
+  return false;
+}
+}
+
+static_assert(sizeof(kOverrideProps) / sizeof(kOverrideProps[0]) == 6, "update kOverrideCount_");
+
+GaugeSprite::GaugeSprite()
+{
+  memset(saved_, 0, sizeof(saved_));
+  memset(&buf_, 0, sizeof(buf_));
+}
+
+GaugeSprite::~GaugeSprite()
+{
+  Detach();
+  heap_caps_free(pixels_);
+}
+
+bool GaugeSprite::Reserve_(uint32_t bytes)
+{
+  if (bytes <= capacity_) return true;
+  heap_caps_free(pixels_);
+  capacity_ = 0;
+  // PSRAM when fitted; the blit is one sequential read per refresh, so its speed is fine
+  pixels_ = static_cast<uint8_t*>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+  if (pixels_ == nullptr)
+  {
+    pixels_ = static_cast<uint8_t*>(heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+  }
+  if (pixels_ == nullptr) return false;
+  capacity_ = bytes;
+  return true;
+}
+
+bool GaugeSprite::Attach(lv_obj_t* arc, uint8_t ticks)
+{
+  Detach();
+  failReason_ = nullptr;
+  if (arc == nullptr || !lv_obj_check_type(arc, &lv_arc_class))
+  {
+    failReason_ = "not an arc";
+    return false;
+  }
+
+  lv_obj_update_layout(arc);
+  const int32_t w = lv_obj_get_width(arc);
+  const int32_t h = lv_obj_get_height(arc);
+  if (w <= 0 || h <= 0 || static_cast<uint32_t>(w) * static_cast<uint32_t>(h) > UI_ARC_SPRITE_MAX_PIXELS)
+  {
+    failReason_ = "arc larger than UI_ARC_SPRITE_MAX_PIXELS";
+    return false;
+  }
+  if (lv_obj_get_style_outline_width(arc, LV_PART_MAIN) != 0 || lv_obj_get_style_shadow_width(arc, LV_PART_MAIN) != 0)
+  {
+    failReason_ = "arc has outline or shadow";
+    return false;
+  }
+
+  lv_color_t backdrop;
+  if (!FindBackdrop_(arc, backdrop))
+  {
+    return false;
+  }
+
+  const uint32_t stride = lv_draw_buf_width_to_stride(static_cast<uint32_t>(w), LV_COLOR_FORMAT_RGB565);
+  if (!Reserve_(stride * static_cast<uint32_t>(h)))
+  {
+    failReason_ = "no memory for the cache";
+    return false;
+  }
+  if (lv_draw_buf_init(&buf_, static_cast<uint32_t>(w), static_cast<uint32_t>(h), LV_COLOR_FORMAT_RGB565, stride,
+                       pixels_, capacity_) != LV_RESULT_OK)
+  {
+    failReason_ = "draw buffer init failed";
+    return false;
+  }
+  Render_(arc, backdrop, ticks);
+  lv_image_cache_drop(&buf_);
+
+  for (uint8_t i = 0; i < kOverrideCount_; ++i)
+  {
+    saved_[i].local = (lv_obj_get_local_style_prop(arc, kOverrideProps[i], &saved_[i].value, LV_PART_MAIN) ==
+                       LV_STYLE_RES_FOUND);
+  }
+  lv_obj_set_style_arc_opa(arc, LV_OPA_TRANSP, LV_PART_MAIN);
+  lv_obj_set_style_bg_opa(arc, LV_OPA_TRANSP, LV_PART_MAIN);
+  lv_obj_set_style_border_opa(arc, LV_OPA_TRANSP, LV_PART_MAIN);
+  lv_obj_set_style_radius(arc, 0, LV_PART_MAIN);
+  lv_obj_set_style_bg_image_src(arc, &buf_, LV_PART_MAIN);
+  lv_obj_set_style_bg_image_opa(arc, LV_OPA_COVER, LV_PART_MAIN);
+  arc_ = arc;
+  return true;
+}
+
+void GaugeSprite::Detach()
+{
+  if (arc_ == nullptr) return;
+  for (uint8_t i = 0; i < kOverrideCount_; ++i)
+  {
+    if (saved_[i].local)
+    {
+      lv_obj_set_local_style_prop(arc_, kOverrideProps[i], saved_[i].value, LV_PART_MAIN);
+    }
+    else
+    {
+      lv_obj_remove_local_style_prop(arc_, kOverrideProps[i], LV_PART_MAIN);
+    }
+  }
+  lv_image_cache_drop(&buf_);
+  arc_ = nullptr;
+}
+
+bool GaugeSprite::FindBackdrop_(lv_obj_t* arc, lv_color_t& color)
+{
+  lv_area_t area;
+  lv_obj_get_coords(arc, &area);
+
+  // Walk up until an opaque background; everything passed must be see-through
+  lv_obj_t* child = arc;
+  for (lv_obj_t* obj = lv_obj_get_parent(arc); obj != nullptr; child = obj, obj = lv_obj_get_parent(obj))
+  {
+    if (LowerSiblingOverlaps(obj, lv_obj_get_index(child), area))
+    {
+      failReason_ = "another widget is drawn below the arc";
+      return false;
+    }
+    if (lv_obj_get_style_border_opa(obj, LV_PART_MAIN) != LV_OPA_TRANSP &&
+        lv_obj_get_style_border_width(obj, LV_PART_MAIN) > 0)
+    {
+      lv_area_t inner;
+      lv_obj_get_coords(obj, &inner);
+      lv_area_increase(&inner, -lv_obj_get_style_border_width(obj, LV_PART_MAIN),
+                       -lv_obj_get_style_border_width(obj, LV_PART_MAIN));
+      if (!lv_area_is_in(&area, &inner, lv_obj_get_style_radius(obj, LV_PART_MAIN)))
+      {
+        failReason_ = "a parent border crosses the arc";
+        return false;
+      }
+    }
+    if (lv_obj_get_style_bg_image_src(obj, LV_PART_MAIN) != nullptr ||
+        lv_obj_get_style_bg_grad_dir(obj, LV_PART_MAIN) != LV_GRAD_DIR_NONE)
+    {
+      failReason_ = "backdrop is not a solid color";
+      return false;
+    }
+    const lv_opa_t opa = lv_obj_get_style_bg_opa(obj, LV_PART_MAIN);
+    if (opa >= LV_OPA_MAX)
+    {
+      color = lv_obj_get_style_bg_color(obj, LV_PART_MAIN);
+      return true;
+    }
+    if (opa > LV_OPA_MIN)
+    {
+      failReason_ = "backdrop is semi-transparent";
+      return false;
+    }
+  }
+  failReason_ = "no opaque backdrop";
+  return false;
+}
+
+void GaugeSprite::Render_(lv_obj_t* arc, lv_color_t backdrop, uint8_t ticks)
+{
+  lv_area_t coords;
+  lv_obj_get_coords(arc, &coords);
+
+  // Layer over the buffer in screen coordinates, as lv_canvas_init_layer() does
+  lv_layer_t layer;
+  memset(&layer, 0, sizeof(layer));
+  layer.draw_buf = &buf_;
+  layer.color_format = LV_COLOR_FORMAT_RGB565;
+  layer.buf_area = coords;
+  layer._clip_area = coords;
+
+  lv_draw_rect_dsc_t fill;
+  lv_draw_rect_dsc_init(&fill);
+  fill.bg_color = backdrop;
+  fill.bg_opa = LV_OPA_COVER;
+  lv_draw_rect(&layer, &fill, &coords);
+
+  // The widget's own background/border, then the background arc exactly as lv_arc draws it
+  lv_draw_rect_dsc_t rect;
+  lv_draw_rect_dsc_init(&rect);
+  lv_obj_init_draw_rect_dsc(arc, LV_PART_MAIN, &rect);
+  lv_draw_rect(&layer, &rect, &coords);
+
+  const int32_t padLeft = lv_obj_get_style_pad_left(arc, LV_PART_MAIN);
+  const int32_t padTop = lv_obj_get_style_pad_top(arc, LV_PART_MAIN);
+  const int32_t contentW = lv_obj_get_width(arc) - padLeft - lv_obj_get_style_pad_right(arc, LV_PART_MAIN);
+  const int32_t contentH = lv_obj_get_height(arc) - padTop - lv_obj_get_style_pad_bottom(arc, LV_PART_MAIN);
+  const int32_t radius = ((contentW < contentH) ? contentW : contentH) / 2;
+  const int32_t cx = coords.x1 + radius + padLeft;
+  const int32_t cy = coords.y1 + radius + padTop;
+  const int32_t rotation = static_cast<int32_t>(lv_arc_get_rotation(arc));
+  const int32_t startAngle = static_cast<int32_t>(lv_arc_get_bg_angle_start(arc)) + rotation;
+  int32_t endAngle = static_cast<int32_t>(lv_arc_get_bg_angle_end(arc)) + rotation;
+
+  lv_draw_arc_dsc_t arcDsc;
+  lv_draw_arc_dsc_init(&arcDsc);
+  lv_obj_init_draw_arc_dsc(arc, LV_PART_MAIN, &arcDsc);
+  if (radius > 0)
+  {
+    arcDsc.center.x = cx;
+    arcDsc.center.y = cy;
+    arcDsc.start_angle = startAngle;
+    arcDsc.end_angle = endAngle;
+    arcDsc.radius = static_cast<uint16_t>(radius);
+    lv_draw_arc(&layer, &arcDsc);
+  }
+
+  // Tick marks evenly spaced along the inside of the background arc
+  const int32_t tickOuter = radius - arcDsc.width - kTickGap;
+  if (ticks >= 2U && tickOuter > kTickLength)
+  {
+    if (endAngle <= startAngle) endAngle += 360;
+    lv_draw_line_dsc_t line;
+    lv_draw_line_dsc_init(&line);
+    line.color = arcDsc.color;
+    line.opa = arcDsc.opa;
+    line.width = kTickWidth;
+    for (uint8_t i = 0; i < ticks; ++i)
+    {
+      const int32_t angle = startAngle + ((endAngle - startAngle) * i) / static_cast<int32_t>(ticks - 1U);
+      const int32_t sinA = lv_trigo_sin(static_cast<int16_t>(angle % 360));
+      const int32_t cosA = lv_trigo_cos(static_cast<int16_t>(angle % 360));
+      line.p1.x = cx + ((tickOuter * cosA) >> LV_TRIGO_SHIFT);
+      line.p1.y = cy + ((tickOuter * sinA) >> LV_TRIGO_SHIFT);
+      line.p2.x = cx + (((tickOuter - kTickLength) * cosA) >> LV_TRIGO_SHIFT);
+      line.p2.y = cy + (((tickOuter - kTickLength) * sinA) >> LV_TRIGO_SHIFT);
+      lv_draw_line(&layer, &line);
+    }
+  }
+
+  // Run the queued draw tasks into the buffer now (same loop as lv_canvas_finish_layer())
+  while (layer.draw_task_head != nullptr)
+  {
+    lv_draw_dispatch_wait_for_request();
+    lv_draw_dispatch_layer(lv_obj_get_display(arc), &layer);
+  }
+}
@@ -0,0 +1,80 @@
+/**
+ * @file GaugeSprite.h
+ * @brief Pre-rendered background for an lv_arc gauge.
+ *
+ * Every arc update redraws the swept area: parent background, the anti-aliased
+ * background arc, the indicator and the knob. The background arc never changes,
+ * so it is rasterized once (together with the backdrop behind it and optional
+ * tick marks) into an RGB565 buffer that the arc then shows as its bg image.
+ * Per update LVGL only blits the cached pixels and draws the indicator sweep.
+ *
+ * The cache is only attached when the backdrop behind the arc is a solid color
+ * (no gradient, image, semi-transparent layer or overlapping sibling drawn
+ * below it); otherwise the arc keeps drawing itself and FailReason() says why.
+ *
+ * The pixel buffer (up to 44 KB) comes from the heap on the first Attach(),
+ * from PSRAM when the board has it and internal RAM otherwise, so a build that
+ * never enables the cache does not reserve the DRAM.
+ */
+#ifndef GAUGE_SPRITE_H
+#define GAUGE_SPRITE_H
+
+#include <cstdint>
+#include <lvgl.h>
+
+// Largest arc (width x height) the cache can hold; 150x150 SquareLine arc = 44 KB RGB565
+#ifndef UI_ARC_SPRITE_MAX_PIXELS
+#define UI_ARC_SPRITE_MAX_PIXELS (150U * 150U)
+#endif
+
+/**
+ * @class GaugeSprite
+ * @brief Owns the RGB565 background cache of one arc widget.
+ */
+class GaugeSprite
+{
+public:
+  GaugeSprite();
+  ~GaugeSprite();
+  GaugeSprite(const GaugeSprite&) = delete;
+  GaugeSprite& operator=(const GaugeSprite&) = delete;
+
+  /**
+   * @brief Render the arc background (and @p ticks tick marks) and attach it.
+   *
+   * Call after the screen is built; call again after changing the arc's size,
+   * angles or styles. Any previous attachment is removed first.
+   * @return true if the arc now draws from the cache.
+   */
+  bool Attach(lv_obj_t* arc, uint8_t ticks);
+
+  /** Restore the arc's own background drawing. */
+  void Detach();
+
+  bool Attached() const { return arc_ != nullptr; }
+  /** Why the last Attach() failed (nullptr after success). */
+  const char* FailReason() const { return failReason_; }
+
+private:
+  // MAIN part style properties overridden while attached, restored on Detach()
+  static constexpr uint8_t kOverrideCount_ = 6;
+
+  struct SavedProp
+  {
+    lv_style_value_t value;
+    bool local;
+  };
+
+  bool Reserve_(uint32_t bytes);
+  bool FindBackdrop_(lv_obj_t* arc, lv_color_t& color);
+  void Render_(lv_obj_t* arc, lv_color_t backdrop, uint8_t ticks);
+
+  lv_obj_t* arc_ = nullptr;
+  const char* failReason_ = nullptr;
+  SavedProp saved_[kOverrideCount_];
+  lv_draw_buf_t buf_;
+  uint8_t* pixels_ = nullptr;
+  uint32_t capacity_ = 0;
+};
+
+#endif // GAUGE_SPRITE_H
@@ -1,6 +1,8 @@
 #include "HealthMonitor.h"
 #include "common/MessageRouter.h"
+#include "Clock.h"
 #include <Arduino.h>
+#include <cstring>
 
 HealthMonitor::HealthMonitor()
 {
@@ -8,6 +10,17 @@ HealthMonitor::HealthMonitor()
 
 bool HealthMonitor::CheckTimeout(EventQueue& eventQueue, const MessageRouter& router)
 {
+  // Expire slots of periodic IDs first so silence counts as misses even without frames
+  const uint32_t nowUs = Clock::NowUs();
+  for (std::size_t i = 0; i < slotCount_; ++i)
+  {
+    AccountMisses_(slots_[i], nowUs);
+  }
+  if (EvaluateStaleness_(eventQueue))
+  {
+    return true;
+  }
+
   uint32_t lastSeenMs = 0;
   if (!router.GetLastSeenMs(lastSeenMs))
   {
@@ -15,7 +28,7 @@ bool HealthMonitor::CheckTimeout(EventQueue& eventQueue, const MessageRouter& ro
     inTimeout_ = false; // treat as not timed out yet; avoid spamming
     return false;
   }
-  const uint32_t nowMs = millis();
+  const uint32_t nowMs = Clock::NowMs();
   const uint32_t elapsed = nowMs - lastSeenMs;
   if (elapsed >= timeoutMs_)
   {
@@ -30,10 +43,20 @@ bool HealthMonitor::CheckTimeout(EventQueue& eventQueue, const MessageRouter& ro
     return false; // already in timeout; don't spam queue
   }
 
-  // Fresh data seen again; clear timeout state
+  // Fresh data seen again. IDs with a nominal period recover through the K-frame
+  // hysteresis in EvaluateStaleness_; without one there is nothing to debounce.
   if (inTimeout_)
   {
-    inTimeout_ = false;
+    bool anyPeriodic = false;
+    for (std::size_t i = 0; i < slotCount_; ++i)
+    {
+      if (slots_[i].expectedPeriodUs != 0) anyPeriodic = true;
+    }
+    if (!anyPeriodic)
+    {
+      inTimeout_ = false;
+      eventQueue.Push(Event::MakeFrameRecovered());
+    }
   }
   return false;
 }
@@ -41,9 +64,234 @@ bool HealthMonitor::CheckTimeout(EventQueue& eventQueue, const MessageRouter& ro
 void HealthMonitor::Reset()
 {
   inTimeout_ = false;
+  // Restart the slot clocks; cycle statistics are kept
+  for (std::size_t i = 0; i < slotCount_; ++i)
+  {
+    slots_[i].deadlineArmed = false;
+    slots_[i].missHistory = 0;
+    slots_[i].onTimeStreak = 0;
+  }
 }
 
 void HealthMonitor::SetTimeoutMs(uint32_t timeoutMs)
 {
   timeoutMs_ = timeoutMs;
 }
+
+bool HealthMonitor::SetStalenessPolicy(uint8_t missedN, uint8_t windowM, uint8_t recoverK)
+{
+  if (missedN == 0 || missedN > windowM || windowM > kMaxMissWindow || recoverK == 0)
+  {
+    return false;
+  }
+  missedN_ = missedN;
+  windowM_ = windowM;
+  recoverK_ = recoverK;
+  return true;
+}
+
+void HealthMonitor::NotifyFrame(EventQueue& eventQueue, uint32_t canId, uint32_t timestampUs)
+{
+  IdStats* s = AcquireSlot_(canId);
+  if (s == nullptr) return; // table full; staleness still covered by CheckTimeout
+
+  const bool havePrevious = s->frameCount > 0;
+  const uint32_t previousTsUs = s->lastTsUs;
+  s->lastTsUs = timestampUs;
+  s->frameCount++;
+
+  // Unsigned subtraction keeps the period correct across the 32-bit micros() wrap
+  const uint32_t periodUs = timestampUs - previousTsUs;
+
+  if (havePrevious && s->frameCount == 2)
+  {
+    // First interval seeds the average and the extremes
+    s->ewmaScaled = periodUs << kEwmaShift_;
+    s->minPeriodUs = periodUs;
+    s->maxPeriodUs = periodUs;
+  }
+  else if (havePrevious)
+  {
+    if (periodUs < s->minPeriodUs) s->minPeriodUs = periodUs;
+    if (periodUs > s->maxPeriodUs) s->maxPeriodUs = periodUs;
+
+    const uint32_t ewmaUs = s->ewmaScaled >> kEwmaShift_;
+    const uint32_t deviationUs = (periodUs > ewmaUs) ? (periodUs - ewmaUs) : (ewmaUs - periodUs);
+    s->jitterHist[JitterBucket_(deviationUs)]++;
+
+    // ewma += (period - ewma) / 8, kept scaled to avoid losing the fraction
+    s->ewmaScaled = s->ewmaScaled - ewmaUs + periodUs;
+  }
+
+  s->drifting = OutsideTolerance_(*s);
+
+  if (s->expectedPeriodUs == 0) return;
+
+  // Slots that expired before this frame are misses; the frame itself fills the current slot
+  AccountMisses_(*s, timestampUs);
+  // The current slot opens half a period after the frame that filled the previous one.
+  // Duplicates and the tail of a burst land before that: they neither shift the miss
+  // window (which would push real misses out of it) nor re-arm the deadline or count
+  // towards the recovery streak.
+  if (s->deadlineArmed &&
+      static_cast<int32_t>(timestampUs - (s->nextDeadlineUs - s->expectedPeriodUs)) < 0)
+  {
+    return;
+  }
+  s->missHistory <<= 1;
+  const uint32_t spanUs = SlotSpanUs_(*s);
+  const bool onTime = s->deadlineArmed && havePrevious && (periodUs <= spanUs);
+  if (!onTime)
+  {
+    s->onTimeStreak = 0;
+  }
+  else if (s->onTimeStreak < UINT16_MAX)
+  {
+    s->onTimeStreak++;
+  }
+  s->nextDeadlineUs = timestampUs + spanUs;
+  s->deadlineArmed = true;
+
+  EvaluateStaleness_(eventQueue);
+}
+
+bool HealthMonitor::SetExpectedPeriod(uint32_t canId, uint32_t periodUs, uint8_t tolerancePct)
+{
+  IdStats* s = AcquireSlot_(canId);
+  if (s == nullptr) return false;
+  s->expectedPeriodUs = periodUs;
+  s->tolerancePct = tolerancePct;
+  s->drifting = OutsideTolerance_(*s);
+  return true;
+}
+
+bool HealthMonitor::GetPeriodStats(uint32_t canId, PeriodStats& out) const
+{
+  const IdStats* s = FindSlot_(canId);
+  if (s == nullptr) return false;
+  out.canId = s->canId;
+  out.frameCount = s->frameCount;
+  out.ewmaPeriodUs = s->ewmaScaled >> kEwmaShift_;
+  out.minPeriodUs = s->minPeriodUs;
+  out.maxPeriodUs = s->maxPeriodUs;
+  out.expectedPeriodUs = s->expectedPeriodUs;
+  out.tolerancePct = s->tolerancePct;
+  out.drifting = s->drifting;
+  out.missesInWindow = MissesInWindow_(*s);
+  out.onTimeStreak = s->onTimeStreak;
+  memcpy(out.jitterHist, s->jitterHist, sizeof(out.jitterHist));
+  return true;
+}
+
+bool HealthMonitor::IsDrifting(uint32_t canId) const
+{
+  const IdStats* s = FindSlot_(canId);
+  return (s != nullptr) && s->drifting;
+}
+
+HealthMonitor::IdStats* HealthMonitor::FindSlot_(uint32_t canId)
+{
+  for (std::size_t i = 0; i < slotCount_; ++i)
+  {
+    if (slots_[i].canId == canId) return &slots_[i];
+  }
+  return nullptr;
+}
+
+const HealthMonitor::IdStats* HealthMonitor::FindSlot_(uint32_t canId) const
+{
+  for (std::size_t i = 0; i < slotCount_; ++i)
+  {
+    if (slots_[i].canId == canId) return &slots_[i];
+  }
+  return nullptr;
+}
+
+HealthMonitor::IdStats* HealthMonitor::AcquireSlot_(uint32_t canId)
+{
+  IdStats* s = FindSlot_(canId);
+  if (s != nullptr) return s;
+  if (slotCount_ >= kMaxTrackedIds) return nullptr;
+  s = &slots_[slotCount_++];
+  memset(s, 0, sizeof(*s));
+  s->canId = canId;
+  return s;
+}
+
+std::size_t HealthMonitor::JitterBucket_(uint32_t deviationUs)
+{
+  if (deviationUs == 0) return 0;
+  // Bit length of the deviation: 1 -> 1, 2..3 -> 2, 4..7 -> 3, ...
+  const std::size_t bucket = 32U - static_cast<std::size_t>(__builtin_clz(deviationUs));
+  return (bucket < kJitterBuckets) ? bucket : (kJitterBuckets - 1);
+}
+
+bool HealthMonitor::OutsideTolerance_(const IdStats& s)
+{
+  // Need a nominal period and at least one measured interval
+  if (s.expectedPeriodUs == 0 || s.frameCount < 2) return false;
+  const uint32_t ewmaUs = s.ewmaScaled >> kEwmaShift_;
+  const uint32_t deviationUs = (ewmaUs > s.expectedPeriodUs) ? (ewmaUs - s.expectedPeriodUs)
+                                                             : (s.expectedPeriodUs - ewmaUs);
+  // 64-bit product: expected periods of seconds times 100 would overflow 32 bits
+  return static_cast<uint64_t>(deviationUs) * 100U >
+         static_cast<uint64_t>(s.expectedPeriodUs) * s.tolerancePct;
+}
+
+uint32_t HealthMonitor::SlotSpanUs_(const IdStats& s)
+{
+  // A slot ends 1.5 periods after the previous frame: jitter up to half a period is
+  // late-but-present, anything beyond is a missed frame. Drift is judged separately.
+  return s.expectedPeriodUs + (s.expectedPeriodUs >> 1);
+}
+
+void HealthMonitor::AccountMisses_(IdStats& s, uint32_t nowUs)
+{
+  if (!s.deadlineArmed || s.expectedPeriodUs == 0) return;
+  const uint32_t overdueUs = nowUs - s.nextDeadlineUs;
+  if (static_cast<int32_t>(overdueUs) < 0) return;
+
+  // One miss for the expired slot plus one for every further full period of silence
+  const uint32_t missed = overdueUs / s.expectedPeriodUs + 1U;
+  s.missHistory = (missed >= kMaxMissWindow) ? 0xFFFFFFFFU
+                                             : ((s.missHistory << missed) | ((1U << missed) - 1U));
+  s.nextDeadlineUs += missed * s.expectedPeriodUs;
+  s.onTimeStreak = 0;
+}
+
+uint8_t HealthMonitor::MissesInWindow_(const IdStats& s) const
+{
+  const uint32_t mask = (windowM_ >= kMaxMissWindow) ? 0xFFFFFFFFU : ((1U << windowM_) - 1U);
+  return static_cast<uint8_t>(__builtin_popcount(s.missHistory & mask));
+}
+
+bool HealthMonitor::EvaluateStaleness_(EventQueue& eventQueue)
+{
+  bool anyArmed = false;
+  bool allRecovered = true;
+  for (std::size_t i = 0; i < slotCount_; ++i)
+  {
+    const IdStats& s = slots_[i];
+    if (s.expectedPeriodUs == 0 || !s.deadlineArmed) continue;
+    anyArmed = true;
+    if (!inTimeout_ && MissesInWindow_(s) >= missedN_)
+    {
+      inTimeout_ = true;
+      eventQueue.Push(Event::MakeFrameTimeout());
+      return true;
+    }
+    if (s.onTimeStreak < recoverK_) allRecovered = false;
+  }
+
+  if (inTimeout_ && anyArmed && allRecovered)
+  {
+    inTimeout_ = false;
+    // Start the next debounce window clean so old misses cannot re-trigger at once
+    for (std::size_t i = 0; i < slotCount_; ++i)
+    {
+      slots_[i].missHistory = 0;
+    }
+    eventQueue.Push(Event::MakeFrameRecovered());
+  }
+  return false;
+}
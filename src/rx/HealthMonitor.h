@@ -4,10 +4,21 @@
  *
  * Polls MessageRouter last-seen timestamp and generates a single crossing event
  * when data becomes stale; resets on fresh frames.
+ *
+ * Additionally keeps per-ID cycle-time statistics (EWMA period, min/max and a
+ * log2 jitter histogram) fed from frame receive timestamps, so a sender that
+ * drifts off its nominal period is flagged long before it goes stale.
+ *
+ * For IDs with a nominal period, staleness is debounced: every expected slot
+ * that passes without a frame is a miss, FrameTimeout fires once N of the last
+ * M slots were missed, and FrameRecovered only after K consecutive on-time
+ * frames. The absolute router timeout remains as a backstop.
  */
 #ifndef HEALTH_MONITOR_H
 #define HEALTH_MONITOR_H
 
+#include <cstddef>
+#include <cstdint>
 #include "freertos/FreeRTOS.h"
 #include "EventQueue.h"
 
@@ -20,6 +31,36 @@ class MessageRouter; // forward declare for pull model
 class HealthMonitor
 {
 public:
+  /** Number of log2 buckets in the jitter histogram. */
+  static constexpr std::size_t kJitterBuckets = 16;
+  /** Maximum number of distinct CAN IDs with period statistics. */
+  static constexpr std::size_t kMaxTrackedIds = 8;
+  /** Longest miss window (M) the slot history can hold. */
+  static constexpr uint8_t kMaxMissWindow = 32;
+
+  /**
+   * @struct PeriodStats
+   * @brief Snapshot of cycle-time statistics for one CAN ID (all times in microseconds).
+   *
+   * Jitter is |period - EWMA| at the time each frame arrived. Bucket 0 counts
+   * deviations of 0 us, bucket i counts [2^(i-1), 2^i) us and the last bucket
+   * collects everything above.
+   */
+  struct PeriodStats
+  {
+    uint32_t canId;
+    uint32_t frameCount;
+    uint32_t ewmaPeriodUs;
+    uint32_t minPeriodUs;
+    uint32_t maxPeriodUs;
+    uint32_t expectedPeriodUs; // 0 = no nominal period configured
+    uint8_t tolerancePct;
+    bool drifting;             // EWMA outside expected +/- tolerance
+    uint8_t missesInWindow;    // missed slots among the last M expected
+    uint16_t onTimeStreak;     // consecutive frames within 1.5 expected periods
+    uint32_t jitterHist[kJitterBuckets];
+  };
+
   HealthMonitor();
 
   // Pull model: check router's last-seen timestamp for staleness
@@ -28,15 +69,80 @@ public:
    * @return true if a timeout crossing was detected and an event enqueued.
    */
   bool CheckTimeout(EventQueue& eventQueue, const MessageRouter& router);
-  /** Reset internal timeout latch. */
+  /** Reset internal timeout latch and slot histories. */
   void Reset();
-  /** Configure timeout threshold in milliseconds. */
+  /** Configure timeout threshold in milliseconds (backstop for total silence). */
   void SetTimeoutMs(uint32_t timeoutMs);
+  /**
+   * @brief Configure debouncing for IDs with an expected period.
+   * @param missedN Missed slots that trigger FrameTimeout.
+   * @param windowM Number of most recent expected slots considered (N <= M <= kMaxMissWindow).
+   * @param recoverK Consecutive on-time frames required before FrameRecovered.
+   * @return false if the parameters are inconsistent (policy unchanged).
+   */
+  bool SetStalenessPolicy(uint8_t missedN, uint8_t windowM, uint8_t recoverK);
+  /** True between an emitted FrameTimeout and the matching FrameRecovered. */
+  bool IsStale() const { return inTimeout_; }
+
+  /**
+   * @brief Record reception of a frame; O(1), call from task context.
+   * @param eventQueue Receives FrameRecovered once the recovery hysteresis is met.
+   * @param canId Identifier of the received frame.
+   * @param timestampUs Receive timestamp (Clock::NowUs() timebase).
+   */
+  void NotifyFrame(EventQueue& eventQueue, uint32_t canId, uint32_t timestampUs);
+  /**
+   * @brief Declare the nominal period of a CAN ID for drift detection.
+   * @return false if the ID table is full.
+   */
+  bool SetExpectedPeriod(uint32_t canId, uint32_t periodUs, uint8_t tolerancePct);
+  /** Copy statistics for a CAN ID. Returns false if the ID was never seen or configured. */
+  bool GetPeriodStats(uint32_t canId, PeriodStats& out) const;
+  /** True when the EWMA period of a CAN ID is outside its configured tolerance. */
+  bool IsDrifting(uint32_t canId) const;
 
 private:
+  struct IdStats
+  {
+    uint32_t canId;
+    uint32_t lastTsUs;
+    uint32_t frameCount;
+    uint32_t ewmaScaled;       // EWMA period << kEwmaShift_
+    uint32_t minPeriodUs;
+    uint32_t maxPeriodUs;
+    uint32_t expectedPeriodUs;
+    uint8_t tolerancePct;
+    bool drifting;
+    bool deadlineArmed;        // slot clock runs once a frame was seen
+    uint32_t nextDeadlineUs;   // end of the current expected slot (1.5 periods)
+    uint32_t missHistory;      // bit 0 = newest slot, 1 = missed
+    uint16_t onTimeStreak;
+    uint32_t jitterHist[kJitterBuckets];
+  };
+
+  // EWMA weight 1/8 (same smoothing as TCP SRTT); keeps the update shift-only
+  static constexpr uint8_t kEwmaShift_ = 3;
+
+  IdStats* FindSlot_(uint32_t canId);
+  const IdStats* FindSlot_(uint32_t canId) const;
+  IdStats* AcquireSlot_(uint32_t canId);
+  static std::size_t JitterBucket_(uint32_t deviationUs);
+  static bool OutsideTolerance_(const IdStats& s);
+  static uint32_t SlotSpanUs_(const IdStats& s);
+  static void AccountMisses_(IdStats& s, uint32_t nowUs);
+  uint8_t MissesInWindow_(const IdStats& s) const;
+  bool EvaluateStaleness_(EventQueue& eventQueue);
+
   uint32_t timeoutMs_ = 1500; // Increased default timeout to reduce flicker to Degraded/Waiting
   // Emit only once when crossing the timeout threshold; cleared when fresh data arrives
   bool inTimeout_ = false;
+  // N-of-M debounce and K-frame recovery hysteresis
+  uint8_t missedN_ = 5;
+  uint8_t windowM_ = 8;
+  uint8_t recoverK_ = 5;
+
+  IdStats slots_[kMaxTrackedIds];
+  std::size_t slotCount_ = 0;
 };
 
 #endif // HEALTH_MONITOR_H
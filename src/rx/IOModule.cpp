@@ -1,28 +1,30 @@
 #include "IOModule.h"
 
+namespace
+{
+bool LeftTurnRequested(const Cluster_t& msg) { return msg.Left_Turn_Signal != 0; }
+bool RightTurnRequested(const Cluster_t& msg) { return msg.Right_Turn_Signal != 0; }
+
+// Both indicators share phase group 0 so hazards blink in step
+constexpr uint8_t kIndicatorGroup = 0;
+}
+
 IOModule::IOModule()
 {
 }
 
 bool IOModule::Init(uint8_t leftPin, uint8_t rightPin, bool activeHigh)
 {
-  leftPin_ = leftPin;
-  rightPin_ = rightPin;
-  activeHigh_ = activeHigh;
-
-  pinMode(leftPin_, OUTPUT);
-  pinMode(rightPin_, OUTPUT);
+  const OutputEngine::Channel channels[] = {
+    OutputEngine::Blink(leftPin, &LeftTurnRequested, kIndicatorGroup, activeHigh),
+    OutputEngine::Blink(rightPin, &RightTurnRequested, kIndicatorGroup, activeHigh),
+  };
+  return Init(channels, static_cast<uint8_t>(sizeof(channels) / sizeof(channels[0])));
+}
 
-  // default OFF
-  digitalWrite(leftPin_, activeHigh_ ? LOW : HIGH);
-  digitalWrite(rightPin_, activeHigh_ ? LOW : HIGH);
-  leftOn_ = false;
-  rightOn_ = false;
-  nextToggleMs_ = 0;
-  lastUpdateMs_ = 0;
-  leftRequested_ = false;
-  rightRequested_ = false;
-  return true;
+bool IOModule::Init(const OutputEngine::Channel* channels, uint8_t count)
+{
+  return engine_.Init(channels, count);
 }
 
 bool IOModule::Start(MessageRouter& router)
@@ -38,123 +40,17 @@ void IOModule::Stop(MessageRouter& router)
   router.UnsubscribeSystemStatus(&IOModule::StatusCb_, this);
 }
 
-void IOModule::Update(uint32_t nowMs)
-{
-  // Gate all behavior based on system status
-  if (!outputsEnabled_)
-  {
-    // ensure safe state
-    if (leftOn_ || rightOn_ || leftRequested_ || rightRequested_)
-    {
-      leftRequested_ = false;
-      rightRequested_ = false;
-      leftOn_ = false;
-      rightOn_ = false;
-      ApplyOutputs_();
-    }
-    return;
-  }
-
-  // Staleness: if no update for > 1000 ms, force off
-  if (lastUpdateMs_ != 0 && (nowMs - lastUpdateMs_) > 1000)
-  {
-    leftRequested_ = false;
-    rightRequested_ = false;
-  }
-
-  // Phase sync requested when a rising edge was detected in OnCluster_
-  if (phaseSync_)
-  {
-    // Start from ON phase for any requested side, align next toggle to half period
-    leftOn_ = leftRequested_;
-    rightOn_ = rightRequested_;
-    nextToggleMs_ = nowMs + kBlinkPeriodMs_ / 2;
-    ApplyOutputs_();
-    phaseSync_ = false;
-    return; // let next tick handle regular blinking
-  }
-
-  // If requested, blink; otherwise ensure off
-  const bool needBlink = leftRequested_ || rightRequested_;
-  if (needBlink)
-  {
-    if (nowMs >= nextToggleMs_)
-    {
-      nextToggleMs_ = nowMs + kBlinkPeriodMs_ / 2; // toggle every half period
-      if (leftRequested_) leftOn_ = !leftOn_; else leftOn_ = false;
-      if (rightRequested_) rightOn_ = !rightOn_; else rightOn_ = false;
-      ApplyOutputs_();
-    }
-  }
-  else
-  {
-    // force off if was on
-    if (leftOn_ || rightOn_)
-    {
-      leftOn_ = false;
-      rightOn_ = false;
-      ApplyOutputs_();
-    }
-  }
-}
-
 void IOModule::ClusterCb_(const Cluster_t& msg, uint32_t tsMs, void* ctx)
 {
   auto* self = static_cast<IOModule*>(ctx);
   if (!self) return;
-  self->OnCluster_(msg, tsMs);
+  // Only evaluates the signal table; GPIO is written from Update()
+  self->engine_.OnSignals(msg, tsMs);
 }
 
-void IOModule::OnCluster_(const Cluster_t& msg, uint32_t tsMs)
-{
-  // Ignore cluster updates when outputs are disabled for safety
-  if (!outputsEnabled_) return;
-
-  lastUpdateMs_ = tsMs;
-  const bool newLeftReq = msg.Left_Turn_Signal != 0;
-  const bool newRightReq = msg.Right_Turn_Signal != 0;
-
-  // Edge-detect start requests to align blink phase once; do not touch GPIO here
-  const bool risingLeft = newLeftReq && !leftRequested_;
-  const bool risingRight = newRightReq && !rightRequested_;
-
-  leftRequested_ = newLeftReq;
-  rightRequested_ = newRightReq;
-
-  if (risingLeft || risingRight)
-  {
-    // Ask Update() to sync phase and reflect ON immediately on its next tick
-    phaseSync_ = true;
-  }
-  // Do not reset nextToggleMs_ on every message; let Update() drive cadence
-}
-
-void IOModule::StatusCb_(const MessageRouter::SystemStatus& status, uint32_t tsMs, void* ctx)
+void IOModule::StatusCb_(const MessageRouter::SystemStatus& status, uint32_t /*tsMs*/, void* ctx)
 {
   auto* self = static_cast<IOModule*>(ctx);
   if (!self) return;
-  self->OnStatus_(status, tsMs);
-}
-
-void IOModule::OnStatus_(const MessageRouter::SystemStatus& status, uint32_t /*tsMs*/)
-{
-  const bool wasEnabled = outputsEnabled_;
-  outputsEnabled_ = status.outputsEnabled;
-  if (!outputsEnabled_ && wasEnabled)
-  {
-    // Immediately go to safe state
-    leftRequested_ = false;
-    rightRequested_ = false;
-    leftOn_ = false;
-    rightOn_ = false;
-    ApplyOutputs_();
-  }
-}
-
-void IOModule::ApplyOutputs_()
-{
-  const int leftLevel = (leftOn_ ? (activeHigh_ ? HIGH : LOW) : (activeHigh_ ? LOW : HIGH));
-  const int rightLevel = (rightOn_ ? (activeHigh_ ? HIGH : LOW) : (activeHigh_ ? LOW : HIGH));
-  digitalWrite(leftPin_, leftLevel);
-  digitalWrite(rightPin_, rightLevel);
+  self->engine_.SetEnabled(status.outputsEnabled);
 }
@@ -2,8 +2,15 @@
  * @file IoModule.h
  * @brief Drives relay outputs for left/right indicators based on Cluster and SystemStatus.
  *
- * Subscribes to MessageRouter topics and implements a free-running 1 Hz blink with
- * phase sync on rising edges. Outputs are gated by SystemStatus.outputsEnabled.
+ * Subscribes to MessageRouter topics and feeds an OutputEngine channel table.
+ * The default table is the two indicator relays blinking at 1 Hz in one phase
+ * group, with phase sync on rising edges; Init() also accepts a full harness
+ * table (steady, blink, pulse train and PWM channels). Outputs are gated by
+ * SystemStatus.outputsEnabled.
+ *
+ * Update() is deadline driven: it records the next time it has work (toggle
+ * edge or staleness timeout) and router input marks it due, so the scheduler
+ * only calls it when IsDue() says so instead of on every tick.
  */
 #ifndef IO_MODULE_H
 #define IO_MODULE_H
@@ -13,21 +20,24 @@
 #include "lecture.h"
 #include "common/MessageRouter.h"
 #include "IOPins.h"
-
-// Simple IO module controlling two relay outputs for left/right blinkers.
-// Subscribes to typed Cluster messages from MessageRouter.
+#include "OutputEngine.h"
 
 /**
  * @class IOModule
- * @brief Configures pins and maintains blink state machine for indicators.
+ * @brief Router adapter that owns the output channel table and its engine.
  */
 class IOModule
 {
 public:
   IOModule();
 
-  /** Initialize IO pins and polarity. */
+  /** Initialize the default left/right indicator relays and polarity. */
   bool Init(uint8_t leftPin = IO_LEFT_RELAY_PIN, uint8_t rightPin = IO_RIGHT_RELAY_PIN, bool activeHigh = true);
+  /** Initialize from a caller-provided channel table (copied). */
+  bool Init(const OutputEngine::Channel* channels, uint8_t count);
+
+  /** Access the engine, e.g. to retime a phase group after Init(). */
+  OutputEngine& Engine() { return engine_; }
 
   // Register subscription; call after router.Init()
   /** Subscribe to router topics to start receiving updates. */
@@ -35,37 +45,20 @@ public:
   /** Unsubscribe from router topics. */
   void Stop(MessageRouter& router);
 
-  // Call periodically from loop for blink timing
+  // Call from the scheduler whenever IsDue() is true (calling more often is harmless)
   /** Update outputs based on time and requested state. */
-  void Update(uint32_t nowMs);
+  void Update(uint32_t nowMs) { engine_.Update(nowMs); }
+
+  /** True if Update() has work at @p nowMs (deadline reached or new router input). */
+  bool IsDue(uint32_t nowMs) const { return engine_.IsDue(nowMs); }
+  /** Milliseconds until Update() has work, or UINT32_MAX when idle until router input. */
+  uint32_t MsToNextWake(uint32_t nowMs) const { return engine_.MsToNextWake(nowMs); }
 
 private:
   static void ClusterCb_(const Cluster_t& msg, uint32_t tsMs, void* ctx);
   static void StatusCb_(const MessageRouter::SystemStatus& status, uint32_t tsMs, void* ctx);
-  void OnCluster_(const Cluster_t& msg, uint32_t tsMs);
-  void OnStatus_(const MessageRouter::SystemStatus& status, uint32_t tsMs);
-  void ApplyOutputs_();
-
-  uint8_t leftPin_ = IO_LEFT_RELAY_PIN;
-  uint8_t rightPin_ = IO_RIGHT_RELAY_PIN;
-  bool activeHigh_ = true;
-
-  // State from latest CAN
-  volatile bool leftRequested_ = false;
-  volatile bool rightRequested_ = false;
-  volatile uint32_t lastUpdateMs_ = 0;
-
-  // Blink state
-    // Blink period: 1 Hz (500ms ON, 500ms OFF)
-    static constexpr uint32_t kBlinkPeriodMs_ = 1000;
-  uint32_t nextToggleMs_ = 0;
-  bool leftOn_ = false;
-  bool rightOn_ = false;
-  // Set by OnCluster_ on rising edge; consumed by Update() to align phase and drive first ON
-  volatile bool phaseSync_ = false;
 
-  // System gating
-  volatile bool outputsEnabled_ = false; // default to safe
+  OutputEngine engine_;
 };
 
 #endif // IO_MODULE_H
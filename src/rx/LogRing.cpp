@@ -0,0 +1,105 @@
+#include "LogRing.h"
+#include <cstring>
+
+static_assert(LogRing::kMaxLineLen <= 255, "line length must fit Entry::bytes");
+static_assert(LogRing::kArenaBytes <= 65535, "arena offsets must fit Entry::offset");
+
+LogRing::LogRing()
+{
+  Clear();
+}
+
+void LogRing::Clear()
+{
+  head_ = 0;
+  count_ = 0;
+  writePos_ = 0;
+  arena_[0] = '\0';
+}
+
+bool LogRing::Overlaps_(const Entry& e, std::size_t start, std::size_t len) const
+{
+  const std::size_t eEnd = static_cast<std::size_t>(e.offset) + e.bytes + 1U;
+  return e.offset < start + len && eEnd > start;
+}
+
+bool LogRing::Append(const char* line, Change& change)
+{
+  if (line == nullptr || line[0] == '\0') return false;
+
+  std::size_t bytes = strnlen(line, kMaxLineLen);
+  // Never split a UTF-8 sequence when truncating
+  while (bytes > 0 && line[bytes] != '\0' && (static_cast<uint8_t>(line[bytes]) & 0xC0U) == 0x80U)
+  {
+    --bytes;
+  }
+  const std::size_t need = bytes + 1U;
+
+  // Lines stay contiguous: skip the tail of the arena if the line does not fit there
+  if (writePos_ + need > kArenaBytes)
+  {
+    writePos_ = 0;
+  }
+
+  // Evict oldest lines that exceed the line budget or occupy the target region.
+  // Allocation is sequential, so any overlapped line is older than all others.
+  const std::size_t countBefore = count_;
+  uint32_t evictedChars = 0;
+  std::size_t evicted = 0;
+  while (count_ > 0 && (count_ == kMaxLines || Overlaps_(entries_[head_], writePos_, need)))
+  {
+    evictedChars += entries_[head_].chars;
+    head_ = (head_ + 1U) % kMaxLines;
+    --count_;
+    ++evicted;
+  }
+  // Each evicted line also takes its '\n' separator, except when nothing remains
+  // (then the view held exactly the evicted lines and n-1 separators).
+  const uint32_t separators = (evicted == 0) ? 0U
+                            : (count_ > 0) ? static_cast<uint32_t>(evicted)
+                                           : static_cast<uint32_t>(countBefore - 1U);
+
+  char* dst = &arena_[writePos_];
+  uint8_t chars = 0;
+  for (std::size_t i = 0; i < bytes; ++i)
+  {
+    const char c = line[i];
+    dst[i] = (c == '\n' || c == '\r') ? ' ' : c;
+    if ((static_cast<uint8_t>(c) & 0xC0U) != 0x80U) ++chars;
+  }
+  dst[bytes] = '\0';
+
+  Entry& e = entries_[(head_ + count_) % kMaxLines];
+  e.offset = static_cast<uint16_t>(writePos_);
+  e.bytes = static_cast<uint8_t>(bytes);
+  e.chars = chars;
+  change.separator = (count_ > 0);
+  ++count_;
+  writePos_ += need;
+
+  change.cutHeadChars = evictedChars + separators;
+  change.text = dst;
+  return true;
+}
+
+const char* LogRing::Line(std::size_t i) const
+{
+  if (i >= count_) return nullptr;
+  return &arena_[entries_[(head_ + i) % kMaxLines].offset];
+}
+
+std::size_t LogRing::CopyText(char* out, std::size_t cap) const
+{
+  if (out == nullptr || cap == 0) return 0;
+  std::size_t pos = 0;
+  for (std::size_t i = 0; i < count_; ++i)
+  {
+    const Entry& e = entries_[(head_ + i) % kMaxLines];
+    if (i > 0 && pos + 1U < cap) out[pos++] = '\n';
+    const std::size_t n = (pos + e.bytes < cap) ? e.bytes : (cap - 1U - pos);
+    memcpy(&out[pos], &arena_[e.offset], n);
+    pos += n;
+  }
+  out[pos] = '\0';
+  return pos;
+}
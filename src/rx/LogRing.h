@@ -0,0 +1,87 @@
+/**
+ * @file LogRing.h
+ * @brief Fixed-capacity, allocation-free store for the Screen2 log lines.
+ *
+ * Lines live NUL-terminated and contiguous in a static char arena that is
+ * reused circularly; a small index ring records where each line starts. An
+ * append reports how many characters of the oldest lines were evicted, so the
+ * log label can be updated incrementally (cut head, append tail) instead of
+ * rebuilding its whole text.
+ */
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class LogRing
+ * @brief Circular char arena holding the newest kMaxLines log lines.
+ */
+class LogRing
+{
+public:
+  /** Number of lines kept (oldest dropped first). */
+  static constexpr std::size_t kMaxLines = 10;
+  /** Longest stored line in bytes, excluding the terminator (longer lines are truncated). */
+  static constexpr std::size_t kMaxLineLen = 95;
+  /** Arena size: a full set of maximum-length lines plus one for wrap slack. */
+  static constexpr std::size_t kArenaBytes = (kMaxLines + 1) * (kMaxLineLen + 1);
+
+  /**
+   * @struct Change
+   * @brief What the view has to do to mirror one Append().
+   *
+   * The view text is the lines joined with '\n'. Apply by cutting
+   * @c cutHeadChars characters from the front, then appending '\n' if
+   * @c separator is set, then @c text.
+   */
+  struct Change
+  {
+    uint32_t cutHeadChars; // UTF-8 characters (not bytes) to remove from the start
+    bool separator;        // a '\n' must precede the new line
+    const char* text;      // the stored (sanitized, possibly truncated) line
+  };
+
+  LogRing();
+
+  /** Drop all lines. */
+  void Clear();
+
+  /**
+   * @brief Store a copy of @p line, evicting the oldest lines as needed.
+   * @param line Text to append; embedded newlines become spaces.
+   * @param change Filled with the incremental view update.
+   * @return false if @p line is null or empty (nothing stored).
+   */
+  bool Append(const char* line, Change& change);
+
+  /** Number of stored lines. */
+  std::size_t Size() const { return count_; }
+  /** Line @p i, oldest first; nullptr if out of range. */
+  const char* Line(std::size_t i) const;
+
+  /**
+   * @brief Write all lines joined with '\n' into @p out (always terminated).
+   * @return Bytes written, excluding the terminator.
+   */
+  std::size_t CopyText(char* out, std::size_t cap) const;
+
+private:
+  struct Entry
+  {
+    uint16_t offset; // start of the line in arena_
+    uint8_t bytes;   // length excluding the terminator
+    uint8_t chars;   // UTF-8 characters, for LVGL's character-indexed cut
+  };
+
+  bool Overlaps_(const Entry& e, std::size_t start, std::size_t len) const;
+
+  char arena_[kArenaBytes];
+  Entry entries_[kMaxLines];
+  std::size_t head_ = 0;  // index of the oldest entry
+  std::size_t count_ = 0;
+  std::size_t writePos_ = 0;
+};
+
+#endif // LOG_RING_H
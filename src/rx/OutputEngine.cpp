@@ -0,0 +1,329 @@
+#include "OutputEngine.h"
+#include "soc/gpio_struct.h" // host builds get the recording stand-in from src/bench/host
+
+namespace
+{
+constexpr uint16_t kDefaultBlinkHalfPeriodMs = 500; // 1 Hz
+
+inline uint8_t LowestBit(uint32_t mask)
+{
+  return static_cast<uint8_t>(__builtin_ctz(mask));
+}
+
+inline uint64_t PinBit(uint8_t pin)
+{
+  return 1ULL << pin;
+}
+
+inline bool Due(uint32_t nowMs, uint32_t dueMs)
+{
+  return static_cast<int32_t>(nowMs - dueMs) >= 0;
+}
+
+// Advance a fixed-grid deadline by one step; re-anchor only after a long stall
+inline void Advance(uint32_t& dueMs, uint32_t stepMs, uint32_t nowMs)
+{
+  dueMs += stepMs;
+  if (Due(nowMs, dueMs)) dueMs = nowMs + stepMs;
+}
+}
+
+OutputEngine::OutputEngine()
+{
+  for (uint8_t g = 0; g < kMaxGroups; ++g)
+  {
+    groups_[g] = Group{kDefaultBlinkHalfPeriodMs, kDefaultBlinkHalfPeriodMs, 0, 0, false};
+  }
+}
+
+void OutputEngine::SetBackend(CommitFn fn, void* ctx)
+{
+  commit_ = (fn != nullptr) ? fn : &OutputEngine::HardwareCommit_;
+  commitCtx_ = (fn != nullptr) ? ctx : nullptr;
+}
+
+bool OutputEngine::Init(const Channel* channels, uint8_t count)
+{
+  if (channels == nullptr || count == 0 || count > kMaxChannels) return false;
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    const Channel& c = channels[i];
+    if (c.pattern == Pattern::Blink && c.group >= kMaxGroups) return false;
+    // Same rule as SetGroupTiming(): a zero phase would re-fire the timer on every pass
+    if (c.pattern == Pattern::PulseTrain && (c.onMs == 0 || c.offMs == 0)) return false;
+  }
+
+  count_ = count;
+  pwmChannels_ = 0;
+  uint64_t setPins = 0;
+  uint64_t clearPins = 0;
+  for (uint8_t g = 0; g < kMaxGroups; ++g)
+  {
+    groups_[g].members = 0;
+    groups_[g].on = false;
+  }
+  for (uint8_t i = 0; i < count_; ++i)
+  {
+    const Channel& c = channels[i];
+    channels_[i] = c;
+    pulses_[i] = PulseState{0, 0};
+    if (c.pattern == Pattern::Pwm)
+    {
+      ledcSetup(c.ledcChannel, kPwmFreqHz_, kPwmResolutionBits_);
+      ledcAttachPin(c.pin, c.ledcChannel);
+      pwmChannels_ |= (1UL << i);
+      WritePwm_(i, false);
+    }
+    else
+    {
+      pinMode(c.pin, OUTPUT);
+      // default OFF
+      if (c.activeHigh) clearPins |= PinBit(c.pin); else setPins |= PinBit(c.pin);
+    }
+    if (c.pattern == Pattern::Blink) groups_[c.group].members |= (1UL << i);
+  }
+  commit_(setPins, clearPins, commitCtx_);
+
+  pendingRequests_ = 0;
+  requested_ = 0;
+  onMask_ = 0;
+  pulseRunning_ = 0;
+  lastInputMs_ = 0;
+  updatePending_ = true;
+  return true;
+}
+
+bool OutputEngine::SetGroupTiming(uint8_t group, uint16_t onMs, uint16_t offMs)
+{
+  if (group >= kMaxGroups || onMs == 0 || offMs == 0) return false;
+  groups_[group].onMs = onMs;
+  groups_[group].offMs = offMs;
+  return true;
+}
+
+void OutputEngine::OnSignals(const Cluster_t& msg, uint32_t tsMs)
+{
+  // Ignore input while outputs are disabled for safety
+  if (!enabled_) return;
+
+  uint32_t requests = 0;
+  for (uint8_t i = 0; i < count_; ++i)
+  {
+    if (channels_[i].signal != nullptr && channels_[i].signal(msg)) requests |= (1UL << i);
+  }
+  pendingRequests_ = requests;
+  lastInputMs_ = tsMs;
+  updatePending_ = true; // staleness deadline moved, requests may have changed
+}
+
+void OutputEngine::SetEnabled(bool enabled)
+{
+  const bool wasEnabled = enabled_;
+  enabled_ = enabled;
+  updatePending_ = true;
+  if (!enabled && wasEnabled)
+  {
+    // Immediately go to safe state
+    const uint32_t before = onMask_;
+    pendingRequests_ = 0;
+    requested_ = 0;
+    onMask_ = 0;
+    pulseRunning_ = 0;
+    Commit_(before);
+  }
+}
+
+void OutputEngine::Update(uint32_t nowMs)
+{
+  updatePending_ = false;
+  const uint32_t before = onMask_;
+
+  uint32_t requests = enabled_ ? pendingRequests_ : 0U;
+  // Staleness: if no input for > 1000 ms, force off
+  if (lastInputMs_ != 0 && (nowMs - lastInputMs_) > kStaleTimeoutMs_)
+  {
+    pendingRequests_ = 0;
+    requests = 0;
+  }
+
+  const uint32_t rising = requests & ~requested_;
+  const uint32_t falling = requested_ & ~requests;
+  requested_ = requests;
+
+  // Released channels go off right away; their timers simply stop
+  onMask_ &= ~falling;
+  pulseRunning_ &= ~falling;
+
+  // Newly requested channels start in their ON phase. A blink channel restarts
+  // its whole group so every member stays in phase (hazards, paired lamps).
+  uint8_t syncGroups = 0;
+  for (uint32_t m = rising; m != 0; m &= m - 1U)
+  {
+    const uint8_t i = LowestBit(m);
+    switch (channels_[i].pattern)
+    {
+      case Pattern::Blink:
+        syncGroups |= static_cast<uint8_t>(1U << channels_[i].group);
+        break;
+      case Pattern::PulseTrain:
+        StartPulses_(i, nowMs);
+        break;
+      default:
+        onMask_ |= (1UL << i);
+        break;
+    }
+  }
+  for (uint8_t g = 0; g < kMaxGroups; ++g)
+  {
+    if ((syncGroups >> g) & 1U) StartGroup_(g, nowMs);
+  }
+
+  RunGroups_(nowMs);
+  RunPulses_(nowMs);
+  Commit_(before);
+  ScheduleNextWake_(nowMs);
+}
+
+void OutputEngine::StartGroup_(uint8_t g, uint32_t nowMs)
+{
+  Group& grp = groups_[g];
+  grp.on = true;
+  grp.dueMs = nowMs + grp.onMs;
+  onMask_ |= grp.members & requested_;
+}
+
+void OutputEngine::StartPulses_(uint8_t ch, uint32_t nowMs)
+{
+  pulses_[ch].done = 0;
+  pulses_[ch].dueMs = nowMs + channels_[ch].onMs;
+  pulseRunning_ |= (1UL << ch);
+  onMask_ |= (1UL << ch);
+}
+
+void OutputEngine::RunGroups_(uint32_t nowMs)
+{
+  for (uint8_t g = 0; g < kMaxGroups; ++g)
+  {
+    Group& grp = groups_[g];
+    const uint32_t active = grp.members & requested_;
+    if (active == 0 || !Due(nowMs, grp.dueMs)) continue;
+
+    grp.on = !grp.on;
+    Advance(grp.dueMs, grp.on ? grp.onMs : grp.offMs, nowMs);
+    if (grp.on) onMask_ |= active; else onMask_ &= ~active;
+  }
+}
+
+void OutputEngine::RunPulses_(uint32_t nowMs)
+{
+  for (uint32_t m = pulseRunning_; m != 0; m &= m - 1U)
+  {
+    const uint8_t i = LowestBit(m);
+    PulseState& p = pulses_[i];
+    if (!Due(nowMs, p.dueMs)) continue;
+
+    const Channel& c = channels_[i];
+    const uint32_t bit = 1UL << i;
+    if ((onMask_ & bit) == 0U)
+    {
+      // Next pulse of the burst (or first pulse after the gap)
+      onMask_ |= bit;
+      Advance(p.dueMs, c.onMs, nowMs);
+      continue;
+    }
+
+    onMask_ &= ~bit;
+    ++p.done;
+    if (c.pulses == 0 || p.done < c.pulses)
+    {
+      Advance(p.dueMs, c.offMs, nowMs);
+    }
+    else if (c.gapMs != 0)
+    {
+      p.done = 0;
+      Advance(p.dueMs, c.gapMs, nowMs);
+    }
+    else
+    {
+      pulseRunning_ &= ~bit; // one burst per request
+    }
+  }
+}
+
+void OutputEngine::Commit_(uint32_t before)
+{
+  const uint32_t changed = before ^ onMask_;
+  if (changed == 0U) return;
+
+  // Collect every changed digital channel into one set and one clear mask
+  uint64_t setPins = 0;
+  uint64_t clearPins = 0;
+  for (uint32_t m = changed & ~pwmChannels_; m != 0; m &= m - 1U)
+  {
+    const uint8_t i = LowestBit(m);
+    const bool high = (((onMask_ >> i) & 1U) != 0U) == channels_[i].activeHigh;
+    if (high) setPins |= PinBit(channels_[i].pin); else clearPins |= PinBit(channels_[i].pin);
+  }
+  if ((setPins | clearPins) != 0U) commit_(setPins, clearPins, commitCtx_);
+
+  for (uint32_t m = changed & pwmChannels_; m != 0; m &= m - 1U)
+  {
+    const uint8_t i = LowestBit(m);
+    WritePwm_(i, (onMask_ >> i) & 1U);
+  }
+}
+
+void OutputEngine::WritePwm_(uint8_t ch, bool on)
+{
+  const Channel& c = channels_[ch];
+  const uint32_t duty = on ? c.duty : 0U;
+  ledcWrite(c.ledcChannel, c.activeHigh ? duty : (255U - duty));
+}
+
+void OutputEngine::HardwareCommit_(uint64_t setPins, uint64_t clearPins, void* /*ctx*/)
+{
+  // One write per register: GPIO 0..31 and 32..39 live in separate banks
+  const uint32_t setLo = static_cast<uint32_t>(setPins);
+  const uint32_t clearLo = static_cast<uint32_t>(clearPins);
+  const uint32_t setHi = static_cast<uint32_t>(setPins >> 32);
+  const uint32_t clearHi = static_cast<uint32_t>(clearPins >> 32);
+  if (setLo != 0U) GPIO.out_w1ts = setLo;
+  if (clearLo != 0U) GPIO.out_w1tc = clearLo;
+  if (setHi != 0U) GPIO.out1_w1ts.val = setHi;
+  if (clearHi != 0U) GPIO.out1_w1tc.val = clearHi;
+}
+
+void OutputEngine::ScheduleNextWake_(uint32_t nowMs)
+{
+  // Nothing time-based left: sleep until new input arrives
+  idleUntilInput_ = true;
+  nextWakeMs_ = nowMs + 0x7FFFFFFFUL;
+  if (!enabled_ || requested_ == 0) return;
+
+  bool haveDeadline = false;
+  uint32_t next = 0;
+  auto consider = [&](uint32_t dueMs) {
+    if (!haveDeadline || static_cast<int32_t>(dueMs - next) < 0) next = dueMs;
+    haveDeadline = true;
+  };
+  if (lastInputMs_ != 0) consider(lastInputMs_ + kStaleTimeoutMs_ + 1U);
+  for (uint8_t g = 0; g < kMaxGroups; ++g)
+  {
+    if ((groups_[g].members & requested_) != 0U) consider(groups_[g].dueMs);
+  }
+  for (uint32_t m = pulseRunning_; m != 0; m &= m - 1U)
+  {
+    consider(pulses_[LowestBit(m)].dueMs);
+  }
+  if (!haveDeadline) return;
+  idleUntilInput_ = false;
+  nextWakeMs_ = next;
+}
+
+uint32_t OutputEngine::MsToNextWake(uint32_t nowMs) const
+{
+  if (updatePending_) return 0;
+  if (idleUntilInput_) return UINT32_MAX;
+  const int32_t remaining = static_cast<int32_t>(nextWakeMs_ - nowMs);
+  return (remaining > 0) ? static_cast<uint32_t>(remaining) : 0U;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file OutputEngine.h
+ * @brief Table-driven output pattern engine for relay, lamp and buzzer channels.
+ *
+ * Each channel is one table row: a pin, a signal selector over the routed
+ * Cluster_t and a pattern (steady, blink in a shared phase group, pulse train
+ * or LEDC PWM duty). Blink channels in the same phase group share one timer,
+ * so hazards and synchronized lamps toggle on the same edge. A single Update()
+ * pass consumes new requests, advances every due timer and writes only the
+ * channels whose state changed.
+ *
+ * Digital channels are committed as one set mask and one clear mask per pass,
+ * written straight to the GPIO W1TS/W1TC registers, so channels switching the
+ * same way (both hazard relays) change on the same register write. A host build
+ * installs its own commit backend (e.g. OutputRecorder) to capture the waveform.
+ */
+#ifndef OUTPUT_ENGINE_H
+#define OUTPUT_ENGINE_H
+
+#include <cstdint>
+#include <Arduino.h>
+#include "lecture.h"
+
+/**
+ * @class OutputEngine
+ * @brief Requests, phase groups and pulse timers for up to kMaxChannels outputs.
+ */
+class OutputEngine
+{
+public:
+  enum class Pattern : uint8_t
+  {
+    Steady,     ///< On while requested
+    Blink,      ///< Toggles on its phase group's grid while requested
+    PulseTrain, ///< Bursts of `pulses` on/off pulses separated by `gapMs`
+    Pwm         ///< LEDC duty `duty` while requested
+  };
+
+  /** Maps a routed Cluster_t to this channel's request. */
+  using SignalFn = bool (*)(const Cluster_t& msg);
+
+  /** One channel table row; build rows with the factory helpers below. */
+  struct Channel
+  {
+    uint8_t pin;
+    bool activeHigh;
+    Pattern pattern;
+    SignalFn signal;
+    uint8_t group;       ///< Blink: phase group index
+    uint16_t onMs;       ///< PulseTrain: pulse on time
+    uint16_t offMs;      ///< PulseTrain: off time between pulses
+    uint8_t pulses;      ///< PulseTrain: pulses per burst (0 = endless)
+    uint16_t gapMs;      ///< PulseTrain: pause after a burst (0 = one burst per request)
+    uint8_t duty;        ///< Pwm: duty 0..255 while requested
+    uint8_t ledcChannel; ///< Pwm: LEDC channel driving the pin
+  };
+
+  static constexpr Channel Steady(uint8_t pin, SignalFn signal, bool activeHigh = true)
+  {
+    return Channel{pin, activeHigh, Pattern::Steady, signal, 0, 0, 0, 0, 0, 0, 0};
+  }
+  static constexpr Channel Blink(uint8_t pin, SignalFn signal, uint8_t group, bool activeHigh = true)
+  {
+    return Channel{pin, activeHigh, Pattern::Blink, signal, group, 0, 0, 0, 0, 0, 0};
+  }
+  static constexpr Channel PulseTrain(uint8_t pin, SignalFn signal, uint16_t onMs, uint16_t offMs,
+                                      uint8_t pulses, uint16_t gapMs, bool activeHigh = true)
+  {
+    return Channel{pin, activeHigh, Pattern::PulseTrain, signal, 0, onMs, offMs, pulses, gapMs, 0, 0};
+  }
+  static constexpr Channel Pwm(uint8_t pin, SignalFn signal, uint8_t ledcChannel, uint8_t duty,
+                               bool activeHigh = true)
+  {
+    return Channel{pin, activeHigh, Pattern::Pwm, signal, 0, 0, 0, 0, 0, duty, ledcChannel};
+  }
+
+  static constexpr uint8_t kMaxChannels = 32; // one bit per channel in the state masks
+  static constexpr uint8_t kMaxGroups = 4;
+
+  /** Output backend signature: drive pins in @p setPins high and in @p clearPins low (bit n = GPIO n). */
+  using CommitFn = void (*)(uint64_t setPins, uint64_t clearPins, void* ctx);
+
+  OutputEngine();
+
+  /**
+   * @brief Replace the digital output backend.
+   * @param fn Backend to call, or nullptr to restore the GPIO register writes.
+   * @param ctx Opaque pointer handed back to @p fn.
+   * @note Install before Init() so the initial OFF state goes through it too.
+   */
+  void SetBackend(CommitFn fn, void* ctx);
+
+  /**
+   * @brief Copy the channel table, configure pins and drive everything off.
+   * @return false if the table is empty, too long, references a bad group or has a
+   *         PulseTrain row with a zero on or off time.
+   */
+  bool Init(const Channel* channels, uint8_t count);
+
+  /** Set a phase group's on/off times (default 500/500 ms, i.e. 1 Hz). */
+  bool SetGroupTiming(uint8_t group, uint16_t onMs, uint16_t offMs);
+
+  /** Evaluate every channel's signal; call from the router's Cluster callback. */
+  void OnSignals(const Cluster_t& msg, uint32_t tsMs);
+  /** Gate all outputs; disabling drives every channel off immediately. */
+  void SetEnabled(bool enabled);
+
+  /** Apply new requests, advance due timers and write changed channels. */
+  void Update(uint32_t nowMs);
+
+  /** True if Update() has work at @p nowMs (deadline reached or new input). */
+  bool IsDue(uint32_t nowMs) const
+  {
+    return updatePending_ || static_cast<int32_t>(nowMs - nextWakeMs_) >= 0;
+  }
+  /** Milliseconds until Update() has work, or UINT32_MAX when idle until input. */
+  uint32_t MsToNextWake(uint32_t nowMs) const;
+
+  /** Bit i set while channel i is driven on. */
+  uint32_t OnMask() const { return onMask_; }
+  uint8_t ChannelCount() const { return count_; }
+
+private:
+  struct Group
+  {
+    uint16_t onMs;
+    uint16_t offMs;
+    uint32_t members; // Blink channels bound to this group
+    uint32_t dueMs;
+    bool on;
+  };
+
+  struct PulseState
+  {
+    uint32_t dueMs;
+    uint8_t done; // pulses completed in the current burst
+  };
+
+  void StartGroup_(uint8_t g, uint32_t nowMs);
+  void StartPulses_(uint8_t ch, uint32_t nowMs);
+  void RunGroups_(uint32_t nowMs);
+  void RunPulses_(uint32_t nowMs);
+  void Commit_(uint32_t before);
+  void WritePwm_(uint8_t ch, bool on);
+  static void HardwareCommit_(uint64_t setPins, uint64_t clearPins, void* ctx);
+  void ScheduleNextWake_(uint32_t nowMs);
+
+  static constexpr uint32_t kStaleTimeoutMs_ = 1000;
+  static constexpr uint32_t kPwmFreqHz_ = 1000;
+  static constexpr uint8_t kPwmResolutionBits_ = 8;
+
+  Channel channels_[kMaxChannels];
+  PulseState pulses_[kMaxChannels];
+  Group groups_[kMaxGroups];
+  uint8_t count_ = 0;
+  uint32_t pwmChannels_ = 0; // Pwm rows; everything else goes through the backend
+  CommitFn commit_ = &OutputEngine::HardwareCommit_;
+  void* commitCtx_ = nullptr;
+
+  // Written by OnSignals(), consumed by Update()
+  volatile uint32_t pendingRequests_ = 0;
+  volatile uint32_t lastInputMs_ = 0;
+  volatile bool enabled_ = false; // default to safe
+
+  uint32_t requested_ = 0;    // requests Update() has acted on
+  uint32_t onMask_ = 0;       // channels currently driven on
+  uint32_t pulseRunning_ = 0; // PulseTrain channels with a live timer
+
+  // Scheduling: next deadline, valid while idleUntilInput_ is false
+  uint32_t nextWakeMs_ = 0;
+  bool idleUntilInput_ = false;
+  volatile bool updatePending_ = true;
+};
+
+#endif // OUTPUT_ENGINE_H
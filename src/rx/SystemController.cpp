@@ -1,6 +1,9 @@
 #include "SystemController.h"
 #include <Arduino.h>
 #include <Wire.h>
+#include "Clock.h"
+#include <cctype>
+#include <cstring>
 
 // -------------------------
 // Test hooks (compile-time)
@@ -21,6 +24,39 @@
   #endif
 #endif
 
+// Serial command that dumps the transition trace
+#ifndef TRACE_DUMP_KEY
+  #define TRACE_DUMP_KEY 'T'
+#endif
+
+// Serial command that forces a full dashboard redraw and prints its frame timing
+#ifndef REDRAW_BENCH_KEY
+  #define REDRAW_BENCH_KEY 'R'
+#endif
+
+namespace
+{
+// Nominal Cluster cadence of the TX board (kSendPeriodMs) and allowed EWMA drift
+constexpr uint32_t kClusterPeriodUs = 100000U;
+constexpr uint8_t kClusterPeriodTolerancePct = 20U;
+// Staleness debounce: Degraded after 5 missed of the last 8 slots, Active again after 5 on-time frames
+constexpr uint8_t kStaleMissedSlots = 5U;
+constexpr uint8_t kStaleWindowSlots = 8U;
+constexpr uint8_t kRecoverOnTimeFrames = 5U;
+// Bus load telemetry cadence (serial + UI log)
+constexpr uint32_t kBusLoadReportPeriodMs = 5000U;
+}
+
+// Entry handlers indexed by SystemState
+const SystemController::EnterHandler SystemController::kEnterHandlers_[] = {
+  &SystemController::OnEnterBoot,
+  &SystemController::OnEnterDisplayInit,
+  &SystemController::OnEnterWaitingForData,
+  &SystemController::OnEnterActive,
+  &SystemController::OnEnterDegraded,
+  &SystemController::OnEnterFault
+};
+
 SystemController::SystemController(EventQueue& eventQueue, CanInterface& canInterface,
                                    UiController& uiController, HealthMonitor& healthMonitor,
                                    MessageRouter& messageRouter)
@@ -30,137 +66,153 @@ SystemController::SystemController(EventQueue& eventQueue, CanInterface& canInte
     healthMonitor_(healthMonitor),
     messageRouter_(messageRouter),
     currentState_(SystemState::Boot),
-    bootStepsCompleted_(0)
+    clusterDrifting_(false),
+    nextBusLoadReportMs_(0),
+    traceCount_(0),
+    traceFlushed_(0)
 {
 }
 
 bool SystemController::RunBootSequence()
 {
   OnEnterBoot();
+  bootOrchestrator_.Begin(Clock::NowUs());
+
+  // Health policy first: with the parallel boot, frames may arrive before the display is up
+  // Increase stale-data timeout to reduce aggressive fallback
+  healthMonitor_.SetTimeoutMs(1500);
+  // Flag Cluster senders whose average period wanders off nominal
+  healthMonitor_.SetExpectedPeriod(Cluster_CANID, kClusterPeriodUs, kClusterPeriodTolerancePct);
+  // Debounce Active <-> Degraded so a marginal sender does not flap the screens
+  healthMonitor_.SetStalenessPolicy(kStaleMissedSlots, kStaleWindowSlots, kRecoverOnTimeFrames);
 
   // Initialize I2C (required for touchscreen)
   Wire.begin();
 
-  // Initialize CAN interface
-  if (!canInterface_.Init(eventQueue_))
-  {
-    Event event = Event::MakeInitFail(Subsystem::CAN);
-    eventQueue_.Push(event);
-    TransitionTo(SystemState::Fault);
-    return false;
-  }
-
-  Event event = Event::MakeInitOk(Subsystem::CAN);
-  eventQueue_.Push(event);
-
-  // Transition to display initialization (handler invoked via TransitionTo)
-  TransitionTo(SystemState::DisplayInit);
-
-  // Initialize UI
+  // Display, LVGL, touch and UI initialize inside the UI task; each step reports through
+  // BootStepCb_ which records timing and queues InitOk/InitFail for Dispatch.
+  uiController_.SetBootStepCallback(&SystemController::BootStepCb_, this);
   if (!uiController_.Init())
   {
-    Event failEvent = Event::MakeInitFail(Subsystem::Display);
-    eventQueue_.Push(failEvent);
-    TransitionTo(SystemState::Fault);
+    Dispatch(Event::MakeInitFail(Subsystem::Display));
     return false;
   }
 
-  Event okEvent = Event::MakeInitOk(Subsystem::Display);
-  eventQueue_.Push(okEvent);
-
-  // Start UI task so all subsequent LVGL operations happen in a single thread
-  if (!uiController_.StartTask())
+  // Start UI task so all subsequent LVGL operations happen in a single thread. Pin it to
+  // the other core so its (blocking) display bring-up overlaps CAN init on this thread.
+  const BaseType_t uiCore = (xPortGetCoreID() == 0) ? 1 : 0;
+  if (!uiController_.StartTask(1, 10, 2, 20 * 1024, uiCore))
   {
-    Event failEvent = Event::MakeInitFail(Subsystem::LVGL);
-    eventQueue_.Push(failEvent);
-    TransitionTo(SystemState::Fault);
+    Dispatch(Event::MakeInitFail(Subsystem::LVGL));
     return false;
   }
 
-  // Now it's safe to send UI messages
+  // Queues exist now; the UI task applies these once the generated UI is up
   uiController_.EnqueueMessage(UiMessage::MakeShowLog());
   uiController_.EnqueueMessage(UiMessage::MakeAddLog("System booting..."));
   uiController_.EnqueueMessage(UiMessage::MakeAddLog("Initializing display..."));
 
-  // Boot successful, transition to waiting for data (handler invoked via TransitionTo)
-  TransitionTo(SystemState::WaitingForData);
-
-  // Increase stale-data timeout to reduce aggressive fallback
-  healthMonitor_.SetTimeoutMs(1500);
+  // CAN comes up on this thread while the UI task works. Boot runs before the processing
+  // task exists, so the result is dispatched directly (Boot -> DisplayInit).
+  bootOrchestrator_.MarkStarted(Subsystem::CAN, Clock::NowUs());
+  const bool canOk = canInterface_.Init(eventQueue_);
+  bootOrchestrator_.MarkDone(Subsystem::CAN, canOk, Clock::NowUs());
+  if (!canOk)
+  {
+    Dispatch(Event::MakeInitFail(Subsystem::CAN));
+    return false;
+  }
+  Dispatch(Event::MakeInitOk(Subsystem::CAN));
 
   return true;
 }
 
+void SystemController::BootStepCb_(Subsystem sys, bool ok, uint32_t startUs, uint32_t endUs, void* ctx)
+{
+  // Runs in the UI task: record timing, hand the state change to the processing task
+  SystemController* self = static_cast<SystemController*>(ctx);
+  if (self == nullptr) return;
+  self->bootOrchestrator_.MarkStarted(sys, startUs);
+  self->bootOrchestrator_.MarkDone(sys, ok, endUs);
+  self->eventQueue_.Push(ok ? Event::MakeInitOk(sys) : Event::MakeInitFail(sys));
+}
+
 void SystemController::Dispatch(const Event& event)
 {
-  switch (event.type)
+  SystemTransition cell;
+  if (!SystemTransitions::Lookup(currentState_, event.type, cell) || !GuardPasses_(cell.guard))
   {
-    case EventType::InitOk:
-      bootStepsCompleted_++;
-      break;
-
-    case EventType::InitFail:
-      TransitionTo(SystemState::Fault);
-      break;
+    return;
+  }
+  TransitionTo(cell.target, event.type);
 
-    case EventType::ClusterFrame:
-      if (currentState_ == SystemState::WaitingForData)
-      {
-        TransitionTo(SystemState::Active);
-      }
-      else if (currentState_ == SystemState::Degraded)
-      {
-        // Recover from degraded state
-        TransitionTo(SystemState::Active);
-      }
+  switch (cell.action)
+  {
+    case TransitionAction::ConsumeFrame:
       // Always publish to message router so all subscribers receive the latest Cluster
-      messageRouter_.PublishCluster(event.payload.clusterData, millis());
+      messageRouter_.PublishCluster(event.payload.clusterData, Clock::NowMs());
+      healthMonitor_.NotifyFrame(eventQueue_, Cluster_CANID, event.rxTimestampUs);
+      ReportClusterDrift_();
       break;
 
-    case EventType::FrameTimeout:
-      if (currentState_ == SystemState::Active)
-      {
-        TransitionTo(SystemState::Degraded);
-      }
-      break;
-
-    case EventType::Error:
-      TransitionTo(SystemState::Fault);
+    case TransitionAction::None:
       break;
+  }
+}
 
-    default:
+bool SystemController::GuardPasses_(TransitionGuard guard) const
+{
+  switch (guard)
+  {
+    case TransitionGuard::Always:
+      return true;
+    case TransitionGuard::CanReady:
+      return bootOrchestrator_.IsReady(Subsystem::CAN);
+    case TransitionGuard::BootComplete:
+      return bootOrchestrator_.AllReady();
+    case TransitionGuard::Ignore:
+    case TransitionGuard::Unspecified:
       break;
   }
+  return false;
 }
 
 void SystemController::Update()
 {
+  // Emit pending transition lines without blocking on a full UART FIFO
+  FlushTrace_();
+  HandleSerialCommand_();
+  // One-shot boot profile once every subsystem reported (or one failed)
+  bootOrchestrator_.PrintProfileOnce();
+
   // Check for timeout in Active state
   if (currentState_ == SystemState::Active || currentState_ == SystemState::Degraded)
   {
     healthMonitor_.CheckTimeout(eventQueue_, messageRouter_);
   }
 
-  // Test hook: allow injecting an InitFail event without changing app logic
-  // - Press TEST_INITFAIL_KEY (default 'E') in the serial monitor to inject immediately
-  // - Or define TEST_INITFAIL_AFTER_MS to auto-inject once after the given delay
-#ifdef TEST_HOOKS
-  // Serial keypress trigger
-  if (Serial.available())
+  // Periodic bus utilization telemetry once the CAN driver is up
+  if (currentState_ == SystemState::WaitingForData || currentState_ == SystemState::Active ||
+      currentState_ == SystemState::Degraded)
   {
-    int c = toupper(Serial.peek());
-    if (c == TEST_INITFAIL_KEY)
+    const uint32_t nowMs = Clock::NowMs();
+    if (static_cast<int32_t>(nowMs - nextBusLoadReportMs_) >= 0)
     {
-      (void)Serial.read();
-      Serial.println("[TEST] Injecting InitFail via serial keypress");
-      eventQueue_.Push(Event::MakeInitFail(TEST_INITFAIL_SUBSYSTEM));
+      nextBusLoadReportMs_ = nowMs + kBusLoadReportPeriodMs;
+      ReportBusLoad_();
+      ReportRenderStats_();
+      ReportUiTelemetry_();
     }
   }
 
+  // Test hook: allow injecting an InitFail event without changing app logic
+  // - Press TEST_INITFAIL_KEY (default 'E') in the serial monitor to inject immediately
+  // - Or define TEST_INITFAIL_AFTER_MS to auto-inject once after the given delay
+#ifdef TEST_HOOKS
   // Timed one-shot trigger
   #if TEST_INITFAIL_AFTER_MS > 0
     static bool s_testInitFailInjected = false;
-    if (!s_testInitFailInjected && millis() >= TEST_INITFAIL_AFTER_MS)
+    if (!s_testInitFailInjected && Clock::NowMs() >= TEST_INITFAIL_AFTER_MS)
     {
       s_testInitFailInjected = true;
       Serial.println("[TEST] Injecting InitFail after delay");
@@ -170,60 +222,118 @@ void SystemController::Update()
 #endif
 }
 
-void SystemController::TransitionTo(SystemState newState)
+void SystemController::HandleSerialCommand_()
+{
+  if (!Serial.available())
+  {
+    return;
+  }
+  const int c = toupper(Serial.read());
+  if (c == TRACE_DUMP_KEY)
+  {
+    DumpTrace();
+    return;
+  }
+  if (c == REDRAW_BENCH_KEY)
+  {
+    uiController_.EnqueueMessage(UiMessage::MakeForceRedraw());
+    return;
+  }
+#ifdef TEST_HOOKS
+  // Serial keypress trigger
+  if (c == TEST_INITFAIL_KEY)
+  {
+    Serial.println("[TEST] Injecting InitFail via serial keypress");
+    eventQueue_.Push(Event::MakeInitFail(TEST_INITFAIL_SUBSYSTEM));
+  }
+#endif
+}
+
+void SystemController::TransitionTo(SystemState newState, EventType cause)
 {
   if (currentState_ == newState)
   {
     return;
   }
 
+  const SystemState oldState = currentState_;
   currentState_ = newState;
 
+  // Record into the trace ring; the serial line is emitted later by FlushTrace_()
+  TraceEntry& entry = trace_[traceCount_ % kTraceDepth_];
+  entry.tsMs = Clock::NowMs();
+  entry.from = static_cast<uint8_t>(oldState);
+  entry.to = static_cast<uint8_t>(newState);
+  entry.cause = static_cast<uint8_t>(cause);
+  traceCount_++;
+
   // Publish system status for consumers like IOModule to gate behavior
   MessageRouter::SystemStatus status{static_cast<uint8_t>(currentState_),
-                                     (currentState_ == SystemState::Active) || (currentState_ == SystemState::Degraded)};
-  messageRouter_.PublishSystemStatus(status, millis());
+                                     SystemTransitions::OutputsEnabled(currentState_)};
+  messageRouter_.PublishSystemStatus(status, entry.tsMs);
+
+  static_assert(sizeof(kEnterHandlers_) / sizeof(kEnterHandlers_[0]) == SystemTransitions::kStateCount,
+                "one entry handler per SystemState");
+  (this->*kEnterHandlers_[static_cast<std::size_t>(newState)])();
+}
 
-  switch (newState)
+void SystemController::FlushTrace_()
+{
+  while (traceFlushed_ != traceCount_)
   {
-    case SystemState::Boot:
-      OnEnterBoot();
-      break;
-    case SystemState::DisplayInit:
-      OnEnterDisplayInit();
-      break;
-    case SystemState::WaitingForData:
-      OnEnterWaitingForData();
-      break;
-    case SystemState::Active:
-      OnEnterActive();
-      break;
-    case SystemState::Degraded:
-      OnEnterDegraded();
-      break;
-    case SystemState::Fault:
-      OnEnterFault();
-      break;
+    // Entries overwritten before they could be printed are skipped
+    if (traceCount_ - traceFlushed_ > kTraceDepth_)
+    {
+      traceFlushed_ = traceCount_ - kTraceDepth_;
+    }
+    const TraceEntry& entry = trace_[traceFlushed_ % kTraceDepth_];
+    const char* line = SystemTransitions::EnterMessage(static_cast<SystemState>(entry.to));
+    if (Serial.availableForWrite() < static_cast<int>(strlen(line) + 2))
+    {
+      return; // UART TX buffer full; try again next tick
+    }
+    Serial.println(line);
+    traceFlushed_++;
+  }
+}
+
+void SystemController::DumpTrace() const
+{
+  uint32_t available = traceCount_;
+  if (available > kTraceDepth_)
+  {
+    available = kTraceDepth_;
+  }
+  char line[96];
+  snprintf(line, sizeof(line), "[TRACE] %lu transitions, showing last %lu",
+           static_cast<unsigned long>(traceCount_), static_cast<unsigned long>(available));
+  Serial.println(line);
+  for (uint32_t i = traceCount_ - available; i != traceCount_; ++i)
+  {
+    const TraceEntry& entry = trace_[i % kTraceDepth_];
+    snprintf(line, sizeof(line), "[TRACE] %10lu ms  %s -> %s (%s)",
+             static_cast<unsigned long>(entry.tsMs),
+             SystemTransitions::StateName(static_cast<SystemState>(entry.from)),
+             SystemTransitions::StateName(static_cast<SystemState>(entry.to)),
+             SystemTransitions::EventName(static_cast<EventType>(entry.cause)));
+    Serial.println(line);
   }
 }
 
 void SystemController::OnEnterBoot()
 {
-  bootStepsCompleted_ = 0;
   Serial.begin(115200);
-  Serial.println("System booting...");
+  Serial.println(SystemTransitions::EnterMessage(SystemState::Boot));
   // Defer UI changes until UI task is started
 }
 
 void SystemController::OnEnterDisplayInit()
 {
-  Serial.println("Initializing display...");
   // UI messages will be sent after the UI task is started
 }
 
 void SystemController::OnEnterWaitingForData()
 {
-  Serial.println("Waiting for CAN data...");
   healthMonitor_.Reset();
   uiController_.EnqueueMessage(UiMessage::MakeShowLog());
   uiController_.EnqueueMessage(UiMessage::MakeAddLog("Waiting for CAN data..."));
@@ -231,13 +341,11 @@ void SystemController::OnEnterWaitingForData()
 
 void SystemController::OnEnterActive()
 {
-  Serial.println("System active");
   uiController_.EnqueueMessage(UiMessage::MakeShowDashboard());
 }
 
 void SystemController::OnEnterDegraded()
 {
-  Serial.println("WARNING: Stale data detected");
   uiController_.EnqueueMessage(UiMessage::MakeShowDegraded());
   uiController_.EnqueueMessage(UiMessage::MakeShowLog());
   uiController_.EnqueueMessage(UiMessage::MakeAddLog("WARNING: Stale data detected"));
@@ -245,8 +353,123 @@ void SystemController::OnEnterDegraded()
 
 void SystemController::OnEnterFault()
 {
-  Serial.println("FAULT: System halted");
   uiController_.EnqueueMessage(UiMessage::MakeShowFault());
   uiController_.EnqueueMessage(UiMessage::MakeShowLog());
   uiController_.EnqueueMessage(UiMessage::MakeAddLog("FAULT: System halted"));
 }
+
+void SystemController::ReportClusterDrift_()
+{
+  const bool drifting = healthMonitor_.IsDrifting(Cluster_CANID);
+  if (drifting == clusterDrifting_)
+  {
+    return;
+  }
+  clusterDrifting_ = drifting;
+
+  HealthMonitor::PeriodStats stats;
+  if (!healthMonitor_.GetPeriodStats(Cluster_CANID, stats))
+  {
+    return;
+  }
+  char line[96];
+  snprintf(line, sizeof(line), "%s: Cluster period %lu us (nominal %lu us)",
+           drifting ? "WARNING" : "OK",
+           static_cast<unsigned long>(stats.ewmaPeriodUs),
+           static_cast<unsigned long>(stats.expectedPeriodUs));
+  Serial.println(line);
+  uiController_.EnqueueMessage(UiMessage::MakeAddLog(line));
+}
+
+void SystemController::ReportBusLoad_()
+{
+  CAN_BUSLOAD_STATS stats;
+  canInterface_.GetBusLoad(stats);
+
+  // Loads are in 0.01 % units; print as fixed point to avoid float formatting
+  char line[96];
+  snprintf(line, sizeof(line), "CAN load %u.%02u%% 1s %u.%02u%% 10s %u.%02u%% peak1s %u.%02u%%",
+           stats.load100ms / 100U, stats.load100ms % 100U,
+           stats.load1s / 100U, stats.load1s % 100U,
+           stats.load10s / 100U, stats.load10s % 100U,
+           stats.peak1s / 100U, stats.peak1s % 100U);
+  Serial.println(line);
+  uiController_.EnqueueMessage(UiMessage::MakeAddLog(line));
+
+  // Only while a TX load scenario sends filler frames
+  CanInterface::FillerStats filler;
+  canInterface_.GetFillerStats(filler);
+  if (filler.received != 0U)
+  {
+    snprintf(line, sizeof(line), "Filler rx %lu lost %lu reord %lu dup %lu",
+             static_cast<unsigned long>(filler.received), static_cast<unsigned long>(filler.lost),
+             static_cast<unsigned long>(filler.reordered), static_cast<unsigned long>(filler.duplicates));
+    Serial.println(line);
+  }
+}
+
+void SystemController::ReportRenderStats_()
+{
+  RenderStats stats;
+  uiController_.GetRenderStats(stats);
+  if (stats.windowMs == 0)
+  {
+    return;
+  }
+
+  // Serial only: logging to the UI would itself cause the redraws being measured
+  char line[160];
+  snprintf(line, sizeof(line),
+           "[UI] %lums: writes %lu skipped %lu inval %lu redraw %lu flush %lu px %lu flushUs %lu waitUs %lu "
+           "frames %lu avgUs %lu maxUs %lu",
+           static_cast<unsigned long>(stats.windowMs),
+           static_cast<unsigned long>(stats.widgetWrites),
+           static_cast<unsigned long>(stats.widgetSkips),
+           static_cast<unsigned long>(stats.invalidations),
+           static_cast<unsigned long>(stats.redraws),
+           static_cast<unsigned long>(stats.flushes),
+           static_cast<unsigned long>(stats.flushedPixels),
+           static_cast<unsigned long>(stats.flushUs),
+           static_cast<unsigned long>(stats.flushWaitUs),
+           static_cast<unsigned long>(stats.frames),
+           static_cast<unsigned long>(stats.frames != 0 ? stats.frameUs / stats.frames : 0U),
+           static_cast<unsigned long>(stats.maxFrameUs));
+  Serial.println(line);
+
+  // UI task CPU share in 0.01 % units, and data-enqueue-to-rendered-frame latency
+  const uint32_t cpu = static_cast<uint32_t>((static_cast<uint64_t>(stats.busyUs) * 10U) / stats.windowMs);
+  snprintf(line, sizeof(line), "[UI] cpu %lu.%02lu%% wakeups %lu latency avg %lu us max %lu us (%lu samples)",
+           static_cast<unsigned long>(cpu / 100U), static_cast<unsigned long>(cpu % 100U),
+           static_cast<unsigned long>(stats.wakeups),
+           static_cast<unsigned long>(stats.latencySamples != 0 ? stats.latencySumUs / stats.latencySamples : 0U),
+           static_cast<unsigned long>(stats.latencyMaxUs),
+           static_cast<unsigned long>(stats.latencySamples));
+  Serial.println(line);
+}
+
+void SystemController::ReportUiTelemetry_()
+{
+  MessageRouter::UiTelemetry t;
+  if (!uiController_.GetTelemetry(t) || t.windowMs == 0)
+  {
+    return;
+  }
+  messageRouter_.PublishUiTelemetry(t, Clock::NowMs());
+
+  // LVGL heap sizing (LV_MEM_SIZE) and per-frame/per-flush cost (draw buffer sizing)
+  const uint32_t fpsX10 = (t.frames * 10000U) / t.windowMs;
+  char line[192];
+  snprintf(line, sizeof(line),
+           "[LVGL] mem used %lu/%lu B (%u%%) max %lu free-biggest %lu frag %u%% | fps %lu.%lu frame avg %lu max %lu us"
+           " | flush %lu avg %lu max %lu us %lu px/flush | inval px %lu",
+           static_cast<unsigned long>(t.memTotal - t.memFree), static_cast<unsigned long>(t.memTotal),
+           static_cast<unsigned>(t.memUsedPct), static_cast<unsigned long>(t.memMaxUsed),
+           static_cast<unsigned long>(t.memFreeBiggest), static_cast<unsigned>(t.memFragPct),
+           static_cast<unsigned long>(fpsX10 / 10U), static_cast<unsigned long>(fpsX10 % 10U),
+           static_cast<unsigned long>(t.frameUsAvg), static_cast<unsigned long>(t.frameUsMax),
+           static_cast<unsigned long>(t.flushes), static_cast<unsigned long>(t.flushUsAvg),
+           static_cast<unsigned long>(t.flushUsMax),
+           static_cast<unsigned long>(t.flushes != 0U ? t.flushedPixels / t.flushes : 0U),
+           static_cast<unsigned long>(t.invalidatedPixels));
+  Serial.println(line);
+}
@@ -3,7 +3,10 @@
  * @brief Top-level state machine coordinating RX boot, UI, CAN consumption, and health.
  *
  * States: Boot → DisplayInit → WaitingForData → Active ⇄ Degraded → Fault.
- * Transitions are event-driven via EventQueue, with automatic recovery on fresh frames.
+ * Transitions are event-driven via EventQueue and looked up in a constexpr
+ * [state][event] table (guard, target, action; SystemTransitions.h) that is
+ * checked at compile time for unspecified cells and unreachable states. Each transition is recorded in a
+ * fixed trace ring; serial output is drained from Update() when the UART has room.
  */
 #ifndef SYSTEM_CONTROLLER_H
 #define SYSTEM_CONTROLLER_H
@@ -12,19 +15,10 @@
 #include "CanInterface.h"
 #include "UiController.h"
 #include "HealthMonitor.h"
+#include "BootOrchestrator.h"
+#include "SystemTransitions.h"
 #include "common/MessageRouter.h"
 
-/** Enumerates high-level runtime states. */
-enum class SystemState : uint8_t
-{
-  Boot,
-  DisplayInit,
-  WaitingForData,
-  Active,
-  Degraded,
-  Fault
-};
-
 /**
  * @class SystemController
  * @brief Drives the main RX control flow by consuming EventQueue and publishing to MessageRouter.
@@ -36,7 +30,12 @@ public:
                    UiController& uiController, HealthMonitor& healthMonitor,
                    MessageRouter& messageRouter);
 
-  /** Run one-time boot sequence (display, driver init). */
+  /**
+   * @brief Run the boot sequence: start the UI task, then bring up CAN concurrently.
+   *
+   * Returns once CAN is up; display/LVGL/touch/UI readiness arrives later as InitOk
+   * events from the UI task. Frames received meanwhile already reach the router.
+   */
   bool RunBootSequence();
   /** Handle a single event. Non-blocking; may transition state. */
   void Dispatch(const Event& event);
@@ -44,23 +43,51 @@ public:
   void Update();
   /** Current state accessor. */
   SystemState GetState() const { return currentState_; }
+  /** Print the transition trace (oldest first) to Serial; also bound to serial key 'T'. */
+  void DumpTrace() const;
 
 private:
-  void TransitionTo(SystemState newState);
+  /** One recorded transition; 8 bytes so the ring stays small. */
+  struct TraceEntry
+  {
+    uint32_t tsMs;
+    uint8_t from;   // SystemState
+    uint8_t to;     // SystemState
+    uint8_t cause;  // EventType
+  };
+  static constexpr uint32_t kTraceDepth_ = 32; // power of two keeps the modulo cheap
+
+  typedef void (SystemController::*EnterHandler)();
+  static const EnterHandler kEnterHandlers_[];
+
+  static void BootStepCb_(Subsystem sys, bool ok, uint32_t startUs, uint32_t endUs, void* ctx);
+  bool GuardPasses_(TransitionGuard guard) const;
+  void TransitionTo(SystemState newState, EventType cause);
+  void FlushTrace_();
+  void HandleSerialCommand_();
   void OnEnterBoot();
   void OnEnterDisplayInit();
   void OnEnterWaitingForData();
   void OnEnterActive();
   void OnEnterDegraded();
   void OnEnterFault();
+  void ReportClusterDrift_();
+  void ReportBusLoad_();
+  void ReportRenderStats_();
+  void ReportUiTelemetry_();
 
   EventQueue& eventQueue_;
   CanInterface& canInterface_;
   UiController& uiController_;
   HealthMonitor& healthMonitor_;
   MessageRouter& messageRouter_;
+  BootOrchestrator bootOrchestrator_;
   SystemState currentState_;
-  uint8_t bootStepsCompleted_;
+  bool clusterDrifting_;
+  uint32_t nextBusLoadReportMs_;
+  TraceEntry trace_[kTraceDepth_];
+  uint32_t traceCount_;   // total transitions recorded
+  uint32_t traceFlushed_; // transitions already printed by FlushTrace_()
 };
 
 #endif // SYSTEM_CONTROLLER_H
@@ -0,0 +1,147 @@
+#include "SystemTransitions.h"
+
+namespace
+{
+constexpr std::size_t kStateCount = SystemTransitions::kStateCount;
+constexpr std::size_t kEventCount = SystemTransitions::kEventCount;
+
+using S = SystemState;
+using G = TransitionGuard;
+using A = TransitionAction;
+
+constexpr SystemTransition kTransitions[kStateCount][kEventCount] = {
+  // Boot
+  {
+    /* InitOk         */ {G::CanReady, S::DisplayInit, A::None},
+    /* InitFail       */ {G::Always, S::Fault, A::None},
+    /* ClusterFrame   */ {G::Always, S::Boot, A::ConsumeFrame},
+    /* FrameTimeout   */ {G::Ignore, S::Boot, A::None},
+    /* FrameRecovered */ {G::Ignore, S::Boot, A::None},
+    /* Error          */ {G::Always, S::Fault, A::None},
+  },
+  // DisplayInit: CAN is up, display/LVGL/touch/UI still coming up in the UI task
+  {
+    /* InitOk         */ {G::BootComplete, S::WaitingForData, A::None},
+    /* InitFail       */ {G::Always, S::Fault, A::None},
+    /* ClusterFrame   */ {G::Always, S::Active, A::ConsumeFrame}, // CAN is up; don't wait for the display
+    /* FrameTimeout   */ {G::Ignore, S::DisplayInit, A::None},
+    /* FrameRecovered */ {G::Ignore, S::DisplayInit, A::None},
+    /* Error          */ {G::Always, S::Fault, A::None},
+  },
+  // WaitingForData
+  {
+    /* InitOk         */ {G::Always, S::WaitingForData, A::None},
+    /* InitFail       */ {G::Always, S::Fault, A::None},
+    /* ClusterFrame   */ {G::Always, S::Active, A::ConsumeFrame},
+    /* FrameTimeout   */ {G::Ignore, S::WaitingForData, A::None},
+    /* FrameRecovered */ {G::Ignore, S::WaitingForData, A::None},
+    /* Error          */ {G::Always, S::Fault, A::None},
+  },
+  // Active
+  {
+    /* InitOk         */ {G::Always, S::Active, A::None},
+    /* InitFail       */ {G::Always, S::Fault, A::None},
+    /* ClusterFrame   */ {G::Always, S::Active, A::ConsumeFrame},
+    /* FrameTimeout   */ {G::Always, S::Degraded, A::None},
+    /* FrameRecovered */ {G::Ignore, S::Active, A::None},
+    /* Error          */ {G::Always, S::Fault, A::None},
+  },
+  // Degraded: leave only on FrameRecovered (K on-time frames), not on the first frame
+  {
+    /* InitOk         */ {G::Always, S::Degraded, A::None},
+    /* InitFail       */ {G::Always, S::Fault, A::None},
+    /* ClusterFrame   */ {G::Always, S::Degraded, A::ConsumeFrame},
+    /* FrameTimeout   */ {G::Ignore, S::Degraded, A::None},
+    /* FrameRecovered */ {G::Always, S::Active, A::None},
+    /* Error          */ {G::Always, S::Fault, A::None},
+  },
+  // Fault: terminal, but keep publishing data for diagnostics
+  {
+    /* InitOk         */ {G::Always, S::Fault, A::None},
+    /* InitFail       */ {G::Ignore, S::Fault, A::None},
+    /* ClusterFrame   */ {G::Always, S::Fault, A::ConsumeFrame},
+    /* FrameTimeout   */ {G::Ignore, S::Fault, A::None},
+    /* FrameRecovered */ {G::Ignore, S::Fault, A::None},
+    /* Error          */ {G::Ignore, S::Fault, A::None},
+  },
+};
+
+// Compile-time checks (C++11 constexpr: single expression, recursion for loops)
+constexpr const SystemTransition& Cell(std::size_t i)
+{
+  return kTransitions[i / kEventCount][i % kEventCount];
+}
+
+// Every cell filled in, and Ignore cells stay in their own state
+constexpr bool AllCellsSpecified(std::size_t i = 0)
+{
+  return (i == kStateCount * kEventCount) ||
+         ((Cell(i).guard != G::Unspecified) &&
+          (Cell(i).guard != G::Ignore || static_cast<std::size_t>(Cell(i).target) == i / kEventCount) &&
+          AllCellsSpecified(i + 1));
+}
+
+// Bitmask of states entered from any state in `mask`
+constexpr uint32_t Successors(uint32_t mask, std::size_t i = 0)
+{
+  return (i == kStateCount * kEventCount)
+             ? 0U
+             : ((((mask >> (i / kEventCount)) & 1U) != 0U && Cell(i).guard != G::Ignore
+                     ? (1U << static_cast<uint32_t>(Cell(i).target))
+                     : 0U) |
+                Successors(mask, i + 1));
+}
+
+// Fixpoint of the successor relation, starting from Boot
+constexpr uint32_t Reachable(uint32_t mask = 1U, std::size_t rounds = kStateCount)
+{
+  return (rounds == 0) ? mask : Reachable(mask | Successors(mask), rounds - 1);
+}
+
+static_assert(kStateCount <= 32, "state bitmask is 32 bits wide");
+static_assert(AllCellsSpecified(), "every (state, event) pair needs an explicit transition cell");
+static_assert(Reachable() == (1U << kStateCount) - 1U, "every SystemState must be reachable from Boot");
+
+// Human-readable names for the trace and the serial lines expected by TESTING_GUIDE
+constexpr const char* kStateNames[kStateCount] = {
+  "Boot", "DisplayInit", "WaitingForData", "Active", "Degraded", "Fault"
+};
+constexpr const char* kEventNames[kEventCount] = {
+  "InitOk", "InitFail", "ClusterFrame", "FrameTimeout", "FrameRecovered", "Error"
+};
+constexpr const char* kEnterMessages[kStateCount] = {
+  "System booting...",
+  "Initializing display...",
+  "Waiting for CAN data...",
+  "System active",
+  "WARNING: Stale data detected",
+  "FAULT: System halted"
+};
+}
+
+bool SystemTransitions::Lookup(SystemState state, EventType event, SystemTransition& out)
+{
+  const std::size_t eventIdx = static_cast<std::size_t>(event);
+  if (eventIdx >= kEventCount)
+  {
+    return false;
+  }
+  out = kTransitions[static_cast<std::size_t>(state)][eventIdx];
+  return true;
+}
+
+const char* SystemTransitions::StateName(SystemState state)
+{
+  return kStateNames[static_cast<std::size_t>(state)];
+}
+
+const char* SystemTransitions::EventName(EventType event)
+{
+  const std::size_t eventIdx = static_cast<std::size_t>(event);
+  return (eventIdx < kEventCount) ? kEventNames[eventIdx] : "?";
+}
+
+const char* SystemTransitions::EnterMessage(SystemState state)
+{
+  return kEnterMessages[static_cast<std::size_t>(state)];
+}
@@ -0,0 +1,83 @@
+/**
+ * @file SystemTransitions.h
+ * @brief RX state machine transition table, independent of the subsystems it drives.
+ *
+ * The [state][event] table (guard, target, action) SystemController dispatches
+ * through, plus the state/event names used by its trace and serial lines. It
+ * has no FreeRTOS, CAN or UI dependencies, so host scenarios step the same
+ * table the board runs; SystemController keeps guard evaluation, entry
+ * handlers and the trace ring.
+ */
+#ifndef SYSTEM_TRANSITIONS_H
+#define SYSTEM_TRANSITIONS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "EventQueue.h"
+
+/** Enumerates high-level runtime states (keep Fault last; the transition table is sized from it). */
+enum class SystemState : uint8_t
+{
+  Boot,
+  DisplayInit,
+  WaitingForData,
+  Active,
+  Degraded,
+  Fault
+};
+
+/**
+ * One cell per (state, event). If the guard fails the event is dropped in this state;
+ * if it passes the target state is entered and then the cell's action runs.
+ */
+enum class TransitionGuard : uint8_t
+{
+  Unspecified = 0, // value-initialized cells; rejected at compile time
+  Ignore,          // event has no effect in this state
+  Always,          // enter target, run action
+  CanReady,        // BootOrchestrator reports CAN ready
+  BootComplete     // BootOrchestrator reports every subsystem ready
+};
+
+enum class TransitionAction : uint8_t
+{
+  None,
+  ConsumeFrame
+};
+
+struct SystemTransition
+{
+  TransitionGuard guard;
+  SystemState target;
+  TransitionAction action;
+};
+
+/**
+ * @class SystemTransitions
+ * @brief Static accessors for the transition table and its names.
+ */
+class SystemTransitions
+{
+public:
+  static constexpr std::size_t kStateCount = static_cast<std::size_t>(SystemState::Fault) + 1;
+  static constexpr std::size_t kEventCount = static_cast<std::size_t>(EventType::Error) + 1;
+
+  /**
+   * @brief Cell for @p event in @p state.
+   * @return false (and @p out untouched) for an event type outside the table.
+   */
+  static bool Lookup(SystemState state, EventType event, SystemTransition& out);
+
+  /** Relay outputs are live only while data is consumed (Active or Degraded). */
+  static bool OutputsEnabled(SystemState state)
+  {
+    return (state == SystemState::Active) || (state == SystemState::Degraded);
+  }
+
+  static const char* StateName(SystemState state);
+  static const char* EventName(EventType event);
+  /** Serial / UI log line printed when @p state is entered (expected by TESTING_GUIDE). */
+  static const char* EnterMessage(SystemState state);
+};
+
+#endif // SYSTEM_TRANSITIONS_H
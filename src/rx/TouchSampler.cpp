@@ -0,0 +1,177 @@
+#include "TouchSampler.h"
+#include <Arduino.h>
+
+namespace
+{
+constexpr uint32_t kPressedBit = 1UL << 31;
+
+int16_t Median3(int16_t a, int16_t b, int16_t c)
+{
+  if (a > b) { const int16_t t = a; a = b; b = t; }
+  if (b > c) { b = c; }
+  return (a > b) ? a : b;
+}
+}
+
+TouchSampler::TouchSampler()
+  : latest_(0)
+{
+  for (uint8_t i = 0; i < kMedianLen_; ++i)
+  {
+    medX_[i] = 0;
+    medY_[i] = 0;
+  }
+}
+
+bool TouchSampler::Start(NS2009* ts, int irqPin, UBaseType_t priority, uint16_t stackWords, BaseType_t coreId)
+{
+  if (ts == nullptr) return false;
+  if (taskHandle_ != nullptr) return true;
+  ts_ = ts;
+  irqPin_ = irqPin;
+
+  const BaseType_t ok = xTaskCreatePinnedToCore(TaskEntry_, "touch_task", stackWords, this, priority,
+                                                &taskHandle_, coreId);
+  if (ok != pdPASS)
+  {
+    taskHandle_ = nullptr;
+    return false;
+  }
+  if (irqPin_ >= 0)
+  {
+    pinMode(irqPin_, INPUT_PULLUP);
+    attachInterruptArg(static_cast<uint8_t>(irqPin_), PenIrqIsr_, this, FALLING);
+  }
+  return true;
+}
+
+TouchSampler::Point TouchSampler::Latest() const
+{
+  const uint32_t packed = latest_.load(std::memory_order_acquire);
+  Point p;
+  p.x = static_cast<int16_t>(packed & 0xFFFFU);
+  p.y = static_cast<int16_t>((packed >> 16) & 0x7FFFU);
+  p.pressed = (packed & kPressedBit) != 0U;
+  return p;
+}
+
+void TouchSampler::Publish_(int16_t x, int16_t y, bool pressed)
+{
+  const uint32_t packed = (static_cast<uint32_t>(static_cast<uint16_t>(x))) |
+                          (static_cast<uint32_t>(static_cast<uint16_t>(y) & 0x7FFFU) << 16) |
+                          (pressed ? kPressedBit : 0U);
+  latest_.store(packed, std::memory_order_release);
+}
+
+void IRAM_ATTR TouchSampler::PenIrqIsr_(void* arg)
+{
+  TouchSampler* self = static_cast<TouchSampler*>(arg);
+  BaseType_t higherPriorityTaskWoken = pdFALSE;
+  vTaskNotifyGiveFromISR(self->taskHandle_, &higherPriorityTaskWoken);
+  portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+void TouchSampler::TaskEntry_(void* pv)
+{
+  TouchSampler* self = static_cast<TouchSampler*>(pv);
+  if (self != nullptr)
+  {
+    self->TaskLoop_();
+  }
+  vTaskDelete(nullptr);
+}
+
+void TouchSampler::TaskLoop_()
+{
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;)
+  {
+    Sample_();
+    if (pressed_)
+    {
+      vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kPressedPeriodMs_));
+    }
+    else if (irqPin_ >= 0)
+    {
+      // Released: sleep until the pen IRQ fires (edges seen while sampling are discarded)
+      ulTaskNotifyTake(pdTRUE, 0);
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kIrqTimeoutMs_));
+      lastWake = xTaskGetTickCount();
+    }
+    else
+    {
+      vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kIdlePollMs_));
+    }
+  }
+}
+
+void TouchSampler::Sample_()
+{
+  ts_->CheckTouched();
+  const int z = ts_->RawZ;
+  const bool down = pressed_ ? (z >= kReleaseZ_) : (z > THRESHOLD_Z);
+
+  if (!down)
+  {
+    if (pressed_)
+    {
+      // LVGL expects the release at the last pressed position
+      pressed_ = false;
+      Publish_(lastX_, lastY_, false);
+    }
+    return;
+  }
+
+  ts_->ScanXY();
+  const int16_t x = static_cast<int16_t>(ts_->X);
+  const int16_t y = static_cast<int16_t>(ts_->Y);
+  if (!pressed_)
+  {
+    // Touch-down: the first conversions are still settling, drop them
+    pressed_ = true;
+    settle_ = kSettleSamples_;
+    filterPrimed_ = false;
+  }
+  if (settle_ > 0U)
+  {
+    --settle_;
+    return;
+  }
+  if (!filterPrimed_)
+  {
+    FilterReset_(x, y);
+    filterPrimed_ = true;
+  }
+
+  int16_t fx, fy;
+  Filter_(x, y, fx, fy);
+  lastX_ = fx;
+  lastY_ = fy;
+  Publish_(fx, fy, true);
+}
+
+void TouchSampler::FilterReset_(int16_t x, int16_t y)
+{
+  for (uint8_t i = 0; i < kMedianLen_; ++i)
+  {
+    medX_[i] = x;
+    medY_[i] = y;
+  }
+  medIdx_ = 0;
+  iirX_ = static_cast<int32_t>(x) << 4;
+  iirY_ = static_cast<int32_t>(y) << 4;
+}
+
+void TouchSampler::Filter_(int16_t x, int16_t y, int16_t& outX, int16_t& outY)
+{
+  static_assert(kMedianLen_ == 3, "Filter_ uses Median3");
+  medX_[medIdx_] = x;
+  medY_[medIdx_] = y;
+  medIdx_ = static_cast<uint8_t>((medIdx_ + 1U) % kMedianLen_);
+  const int32_t mx = Median3(medX_[0], medX_[1], medX_[2]);
+  const int32_t my = Median3(medY_[0], medY_[1], medY_[2]);
+  iirX_ += ((mx << 4) - iirX_) >> kIirShift_;
+  iirY_ += ((my << 4) - iirY_) >> kIirShift_;
+  outX = static_cast<int16_t>((iirX_ + 8) >> 4);
+  outY = static_cast<int16_t>((iirY_ + 8) >> 4);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file TouchSampler.h
+ * @brief NS2009 touch sampling task with filtering and a lock-free latest point.
+ *
+ * NS2009 reads are blocking I2C round trips. Doing them in LVGL's input read
+ * callback puts them on the UI task on every lv_timer_handler() pass. This
+ * task samples the controller instead: at a fixed rate while the panel is
+ * pressed, and otherwise either waiting for the pen IRQ (TOUCH_IRQ_PIN) or
+ * polling Z at a slower idle rate. Coordinates go through a 3-sample median
+ * (rejects single-sample spikes) and a first-order IIR; press/release use a
+ * pressure threshold with hysteresis. The result is packed into one 32-bit
+ * atomic, so readers on any task get a consistent point without locking.
+ */
+#ifndef TOUCH_SAMPLER_H
+#define TOUCH_SAMPLER_H
+
+#include <atomic>
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <NS2009.h>
+
+// GPIO wired to the NS2009 PENIRQ output (active low); -1 polls Z instead
+#ifndef TOUCH_IRQ_PIN
+#define TOUCH_IRQ_PIN -1
+#endif
+
+/**
+ * @class TouchSampler
+ * @brief Owns all I2C access to the touch controller once started.
+ */
+class TouchSampler
+{
+public:
+  /** Filtered touch state in controller coordinates (NS2009 X/Y after calibration). */
+  struct Point
+  {
+    int16_t x;
+    int16_t y;
+    bool pressed;
+  };
+
+  TouchSampler();
+
+  /**
+   * @brief Start the sampling task; @p ts must be calibrated already.
+   * @param irqPin PENIRQ GPIO, or -1 to poll while released.
+   * @return true if the task is running.
+   */
+  bool Start(NS2009* ts, int irqPin = TOUCH_IRQ_PIN, UBaseType_t priority = 3,
+             uint16_t stackWords = 2048, BaseType_t coreId = tskNO_AFFINITY);
+
+  /** Latest filtered point; lock-free, safe from any task. */
+  Point Latest() const;
+
+private:
+  static void TaskEntry_(void* pv);
+  static void PenIrqIsr_(void* arg);
+  void TaskLoop_();
+  void Sample_();
+  void Publish_(int16_t x, int16_t y, bool pressed);
+  void FilterReset_(int16_t x, int16_t y);
+  void Filter_(int16_t x, int16_t y, int16_t& outX, int16_t& outY);
+
+  static constexpr uint32_t kPressedPeriodMs_ = 10;   // 100 Hz while touched
+  static constexpr uint32_t kIdlePollMs_ = 20;        // Z polling without PENIRQ
+  static constexpr uint32_t kIrqTimeoutMs_ = 1000;    // re-check Z if an IRQ edge was missed
+  static constexpr int kReleaseZ_ = THRESHOLD_Z * 3 / 4; // press above THRESHOLD_Z, release below this
+  static constexpr uint8_t kSettleSamples_ = 1;       // XY samples dropped after touch-down
+  static constexpr uint8_t kMedianLen_ = 3;
+  static constexpr uint8_t kIirShift_ = 1;            // new = old + (in - old) / 2
+
+  NS2009* ts_ = nullptr;
+  int irqPin_ = -1;
+  TaskHandle_t taskHandle_ = nullptr;
+
+  // bit 31 pressed, bits 16..30 y, bits 0..15 x
+  std::atomic<uint32_t> latest_;
+
+  // Sampling task state only
+  bool pressed_ = false;
+  uint8_t settle_ = 0;
+  bool filterPrimed_ = false;
+  int16_t medX_[kMedianLen_];
+  int16_t medY_[kMedianLen_];
+  uint8_t medIdx_ = 0;
+  int32_t iirX_ = 0; // Q4
+  int32_t iirY_ = 0; // Q4
+  int16_t lastX_ = 0;
+  int16_t lastY_ = 0;
+};
+
+#endif // TOUCH_SAMPLER_H
@@ -1,10 +1,12 @@
 #include "UiController.h"
 #include <Arduino.h>
+#include "Clock.h"
 #include <cstring>
 
 UiController::UiController() 
-  : lvglDisplay_(nullptr), degradedLabel_(nullptr), faultLabel_(nullptr)
+  : lvglDisplay_(nullptr)
 {
+  portMUX_INITIALIZE(&telemetryMux_);
 }
 
 bool UiController::Init()
@@ -13,8 +15,22 @@ bool UiController::Init()
   return true;
 }
 
+void UiController::SetBootStepCallback(BootStepCb cb, void* ctx)
+{
+  bootStepCb_ = cb;
+  bootStepCtx_ = ctx;
+}
+
+void UiController::ReportBootStep_(Subsystem sys, bool ok, uint32_t startUs)
+{
+  if (bootStepCb_ != nullptr)
+  {
+    bootStepCb_(sys, ok, startUs, Clock::NowUs(), bootStepCtx_);
+  }
+}
+
 bool UiController::StartTask(uint16_t dataQueueLen, uint16_t msgQueueLen,
-                             UBaseType_t priority, uint16_t stackWords)
+                             UBaseType_t priority, uint16_t stackWords, BaseType_t coreId)
 {
   // Create queues
   if (uiDataQueue_ == nullptr)
@@ -31,11 +47,11 @@ bool UiController::StartTask(uint16_t dataQueueLen, uint16_t msgQueueLen,
     return false;
   }
 
-  // Spawn task pinned (core selection left to scheduler)
+  // Spawn task (core selection left to scheduler unless coreId is given)
   if (uiTaskHandle_ == nullptr)
   {
-    BaseType_t ok = xTaskCreate(
-      UiTaskEntry_, "ui_task", stackWords, this, priority, &uiTaskHandle_);
+    BaseType_t ok = xTaskCreatePinnedToCore(
+      UiTaskEntry_, "ui_task", stackWords, this, priority, &uiTaskHandle_, coreId);
     return ok == pdPASS;
   }
 
@@ -45,117 +61,72 @@ bool UiController::StartTask(uint16_t dataQueueLen, uint16_t msgQueueLen,
 bool UiController::EnqueueUiData(const UiData& data)
 {
   if (uiDataQueue_ == nullptr) return false;
+  UiData stamped = data;
+  stamped.enqueueUs = Clock::NowUs();
+  bool ok;
   // Use overwrite semantics if queue length == 1
   if (uxQueueSpacesAvailable(uiDataQueue_) == 0)
   {
     // queue full: overwrite last item
-    return xQueueOverwrite(uiDataQueue_, &data) == pdTRUE;
+    ok = xQueueOverwrite(uiDataQueue_, &stamped) == pdTRUE;
   }
-  return xQueueSend(uiDataQueue_, &data, 0) == pdTRUE;
+  else
+  {
+    ok = xQueueSend(uiDataQueue_, &stamped, 0) == pdTRUE;
+  }
+  // The UI task sleeps until notified or an LVGL timer / blink edge is due
+  if (ok && uiTaskHandle_ != nullptr) xTaskNotifyGive(uiTaskHandle_);
+  return ok;
 }
 
 bool UiController::EnqueueMessage(const UiMessage& msg)
 {
   if (uiMsgQueue_ == nullptr) return false;
-  return xQueueSend(uiMsgQueue_, &msg, 0) == pdTRUE;
+  const bool ok = xQueueSend(uiMsgQueue_, &msg, 0) == pdTRUE;
+  if (ok && uiTaskHandle_ != nullptr) xTaskNotifyGive(uiTaskHandle_);
+  return ok;
 }
 
 void UiController::ApplyCluster(const Cluster_t& cluster)
 {
   // Hide degraded warning when receiving valid data
-  if (degradedLabel_ != nullptr)
-  {
-    lv_obj_add_flag(degradedLabel_, LV_OBJ_FLAG_HIDDEN);
-  }
-
-  // Update speed gauge
-  if (ui_Arc1 != nullptr)
-  {
-    const uint16_t arcValue = ConvertSpeedToArcValue(cluster.speed);
-    lv_arc_set_value(ui_Arc1, static_cast<int32_t>(arcValue));
-  }
-
-  // Update left turn indicator
-  if (ui_LeftTurnLabel != nullptr)
-  {
-    const uint8_t leftAlpha = cluster.Left_Turn_Signal ? kOpacityOn : kOpacityOff;
-    lv_obj_set_style_text_opa(ui_LeftTurnLabel, leftAlpha, LV_PART_MAIN | LV_STATE_DEFAULT);
-  }
-
-  // Update right turn indicator
-  if (ui_RightTurnLabel != nullptr)
-  {
-    const uint8_t rightAlpha = cluster.Right_Turn_Signal ? kOpacityOn : kOpacityOff;
-    lv_obj_set_style_text_opa(ui_RightTurnLabel, rightAlpha, LV_PART_MAIN | LV_STATE_DEFAULT);
-  }
+  view_.HideDegraded();
+  UiData data{ConvertSpeedToArcValue(cluster.speed), static_cast<bool>(cluster.Left_Turn_Signal),
+              static_cast<bool>(cluster.Right_Turn_Signal), 0};
+  view_.ApplyData(data, Clock::NowMs());
+  // Legacy path has no animation or blink loop: jump the arc, show active indicators steadily
+  view_.FinishAnimations();
+  view_.UpdateBlink(data, 0);
 }
 
 void UiController::ShowDegraded()
 {
-  if (degradedLabel_ != nullptr)
-  {
-    lv_obj_clear_flag(degradedLabel_, LV_OBJ_FLAG_HIDDEN);
-  }
+  view_.ShowDegraded();
 }
 
 void UiController::ShowFault()
 {
-  if (faultLabel_ != nullptr)
-  {
-    lv_obj_clear_flag(faultLabel_, LV_OBJ_FLAG_HIDDEN);
-  }
+  view_.ShowFault();
 }
 
 void UiController::ShowDashboardScreen()
 {
-  // Load the main dashboard screen (Screen1)
-  if (ui_Screen1 != nullptr)
-  {
-    lv_disp_load_scr(ui_Screen1);
-  }
+  view_.ShowDashboardScreen();
 }
 
 void UiController::ShowLogScreen()
 {
-  // Load the log screen (Screen2) and ensure LogBox shows current lines
-  if (ui_Screen2 != nullptr)
-  {
-    lv_disp_load_scr(ui_Screen2);
-    UpdateLogBox_();
-  }
+  view_.ShowLogScreen();
 }
 
 void UiController::AddLogLine(const char* line)
 {
-  if (line == nullptr) return;
-  AddLogLine(std::string(line));
+  view_.AddLogLine(line);
 }
 
 void UiController::AddLogLine(const std::string& line)
 {
-  if (line.empty()) return;
-  // Maintain ring buffer up to kMaxLogLines_
-  if (logLines_.size() >= kMaxLogLines_)
-  {
-    logLines_.pop_front();
-  }
-  logLines_.push_back(line);
-  UpdateLogBox_();
-}
-
-void UiController::UpdateLogBox_()
-{
-  if (ui_LogBox == nullptr) return;
-
-  // Concatenate lines with newlines
-  std::string text;
-  text.reserve(256);
-  for (size_t i = 0; i < logLines_.size(); ++i)
-  {
-    text += logLines_[i];
-    if (i + 1 < logLines_.size()) text += '\n';
-  }
-  lv_textarea_set_text(ui_LogBox, text.c_str());
+  view_.AddLogLine(line.c_str());
 }
 
 void UiController::ServiceTimers()
@@ -175,15 +146,25 @@ void UiController::UiTaskEntry_(void* pv)
 
 void UiController::UiTaskLoop_()
 {
-  // Initialize LVGL, TFT, Touch, and UI in this task context
-  lv_init();
-  lv_tick_set_cb(LvglTickGetCb);
-
+  // Initialize TFT, LVGL, Touch, and UI in this task context. Each step is reported
+  // so the boot orchestrator can profile it while CAN comes up on the setup thread.
+  uint32_t stepStartUs = Clock::NowUs();
   tft.begin();
   tft.setRotation(3);
+#if UI_DISPLAY_DMA
+  // LVGL RGB565 is little endian, the panel wants big endian; the DMA path swaps in place.
+  // The UI task is the only SPI user, so the bus stays claimed for queued DMA transfers.
+  tft.setSwapBytes(true);
+  const bool displayOk = tft.initDMA();
+  tft.startWrite();
+#else
+  const bool displayOk = true;
+#endif
+  ReportBootStep_(Subsystem::Display, displayOk, stepStartUs);
 
-  // Calibrate touchscreen
-  TS.Calibrate(372, 3695, 501, 3838);
+  stepStartUs = Clock::NowUs();
+  lv_init();
+  lv_tick_set_cb(LvglTickGetCb);
 
   // Create LVGL display
   lvglDisplay_ = lv_display_create(screenWidth, screenHeight);
@@ -192,10 +173,33 @@ void UiController::UiTaskLoop_()
     lv_display_set_default(lvglDisplay_);
     lv_display_set_flush_cb(lvglDisplay_, DisplayFlushCb);
     lv_display_set_color_format(lvglDisplay_, LV_COLOR_FORMAT_RGB565);
-    lv_display_set_buffers(lvglDisplay_, buf, nullptr,
-                           lvglBufferSizePixels * sizeof(lv_color_t),
+#if UI_DISPLAY_DMA
+    // Render into one band while the other is on the wire; LVGL only blocks in
+    // DisplayFlushWaitCb_ when it needs the buffer that is still being sent.
+    lv_display_set_buffers(lvglDisplay_, drawBuf1, drawBuf2,
+                           lvglBufferSizePixels * sizeof(uint16_t),
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_wait_cb(lvglDisplay_, DisplayFlushWaitCb_);
+#else
+    lv_display_set_buffers(lvglDisplay_, drawBuf1, nullptr,
+                           lvglBufferSizePixels * sizeof(uint16_t),
                            LV_DISPLAY_RENDER_MODE_PARTIAL);
+#endif
+    // Flush and render hooks feed the per-second render statistics
+    lv_display_set_user_data(lvglDisplay_, this);
+    lv_display_add_event_cb(lvglDisplay_, DisplayEventCb_, LV_EVENT_INVALIDATE_AREA, this);
+    lv_display_add_event_cb(lvglDisplay_, DisplayEventCb_, LV_EVENT_RENDER_START, this);
+    lv_display_add_event_cb(lvglDisplay_, DisplayEventCb_, LV_EVENT_REFR_START, this);
+    lv_display_add_event_cb(lvglDisplay_, DisplayEventCb_, LV_EVENT_REFR_READY, this);
   }
+  ReportBootStep_(Subsystem::LVGL, lvglDisplay_ != nullptr, stepStartUs);
+
+  // Calibrate touchscreen
+  stepStartUs = Clock::NowUs();
+  TS.Calibrate(372, 3695, 501, 3838);
+
+  // Sample the touch controller in its own task from here on
+  const bool samplerOk = touchSampler_.Start(&TS);
 
   // Create LVGL input device (touchscreen)
   lv_indev_t* indev = lv_indev_create();
@@ -203,51 +207,30 @@ void UiController::UiTaskLoop_()
   {
     lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
     lv_indev_set_read_cb(indev, TouchpadReadCb);
+    lv_indev_set_user_data(indev, this);
     lv_indev_set_display(indev, lvglDisplay_);
   }
+  ReportBootStep_(Subsystem::Touch, indev != nullptr && samplerOk, stepStartUs);
 
   // Initialize generated UI
+  stepStartUs = Clock::NowUs();
   ui_init();
 
-  // Initialize UI widgets defaults
-  if (ui_LeftTurnLabel != nullptr)
-  {
-    lv_obj_set_style_text_opa(ui_LeftTurnLabel, kOpacityOff, LV_PART_MAIN | LV_STATE_DEFAULT);
-  }
-  if (ui_RightTurnLabel != nullptr)
-  {
-    lv_obj_set_style_text_opa(ui_RightTurnLabel, kOpacityOff, LV_PART_MAIN | LV_STATE_DEFAULT);
-  }
-  if (ui_Arc1 != nullptr)
-  {
-    lv_arc_set_value(ui_Arc1, 0);
-  }
-
-  // Create overlays
-  degradedLabel_ = lv_label_create(lv_screen_active());
-  if (degradedLabel_ != nullptr)
-  {
-    lv_label_set_text(degradedLabel_, "STALE DATA");
-    lv_obj_set_style_text_color(degradedLabel_, lv_color_hex(0xFFFF00), LV_PART_MAIN);
-    lv_obj_set_style_text_font(degradedLabel_, &lv_font_montserrat_20, LV_PART_MAIN);
-    lv_obj_align(degradedLabel_, LV_ALIGN_TOP_MID, 0, 10);
-    lv_obj_add_flag(degradedLabel_, LV_OBJ_FLAG_HIDDEN);
-  }
-  faultLabel_ = lv_label_create(lv_screen_active());
-  if (faultLabel_ != nullptr)
+  view_.Build();
+  if (UI_ARC_SPRITE && !view_.ArcSprite().Attached())
   {
-    lv_label_set_text(faultLabel_, "SYSTEM FAULT");
-    lv_obj_set_style_text_color(faultLabel_, lv_color_hex(0xFF0000), LV_PART_MAIN);
-    lv_obj_set_style_text_font(faultLabel_, &lv_font_montserrat_28, LV_PART_MAIN);
-    lv_obj_align(faultLabel_, LV_ALIGN_CENTER, 0, 0);
-    lv_obj_add_flag(faultLabel_, LV_OBJ_FLAG_HIDDEN);
+    char line[96];
+    snprintf(line, sizeof(line), "[UI] arc sprite cache off: %s", view_.ArcSprite().FailReason());
+    Serial.println(line);
   }
+  ReportBootStep_(Subsystem::UI, true, stepStartUs);
 
-  UiData latest{0, false, false};
-  const TickType_t tick5ms = pdMS_TO_TICKS(5);
+  UiData latest{0, false, false, 0};
 
   for (;;)
   {
+    const uint32_t wakeUs = Clock::NowUs();
+
     // Process any pending UI commands quickly
     UiMessage msg;
     while (uiMsgQueue_ && xQueueReceive(uiMsgQueue_, &msg, 0) == pdTRUE)
@@ -255,84 +238,63 @@ void UiController::UiTaskLoop_()
       HandleUiMessage_(msg);
     }
 
-    // Wait briefly for new data to refresh display
+    // Apply the newest data sample, if any arrived
     if (uiDataQueue_)
     {
       UiData incoming;
-      if (xQueueReceive(uiDataQueue_, &incoming, tick5ms) == pdTRUE)
+      if (xQueueReceive(uiDataQueue_, &incoming, 0) == pdTRUE)
       {
         latest = incoming; // overwrite latest sample
-        ApplyUiData_(latest);
+        view_.ApplyData(latest, Clock::NowMs());
       }
     }
 
-    // Run blink animation and LVGL timers
-    UpdateBlink_(latest);
-    lv_timer_handler();
+    // Run gauge/blink animations and LVGL timers
+    view_.Animate(Clock::NowMs());
+    view_.UpdateBlink(latest, Clock::NowMs());
+    const uint32_t lvglWaitMs = lv_timer_handler();
+    if (view_.Model().Roll(Clock::NowMs()))
+    {
+      SampleTelemetry_();
+    }
+    view_.Model().NoteBusy(Clock::NowUs() - wakeUs);
+
+    // Sleep until data/commands arrive (task notification) or timed work is due
+    TickType_t waitTicks = pdMS_TO_TICKS(NextWakeMs_(lvglWaitMs, latest));
+    if (waitTicks == 0) waitTicks = 1; // always yield to lower priority tasks
+    ulTaskNotifyTake(pdTRUE, waitTicks);
   }
 }
 
-void UiController::HandleUiMessage_(const UiMessage& msg)
+uint32_t UiController::NextWakeMs_(uint32_t lvglWaitMs, const UiData& data) const
 {
-  switch (msg.type)
+  // lv_timer_handler() returns LV_NO_TIMER_READY when no timer is armed
+  uint32_t waitMs = lvglWaitMs;
+  if (waitMs == LV_NO_TIMER_READY || waitMs > kMaxIdleWaitMs_)
   {
-    case UiMessageType::ShowDashboard:
-      ShowDashboardScreen();
-      break;
-    case UiMessageType::ShowLog:
-      ShowLogScreen();
-      break;
-    case UiMessageType::AddLogLine:
-      AddLogLine(msg.text);
-      break;
-    case UiMessageType::ShowDegraded:
-      ShowDegraded();
-      break;
-    case UiMessageType::ShowFault:
-      ShowFault();
-      break;
-    default:
-      break;
+    waitMs = kMaxIdleWaitMs_;
   }
+  // Wake exactly on the next blink phase edge
+  const uint32_t toEdgeMs = view_.MsToBlinkEdge(data, Clock::NowMs());
+  if (toEdgeMs < waitMs) waitMs = toEdgeMs;
+  // Wake for the next gauge animation frame while the arc is moving
+  const uint32_t toFrameMs = view_.MsToNextAnimation(Clock::NowMs());
+  if (toFrameMs < waitMs) waitMs = toFrameMs;
+  return waitMs;
 }
 
-void UiController::ApplyUiData_(const UiData& data)
+void UiController::HandleUiMessage_(const UiMessage& msg)
 {
-  // Update speed
-  if (ui_Arc1 != nullptr)
+  if (msg.type == UiMessageType::ForceRedraw)
   {
-    lv_arc_set_value(ui_Arc1, static_cast<int32_t>(data.speedArc));
-  }
-
-  // If not active, ensure indicators are off immediately
-  if (!data.leftActive && ui_LeftTurnLabel != nullptr)
-  {
-    lv_obj_set_style_text_opa(ui_LeftTurnLabel, kOpacityOff, LV_PART_MAIN | LV_STATE_DEFAULT);
-  }
-  if (!data.rightActive && ui_RightTurnLabel != nullptr)
-  {
-    lv_obj_set_style_text_opa(ui_RightTurnLabel, kOpacityOff, LV_PART_MAIN | LV_STATE_DEFAULT);
+    frameReportPending_ = true;
   }
+  view_.HandleMessage(msg);
 }
 
-void UiController::UpdateBlink_(const UiData& data)
+void UiController::GetRenderStats(RenderStats& out) const
 {
-  // Use a shared time-based phase so both indicators stay perfectly in sync
-  // when active at the same time, regardless of individual toggle history.
-  const uint32_t now = millis();
-  const bool phaseOn = ((now / kBlinkPeriodMs_) % 2U) == 0U;
-
-  if (ui_LeftTurnLabel != nullptr)
-  {
-    const uint8_t alpha = (data.leftActive && phaseOn) ? kOpacityOn : kOpacityOff;
-    lv_obj_set_style_text_opa(ui_LeftTurnLabel, alpha, LV_PART_MAIN | LV_STATE_DEFAULT);
-  }
-
-  if (ui_RightTurnLabel != nullptr)
-  {
-    const uint8_t alpha = (data.rightActive && phaseOn) ? kOpacityOn : kOpacityOff;
-    lv_obj_set_style_text_opa(ui_RightTurnLabel, alpha, LV_PART_MAIN | LV_STATE_DEFAULT);
-  }
+  view_.Model().GetLastWindow(out);
 }
 
 uint16_t UiController::ConvertSpeedToArcValue(uint16_t rawSpeed)
@@ -343,34 +305,143 @@ uint16_t UiController::ConvertSpeedToArcValue(uint16_t rawSpeed)
 
 uint32_t UiController::LvglTickGetCb()
 {
-  return static_cast<uint32_t>(millis());
+  return Clock::NowMs();
 }
 
 void UiController::DisplayFlushCb(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map)
 {
   const uint32_t w = static_cast<uint32_t>(lv_area_get_width(area));
   const uint32_t h = static_cast<uint32_t>(lv_area_get_height(area));
-
+  const uint32_t startUs = Clock::NowUs();
+
+#if UI_DISPLAY_DMA
+  // Queue the band and return; flush_ready is signalled once the transfer completed
+  // (DisplayFlushWaitCb_). pushImageDMA first waits for the previous band, if any.
+  tft.pushImageDMA(area->x1, area->y1, static_cast<int32_t>(w), static_cast<int32_t>(h),
+                   reinterpret_cast<uint16_t*>(px_map));
+#else
   tft.startWrite();
   tft.setAddrWindow(area->x1, area->y1, w, h);
   tft.pushColors(reinterpret_cast<uint16_t*>(px_map), w * h, true);
   tft.endWrite();
+#endif
 
+  UiController* self = static_cast<UiController*>(lv_display_get_user_data(disp));
+  if (self != nullptr)
+  {
+    self->view_.Model().NoteFlush(w * h, Clock::NowUs() - startUs);
+  }
+#if !UI_DISPLAY_DMA
   lv_display_flush_ready(disp);
+#endif
 }
 
-void UiController::TouchpadReadCb(lv_indev_t* indev, lv_indev_data_t* data)
+void UiController::DisplayFlushWaitCb_(lv_display_t* disp)
 {
-  const bool touched = TS.CheckTouched();
+  // Only called while a DMA transfer is in flight and LVGL needs its buffer back
+  const uint32_t startUs = Clock::NowUs();
+  tft.dmaWait();
+  UiController* self = static_cast<UiController*>(lv_display_get_user_data(disp));
+  if (self != nullptr)
+  {
+    self->view_.Model().NoteFlushWait(Clock::NowUs() - startUs);
+  }
+  lv_display_flush_ready(disp);
+}
 
-  if (!touched)
+void UiController::DisplayEventCb_(lv_event_t* e)
+{
+  UiController* self = static_cast<UiController*>(lv_event_get_user_data(e));
+  if (self == nullptr) return;
+  switch (lv_event_get_code(e))
+  {
+    case LV_EVENT_INVALIDATE_AREA:
+      self->view_.Model().NoteInvalidation(lv_area_get_size(static_cast<const lv_area_t*>(lv_event_get_param(e))));
+      break;
+    case LV_EVENT_RENDER_START:
+      self->view_.Model().NoteRedraw();
+      break;
+    case LV_EVENT_REFR_START:
+      self->view_.Model().NoteRefrStart(Clock::NowUs());
+      break;
+    case LV_EVENT_REFR_READY:
+      if (self->view_.Model().NoteRefrReady(Clock::NowUs()) && self->frameReportPending_)
+      {
+        self->frameReportPending_ = false;
+        self->PrintFrameTiming_();
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void UiController::SampleTelemetry_()
+{
+  RenderStats stats;
+  view_.Model().GetLastWindow(stats);
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+
+  MessageRouter::UiTelemetry t{};
+  t.windowMs = stats.windowMs;
+  t.memTotal = static_cast<uint32_t>(mon.total_size);
+  t.memFree = static_cast<uint32_t>(mon.free_size);
+  t.memFreeBiggest = static_cast<uint32_t>(mon.free_biggest_size);
+  t.memMaxUsed = static_cast<uint32_t>(mon.max_used);
+  t.memUsedPct = mon.used_pct;
+  t.memFragPct = mon.frag_pct;
+  t.frames = stats.frames;
+  t.frameUsAvg = (stats.frames != 0U) ? stats.frameUs / stats.frames : 0U;
+  t.frameUsMax = stats.maxFrameUs;
+  t.flushes = stats.flushes;
+  t.flushUsAvg = (stats.flushes != 0U) ? stats.flushUs / stats.flushes : 0U;
+  t.flushUsMax = stats.maxFlushUs;
+  t.invalidatedPixels = stats.invalidatedPixels;
+  t.flushedPixels = stats.flushedPixels;
+
+  portENTER_CRITICAL(&telemetryMux_);
+  telemetry_ = t;
+  haveTelemetry_ = true;
+  portEXIT_CRITICAL(&telemetryMux_);
+}
+
+bool UiController::GetTelemetry(MessageRouter::UiTelemetry& out) const
+{
+  portENTER_CRITICAL(&telemetryMux_);
+  const bool have = haveTelemetry_;
+  out = telemetry_;
+  portEXIT_CRITICAL(&telemetryMux_);
+  return have;
+}
+
+void UiController::PrintFrameTiming_() const
+{
+  const FrameTiming& f = view_.Model().LastFrame();
+  const uint32_t busyUs = f.flushUs + f.flushWaitUs;
+  const uint32_t renderUs = (f.frameUs > busyUs) ? (f.frameUs - busyUs) : 0U;
+  char line[128];
+  snprintf(line, sizeof(line),
+           "[UI] redraw (%s, %u lines): frame %lu us render %lu us flush %lu us wait %lu us, %lu px in %lu bands",
+           UI_DISPLAY_DMA ? "dma" : "blocking", static_cast<unsigned>(UI_DRAW_BUF_LINES),
+           static_cast<unsigned long>(f.frameUs), static_cast<unsigned long>(renderUs),
+           static_cast<unsigned long>(f.flushUs), static_cast<unsigned long>(f.flushWaitUs),
+           static_cast<unsigned long>(f.pixels), static_cast<unsigned long>(f.flushes));
+  Serial.println(line);
+}
+
+void UiController::TouchpadReadCb(lv_indev_t* indev, lv_indev_data_t* data)
+{
+  // No I2C here: TouchSampler publishes the filtered point from its own task
+  UiController* self = static_cast<UiController*>(lv_indev_get_user_data(indev));
+  if (self == nullptr)
   {
     data->state = LV_INDEV_STATE_RELEASED;
     return;
   }
-
-  TS.Scan();
-  data->state = LV_INDEV_STATE_PRESSED;
-  data->point.x = static_cast<int16_t>(TS.Y);
-  data->point.y = static_cast<int16_t>(TS.X);
+  const TouchSampler::Point p = self->touchSampler_.Latest();
+  data->state = p.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+  // Panel is rotated: controller Y is the display X
+  data->point.x = p.y;
+  data->point.y = p.x;
 }
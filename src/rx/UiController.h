@@ -12,60 +12,15 @@
 #include "lecture.h"
 #include "TFTConfiguration.h"
 #include "ui.h"
-#include <deque>
+#include "EventQueue.h"
+#include "DashboardView.h"
+#include "TouchSampler.h"
+#include "common/MessageRouter.h"
 #include <string>
-#include <cstring>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "freertos/task.h"
 
-// Lightweight data payload for UI updates (overwrite-queue semantics)
-/**
- * @struct UiData
- * @brief Current dashboard state mapped for LVGL widgets.
- */
-struct UiData
-{
-  uint16_t speedArc;   // 0..240 mapped arc value
-  bool leftActive;     // left turn signal active
-  bool rightActive;    // right turn signal active
-};
-
-/** UI message command types. */
-enum class UiMessageType : uint8_t
-{
-  ShowDashboard,
-  ShowLog,
-  AddLogLine,
-  ShowDegraded,
-  ShowFault
-};
-
-/**
- * @struct UiMessage
- * @brief UI command with optional text payload (for logs).
- */
-struct UiMessage
-{
-  UiMessageType type;
-  char text[96]; // for AddLogLine
-
-  static UiMessage MakeShowDashboard() { return UiMessage{UiMessageType::ShowDashboard, {0}}; }
-  static UiMessage MakeShowLog() { return UiMessage{UiMessageType::ShowLog, {0}}; }
-  static UiMessage MakeShowDegraded() { return UiMessage{UiMessageType::ShowDegraded, {0}}; }
-  static UiMessage MakeShowFault() { return UiMessage{UiMessageType::ShowFault, {0}}; }
-  static UiMessage MakeAddLog(const char* s)
-  {
-    UiMessage m{UiMessageType::AddLogLine, {0}};
-    if (s)
-    {
-      strncpy(m.text, s, sizeof(m.text) - 1);
-      m.text[sizeof(m.text) - 1] = '\0';
-    }
-    return m;
-  }
-};
-
 /**
  * @class UiController
  * @brief Initializes LVGL, manages screens, and runs an optional UI task processing queues.
@@ -73,12 +28,18 @@ struct UiMessage
 class UiController
 {
 public:
+  /** Boot step report from the UI task: subsystem, result and micros() start/end. */
+  typedef void (*BootStepCb)(Subsystem sys, bool ok, uint32_t startUs, uint32_t endUs, void* ctx);
+
   UiController();
 
   bool Init();
+  // Register before StartTask(); invoked from the UI task as display/LVGL/touch/UI come up
+  void SetBootStepCallback(BootStepCb cb, void* ctx);
   // Start dedicated UI task with queues; call after Init()
   bool StartTask(uint16_t dataQueueLen = 1, uint16_t msgQueueLen = 10,
-                 UBaseType_t priority = 2, uint16_t stackWords = 20*1024);
+                 UBaseType_t priority = 2, uint16_t stackWords = 20*1024,
+                 BaseType_t coreId = tskNO_AFFINITY);
 
   // Queue-based API (thread-safe):
   bool EnqueueUiData(const UiData& data); // overwrite latest
@@ -101,14 +62,20 @@ public:
   // Mapping helper for speed to arc value
   static uint16_t ConvertSpeedToArcValue(uint16_t rawSpeed);
 
+  // Render activity over the last closed 1 s window (safe from any task)
+  void GetRenderStats(RenderStats& out) const;
+  // LVGL heap and render timing sampled at the end of each 1 s window (safe from any task);
+  // false until the first window closed
+  bool GetTelemetry(MessageRouter::UiTelemetry& out) const;
+
 private:
   static uint32_t LvglTickGetCb();
   static void DisplayFlushCb(lv_display_t* disp, const lv_area_t* area, uint8_t* px_map);
+  static void DisplayFlushWaitCb_(lv_display_t* disp);
   static void TouchpadReadCb(lv_indev_t* indev, lv_indev_data_t* data);
+  static void DisplayEventCb_(lv_event_t* e);
 
   lv_display_t* lvglDisplay_;
-  lv_obj_t* degradedLabel_;
-  lv_obj_t* faultLabel_;
 
   // RTOS UI task + queues
   QueueHandle_t uiDataQueue_ = nullptr; // length 1, uses overwrite
@@ -117,24 +84,31 @@ private:
   static void UiTaskEntry_(void* pv);
   void UiTaskLoop_();
   void HandleUiMessage_(const UiMessage& msg);
-  void ApplyUiData_(const UiData& data);
-  void UpdateBlink_(const UiData& data);
+  void ReportBootStep_(Subsystem sys, bool ok, uint32_t startUs);
 
-  // Buffer for last N log lines displayed in Screen2 LogBox
-  static constexpr size_t kMaxLogLines_ = 10;
-  std::deque<std::string> logLines_;
-  void UpdateLogBox_();
+  // Owns touch controller I2C; the LVGL read callback only copies its latest point
+  TouchSampler touchSampler_;
+
+  // Screens, overlays, log and widget diffing (shared with the host render benchmark)
+  DashboardView view_;
+  bool frameReportPending_ = false; // print the next rendered frame's timing (ForceRedraw)
+  void PrintFrameTiming_() const;
+
+  // lv_mem_monitor() must run on the LVGL thread; other tasks read this copy
+  void SampleTelemetry_();
+  MessageRouter::UiTelemetry telemetry_{};
+  bool haveTelemetry_ = false;
+  mutable portMUX_TYPE telemetryMux_;
+
+  BootStepCb bootStepCb_ = nullptr;
+  void* bootStepCtx_ = nullptr;
 
   static constexpr uint16_t kArcMaxValue = 240U;
   static constexpr uint16_t kSpeedRawMax = 4095U;
-  static constexpr uint8_t kOpacityOn = 255U;
-  static constexpr uint8_t kOpacityOff = 0U;
-
-  // Blink control
-  static constexpr uint32_t kBlinkPeriodMs_ = 500;
-  uint32_t lastBlinkTickMs_ = 0;
-  bool leftBlinkOn_ = false;
-  bool rightBlinkOn_ = false;
+
+  // Longest the UI task sleeps when neither LVGL timers nor blink edges are due
+  static constexpr uint32_t kMaxIdleWaitMs_ = 500;
+  uint32_t NextWakeMs_(uint32_t lvglWaitMs, const UiData& data) const;
 };
 
 #endif // UI_CONTROLLER_H
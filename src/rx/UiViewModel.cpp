@@ -0,0 +1,145 @@
+#include "UiViewModel.h"
+#include <cstring>
+
+UiViewModel::UiViewModel()
+{
+  portMUX_INITIALIZE(&mux_);
+  memset(&current_, 0, sizeof(current_));
+  memset(&last_, 0, sizeof(last_));
+  memset(&frame_, 0, sizeof(frame_));
+  memset(&lastFrame_, 0, sizeof(lastFrame_));
+  Reset();
+}
+
+void UiViewModel::Reset()
+{
+  arcKnown_ = false;
+  for (std::size_t i = 0; i < kLabelCount_; ++i)
+  {
+    labelOpa_[i] = 0;
+    labelKnown_[i] = false;
+  }
+}
+
+void UiViewModel::SetArcValue(lv_obj_t* arc, int32_t value)
+{
+  if (arc == nullptr) return;
+  if (arcKnown_ && arcValue_ == value)
+  {
+    current_.widgetSkips++;
+    return;
+  }
+  lv_arc_set_value(arc, value);
+  arcValue_ = value;
+  arcKnown_ = true;
+  NoteWrite_();
+}
+
+void UiViewModel::SetLabelOpa(Label label, lv_obj_t* obj, uint8_t opa)
+{
+  const std::size_t idx = static_cast<std::size_t>(label);
+  if (obj == nullptr || idx >= kLabelCount_) return;
+  if (labelKnown_[idx] && labelOpa_[idx] == opa)
+  {
+    current_.widgetSkips++;
+    return;
+  }
+  lv_obj_set_style_text_opa(obj, opa, LV_PART_MAIN | LV_STATE_DEFAULT);
+  labelOpa_[idx] = opa;
+  labelKnown_[idx] = true;
+  NoteWrite_();
+}
+
+void UiViewModel::NoteWrite_()
+{
+  current_.widgetWrites++;
+  if (inputOpen_ && !latencyArmed_)
+  {
+    latencyStartUs_ = inputUs_;
+    latencyArmed_ = true;
+  }
+}
+
+void UiViewModel::BeginInput(uint32_t inputUs)
+{
+  inputUs_ = inputUs;
+  inputOpen_ = true;
+}
+
+void UiViewModel::NoteBusy(uint32_t us)
+{
+  current_.wakeups++;
+  current_.busyUs += us;
+}
+
+void UiViewModel::NoteFlush(uint32_t pixels, uint32_t us)
+{
+  current_.flushes++;
+  current_.flushedPixels += pixels;
+  current_.flushUs += us;
+  if (us > current_.maxFlushUs) current_.maxFlushUs = us;
+  frame_.flushes++;
+  frame_.pixels += pixels;
+  frame_.flushUs += us;
+}
+
+void UiViewModel::NoteFlushWait(uint32_t us)
+{
+  current_.flushWaitUs += us;
+  frame_.flushWaitUs += us;
+}
+
+void UiViewModel::NoteRefrStart(uint32_t nowUs)
+{
+  frameStartUs_ = nowUs;
+  frameRendered_ = false;
+  memset(&frame_, 0, sizeof(frame_));
+}
+
+bool UiViewModel::NoteRefrReady(uint32_t nowUs)
+{
+  if (!frameRendered_) return false;
+  frame_.frameUs = nowUs - frameStartUs_;
+  lastFrame_ = frame_;
+  current_.frames++;
+  current_.frameUs += frame_.frameUs;
+  if (frame_.frameUs > current_.maxFrameUs) current_.maxFrameUs = frame_.frameUs;
+  frameRendered_ = false;
+
+  if (latencyArmed_)
+  {
+    const uint32_t latencyUs = nowUs - latencyStartUs_;
+    current_.latencySamples++;
+    current_.latencySumUs += latencyUs;
+    if (latencyUs > current_.latencyMaxUs) current_.latencyMaxUs = latencyUs;
+    latencyArmed_ = false;
+  }
+  return true;
+}
+
+bool UiViewModel::Roll(uint32_t nowMs)
+{
+  if (!windowStarted_)
+  {
+    windowStartMs_ = nowMs;
+    windowStarted_ = true;
+    return false;
+  }
+  const uint32_t elapsed = nowMs - windowStartMs_;
+  if (elapsed < kWindowMs_) return false;
+
+  current_.windowMs = elapsed;
+  portENTER_CRITICAL(&mux_);
+  last_ = current_;
+  portEXIT_CRITICAL(&mux_);
+  memset(&current_, 0, sizeof(current_));
+  windowStartMs_ = nowMs;
+  return true;
+}
+
+void UiViewModel::GetLastWindow(RenderStats& out) const
+{
+  portENTER_CRITICAL(&mux_);
+  out = last_;
+  portEXIT_CRITICAL(&mux_);
+}
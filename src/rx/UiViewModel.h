@@ -0,0 +1,160 @@
+/**
+ * @file UiViewModel.h
+ * @brief Last-applied widget state and render counters for the dashboard.
+ *
+ * Every LVGL setter can invalidate an area and cause a redraw plus an SPI
+ * flush, even when the value did not change. The view model remembers what
+ * was last written to each dashboard widget and only forwards real changes
+ * to LVGL. It also counts widget writes, invalidated areas, redraws and
+ * flushed pixels in 1 s windows so the effect is visible on serial, and
+ * splits each rendered frame into render, flush and transfer-wait time.
+ * UI task busy time and input-to-pixel latency (data enqueued until the
+ * frame showing it finished rendering) are tracked in the same windows.
+ *
+ * All setters and Note* hooks run in the UI task; GetLastWindow() may be
+ * called from any task.
+ */
+#ifndef UI_VIEW_MODEL_H
+#define UI_VIEW_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <lvgl.h>
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @struct RenderStats
+ * @brief Render activity accumulated over one window.
+ */
+struct RenderStats
+{
+  uint32_t windowMs;       // length of the window the counts cover
+  uint32_t widgetWrites;   // LVGL setter calls issued
+  uint32_t widgetSkips;    // setter calls suppressed because the value was unchanged
+  uint32_t invalidations;  // LV_EVENT_INVALIDATE_AREA on the display
+  uint32_t invalidatedPixels; // summed size of those areas (overlaps counted twice)
+  uint32_t redraws;        // LV_EVENT_RENDER_START (refresh cycles that drew something)
+  uint32_t flushes;        // flush callback invocations
+  uint32_t flushedPixels;  // pixels sent to the panel
+  uint32_t flushUs;        // time spent inside the flush callback
+  uint32_t maxFlushUs;     // longest single flush callback
+  uint32_t flushWaitUs;    // time LVGL blocked waiting for a DMA transfer to finish
+  uint32_t frames;         // refresh cycles that rendered something
+  uint32_t frameUs;        // summed duration of those refresh cycles
+  uint32_t maxFrameUs;     // longest of those refresh cycles
+  uint32_t wakeups;        // UI task loop iterations
+  uint32_t busyUs;         // UI task time between waking and going back to sleep
+  uint32_t latencySamples; // data samples that changed a widget and reached a rendered frame
+  uint32_t latencySumUs;   // enqueue-to-frame-ready time summed over those samples
+  uint32_t latencyMaxUs;
+};
+
+/**
+ * @struct FrameTiming
+ * @brief Breakdown of the most recent refresh cycle that rendered something.
+ *
+ * Render time is frameUs - flushUs - flushWaitUs. With DMA the transfer of
+ * the last band overlaps whatever runs after the frame, so it is not included.
+ */
+struct FrameTiming
+{
+  uint32_t frameUs;
+  uint32_t flushUs;
+  uint32_t flushWaitUs;
+  uint32_t pixels;
+  uint32_t flushes;
+};
+
+/**
+ * @class UiViewModel
+ * @brief Diffing front end for the dashboard widgets.
+ */
+class UiViewModel
+{
+public:
+  /** Dashboard widgets whose text opacity is tracked. */
+  enum class Label : uint8_t
+  {
+    LeftTurn,
+    RightTurn,
+    Count
+  };
+
+  UiViewModel();
+
+  /** Forget the cached widget state so the next setters always reach LVGL. */
+  void Reset();
+
+  /** Set the arc value if it differs from the last applied one. */
+  void SetArcValue(lv_obj_t* arc, int32_t value);
+  /** Set a label's main-part text opacity if it differs from the last applied one. */
+  void SetLabelOpa(Label label, lv_obj_t* obj, uint8_t opa);
+
+  /** Count one invalidated area of @p pixels (display event hook). */
+  void NoteInvalidation(uint32_t pixels)
+  {
+    current_.invalidations++;
+    current_.invalidatedPixels += pixels;
+  }
+  /** Count one refresh cycle that rendered (display event hook). */
+  void NoteRedraw() { current_.redraws++; frameRendered_ = true; }
+  /** Count one flush of @p pixels that took @p us microseconds. */
+  void NoteFlush(uint32_t pixels, uint32_t us);
+  /** Count time LVGL spent waiting for an in-flight transfer. */
+  void NoteFlushWait(uint32_t us);
+  /** Mark the start of a display refresh cycle. */
+  void NoteRefrStart(uint32_t nowUs);
+  /**
+   * @brief Mark the end of a display refresh cycle.
+   * @return true if the cycle rendered something (LastFrame() was updated).
+   */
+  bool NoteRefrReady(uint32_t nowUs);
+  /** Breakdown of the last rendered frame (UI task only). */
+  const FrameTiming& LastFrame() const { return lastFrame_; }
+
+  /** Count one UI task wakeup that kept the task busy for @p us microseconds. */
+  void NoteBusy(uint32_t us);
+  /**
+   * @brief Bracket the application of one data sample enqueued at @p inputUs.
+   *
+   * If any widget write happens between BeginInput() and EndInput(), the next
+   * rendered frame completes a latency sample. The earliest pending input wins.
+   */
+  void BeginInput(uint32_t inputUs);
+  void EndInput() { inputOpen_ = false; }
+
+  /**
+   * @brief Close the current window once it is at least 1 s old.
+   * @return true if a window was closed by this call.
+   */
+  bool Roll(uint32_t nowMs);
+  /** Copy the most recently closed window. Safe from any task. */
+  void GetLastWindow(RenderStats& out) const;
+
+private:
+  static constexpr uint32_t kWindowMs_ = 1000U;
+  static constexpr std::size_t kLabelCount_ = static_cast<std::size_t>(Label::Count);
+
+  int32_t arcValue_ = 0;
+  bool arcKnown_ = false;
+  uint8_t labelOpa_[kLabelCount_];
+  bool labelKnown_[kLabelCount_];
+
+  RenderStats current_;
+  RenderStats last_;
+  FrameTiming frame_;
+  FrameTiming lastFrame_;
+  uint32_t frameStartUs_ = 0;
+  bool frameRendered_ = false;
+  void NoteWrite_();
+
+  uint32_t inputUs_ = 0;
+  bool inputOpen_ = false;
+  uint32_t latencyStartUs_ = 0;
+  bool latencyArmed_ = false;
+  uint32_t windowStartMs_ = 0;
+  bool windowStarted_ = false;
+  mutable portMUX_TYPE mux_;
+};
+
+#endif // UI_VIEW_MODEL_H
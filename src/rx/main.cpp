@@ -11,6 +11,7 @@
 #include "SystemController.h"
 #include "common/MessageRouter.h"
 #include "IOModule.h"
+#include "Clock.h"
 
 namespace
 {
@@ -40,7 +41,8 @@ static void RouterUiCb(const Cluster_t& c, uint32_t tsMs, void* ctx)
   UiData ui{
     UiController::ConvertSpeedToArcValue(c.speed),
     static_cast<bool>(c.Left_Turn_Signal),
-    static_cast<bool>(c.Right_Turn_Signal)
+    static_cast<bool>(c.Right_Turn_Signal),
+    0
   };
   s->ui->EnqueueUiData(ui);
 }
@@ -61,7 +63,14 @@ void setup()
   // Init message router
   messageRouter.Init(8);
 
-  // Create system controller and run boot sequence
+  // Initialize and start IO module (relays) and subscribe sinks before boot, so the
+  // first frames after CAN comes up reach IO without waiting for the display
+  ioModule.Init();
+  ioModule.Start(messageRouter);
+  messageRouter.SubscribeCluster(&RouterUiCb, &sinks);
+
+  // Create system controller and run boot sequence. The UI task is started inside
+  // RunBootSequence() and brings up the display while CAN initializes here.
   systemController = new SystemController(eventQueue, canInterface, uiController, healthMonitor, messageRouter);
   
   if (!systemController->RunBootSequence())
@@ -70,13 +79,6 @@ void setup()
     // Controller will display fault message
   }
 
-  // Initialize and start IO module (relays); subscribe to router
-  ioModule.Init();
-  ioModule.Start(messageRouter);
-  // Subscribe UI+Health to router after UI task is running
-  messageRouter.SubscribeCluster(&RouterUiCb, &sinks);
-  // UI task is started inside SystemController::RunBootSequence()
-
   // Create high-frequency processing task pinned to core 0
   // Runs the former loop() work at ~1 tick cadence
   xTaskCreatePinnedToCore(
@@ -114,8 +116,12 @@ static void ProcessingTask(void* /*param*/)
       // Update health monitoring (checks for timeouts)
       systemController->Update();
 
-      // Update IO blink timing
-      ioModule.Update(millis());
+      // IO only runs at its own deadlines (blink edge, staleness) or after new router input
+      const uint32_t nowMs = Clock::NowMs();
+      if (ioModule.IsDue(nowMs))
+      {
+        ioModule.Update(nowMs);
+      }
     }
 
     // High-frequency cadence: sleep 1 tick to yield CPU
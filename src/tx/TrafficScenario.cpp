@@ -0,0 +1,182 @@
+#include "TrafficScenario.h"
+#include "common/TrafficSeq.h"
+
+namespace
+{
+constexpr uint16_t kSpeedMax = 4095; // full Cluster speed signal range (12 bit)
+constexpr uint8_t kToggleShift = 2;
+constexpr uint32_t kToggleUnitMs = 50;
+
+using G = TrafficGenerator;
+
+// Full-scale ramps up and down with holds at the ends
+constexpr TrafficStep kRampSteps[] = {
+  {3000, 0, kSpeedMax, 0, 0},
+  {2000, kSpeedMax, kSpeedMax, 0, 0},
+  {3000, kSpeedMax, 0, 0, 0},
+  {2000, 0, 0, 0, 0},
+};
+
+// Indicator requests: steady left, right, hazard, then a left request flickering
+// every 300 ms (exercises phase sync on repeated rising edges)
+constexpr TrafficStep kTurnSteps[] = {
+  {4000, 1000, 1000, G::kTurnLeft, 0},
+  {4000, 1000, 1000, G::kTurnRight, 0},
+  {4000, 1000, 1000, G::kTurnHazard, 0},
+  {4000, 1000, 1000, G::kTurnLeft | G::TurnToggle(300), 0},
+  {2000, 1000, 1000, 0, 0},
+};
+
+// Quiet traffic broken by short filler bursts and a flood spike
+constexpr TrafficStep kBurstSteps[] = {
+  {1000, 2000, 2000, 0, 0},
+  {200, 2000, 2000, 0, 5000},
+  {800, 2000, 2000, 0, 0},
+  {100, 2000, 2000, G::kTurnHazard, G::kFlood},
+};
+
+// Flat out: as many fillers as the bus accepts while Cluster keeps its cycle
+constexpr TrafficStep kFloodSteps[] = {
+  {10000, 0, kSpeedMax, G::kTurnHazard, G::kFlood},
+  {10000, kSpeedMax, 0, G::kTurnHazard, G::kFlood},
+};
+
+template <uint8_t N>
+constexpr uint8_t CountOf(const TrafficStep (&)[N])
+{
+  return N;
+}
+
+const TrafficScenario kScenarios[] = {
+  {"ramp", kRampSteps, CountOf(kRampSteps), true},
+  {"turns", kTurnSteps, CountOf(kTurnSteps), true},
+  {"burst", kBurstSteps, CountOf(kBurstSteps), true},
+  {"flood", kFloodSteps, CountOf(kFloodSteps), true},
+};
+}
+
+uint8_t TrafficGenerator::ScenarioCount()
+{
+  return static_cast<uint8_t>(sizeof(kScenarios) / sizeof(kScenarios[0]));
+}
+
+const TrafficScenario* TrafficGenerator::Scenario(uint8_t index)
+{
+  return (index < ScenarioCount()) ? &kScenarios[index] : nullptr;
+}
+
+bool TrafficGenerator::Start(uint8_t index, uint32_t nowMs)
+{
+  const TrafficScenario* s = Scenario(index);
+  if (s == nullptr || s->stepCount == 0) return false;
+  for (uint8_t i = 0; i < s->stepCount; ++i)
+  {
+    if (s->steps[i].durationMs == 0) return false;
+  }
+  scenario_ = s;
+  index_ = index;
+  done_ = false;
+  counters_ = Counters{0, 0, 0};
+  lastTickMs_ = nowMs;
+  EnterStep_(0, nowMs);
+  UpdateValues_(nowMs);
+  return true;
+}
+
+void TrafficGenerator::EnterStep_(uint8_t step, uint32_t nowMs)
+{
+  step_ = step;
+  stepStartMs_ = nowMs;
+  fillerCredit_ = 0;
+}
+
+void TrafficGenerator::Tick(uint32_t nowMs, SendFn send, void* ctx)
+{
+  if (!Running()) return;
+
+  // Step boundaries stay on the scenario's own timeline even if ticks are late
+  while (static_cast<int32_t>(nowMs - stepStartMs_) >= static_cast<int32_t>(scenario_->steps[step_].durationMs))
+  {
+    const uint32_t nextStartMs = stepStartMs_ + scenario_->steps[step_].durationMs;
+    if (step_ + 1U < scenario_->stepCount)
+    {
+      EnterStep_(static_cast<uint8_t>(step_ + 1U), nextStartMs);
+    }
+    else if (scenario_->repeat)
+    {
+      ++counters_.loops;
+      EnterStep_(0, nextStartMs);
+    }
+    else
+    {
+      done_ = true;
+      values_ = ClusterValues{0, false, false};
+      return;
+    }
+  }
+
+  UpdateValues_(nowMs);
+  SendFillers_(nowMs, send, ctx);
+  lastTickMs_ = nowMs;
+}
+
+void TrafficGenerator::UpdateValues_(uint32_t nowMs)
+{
+  const TrafficStep& s = scenario_->steps[step_];
+  const uint32_t elapsedMs = nowMs - stepStartMs_;
+
+  const int32_t span = static_cast<int32_t>(s.speedEnd) - static_cast<int32_t>(s.speedStart);
+  const int32_t speed = static_cast<int32_t>(s.speedStart) + span * static_cast<int32_t>(elapsedMs) / s.durationMs;
+  values_.speed = static_cast<uint16_t>(speed);
+
+  bool active = true;
+  const uint32_t togglePeriodMs = static_cast<uint32_t>(s.turn >> kToggleShift) * kToggleUnitMs;
+  if (togglePeriodMs != 0U)
+  {
+    // Requests on for the first half of each toggle period
+    active = (elapsedMs % togglePeriodMs) < (togglePeriodMs / 2U);
+  }
+  values_.leftTurn = active && (s.turn & kTurnLeft) != 0U;
+  values_.rightTurn = active && (s.turn & kTurnRight) != 0U;
+}
+
+void TrafficGenerator::SendFillers_(uint32_t nowMs, SendFn send, void* ctx)
+{
+  const TrafficStep& s = scenario_->steps[step_];
+  if (s.fillerPerSec == 0 || send == nullptr) return;
+
+  uint32_t due;
+  if (s.fillerPerSec == kFlood)
+  {
+    due = kMaxFillersPerTick;
+  }
+  else
+  {
+    // Fractional rate: credit accumulates in 1/1000 frame per ms elapsed in this step
+    const uint32_t sinceMs = (static_cast<int32_t>(lastTickMs_ - stepStartMs_) > 0) ? lastTickMs_ : stepStartMs_;
+    fillerCredit_ += static_cast<uint32_t>(s.fillerPerSec) * (nowMs - sinceMs);
+    due = fillerCredit_ / 1000U;
+    if (due > kMaxFillersPerTick)
+    {
+      due = kMaxFillersPerTick;
+      fillerCredit_ = due * 1000U; // drop the backlog instead of bursting later
+    }
+  }
+
+  Frame frame;
+  frame.length = TrafficSeq::kFillerLength;
+  for (uint32_t n = 0; n < due; ++n)
+  {
+    const uint32_t seq = counters_.fillerSent;
+    frame.id = TrafficSeq::FillerId(seq);
+    TrafficSeq::Encode(frame.data, seq, index_, step_);
+    if (!send(frame, ctx))
+    {
+      // Bus full: the same sequence number is retried next tick
+      ++counters_.fillerRefused;
+      break;
+    }
+    ++counters_.fillerSent;
+    if (s.fillerPerSec != kFlood) fillerCredit_ -= 1000U;
+  }
+}
@@ -0,0 +1,112 @@
+/**
+ * @file TrafficScenario.h
+ * @brief Table-driven traffic scenarios for characterizing the RX board.
+ *
+ * A scenario is a compact table of steps. Each step holds for a duration and
+ * sets the Cluster values (a linear speed ramp and turn signal requests,
+ * optionally toggling) plus a filler frame rate, up to flooding the bus.
+ * Filler frames carry TrafficSeq sequence numbers so a receiver can count
+ * exact loss and reordering. The generator has no hardware dependencies:
+ * the TX firmware ticks it from a task and sends through CAN0, the host
+ * tx_sim tool ticks it against SocketCAN.
+ */
+#ifndef TRAFFIC_SCENARIO_H
+#define TRAFFIC_SCENARIO_H
+
+#include <cstdint>
+
+/** One scenario step; a few bytes each so scenarios stay in flash as tables. */
+struct TrafficStep
+{
+  uint16_t durationMs;
+  uint16_t speedStart;   ///< Cluster speed at the start of the step
+  uint16_t speedEnd;     ///< ramps linearly to this by the end of the step
+  uint8_t turn;          ///< TrafficGenerator::kTurn* bits; bits 2..7 toggle period in 50 ms units (0 = steady)
+  uint16_t fillerPerSec; ///< filler frames per second, or TrafficGenerator::kFlood
+};
+
+struct TrafficScenario
+{
+  const char* name;
+  const TrafficStep* steps;
+  uint8_t stepCount;
+  bool repeat; ///< restart at step 0 after the last step
+};
+
+/**
+ * @class TrafficGenerator
+ * @brief Steps through one scenario and emits filler frames on Tick().
+ */
+class TrafficGenerator
+{
+public:
+  static constexpr uint8_t kTurnLeft = 0x01;
+  static constexpr uint8_t kTurnRight = 0x02;
+  static constexpr uint8_t kTurnHazard = kTurnLeft | kTurnRight;
+  /** Encode a request toggle period for TrafficStep::turn (50 ms units, max 3150 ms). */
+  static constexpr uint8_t TurnToggle(uint16_t periodMs) { return static_cast<uint8_t>((periodMs / 50U) << 2); }
+  /** fillerPerSec value: send until the bus refuses a frame, every tick. */
+  static constexpr uint16_t kFlood = 0xFFFF;
+  /** Cap on filler frames per Tick() so flooding cannot starve the calling task. */
+  static constexpr uint16_t kMaxFillersPerTick = 32;
+
+  struct Frame
+  {
+    uint32_t id;
+    uint8_t length;
+    uint8_t data[8];
+  };
+
+  /** Frame sink; return false if the frame was not accepted (it is retried next tick). */
+  using SendFn = bool (*)(const Frame& frame, void* ctx);
+
+  struct ClusterValues
+  {
+    uint16_t speed;
+    bool leftTurn;
+    bool rightTurn;
+  };
+
+  struct Counters
+  {
+    uint32_t fillerSent;    ///< accepted filler frames = next sequence number
+    uint32_t fillerRefused; ///< sink refusals (flood mode ends each tick with one)
+    uint32_t loops;         ///< completed passes of a repeating scenario
+  };
+
+  /** Built-in scenarios (see TrafficScenario.cpp). */
+  static uint8_t ScenarioCount();
+  static const TrafficScenario* Scenario(uint8_t index);
+
+  /** Begin @p index at @p nowMs; false if there is no such scenario. */
+  bool Start(uint8_t index, uint32_t nowMs);
+
+  /**
+   * @brief Advance to @p nowMs: update Cluster values and send due filler frames.
+   * Call every millisecond or so; longer gaps are caught up (bounded by kMaxFillersPerTick).
+   */
+  void Tick(uint32_t nowMs, SendFn send, void* ctx);
+
+  ClusterValues Values() const { return values_; }
+  const Counters& Stats() const { return counters_; }
+  bool Running() const { return scenario_ != nullptr && !done_; }
+  uint8_t ScenarioIndex() const { return index_; }
+  uint8_t StepIndex() const { return step_; }
+
+private:
+  void EnterStep_(uint8_t step, uint32_t nowMs);
+  void UpdateValues_(uint32_t nowMs);
+  void SendFillers_(uint32_t nowMs, SendFn send, void* ctx);
+
+  const TrafficScenario* scenario_ = nullptr;
+  uint8_t index_ = 0;
+  uint8_t step_ = 0;
+  bool done_ = false;
+  uint32_t stepStartMs_ = 0;
+  uint32_t lastTickMs_ = 0;
+  uint32_t fillerCredit_ = 0; // filler frames owed, in 1/1000 frame
+  ClusterValues values_ = {0, false, false};
+  Counters counters_ = {0, 0, 0};
+};
+
+#endif // TRAFFIC_SCENARIO_H
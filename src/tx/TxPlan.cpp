@@ -0,0 +1,198 @@
+#include "TxPlan.h"
+
+namespace
+{
+uint32_t Gcd(uint32_t a, uint32_t b)
+{
+  while (b != 0U)
+  {
+    const uint32_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Largest slot sum that message m would see if placed at offsetMs
+uint32_t PeakAt(const uint32_t* load, uint32_t windowMs, uint32_t periodMs, uint32_t offsetMs)
+{
+  uint32_t peak = 0;
+  for (uint32_t t = offsetMs; t < windowMs; t += periodMs)
+  {
+    if (load[t] > peak) peak = load[t];
+  }
+  return peak;
+}
+
+void Place(uint32_t* load, uint32_t windowMs, uint32_t periodMs, uint32_t offsetMs, uint32_t bits)
+{
+  for (uint32_t t = offsetMs; t < windowMs; t += periodMs) load[t] += bits;
+}
+
+uint32_t MaxOf(const uint32_t* load, uint32_t windowMs)
+{
+  uint32_t peak = 0;
+  for (uint32_t t = 0; t < windowMs; ++t)
+  {
+    if (load[t] > peak) peak = load[t];
+  }
+  return peak;
+}
+}
+
+TxPlan::~TxPlan()
+{
+  delete[] rows_;
+  delete[] offsetsMs_;
+  delete[] heap_;
+}
+
+bool TxPlan::Init(const Row* rows, uint16_t count)
+{
+  if (rows == nullptr || count == 0) return false;
+  for (uint16_t i = 0; i < count; ++i)
+  {
+    if (rows[i].periodMs == 0) return false;
+    if (rows[i].offsetMs != kAutoOffset &&
+        (rows[i].offsetMs < 0 || rows[i].offsetMs >= static_cast<int32_t>(rows[i].periodMs)))
+    {
+      return false;
+    }
+  }
+
+  delete[] rows_;
+  delete[] offsetsMs_;
+  delete[] heap_;
+  count_ = count;
+  rows_ = new Row[count_];
+  offsetsMs_ = new uint32_t[count_];
+  heap_ = new HeapEntry[count_];
+  for (uint16_t i = 0; i < count_; ++i) rows_[i] = rows[i];
+  AssignOffsets_();
+  return true;
+}
+
+void TxPlan::AssignOffsets_()
+{
+  // Window: hyperperiod of all cycles, capped (placement is approximate beyond the cap)
+  uint32_t windowMs = 1;
+  for (uint16_t i = 0; i < count_; ++i)
+  {
+    const uint32_t p = rows_[i].periodMs;
+    windowMs = windowMs / Gcd(windowMs, p) * p;
+    if (windowMs >= kStaggerWindowMs_)
+    {
+      windowMs = kStaggerWindowMs_;
+      break;
+    }
+  }
+
+  uint32_t* load = new uint32_t[windowMs];
+
+  // Reference: every message released at offset 0
+  for (uint32_t t = 0; t < windowMs; ++t) load[t] = 0;
+  for (uint16_t i = 0; i < count_; ++i) Place(load, windowMs, rows_[i].periodMs, 0, rows_[i].frameBits);
+  peakBitsAligned_ = MaxOf(load, windowMs);
+
+  // Fixed offsets first, they are not ours to move
+  for (uint32_t t = 0; t < windowMs; ++t) load[t] = 0;
+  for (uint16_t i = 0; i < count_; ++i)
+  {
+    if (rows_[i].offsetMs == kAutoOffset) continue;
+    offsetsMs_[i] = static_cast<uint32_t>(rows_[i].offsetMs);
+    Place(load, windowMs, rows_[i].periodMs, offsetsMs_[i] % windowMs, rows_[i].frameBits);
+  }
+
+  // Then automatic ones, shortest period first (they have the fewest choices). Each
+  // takes the offset whose busiest slot is emptiest; ties keep the earliest offset.
+  uint16_t* order = new uint16_t[count_];
+  uint16_t autoCount = 0;
+  for (uint16_t i = 0; i < count_; ++i)
+  {
+    if (rows_[i].offsetMs != kAutoOffset) continue;
+    uint16_t pos = autoCount++;
+    while (pos > 0 && rows_[order[pos - 1]].periodMs > rows_[i].periodMs)
+    {
+      order[pos] = order[pos - 1];
+      --pos;
+    }
+    order[pos] = i;
+  }
+  for (uint16_t n = 0; n < autoCount; ++n)
+  {
+    const uint16_t i = order[n];
+    const uint32_t periodMs = rows_[i].periodMs;
+    const uint32_t candidates = (periodMs < windowMs) ? periodMs : windowMs;
+    uint32_t bestOffset = 0;
+    uint32_t bestPeak = UINT32_MAX;
+    for (uint32_t o = 0; o < candidates && bestPeak != 0; ++o)
+    {
+      const uint32_t peak = PeakAt(load, windowMs, periodMs, o);
+      if (peak < bestPeak)
+      {
+        bestPeak = peak;
+        bestOffset = o;
+      }
+    }
+    offsetsMs_[i] = bestOffset;
+    Place(load, windowMs, periodMs, bestOffset, rows_[i].frameBits);
+  }
+  peakBitsStaggered_ = MaxOf(load, windowMs);
+
+  delete[] order;
+  delete[] load;
+}
+
+void TxPlan::Start(int64_t startUs)
+{
+  for (uint16_t i = 0; i < count_; ++i)
+  {
+    heap_[i].dueUs = startUs + static_cast<int64_t>(offsetsMs_[i]) * 1000;
+    heap_[i].idx = i;
+  }
+  for (uint16_t pos = count_ / 2; pos-- > 0;) SiftDown_(pos);
+}
+
+bool TxPlan::PopDue(int64_t nowUs, uint16_t& idx, int64_t& dueUs, uint32_t& missedCycles)
+{
+  if (count_ == 0 || heap_[0].dueUs > nowUs) return false;
+  HeapEntry& top = heap_[0];
+  idx = top.idx;
+  dueUs = top.dueUs;
+  missedCycles = 0;
+
+  // Next release on the same grid; after a stall skip the missed cycles
+  const int64_t periodUs = static_cast<int64_t>(rows_[top.idx].periodMs) * 1000;
+  top.dueUs += periodUs;
+  if (top.dueUs <= nowUs)
+  {
+    const int64_t skip = (nowUs - top.dueUs) / periodUs + 1;
+    top.dueUs += skip * periodUs;
+    missedCycles = static_cast<uint32_t>(skip);
+  }
+  SiftDown_(0);
+  return true;
+}
+
+bool TxPlan::Before_(const HeapEntry& a, const HeapEntry& b) const
+{
+  if (a.dueUs != b.dueUs) return a.dueUs < b.dueUs;
+  // Same deadline: queue in arbitration order (lower ID wins on the bus anyway)
+  return rows_[a.idx].id < rows_[b.idx].id;
+}
+
+void TxPlan::SiftDown_(uint16_t pos)
+{
+  for (;;)
+  {
+    const uint32_t left = 2U * pos + 1U;
+    if (left >= count_) return;
+    uint32_t child = left;
+    if (left + 1U < count_ && Before_(heap_[left + 1U], heap_[left])) child = left + 1U;
+    if (!Before_(heap_[child], heap_[pos])) return;
+    const HeapEntry tmp = heap_[pos];
+    heap_[pos] = heap_[child];
+    heap_[child] = tmp;
+    pos = static_cast<uint16_t>(child);
+  }
+}
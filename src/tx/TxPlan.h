@@ -0,0 +1,96 @@
+/**
+ * @file TxPlan.h
+ * @brief Offset staggering and deadline order for periodic TX messages, without timers or CAN.
+ *
+ * The hardware-independent core of TxScheduler: it assigns phase offsets that
+ * flatten the per-millisecond bus load, keeps every message's next deadline in
+ * a min-heap on a fixed grid (start + offset + k * period, so no drift), skips
+ * the cycles missed during a stall and releases messages with equal deadlines
+ * in CAN arbitration order. Time is passed in, so host tests drive it on a
+ * virtual clock; TxScheduler adds the esp_timer, the task and the bus.
+ */
+#ifndef TX_PLAN_H
+#define TX_PLAN_H
+
+#include <cstdint>
+
+/**
+ * @class TxPlan
+ * @brief Offsets, stagger peaks and the deadline heap for up to 65535 messages.
+ */
+class TxPlan
+{
+public:
+  /** Offset value asking Init() to choose the phase offset. */
+  static constexpr int32_t kAutoOffset = -1;
+
+  /** What the plan needs to know about one message. */
+  struct Row
+  {
+    uint32_t id;        ///< CAN ID; orders messages with equal deadlines
+    uint16_t periodMs;
+    int32_t offsetMs;   ///< 0..periodMs-1, or kAutoOffset
+    uint32_t frameBits; ///< frame size on the wire; weights the stagger
+  };
+
+  TxPlan() = default;
+  ~TxPlan();
+  TxPlan(const TxPlan&) = delete;
+  TxPlan& operator=(const TxPlan&) = delete;
+
+  /**
+   * @brief Copy the rows and assign automatic offsets.
+   * @return false on an empty table, a zero period or an out of range fixed offset.
+   */
+  bool Init(const Row* rows, uint16_t count);
+
+  uint16_t Count() const { return count_; }
+  /** Offset in use for message @p idx (after automatic staggering). */
+  uint32_t OffsetMs(uint16_t idx) const { return (idx < count_) ? offsetsMs_[idx] : 0U; }
+  /** Largest per-millisecond frame-bit sum over the stagger window, before and after staggering. */
+  void GetStaggerPeaks(uint32_t& unstaggeredBits, uint32_t& staggeredBits) const
+  {
+    unstaggeredBits = peakBitsAligned_;
+    staggeredBits = peakBitsStaggered_;
+  }
+
+  /** First release of every message is one offset after @p startUs. */
+  void Start(int64_t startUs);
+  /** Earliest pending deadline; only valid after Start(). */
+  int64_t NextDueUs() const { return heap_[0].dueUs; }
+
+  /**
+   * @brief Release the earliest message due at or before @p nowUs.
+   *
+   * Its deadline moves to the next grid point after @p nowUs: one period on time,
+   * or past every cycle missed during a stall (those are not sent late).
+   * @param idx Released message.
+   * @param dueUs The deadline it was released for.
+   * @param missedCycles Cycles skipped by this release (0 when on time).
+   * @return false if nothing is due.
+   */
+  bool PopDue(int64_t nowUs, uint16_t& idx, int64_t& dueUs, uint32_t& missedCycles);
+
+private:
+  struct HeapEntry
+  {
+    int64_t dueUs;
+    uint16_t idx;
+  };
+
+  void AssignOffsets_();
+  bool Before_(const HeapEntry& a, const HeapEntry& b) const;
+  void SiftDown_(uint16_t pos);
+
+  // Offsets are chosen on a 1 ms grid over the hyperperiod, capped to this window
+  static constexpr uint32_t kStaggerWindowMs_ = 2000;
+
+  Row* rows_ = nullptr;
+  uint16_t count_ = 0;
+  uint32_t* offsetsMs_ = nullptr;
+  HeapEntry* heap_ = nullptr;
+  uint32_t peakBitsAligned_ = 0;
+  uint32_t peakBitsStaggered_ = 0;
+};
+
+#endif // TX_PLAN_H
@@ -0,0 +1,188 @@
+#include "TxScheduler.h"
+#include <Arduino.h>
+#include "can_busload.h"
+
+TxScheduler::TxScheduler()
+{
+  portMUX_INITIALIZE(&statsMux_);
+}
+
+bool TxScheduler::Init(CAN_COMMON& bus, const Message* table, uint16_t count)
+{
+  if (table == nullptr || count == 0 || taskHandle_ != nullptr) return false;
+
+  TxPlan::Row* rows = new TxPlan::Row[count];
+  for (uint16_t i = 0; i < count; ++i)
+  {
+    rows[i].id = table[i].id;
+    rows[i].periodMs = table[i].periodMs;
+    rows[i].offsetMs = table[i].offsetMs;
+    rows[i].frameBits = CANBusLoad::classicFrameBits(table[i].extended, table[i].length, false);
+  }
+  const bool ok = plan_.Init(rows, count);
+  delete[] rows;
+  if (!ok) return false;
+
+  bus_ = &bus;
+  table_ = table;
+  count_ = count;
+  delete[] counters_;
+  counters_ = new Counters[count_];
+  for (uint16_t i = 0; i < count_; ++i)
+  {
+    counters_[i] = Counters{0, 0, 0, 0, 0, 0, 0};
+  }
+  return true;
+}
+
+bool TxScheduler::Start(UBaseType_t priority, uint16_t stackWords, BaseType_t coreId)
+{
+  if (table_ == nullptr) return false;
+  if (taskHandle_ != nullptr) return true;
+
+  if (timer_ == nullptr)
+  {
+    esp_timer_create_args_t args = {};
+    args.callback = &TxScheduler::TimerCb_;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "tx_sched";
+    if (esp_timer_create(&args, &timer_) != ESP_OK)
+    {
+      timer_ = nullptr;
+      return false;
+    }
+  }
+
+  // First release of every message is one offset after now
+  plan_.Start(esp_timer_get_time());
+
+  const BaseType_t ok = xTaskCreatePinnedToCore(TaskEntry_, "tx_sched", stackWords, this, priority,
+                                                &taskHandle_, coreId);
+  if (ok != pdPASS)
+  {
+    taskHandle_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void TxScheduler::TaskEntry_(void* pv)
+{
+  static_cast<TxScheduler*>(pv)->TaskLoop_();
+}
+
+void TxScheduler::TimerCb_(void* arg)
+{
+  auto* self = static_cast<TxScheduler*>(arg);
+  if (self && self->taskHandle_ != nullptr) xTaskNotifyGive(self->taskHandle_);
+}
+
+void TxScheduler::TaskLoop_()
+{
+  for (;;)
+  {
+    SendDue_(esp_timer_get_time());
+
+    // Sleep until the earliest deadline; the one-shot timer wakes us with a notify
+    const int64_t waitUs = plan_.NextDueUs() - esp_timer_get_time();
+    if (waitUs > 0)
+    {
+      esp_timer_start_once(timer_, static_cast<uint64_t>(waitUs));
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+  }
+}
+
+void TxScheduler::SendDue_(int64_t nowUs)
+{
+  // Missed cycles after a stall are dropped by the plan, not sent late
+  uint16_t idx;
+  int64_t dueUs;
+  uint32_t missed;
+  while (plan_.PopDue(nowUs, idx, dueUs, missed)) Send_(idx, dueUs);
+}
+
+void TxScheduler::Send_(uint16_t idx, int64_t dueUs)
+{
+  const Message& m = table_[idx];
+  CAN_FRAME frame;
+  frame.id = m.id;
+  frame.extended = m.extended ? 1U : 0U;
+  frame.length = m.length;
+  frame.rtr = 0U;
+
+  const bool packed = (m.pack == nullptr) || m.pack(frame, m.ctx);
+  const bool sent = packed && bus_->sendFrame(frame);
+  const int64_t sentUs = esp_timer_get_time();
+
+  const uint32_t lateUs = static_cast<uint32_t>(sentUs - dueUs);
+  portENTER_CRITICAL(&statsMux_);
+  Counters& c = counters_[idx];
+  if (!packed)
+  {
+    ++c.skipped;
+    c.lastSentUs = 0;
+  }
+  else if (!sent)
+  {
+    ++c.failed;
+    c.lastSentUs = 0;
+  }
+  else
+  {
+    ++c.sent;
+    c.lateSumUs += lateUs;
+    if (lateUs > c.maxLateUs) c.maxLateUs = lateUs;
+    if (c.lastSentUs != 0)
+    {
+      const int64_t dev = (sentUs - c.lastSentUs) - static_cast<int64_t>(m.periodMs) * 1000;
+      const uint32_t jitterUs = static_cast<uint32_t>(dev < 0 ? -dev : dev);
+      if (jitterUs > c.maxJitterUs) c.maxJitterUs = jitterUs;
+    }
+    c.lastSentUs = sentUs;
+  }
+  portEXIT_CRITICAL(&statsMux_);
+}
+
+bool TxScheduler::GetStats(uint16_t idx, Stats& out) const
+{
+  if (idx >= count_ || counters_ == nullptr) return false;
+  portENTER_CRITICAL(&statsMux_);
+  const Counters c = counters_[idx];
+  portEXIT_CRITICAL(&statsMux_);
+
+  out.sent = c.sent;
+  out.failed = c.failed;
+  out.skipped = c.skipped;
+  out.avgLateUs = (c.sent != 0U) ? static_cast<uint32_t>(c.lateSumUs / c.sent) : 0U;
+  out.maxLateUs = c.maxLateUs;
+  out.maxJitterUs = c.maxJitterUs;
+  return true;
+}
+
+void TxScheduler::PrintStats() const
+{
+  uint32_t alignedBits;
+  uint32_t staggeredBits;
+  plan_.GetStaggerPeaks(alignedBits, staggeredBits);
+  char line[128];
+  snprintf(line, sizeof(line), "[TX] %u messages, peak %lu bits/ms staggered (%lu aligned)",
+           static_cast<unsigned>(count_), static_cast<unsigned long>(staggeredBits),
+           static_cast<unsigned long>(alignedBits));
+  Serial.println(line);
+  Serial.println("[TX] name             id     period off    sent  fail  skip  late avg/max us  jitter max us");
+  for (uint16_t i = 0; i < count_; ++i)
+  {
+    Stats s;
+    if (!GetStats(i, s)) continue;
+    const Message& m = table_[i];
+    snprintf(line, sizeof(line), "[TX] %-16s %-6lX %6u %4lu %7lu %5lu %5lu %7lu/%-7lu %8lu",
+             (m.name != nullptr) ? m.name : "?", static_cast<unsigned long>(m.id),
+             static_cast<unsigned>(m.periodMs), static_cast<unsigned long>(plan_.OffsetMs(i)),
+             static_cast<unsigned long>(s.sent), static_cast<unsigned long>(s.failed),
+             static_cast<unsigned long>(s.skipped), static_cast<unsigned long>(s.avgLateUs),
+             static_cast<unsigned long>(s.maxLateUs), static_cast<unsigned long>(s.maxJitterUs));
+    Serial.println(line);
+  }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file TxScheduler.h
+ * @brief Periodic multi-message CAN transmit scheduler for the TX board.
+ *
+ * Takes a table of periodic messages (one per DBC message), each with a cycle
+ * time, a phase offset and a pack callback. Offset staggering and the deadline
+ * heap live in TxPlan (host-tested); this class adds the bus and the timing.
+ * One task owns all transmission: it sleeps on a one-shot esp_timer armed for
+ * the plan's earliest deadline, sends everything due, and re-arms, so cost per
+ * wakeup is O(k log n) for k due messages out of n. Per-message lateness and
+ * period jitter are recorded for PrintStats().
+ */
+#ifndef TX_SCHEDULER_H
+#define TX_SCHEDULER_H
+
+#include <cstdint>
+#include <esp32_can.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "TxPlan.h"
+
+/**
+ * @class TxScheduler
+ * @brief Owns the message table, its TxPlan and the transmit task.
+ */
+class TxScheduler
+{
+public:
+  /**
+   * @brief Fill the frame payload; id, extended and length are pre-set from the table.
+   * @return false to skip this cycle (nothing is sent, the deadline still advances).
+   */
+  using PackFn = bool (*)(CAN_FRAME& frame, void* ctx);
+
+  /** Offset value asking Init() to choose the phase offset. */
+  static constexpr int32_t kAutoOffset = TxPlan::kAutoOffset;
+
+  /** One table row; the table must outlive the scheduler (typically a static const array). */
+  struct Message
+  {
+    const char* name;
+    uint32_t id;
+    bool extended;
+    uint8_t length;     ///< DLC; also weights the bus load used for staggering
+    uint16_t periodMs;
+    int32_t offsetMs;   ///< 0..periodMs-1, or kAutoOffset
+    PackFn pack;
+    void* ctx;
+  };
+
+  /** Per-message counters; lateness is send time minus scheduled time. */
+  struct Stats
+  {
+    uint32_t sent;
+    uint32_t failed;      ///< sendFrame() refused the frame (TX queue full / bus off)
+    uint32_t skipped;     ///< pack callback returned false
+    uint32_t avgLateUs;
+    uint32_t maxLateUs;
+    uint32_t maxJitterUs; ///< largest |actual interval - period| between two sends
+  };
+
+  TxScheduler();
+
+  /**
+   * @brief Bind the table and assign automatic offsets.
+   * @return false on an empty table, a zero period or an out of range fixed offset.
+   */
+  bool Init(CAN_COMMON& bus, const Message* table, uint16_t count);
+
+  /** Start the transmit task; the first frames go out one offset after this call. */
+  bool Start(UBaseType_t priority = 5, uint16_t stackWords = 3072, BaseType_t coreId = tskNO_AFFINITY);
+
+  uint16_t Count() const { return count_; }
+  /** Offset in use for message @p idx (after automatic staggering). */
+  uint32_t OffsetMs(uint16_t idx) const { return plan_.OffsetMs(idx); }
+  /** Consistent copy of one message's counters; safe from any task. */
+  bool GetStats(uint16_t idx, Stats& out) const;
+  /** Largest per-millisecond frame-bit sum over the stagger window, before and after staggering. */
+  void GetStaggerPeaks(uint32_t& unstaggeredBits, uint32_t& staggeredBits) const
+  {
+    plan_.GetStaggerPeaks(unstaggeredBits, staggeredBits);
+  }
+  /** Print one line per message to Serial. */
+  void PrintStats() const;
+
+private:
+  struct Counters
+  {
+    int64_t lastSentUs;
+    uint64_t lateSumUs;
+    uint32_t sent;
+    uint32_t failed;
+    uint32_t skipped;
+    uint32_t maxLateUs;
+    uint32_t maxJitterUs;
+  };
+
+  static void TaskEntry_(void* pv);
+  static void TimerCb_(void* arg);
+  void TaskLoop_();
+  void SendDue_(int64_t nowUs);
+  void Send_(uint16_t idx, int64_t dueUs);
+
+  CAN_COMMON* bus_ = nullptr;
+  const Message* table_ = nullptr;
+  uint16_t count_ = 0;
+  TxPlan plan_;
+  Counters* counters_ = nullptr;
+
+  TaskHandle_t taskHandle_ = nullptr;
+  esp_timer_handle_t timer_ = nullptr;
+  mutable portMUX_TYPE statsMux_;
+};
+
+#endif // TX_SCHEDULER_H
@@ -2,12 +2,66 @@
 #include <esp32_can.h>
 #include <cstring>
 #include "lecture.h"  // Generated from Lecture.dbc using cantools or c-coderdbc
+#include "TxScheduler.h"
+#include "TrafficScenario.h"
+
+// Traffic scenario replayed from boot (index into TrafficGenerator's built-in
+// scenarios: 0 ramp, 1 turns, 2 burst, 3 flood); -1 sends the fixed test values
+#ifndef TX_SCENARIO
+#define TX_SCENARIO -1
+#endif
+
+static bool PackClusterFrame(CAN_FRAME& frame, void* ctx);
 
 namespace
 {
 constexpr uint32_t kBusSpeed = 500000U;
-constexpr uint32_t kSendPeriodMs = 100U;
+constexpr uint16_t kSendPeriodMs = 100U;
 constexpr uint32_t kSerialBaudRate = 115200U;
+constexpr uint32_t kStatsPeriodMs = 10000U;
+
+// Values the Cluster message is packed from (written by the scenario task when one runs)
+using ClusterValues = TrafficGenerator::ClusterValues;
+
+// TODO: Modify these test values or create your own test patterns
+ClusterValues clusterValues = {100U, true, false};
+portMUX_TYPE clusterValuesMux = portMUX_INITIALIZER_UNLOCKED;
+
+// One row per periodic DBC message; kAutoOffset lets the scheduler stagger it
+const TxScheduler::Message kTxTable[] = {
+  {"Cluster", Cluster_CANID, Cluster_IDE != 0U, Cluster_DLC, kSendPeriodMs, TxScheduler::kAutoOffset,
+   &PackClusterFrame, &clusterValues},
+};
+
+TxScheduler txScheduler;
+TrafficGenerator trafficGenerator;
+TaskHandle_t trafficTaskHandle = nullptr;
+
+bool SendFillerFrame(const TrafficGenerator::Frame& filler, void* /*ctx*/)
+{
+  CAN_FRAME frame;
+  frame.id = filler.id;
+  frame.extended = 0U;
+  frame.rtr = 0U;
+  frame.length = filler.length;
+  memcpy(frame.data.bytes, filler.data, sizeof(filler.data));
+  return CAN0.sendFrame(frame);
+}
+
+// Steps the scenario every tick: Cluster values for the scheduler, filler frames directly
+void TrafficTask(void* /*param*/)
+{
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;)
+  {
+    trafficGenerator.Tick(millis(), &SendFillerFrame, nullptr);
+    const ClusterValues values = trafficGenerator.Values();
+    portENTER_CRITICAL(&clusterValuesMux);
+    clusterValues = values;
+    portEXIT_CRITICAL(&clusterValuesMux);
+    vTaskDelayUntil(&lastWake, 1);
+  }
+}
 }
 
 // TODO: Define your CAN message data structure here
@@ -19,11 +73,17 @@ constexpr uint32_t kSerialBaudRate = 115200U;
 // Option 1: Use generated helper functions from lecture.h (e.g., Pack_Cluster_lecture)
 // Option 2: Implement your own bit packing based on the DBC signal definitions
 //
-// This function should take your data and pack it into a CAN frame
-static void SendClusterFrame(uint16_t speed, bool leftTurn, bool rightTurn)
+// The TX scheduler calls this every kSendPeriodMs with frame.id, frame.extended and
+// frame.length already set from kTxTable; fill frame.data and return true to send it.
+static bool PackClusterFrame(CAN_FRAME& frame, void* ctx)
 {
-  // TODO: Create and populate your message structure
-  CAN_FRAME frame{};
+  ClusterValues values;
+  portENTER_CRITICAL(&clusterValuesMux);
+  values = *static_cast<const ClusterValues*>(ctx);
+  portEXIT_CRITICAL(&clusterValuesMux);
+  (void)values;
+  // TODO: Create and populate your message structure from values.speed,
+  // values.leftTurn and values.rightTurn
   // TODO: Pack the data into a byte array
   // Option 1 - Using generated functions:
   // check the generated header file for details
@@ -38,24 +98,8 @@ static void SendClusterFrame(uint16_t speed, bool leftTurn, bool rightTurn)
   // Calculate byte positions and bit shifts based on DBC signal definitions
   // populate frame.data.bytes[] accordingly using speed, leftTurn, rightTurn and your own function.
 
-  // further populate the CAN frame properties required for transmission
-  
-  // frame.id = ???;           // TODO: Set the CAN ID from your DBC
-  // frame.extended = ???;      // TODO: Standard (0) or Extended (1)?
-  // frame.length = ???;        // TODO: Set DLC (data length code)
-  // frame.rtr = 0U;
-
-
-  // Send the frame (this part is provided)
-  // this is a driver call to send the CAN frame once everything is populated
-  const bool sent = CAN0.sendFrame(frame);
-
-  // Debug output
-  if (Serial)
-  {
-    Serial.printf("[CAN] TX Result: %s\n", sent ? "OK" : "FAILED");
-    // TODO: Add more debug info about your message content
-  }
+  (void)frame;
+  return true;
 }
 
 void setup()
@@ -70,28 +114,43 @@ void setup()
   if (Serial)
   {
     Serial.printf("[CAN] Initialized at %lu bps\n", static_cast<unsigned long>(kBusSpeed));
-    Serial.println("[Exercise] Implement the SendClusterFrame function to transmit CAN messages");
+    Serial.println("[Exercise] Implement the PackClusterFrame function to transmit CAN messages");
+  }
+
+  if (!txScheduler.Init(CAN0, kTxTable, static_cast<uint16_t>(sizeof(kTxTable) / sizeof(kTxTable[0]))) ||
+      !txScheduler.Start())
+  {
+    Serial.println("[TX] scheduler start failed");
+  }
+
+#if TX_SCENARIO >= 0
+  if (trafficGenerator.Start(static_cast<uint8_t>(TX_SCENARIO), millis()) &&
+      xTaskCreatePinnedToCore(TrafficTask, "tx_traffic", 3072, nullptr, 4, &trafficTaskHandle,
+                              tskNO_AFFINITY) == pdPASS)
+  {
+    Serial.printf("[TX] scenario %s\n", TrafficGenerator::Scenario(TX_SCENARIO)->name);
   }
+  else
+  {
+    Serial.println("[TX] scenario start failed");
+  }
+#endif
 }
 
 void loop()
 {
-  static uint32_t lastSendTick = 0U;
-  const uint32_t now = millis();
-  
-  // Send messages periodically
-  if ((now - lastSendTick) < kSendPeriodMs)
+  // Transmission runs in the scheduler task; the loop only reports send timing
+  delay(kStatsPeriodMs);
+  if (Serial)
   {
-    delay(1);
-    return;
+    txScheduler.PrintStats();
+    if (trafficGenerator.Running())
+    {
+      const TrafficGenerator::Counters& c = trafficGenerator.Stats();
+      Serial.printf("[TX] scenario %s step %u loops %lu | filler sent %lu (next seq) refused %lu\n",
+                    TrafficGenerator::Scenario(trafficGenerator.ScenarioIndex())->name,
+                    static_cast<unsigned>(trafficGenerator.StepIndex()), static_cast<unsigned long>(c.loops),
+                    static_cast<unsigned long>(c.fillerSent), static_cast<unsigned long>(c.fillerRefused));
+    }
   }
-
-  lastSendTick = now;
-  
-  // TODO: Modify these test values or create your own test patterns
-  uint16_t testSpeed = 100U;      // Example speed value
-  bool testLeft = true;            // Example left turn signal
-  bool testRight = false;          // Example right turn signal
-  
-  SendClusterFrame(testSpeed, testLeft, testRight);
-}
\ No newline at end of file
+}
@@ -0,0 +1,92 @@
+/**
+ * @file EventScheduler.h
+ * @brief Discrete-event scheduler driving a VirtualClock.
+ *
+ * Tests describe the world as timed callbacks (a sender putting a frame on
+ * the bus, a task waking up, a fault being injected) and RunUntil() executes
+ * them in time order, jumping the clock straight from one event to the next.
+ * Events due at the same time run in the order they were scheduled, so a run
+ * is fully deterministic.
+ */
+#ifndef TEST_EVENT_SCHEDULER_H
+#define TEST_EVENT_SCHEDULER_H
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "VirtualClock.h"
+
+/**
+ * @class EventScheduler
+ * @brief Time-ordered queue of callbacks; periodic tasks reschedule themselves.
+ */
+class EventScheduler
+{
+public:
+  using Action = std::function<void()>;
+  /** Periodic body; returns the delay to its next run, or 0 to stop. */
+  using Task = std::function<uint64_t()>;
+
+  explicit EventScheduler(VirtualClock& clock) : clock_(clock) {}
+
+  /** Run @p action at absolute time @p tUs (clamped to now). */
+  void At(uint64_t tUs, Action action)
+  {
+    if (tUs < clock_.NowUs()) tUs = clock_.NowUs();
+    queue_.push(Entry{tUs, nextSeq_++, std::move(action)});
+  }
+
+  /** Run @p action @p delayUs after the current time. */
+  void After(uint64_t delayUs, Action action) { At(clock_.NowUs() + delayUs, std::move(action)); }
+
+  /** Run @p task at @p firstUs and again after every delay it returns. */
+  void Every(uint64_t firstUs, Task task)
+  {
+    At(firstUs, [this, task]() {
+      const uint64_t nextUs = task();
+      if (nextUs != 0) Every(clock_.NowUs() + nextUs, task);
+    });
+  }
+
+  /** Execute every event due up to and including @p tUs, then park the clock there. */
+  void RunUntil(uint64_t tUs)
+  {
+    while (!queue_.empty() && queue_.top().tUs <= tUs)
+    {
+      Entry e = queue_.top();
+      queue_.pop();
+      clock_.AdvanceTo(e.tUs);
+      e.action();
+      ++executed_;
+    }
+    clock_.AdvanceTo(tUs);
+  }
+
+  void RunFor(uint64_t durationUs) { RunUntil(clock_.NowUs() + durationUs); }
+
+  uint64_t Executed() const { return executed_; }
+  bool Idle() const { return queue_.empty(); }
+
+private:
+  struct Entry
+  {
+    uint64_t tUs;
+    uint64_t seq;
+    Action action;
+  };
+  struct Later
+  {
+    bool operator()(const Entry& a, const Entry& b) const
+    {
+      return (a.tUs != b.tUs) ? (a.tUs > b.tUs) : (a.seq > b.seq);
+    }
+  };
+
+  VirtualClock& clock_;
+  std::priority_queue<Entry, std::vector<Entry>, Later> queue_;
+  uint64_t nextSeq_ = 0;
+  uint64_t executed_ = 0;
+};
+
+#endif // TEST_EVENT_SCHEDULER_H
@@ -0,0 +1,395 @@
+/**
+ * @file FakeMcp2515.h
+ * @brief Register-level model of the MCP2515 on the host SPI bus.
+ *
+ * Speaks the chip's SPI instruction set (RESET, READ, WRITE, BIT MODIFY,
+ * READ STATUS, RX STATUS, READ RX BUFFER, LOAD TX BUFFER, RTS) against its
+ * 128 byte register map. Only what MCP2515 in lib/CanDriver relies on is
+ * modelled:
+ *   - CANCTRL: a REQOP write is reflected in CANSTAT OPMOD at once.
+ *   - RX: standard frames are matched against RXF0/RXF1 with RXM0 for RXB0
+ *     and RXF2..RXF5 with RXM1 for RXB1 (RXM = 11 in RXBnCTRL takes any
+ *     frame). A frame for a full RXB0 rolls over into RXB1 when BUKT is set,
+ *     otherwise, or with RXB1 full too, it is dropped and RXnOVR set in EFLG.
+ *   - CANINTF holds RX0IF/RX1IF while the buffers are full; BIT MODIFY, WRITE
+ *     and the end of READ RX BUFFER clear them. EFLG RXnOVR is clear-only.
+ *   - INT is low while CANINTF & CANINTE is non-zero.
+ *   - TX: RTS sets TXREQ; Transmit() takes the requested buffers off the bus
+ *     and sets TXnIF.
+ *
+ * Frames are put on the bus with Receive(). Every BIT MODIFY of CANINTF is
+ * recorded, and OnRelease runs when a transaction ends (CS high), so a test
+ * can deliver a frame at an exact point of a driver readout.
+ */
+#ifndef TEST_FAKE_MCP2515_H
+#define TEST_FAKE_MCP2515_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "Arduino.h"
+#include "SPI.h"
+
+/**
+ * @class FakeMcp2515
+ * @brief Installs itself as the host SPI device and the CS/INT pin model.
+ */
+class FakeMcp2515 : public HostSpiDevice, public HostPinHook
+{
+public:
+  // Register addresses and bits, as in the datasheet
+  static constexpr uint8_t kCanStat = 0x0E;
+  static constexpr uint8_t kCanCtrl = 0x0F;
+  static constexpr uint8_t kCanIntE = 0x2B;
+  static constexpr uint8_t kCanIntF = 0x2C;
+  static constexpr uint8_t kEflg = 0x2D;
+  static constexpr uint8_t kRxb0Ctrl = 0x60;
+  static constexpr uint8_t kRxb1Ctrl = 0x70;
+  static constexpr uint8_t kRx0If = 0x01;
+  static constexpr uint8_t kRx1If = 0x02;
+  static constexpr uint8_t kRx0Ovr = 0x40;
+  static constexpr uint8_t kRx1Ovr = 0x80;
+
+  /** One BIT MODIFY instruction on CANINTF. */
+  struct BitModify
+  {
+    uint8_t mask;
+    uint8_t data;
+  };
+
+  /** A standard frame as it goes over the bus. */
+  struct Frame
+  {
+    uint16_t id;
+    uint8_t length;
+    uint8_t data[8];
+  };
+
+  FakeMcp2515(uint8_t csPin, uint8_t intPin) : cs_(csPin), int_(intPin)
+  {
+    Reset_();
+    HostSpi() = this;
+    HostPins() = this;
+  }
+  ~FakeMcp2515() override
+  {
+    HostSpi() = nullptr;
+    HostPins() = nullptr;
+  }
+  FakeMcp2515(const FakeMcp2515&) = delete;
+  FakeMcp2515& operator=(const FakeMcp2515&) = delete;
+
+  // --- bus side ---
+
+  /** Run @p frame through the filters into RXB0 or RXB1. False if no filter took it or it was dropped. */
+  bool Receive(const Frame& frame)
+  {
+    uint8_t filter = 0;
+    if (Accepts_(0, frame.id, filter))
+    {
+      if (!(reg_[kCanIntF] & kRx0If)) return Store_(0, frame, filter);
+      if (reg_[kRxb0Ctrl] & 0x04) // BUKT: roll over into RXB1, FILHIT 0 or 1 shows it
+      {
+        if (!(reg_[kCanIntF] & kRx1If)) return Store_(1, frame, filter);
+        reg_[kEflg] |= kRx1Ovr;
+        ++dropped;
+        return false;
+      }
+      reg_[kEflg] |= kRx0Ovr;
+      ++dropped;
+      return false;
+    }
+    if (Accepts_(1, frame.id, filter))
+    {
+      if (!(reg_[kCanIntF] & kRx1If)) return Store_(1, frame, filter);
+      reg_[kEflg] |= kRx1Ovr;
+      ++dropped;
+      return false;
+    }
+    return false;
+  }
+
+  /** Send every TX buffer with TXREQ set, TXB0 first. */
+  std::vector<Frame> Transmit()
+  {
+    std::vector<Frame> sent;
+    for (uint8_t n = 0; n < 3; ++n)
+    {
+      uint8_t* b = &reg_[0x30 + 0x10 * n];
+      if (!(b[0] & 0x08)) continue;
+      Frame f{};
+      f.id = static_cast<uint16_t>((b[1] << 3) | (b[2] >> 5));
+      f.length = b[5] & 0x0F;
+      memcpy(f.data, &b[6], 8);
+      sent.push_back(f);
+      b[0] &= static_cast<uint8_t>(~0x08);
+      reg_[kCanIntF] |= static_cast<uint8_t>(0x04 << n); // TXnIF
+    }
+    return sent;
+  }
+
+  // --- observation ---
+
+  uint8_t Register(uint8_t address) const { return reg_[address & 0x7F]; }
+
+  std::vector<BitModify> intfModifies; ///< every BIT MODIFY of CANINTF, in order
+  uint32_t transactions = 0;           ///< CS low periods
+  uint32_t statusReads = 0;            ///< READ STATUS instructions
+  uint32_t dropped = 0;                ///< frames lost to a full buffer
+  /** Runs after each transaction with its instruction and start address (0 if none). */
+  std::function<void(uint8_t instruction, uint8_t address)> OnRelease;
+
+  void ClearCounters()
+  {
+    intfModifies.clear();
+    transactions = statusReads = dropped = 0;
+  }
+
+  // --- HostPinHook / HostSpiDevice ---
+
+  void Write(uint8_t pin, uint8_t level) override
+  {
+    if (pin != cs_) return;
+    if (level == LOW && !selected_)
+    {
+      selected_ = true;
+      byteIndex_ = 0;
+      ++transactions;
+    }
+    else if (level == HIGH && selected_)
+    {
+      selected_ = false;
+      EndCommand_();
+    }
+  }
+
+  int Read(uint8_t pin) override
+  {
+    if (pin != int_) return HIGH;
+    return (reg_[kCanIntF] & reg_[kCanIntE]) ? LOW : HIGH;
+  }
+
+  uint8_t Transfer(uint8_t mosi) override
+  {
+    if (!selected_) return 0xFF;
+    uint8_t miso = 0;
+    if (byteIndex_ == 0)
+    {
+      StartCommand_(mosi);
+    }
+    else if (instruction_ == kRead || instruction_ == kWrite || instruction_ == kBitModify)
+    {
+      if (byteIndex_ == 1)
+      {
+        address_ = mosi & 0x7F;
+        startAddress_ = address_;
+      }
+      else if (instruction_ == kRead)
+      {
+        miso = reg_[address_];
+        address_ = (address_ + 1) & 0x7F;
+      }
+      else if (instruction_ == kWrite)
+      {
+        Poke_(address_, mosi);
+        address_ = (address_ + 1) & 0x7F;
+      }
+      else if (byteIndex_ == 2)
+      {
+        modifyMask_ = mosi;
+      }
+      else if (byteIndex_ == 3)
+      {
+        Modify_(address_, modifyMask_, mosi);
+      }
+    }
+    else if (instruction_ == kStatus)
+    {
+      miso = Status_();
+    }
+    else if (instruction_ == kRxStatus)
+    {
+      miso = static_cast<uint8_t>((reg_[kCanIntF] & 0x03) << 6);
+    }
+    else if ((instruction_ & 0xF9) == kReadRxBuffer)
+    {
+      miso = reg_[address_];
+      address_ = (address_ + 1) & 0x7F;
+    }
+    else if ((instruction_ & 0xF8) == kLoadTxBuffer)
+    {
+      reg_[address_] = mosi;
+      address_ = (address_ + 1) & 0x7F;
+    }
+    ++byteIndex_;
+    return miso;
+  }
+
+private:
+  static constexpr uint8_t kReset = 0xC0;
+  static constexpr uint8_t kRead = 0x03;
+  static constexpr uint8_t kWrite = 0x02;
+  static constexpr uint8_t kBitModify = 0x05;
+  static constexpr uint8_t kStatus = 0xA0;
+  static constexpr uint8_t kRxStatus = 0xB0;
+  static constexpr uint8_t kReadRxBuffer = 0x90;
+  static constexpr uint8_t kLoadTxBuffer = 0x40;
+  static constexpr uint8_t kRts = 0x80;
+
+  void Reset_()
+  {
+    memset(reg_, 0, sizeof(reg_));
+    reg_[kCanStat] = 0x80; // configuration mode
+    reg_[kCanCtrl] = 0x87;
+  }
+
+  void StartCommand_(uint8_t instruction)
+  {
+    instruction_ = instruction;
+    address_ = 0;
+    startAddress_ = 0;
+    if (instruction == kReset)
+    {
+      Reset_();
+    }
+    else if (instruction == kStatus)
+    {
+      ++statusReads;
+    }
+    else if ((instruction & 0xF9) == kReadRxBuffer)
+    {
+      // n m: RXB0 or RXB1, from SIDH or from D0
+      address_ = static_cast<uint8_t>(((instruction & 0x04) ? kRxb1Ctrl : kRxb0Ctrl) + ((instruction & 0x02) ? 6 : 1));
+      startAddress_ = address_;
+    }
+    else if ((instruction & 0xF8) == kLoadTxBuffer)
+    {
+      const uint8_t abc = instruction & 0x07;
+      address_ = static_cast<uint8_t>(0x31 + 0x10 * (abc >> 1) + ((abc & 1) ? 5 : 0));
+      startAddress_ = address_;
+    }
+    else if ((instruction & 0xF0) == kRts)
+    {
+      for (uint8_t n = 0; n < 3; ++n)
+      {
+        if (instruction & (1 << n)) reg_[0x30 + 0x10 * n] |= 0x08;
+      }
+    }
+  }
+
+  void EndCommand_()
+  {
+    // READ RX BUFFER frees its buffer when CS goes high
+    if ((instruction_ & 0xF9) == kReadRxBuffer && byteIndex_ > 1)
+    {
+      reg_[kCanIntF] &= static_cast<uint8_t>(~((instruction_ & 0x04) ? kRx1If : kRx0If));
+    }
+    if (OnRelease) OnRelease(instruction_, startAddress_);
+  }
+
+  uint8_t Status_() const
+  {
+    const uint8_t intf = reg_[kCanIntF];
+    uint8_t s = intf & 0x03;
+    for (uint8_t n = 0; n < 3; ++n)
+    {
+      if (reg_[0x30 + 0x10 * n] & 0x08) s |= static_cast<uint8_t>(0x04 << (2 * n)); // TXREQ
+      if (intf & (0x04 << n)) s |= static_cast<uint8_t>(0x08 << (2 * n));           // TXnIF
+    }
+    return s;
+  }
+
+  void Poke_(uint8_t address, uint8_t value)
+  {
+    switch (address)
+    {
+    case kCanStat:
+      return; // read only
+    case kCanCtrl:
+      reg_[kCanCtrl] = value;
+      reg_[kCanStat] = static_cast<uint8_t>((reg_[kCanStat] & 0x1F) | (value & 0xE0));
+      return;
+    case kEflg:
+      reg_[kEflg] &= static_cast<uint8_t>(value | 0x3F); // only RXnOVR are writable, and only to 0
+      return;
+    case kRxb0Ctrl:
+      reg_[kRxb0Ctrl] = static_cast<uint8_t>((reg_[kRxb0Ctrl] & 0x0B) | (value & 0x64));
+      return;
+    case kRxb1Ctrl:
+      reg_[kRxb1Ctrl] = static_cast<uint8_t>((reg_[kRxb1Ctrl] & 0x0F) | (value & 0x60));
+      return;
+    default:
+      reg_[address] = value;
+    }
+  }
+
+  void Modify_(uint8_t address, uint8_t mask, uint8_t data)
+  {
+    if (address == kCanIntF) intfModifies.push_back(BitModify{mask, data});
+    Poke_(address, static_cast<uint8_t>((reg_[address] & ~mask) | (data & mask)));
+  }
+
+  // Standard ID in the SIDH/SIDL layout of filters, masks and buffers
+  uint16_t Sid_(uint8_t address) const
+  {
+    return static_cast<uint16_t>((reg_[address] << 3) | (reg_[address + 1] >> 5));
+  }
+
+  bool Accepts_(uint8_t buffer, uint16_t id, uint8_t& filter) const
+  {
+    const uint8_t ctrl = reg_[buffer == 0 ? kRxb0Ctrl : kRxb1Ctrl];
+    if ((ctrl & 0x60) == 0x60)
+    {
+      filter = (buffer == 0) ? 0 : 2;
+      return true;
+    }
+    static const uint8_t kFilters[6] = {0x00, 0x04, 0x08, 0x10, 0x14, 0x18};
+    const uint16_t mask = Sid_(buffer == 0 ? 0x20 : 0x24);
+    const uint8_t first = (buffer == 0) ? 0 : 2;
+    const uint8_t last = (buffer == 0) ? 2 : 6;
+    for (uint8_t f = first; f < last; ++f)
+    {
+      if (reg_[kFilters[f] + 1] & 0x08) continue; // EXIDE: extended frames only
+      if (((Sid_(kFilters[f]) ^ id) & mask & 0x7FF) == 0)
+      {
+        filter = f;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool Store_(uint8_t buffer, const Frame& frame, uint8_t filter)
+  {
+    uint8_t* b = &reg_[buffer == 0 ? kRxb0Ctrl : kRxb1Ctrl];
+    if (buffer == 0)
+    {
+      b[0] = static_cast<uint8_t>((b[0] & 0x64) | ((b[0] & 0x04) ? 0x02 : 0) | filter);
+    }
+    else
+    {
+      b[0] = static_cast<uint8_t>((b[0] & 0x60) | filter);
+    }
+    b[1] = static_cast<uint8_t>(frame.id >> 3);
+    b[2] = static_cast<uint8_t>((frame.id & 7) << 5);
+    b[3] = 0;
+    b[4] = 0;
+    b[5] = frame.length & 0x0F;
+    memcpy(&b[6], frame.data, 8);
+    reg_[kCanIntF] |= (buffer == 0) ? kRx0If : kRx1If;
+    return true;
+  }
+
+  uint8_t cs_;
+  uint8_t int_;
+  bool selected_ = false;
+  uint32_t byteIndex_ = 0;
+  uint8_t instruction_ = 0;
+  uint8_t address_ = 0;
+  uint8_t startAddress_ = 0;
+  uint8_t modifyMask_ = 0;
+  uint8_t reg_[0x80];
+};
+
+#endif // TEST_FAKE_MCP2515_H
@@ -0,0 +1,402 @@
+/**
+ * @file FakeMcp2517fd.h
+ * @brief Register-level model of the MCP2517FD on the host SPI bus.
+ *
+ * Speaks the chip's SPI framing (RESET/READ/WRITE with a 12 bit address that
+ * auto-increments while CS stays low) against 1 KB of SFR space and the 2 KB
+ * message RAM at 0x400. Only what MCP2517FD in lib/CanDriver relies on is
+ * modelled:
+ *   - CiCON: a REQOP write is reflected in OPMOD at once.
+ *   - FIFO1..31: geometry from FIFOCON (TXEN, RXTSEN, FSIZE, PLSIZE), laid out
+ *     in index order from the start of RAM, TXQ and TEF disabled. FIFOCON byte
+ *     1 acts on UINC, TXREQ and FRESET; FIFOSTA and FIFOUA follow the ring.
+ *   - CiINT keeps what was written with RXIF ORed in; CiRXIF and CiRXOVIF are
+ *     recomputed from the FIFOs at the start of every READ.
+ *   - Filters: FLTCON/FLTOBJ/MASK route received frames, lowest filter first.
+ *
+ * Frames are put on the "bus" with Receive() and taken off the TX FIFO with
+ * Transmit(). Every UINC byte written is recorded, and OnUinc can inject more
+ * traffic in the middle of a driver readout.
+ */
+#ifndef TEST_FAKE_MCP2517FD_H
+#define TEST_FAKE_MCP2517FD_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "Arduino.h"
+#include "SPI.h"
+
+/**
+ * @class FakeMcp2517fd
+ * @brief Installs itself as the host SPI device and the CS pin observer.
+ */
+class FakeMcp2517fd : public HostSpiDevice, public HostPinHook
+{
+public:
+  static constexpr uint16_t kRamBase = 0x400;
+  static constexpr uint16_t kRamSize = 2048;
+  static constexpr uint8_t kFifos = 32;
+
+  /** One byte written to FIFOCON+1 with UINC set. */
+  struct Uinc
+  {
+    uint8_t fifo;
+    uint8_t value; ///< bit 0 UINC, bit 1 TXREQ
+  };
+
+  /** A frame as it goes over the bus. */
+  struct Frame
+  {
+    uint32_t id;
+    bool extended;
+    uint8_t length;
+    uint8_t data[8];
+  };
+
+  explicit FakeMcp2517fd(uint8_t csPin) : cs_(csPin)
+  {
+    Reset_();
+    HostSpi() = this;
+    HostPins() = this;
+  }
+  ~FakeMcp2517fd() override
+  {
+    HostSpi() = nullptr;
+    HostPins() = nullptr;
+  }
+  FakeMcp2517fd(const FakeMcp2517fd&) = delete;
+  FakeMcp2517fd& operator=(const FakeMcp2517fd&) = delete;
+
+  // --- bus side ---
+
+  /** Run @p frame through the filters into its RX FIFO. False if no filter took it or the FIFO overflowed. */
+  bool Receive(const Frame& frame)
+  {
+    const uint32_t packed = frame.extended
+        ? (((frame.id >> 18) & 0x7FFu) | ((frame.id & 0x3FFFFu) << 11) | (1u << 30))
+        : (frame.id & 0x7FFu);
+    for (uint8_t f = 0; f < 32; ++f)
+    {
+      const uint8_t con = sfr_[kFltCon + f];
+      if (!(con & 0x80)) continue;
+      const uint32_t obj = Sfr32_(kFltObj + 8u * f);
+      const uint32_t mask = Sfr32_(kFltObj + 8u * f + 4u);
+      if (((packed ^ obj) & mask & 0x5FFFFFFFu) != 0) continue;
+      return Store_(con & 0x1F, f, packed, frame);
+    }
+    return false;
+  }
+
+  /** Send what the TX FIFO holds while TXREQ is set, oldest first. */
+  std::vector<Frame> Transmit(uint8_t fifo)
+  {
+    std::vector<Frame> sent;
+    Fifo& q = fifo_[fifo];
+    while (q.txreq && q.count > 0)
+    {
+      const uint8_t* obj = &ram_[Base_(fifo) + q.tail * ObjectSize_(fifo)];
+      uint32_t word0, word1;
+      memcpy(&word0, obj, 4);
+      memcpy(&word1, obj + 4, 4);
+      Frame f{};
+      f.extended = (word1 >> 4) & 1;
+      f.id = f.extended ? (((word0 >> 11) & 0x3FFFFu) | ((word0 & 0x7FFu) << 18)) : (word0 & 0x7FFu);
+      f.length = word1 & 0xF;
+      memcpy(f.data, obj + 8, 8);
+      sent.push_back(f);
+      q.tail = (q.tail + 1) % Depth_(fifo);
+      --q.count;
+    }
+    if (q.count == 0) q.txreq = false;
+    return sent;
+  }
+
+  // --- observation ---
+
+  uint8_t FilterControl(uint8_t filter) const { return sfr_[kFltCon + filter]; }
+  uint8_t Pending(uint8_t fifo) const { return fifo_[fifo].count; }
+  uint8_t Depth(uint8_t fifo) const { return Depth_(fifo); }
+
+  std::vector<Uinc> uincs;        ///< every UINC write, in order
+  uint32_t transactions = 0;      ///< CS low periods
+  uint32_t ramReads = 0;          ///< READ transactions starting in message RAM
+  uint32_t ramWrites = 0;         ///< WRITE transactions starting in message RAM
+  uint32_t fifoStatusReads[kFifos] = {}; ///< READ transactions starting at a FIFOCON
+  std::function<void(uint8_t fifo)> OnUinc; ///< runs after each UINC is applied
+
+  void ClearCounters()
+  {
+    uincs.clear();
+    transactions = ramReads = ramWrites = 0;
+    memset(fifoStatusReads, 0, sizeof(fifoStatusReads));
+  }
+
+  // --- HostPinHook / HostSpiDevice ---
+
+  void Write(uint8_t pin, uint8_t level) override
+  {
+    if (pin != cs_) return;
+    if (level == LOW && !selected_)
+    {
+      selected_ = true;
+      byteIndex_ = 0;
+      ++transactions;
+    }
+    else if (level == HIGH)
+    {
+      selected_ = false;
+    }
+  }
+
+  int Read(uint8_t /*pin*/) override { return HIGH; }
+
+  uint8_t Transfer(uint8_t mosi) override
+  {
+    if (!selected_) return 0xFF;
+    uint8_t miso = 0;
+    if (byteIndex_ == 0)
+    {
+      command_ = mosi >> 4;
+      address_ = static_cast<uint16_t>((mosi & 0x0F) << 8);
+    }
+    else if (byteIndex_ == 1)
+    {
+      address_ |= mosi;
+      StartCommand_();
+    }
+    else if (command_ == kCmdRead)
+    {
+      miso = Peek_(address_++);
+    }
+    else if (command_ == kCmdWrite)
+    {
+      Poke_(address_++, mosi);
+    }
+    ++byteIndex_;
+    return miso;
+  }
+
+private:
+  static constexpr uint8_t kCmdReset = 0x0;
+  static constexpr uint8_t kCmdWrite = 0x2;
+  static constexpr uint8_t kCmdRead = 0x3;
+  static constexpr uint16_t kCon = 0x000;
+  static constexpr uint16_t kInt = 0x01C;
+  static constexpr uint16_t kRxIf = 0x020;
+  static constexpr uint16_t kRxOvIf = 0x028;
+  static constexpr uint16_t kFifoCon = 0x050;
+  static constexpr uint16_t kFifoStride = 12;
+  static constexpr uint16_t kFltCon = 0x1D0;
+  static constexpr uint16_t kFltObj = 0x1F0;
+
+  struct Fifo
+  {
+    uint8_t head;  ///< next object the writer fills (chip for RX, host for TX)
+    uint8_t tail;  ///< next object the reader takes (host for RX, chip for TX)
+    uint8_t count;
+    bool overflow;
+    bool txreq;
+  };
+
+  void Reset_()
+  {
+    memset(sfr_, 0, sizeof(sfr_));
+    memset(ram_, 0, sizeof(ram_));
+    memset(fifo_, 0, sizeof(fifo_));
+    sfr_[kCon + 2] = 4 << 5; // OPMOD: configuration
+    sfr_[kCon + 3] = 4;      // REQOP: configuration
+    stamp_ = 0;
+  }
+
+  void StartCommand_()
+  {
+    if (command_ == kCmdReset)
+    {
+      Reset_();
+    }
+    else if (command_ == kCmdRead)
+    {
+      if (address_ >= kRamBase) ++ramReads;
+      if (address_ >= kFifoCon && address_ < kFltCon && (address_ - kFifoCon) % kFifoStride == 0)
+      {
+        ++fifoStatusReads[(address_ - kFifoCon) / kFifoStride];
+      }
+      RefreshStatus_();
+    }
+    else if (command_ == kCmdWrite && address_ >= kRamBase)
+    {
+      ++ramWrites;
+    }
+  }
+
+  // --- geometry ---
+
+  bool IsTx_(uint8_t fifo) const { return sfr_[FifoCon_(fifo)] & 0x80; }
+  uint8_t Depth_(uint8_t fifo) const { return (sfr_[FifoCon_(fifo) + 3] & 0x1F) + 1; }
+  uint16_t ObjectSize_(uint8_t fifo) const
+  {
+    static const uint8_t payload[8] = {8, 12, 16, 20, 24, 32, 48, 64};
+    const uint8_t con0 = sfr_[FifoCon_(fifo)];
+    const uint16_t header = (!(con0 & 0x80) && (con0 & 0x20)) ? 12 : 8; // RX with RXTSEN gets the timestamp word
+    return header + payload[sfr_[FifoCon_(fifo) + 3] >> 5];
+  }
+  uint16_t Base_(uint8_t fifo) const
+  {
+    uint16_t base = 0;
+    for (uint8_t n = 1; n < fifo; ++n) base += Depth_(n) * ObjectSize_(n);
+    return base;
+  }
+  static uint16_t FifoCon_(uint8_t fifo) { return kFifoCon + kFifoStride * fifo; }
+
+  // --- registers ---
+
+  uint32_t Sfr32_(uint16_t address) const
+  {
+    uint32_t v;
+    memcpy(&v, &sfr_[address], 4);
+    return v;
+  }
+  void SetSfr32_(uint16_t address, uint32_t v) { memcpy(&sfr_[address], &v, 4); }
+
+  // FIFOSTA, FIFOUA and the per FIFO flag registers as the driver would see them now
+  void RefreshStatus_()
+  {
+    uint32_t rxIf = 0;
+    uint32_t rxOvIf = 0;
+    for (uint8_t n = 1; n < kFifos; ++n)
+    {
+      const Fifo& q = fifo_[n];
+      const uint8_t depth = Depth_(n);
+      uint32_t sta = 0;
+      if (IsTx_(n))
+      {
+        if (q.count < depth) sta |= 1;  // not full
+        if (q.count == 0) sta |= 1 << 2; // empty
+        sta |= static_cast<uint32_t>(q.tail) << 8;
+        SetSfr32_(FifoCon_(n) + 8, Base_(n) + q.head * ObjectSize_(n));
+      }
+      else
+      {
+        if (q.count > 0) sta |= 1;          // not empty
+        if (q.count == depth) sta |= 1 << 2; // full
+        if (q.overflow) sta |= 1 << 3;
+        sta |= static_cast<uint32_t>(q.head) << 8;
+        SetSfr32_(FifoCon_(n) + 8, Base_(n) + q.tail * ObjectSize_(n));
+        if (q.count > 0) rxIf |= 1u << n;
+        if (q.overflow) rxOvIf |= 1u << n;
+      }
+      SetSfr32_(FifoCon_(n) + 4, sta);
+      sfr_[FifoCon_(n) + 1] = q.txreq ? 0x02 : 0;
+    }
+    SetSfr32_(kRxIf, rxIf);
+    SetSfr32_(kRxOvIf, rxOvIf);
+    uint32_t intReg = Sfr32_(kInt);
+    if (rxIf != 0) intReg |= 1u << 1;
+    SetSfr32_(kInt, intReg);
+  }
+
+  uint8_t Peek_(uint16_t address) const
+  {
+    if (address >= kRamBase && address < kRamBase + kRamSize) return ram_[address - kRamBase];
+    if (address < sizeof(sfr_)) return sfr_[address];
+    return 0;
+  }
+
+  void Poke_(uint16_t address, uint8_t value)
+  {
+    if (address >= kRamBase && address < kRamBase + kRamSize)
+    {
+      ram_[address - kRamBase] = value;
+      return;
+    }
+    if (address >= sizeof(sfr_)) return;
+    if (address == kCon + 3)
+    {
+      sfr_[address] = value;
+      sfr_[kCon + 2] = static_cast<uint8_t>((sfr_[kCon + 2] & 0x1F) | ((value & 0x07) << 5));
+      return;
+    }
+    if (address >= FifoCon_(1) && address < kFltCon)
+    {
+      const uint8_t fifo = (address - kFifoCon) / kFifoStride;
+      const uint8_t offset = (address - kFifoCon) % kFifoStride;
+      if (offset == 1)
+      {
+        FifoControl_(fifo, value);
+        return;
+      }
+      if (offset == 3) memset(&fifo_[fifo], 0, sizeof(Fifo)); // new geometry starts an empty ring
+      if (offset == 4)
+      {
+        if (!(value & (1 << 3))) fifo_[fifo].overflow = false; // RXOVIF is clear-only
+        return;
+      }
+      if (offset >= 5) return; // FIFOSTA and FIFOUA are read only
+    }
+    sfr_[address] = value;
+  }
+
+  void FifoControl_(uint8_t fifo, uint8_t value)
+  {
+    Fifo& q = fifo_[fifo];
+    if (value & 0x04)
+    {
+      memset(&q, 0, sizeof(Fifo));
+      return;
+    }
+    if (value & 0x01)
+    {
+      uincs.push_back(Uinc{fifo, value});
+      if (IsTx_(fifo))
+      {
+        if (q.count < Depth_(fifo))
+        {
+          q.head = (q.head + 1) % Depth_(fifo);
+          ++q.count;
+        }
+      }
+      else if (q.count > 0)
+      {
+        q.tail = (q.tail + 1) % Depth_(fifo);
+        --q.count;
+      }
+    }
+    if (IsTx_(fifo)) q.txreq = value & 0x02;
+    if (value & 0x01 && OnUinc) OnUinc(fifo);
+  }
+
+  bool Store_(uint8_t fifo, uint8_t filter, uint32_t packedId, const Frame& frame)
+  {
+    Fifo& q = fifo_[fifo];
+    if (fifo == 0 || IsTx_(fifo)) return false;
+    if (q.count == Depth_(fifo))
+    {
+      q.overflow = true;
+      return false;
+    }
+    uint8_t* obj = &ram_[Base_(fifo) + q.head * ObjectSize_(fifo)];
+    const uint32_t flags = (frame.length & 0xFu) | (frame.extended ? 1u << 4 : 0u) | (static_cast<uint32_t>(filter) << 11);
+    const uint32_t stamp = ++stamp_;
+    memcpy(obj, &packedId, 4);
+    memcpy(obj + 4, &flags, 4);
+    memcpy(obj + 8, &stamp, 4);
+    memcpy(obj + 12, frame.data, 8);
+    q.head = (q.head + 1) % Depth_(fifo);
+    ++q.count;
+    return true;
+  }
+
+  uint8_t cs_;
+  bool selected_ = false;
+  uint32_t byteIndex_ = 0;
+  uint8_t command_ = 0;
+  uint16_t address_ = 0;
+  uint32_t stamp_ = 0;
+  uint8_t sfr_[0x400];
+  uint8_t ram_[kRamSize];
+  Fifo fifo_[kFifos];
+};
+
+#endif // TEST_FAKE_MCP2517FD_H
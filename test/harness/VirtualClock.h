@@ -0,0 +1,46 @@
+/**
+ * @file VirtualClock.h
+ * @brief Virtual time source for host tests, installed behind Clock.
+ *
+ * While installed, every Clock::NowUs()/NowMs() read in the units under test
+ * returns the virtual time, which only moves when the test (or an
+ * EventScheduler) advances it. Time starts at 1 s so that "0 = never seen"
+ * sentinels in the firmware are not hit by accident.
+ */
+#ifndef TEST_VIRTUAL_CLOCK_H
+#define TEST_VIRTUAL_CLOCK_H
+
+#include <cstdint>
+#include "Clock.h"
+
+/**
+ * @class VirtualClock
+ * @brief Monotonic microsecond counter that replaces the hardware timer.
+ */
+class VirtualClock
+{
+public:
+  static constexpr uint64_t kStartUs = 1000000ULL;
+
+  VirtualClock() { Clock::SetSource(&VirtualClock::Source_, this); }
+  ~VirtualClock() { Clock::SetSource(nullptr, nullptr); }
+  VirtualClock(const VirtualClock&) = delete;
+  VirtualClock& operator=(const VirtualClock&) = delete;
+
+  uint64_t NowUs() const { return nowUs_; }
+  uint32_t NowMs() const { return static_cast<uint32_t>(nowUs_ / 1000ULL); }
+
+  /** Move time forward to @p tUs; going backwards is ignored. */
+  void AdvanceTo(uint64_t tUs)
+  {
+    if (tUs > nowUs_) nowUs_ = tUs;
+  }
+  void Advance(uint64_t deltaUs) { nowUs_ += deltaUs; }
+
+private:
+  static uint64_t Source_(void* ctx) { return static_cast<VirtualClock*>(ctx)->nowUs_; }
+
+  uint64_t nowUs_ = kStartUs;
+};
+
+#endif // TEST_VIRTUAL_CLOCK_H
@@ -0,0 +1,236 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for CANBusLoad: frame bit counts and the 100 ms bucket ring.
+ *
+ * lib/CanDriver as a whole needs the ESP32 core, so the native env ignores the
+ * library and this suite compiles the one hardware-free unit it tests directly.
+ */
+#include <unity.h>
+#include "can_busload.cpp"
+
+namespace
+{
+constexpr uint32_t kBitRate = 500000;     // 50000 bit times per 100 ms bucket
+constexpr uint32_t kBucketUs = BUSLOAD_BUCKET_US;
+constexpr uint32_t kT0 = 1000000;
+
+// Stuff bits a CAN transmitter inserts into @p bits (one after every run of 5 equal bits)
+uint32_t CountStuffBits(const uint8_t* bits, uint32_t n)
+{
+  uint32_t stuffed = 0;
+  uint32_t run = 0;
+  uint8_t last = 2;
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    run = (bits[i] == last) ? run + 1 : 1;
+    last = bits[i];
+    if (run == 5)
+    {
+      // the complemented stuff bit starts the next run
+      ++stuffed;
+      last = !last;
+      run = 1;
+    }
+  }
+  return stuffed;
+}
+
+// Worst case pattern: 5 equal bits, then alternating groups of 4, so every
+// inserted stuff bit is the first of a new run of the same polarity
+uint32_t WorstCaseStuffBits(uint32_t n)
+{
+  uint8_t bits[700];
+  uint32_t i = 0;
+  for (; i < 5 && i < n; ++i) bits[i] = 0;
+  uint8_t level = 1;
+  for (uint32_t k = 0; i < n; ++i, ++k)
+  {
+    if (k == 4)
+    {
+      k = 0;
+      level = !level;
+    }
+    bits[i] = level;
+  }
+  return CountStuffBits(bits, n);
+}
+
+CAN_BUSLOAD_STATS Stats(CANBusLoad& load, uint32_t nowUs)
+{
+  CAN_BUSLOAD_STATS s;
+  load.getStats(s, kBitRate, nowUs);
+  return s;
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_classic_unstuffed_lengths(void)
+{
+  // Standard: 47 bits + data, extended: 67 bits + data (intermission included), plus
+  // worst case stuffing of the SOF..CRC region on top
+  for (uint8_t len = 0; len <= 8; ++len)
+  {
+    const uint32_t std = CANBusLoad::classicFrameBits(false, len, false);
+    const uint32_t ext = CANBusLoad::classicFrameBits(true, len, false);
+    TEST_ASSERT_EQUAL_UINT32(47u + 8u * len + (34u + 8u * len - 1u) / 4u, std);
+    TEST_ASSERT_EQUAL_UINT32(67u + 8u * len + (54u + 8u * len - 1u) / 4u, ext);
+  }
+}
+
+void test_classic_stuff_bits_match_worst_case_pattern(void)
+{
+  // The stuffed region (SOF..CRC) of every DLC gets exactly the stuff bits a
+  // bit-level stuffer inserts into the worst case pattern of that length
+  for (uint8_t len = 0; len <= 8; ++len)
+  {
+    const uint32_t stdRegion = 34u + 8u * len;
+    const uint32_t extRegion = 54u + 8u * len;
+    TEST_ASSERT_EQUAL_UINT32(stdRegion + WorstCaseStuffBits(stdRegion) + 13u,
+                             CANBusLoad::classicFrameBits(false, len, false));
+    TEST_ASSERT_EQUAL_UINT32(extRegion + WorstCaseStuffBits(extRegion) + 13u,
+                             CANBusLoad::classicFrameBits(true, len, false));
+  }
+}
+
+void test_classic_rtr_and_long_dlc(void)
+{
+  TEST_ASSERT_EQUAL_UINT32(55, CANBusLoad::classicFrameBits(false, 8, true));
+  TEST_ASSERT_EQUAL_UINT32(80, CANBusLoad::classicFrameBits(true, 4, true));
+  TEST_ASSERT_EQUAL_UINT32(135, CANBusLoad::classicFrameBits(false, 15, false));
+  TEST_ASSERT_EQUAL_UINT32(160, CANBusLoad::classicFrameBits(true, 255, false));
+}
+
+void test_fd_frame_bits_nominal_rate(void)
+{
+  // 11 bit ID, 8 bytes: 17 arbitration bits + 4 stuff + 12 trailer = 33 nominal,
+  // data phase 69 + 17 dynamic stuff, CRC field 21 + 6 fixed stuff, delimiter 1
+  TEST_ASSERT_EQUAL_UINT32(147, CANBusLoad::fdFrameBits(false, 8, false, 500000, 2000000));
+  // 29 bit ID, no data: 36 + 8 + 12 nominal, 5 + 1 + 21 + 6 + 1 data phase
+  TEST_ASSERT_EQUAL_UINT32(90, CANBusLoad::fdFrameBits(true, 0, false, 500000, 2000000));
+  // Above 16 data bytes the CRC grows to 21 bits: 517 + 129 + 25 + 7 + 1 data phase
+  TEST_ASSERT_EQUAL_UINT32(712, CANBusLoad::fdFrameBits(false, 64, false, 500000, 2000000));
+  TEST_ASSERT_EQUAL_UINT32(CANBusLoad::fdFrameBits(false, 16, false, 500000, 500000) + 8u * 4u + 8u + 4u + 1u,
+                           CANBusLoad::fdFrameBits(false, 20, false, 500000, 500000));
+}
+
+void test_fd_frame_bits_bit_rate_switch(void)
+{
+  // 679 data phase bits at 4x the nominal rate are 169.75 nominal bit times, rounded up
+  TEST_ASSERT_EQUAL_UINT32(33u + 170u, CANBusLoad::fdFrameBits(false, 64, true, 500000, 2000000));
+  // BRS only shortens the frame when the data rate really is faster
+  TEST_ASSERT_EQUAL_UINT32(712, CANBusLoad::fdFrameBits(false, 64, true, 500000, 500000));
+  TEST_ASSERT_EQUAL_UINT32(712, CANBusLoad::fdFrameBits(false, 64, true, 500000, 250000));
+  TEST_ASSERT_EQUAL_UINT32(712, CANBusLoad::fdFrameBits(false, 64, true, 0, 2000000));
+  // Lengths above 64 bytes clamp
+  TEST_ASSERT_EQUAL_UINT32(712, CANBusLoad::fdFrameBits(false, 200, false, 500000, 2000000));
+}
+
+void test_windows_roll_over_the_bucket_ring(void)
+{
+  CANBusLoad load;
+  // Bucket k carries (k + 1) * 100 bits for 25 s, i.e. 2.5 passes over the 100 bucket ring
+  for (uint32_t k = 0; k < 250; ++k)
+  {
+    load.recordFrame((k + 1u) * 100u, kT0 + k * kBucketUs);
+  }
+
+  CAN_BUSLOAD_STATS s = Stats(load, kT0 + 250u * kBucketUs);
+  TEST_ASSERT_EQUAL_UINT32(250, s.frames);
+  TEST_ASSERT_EQUAL_UINT16(5000, s.load100ms); // 25000 of 50000 bits
+  TEST_ASSERT_EQUAL_UINT16(4910, s.load1s);    // buckets 240..249
+  TEST_ASSERT_EQUAL_UINT16(4010, s.load10s);   // buckets 150..249
+  TEST_ASSERT_EQUAL_UINT16(5000, s.peak100ms);
+  TEST_ASSERT_EQUAL_UINT16(4910, s.peak1s);
+  TEST_ASSERT_EQUAL_UINT16(4010, s.peak10s);
+
+  // 3 s of silence: the 1 s window empties, the 10 s window keeps buckets 180..249
+  s = Stats(load, kT0 + 280u * kBucketUs);
+  TEST_ASSERT_EQUAL_UINT16(0, s.load100ms);
+  TEST_ASSERT_EQUAL_UINT16(0, s.load1s);
+  TEST_ASSERT_EQUAL_UINT16(3017, s.load10s);
+  TEST_ASSERT_EQUAL_UINT16(5000, s.peak100ms);
+  TEST_ASSERT_EQUAL_UINT16(4910, s.peak1s);
+  TEST_ASSERT_EQUAL_UINT16(4010, s.peak10s);
+}
+
+void test_long_silence_clears_every_window(void)
+{
+  CANBusLoad load;
+  for (uint32_t k = 0; k < 120; ++k)
+  {
+    load.recordFrame(10000, kT0 + k * kBucketUs);
+  }
+  // An hour later: only BUSLOAD_BUCKETS + 1 buckets are closed, all of them empty
+  const CAN_BUSLOAD_STATS s = Stats(load, kT0 + 3600u * 1000000u);
+  TEST_ASSERT_EQUAL_UINT16(0, s.load100ms);
+  TEST_ASSERT_EQUAL_UINT16(0, s.load1s);
+  TEST_ASSERT_EQUAL_UINT16(0, s.load10s);
+  TEST_ASSERT_EQUAL_UINT16(2000, s.peak100ms);
+  TEST_ASSERT_EQUAL_UINT16(2000, s.peak10s);
+  TEST_ASSERT_EQUAL_UINT32(120, s.frames);
+}
+
+void test_saturates_at_full_load(void)
+{
+  CANBusLoad load;
+  // 12 frames of 50000 bits in one bucket: 12x the capacity of 100 ms and 1.2x that of 1 s
+  for (int i = 0; i < 12; ++i) load.recordFrame(50000, kT0 + static_cast<uint32_t>(i) * 1000u);
+  CAN_BUSLOAD_STATS s = Stats(load, kT0 + kBucketUs);
+  TEST_ASSERT_EQUAL_UINT16(10000, s.load100ms);
+  TEST_ASSERT_EQUAL_UINT16(10000, s.load1s);
+  TEST_ASSERT_EQUAL_UINT16(1200, s.load10s);
+  TEST_ASSERT_EQUAL_UINT16(10000, s.peak100ms);
+  TEST_ASSERT_EQUAL_UINT16(10000, s.peak1s);
+
+  // Counts far beyond 32 bit products still clamp instead of wrapping
+  load.recordFrame(0xF0000000u, kT0 + kBucketUs);
+  s = Stats(load, kT0 + 2u * kBucketUs);
+  TEST_ASSERT_EQUAL_UINT16(10000, s.load100ms);
+  TEST_ASSERT_EQUAL_UINT16(10000, s.load10s);
+
+  load.getStats(s, 0, kT0 + 2u * kBucketUs);
+  TEST_ASSERT_EQUAL_UINT16(0, s.load100ms);
+}
+
+void test_buckets_follow_the_micros_wrap(void)
+{
+  CANBusLoad load;
+  const uint32_t start = 0xFFFFFFFFu - 250000u; // wraps during the third bucket
+  for (uint32_t k = 0; k < 20; ++k)
+  {
+    load.recordFrame(5000, start + k * kBucketUs);
+  }
+  const CAN_BUSLOAD_STATS s = Stats(load, start + 20u * kBucketUs);
+  TEST_ASSERT_EQUAL_UINT16(1000, s.load100ms);
+  TEST_ASSERT_EQUAL_UINT16(1000, s.load1s);
+  TEST_ASSERT_EQUAL_UINT16(200, s.load10s);
+}
+
+void test_reset_clears_history(void)
+{
+  CANBusLoad load;
+  load.recordFrame(50000, kT0);
+  load.reset();
+  const CAN_BUSLOAD_STATS s = Stats(load, kT0 + 5u * kBucketUs);
+  TEST_ASSERT_EQUAL_UINT32(0, s.frames);
+  TEST_ASSERT_EQUAL_UINT16(0, s.load100ms);
+  TEST_ASSERT_EQUAL_UINT16(0, s.peak100ms);
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_classic_unstuffed_lengths);
+  RUN_TEST(test_classic_stuff_bits_match_worst_case_pattern);
+  RUN_TEST(test_classic_rtr_and_long_dlc);
+  RUN_TEST(test_fd_frame_bits_nominal_rate);
+  RUN_TEST(test_fd_frame_bits_bit_rate_switch);
+  RUN_TEST(test_windows_roll_over_the_bucket_ring);
+  RUN_TEST(test_long_silence_clears_every_window);
+  RUN_TEST(test_saturates_at_full_load);
+  RUN_TEST(test_buckets_follow_the_micros_wrap);
+  RUN_TEST(test_reset_clears_history);
+  return UNITY_END();
+}
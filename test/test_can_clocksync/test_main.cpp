@@ -0,0 +1,185 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for CANClockSync: TBC to host time conversion under drift and jitter.
+ *
+ * The MCP2517FD time base counter is modelled as a 1 µs counter running a
+ * fixed number of ppm fast or slow against host time, starting close to its
+ * 32-bit wrap. Samples arrive every 250 ms like the driver takes them, with
+ * the host side jittered by up to ±3 µs (the CiTBC read between two
+ * esp_timer_get_time() calls). Frames are stamped at random points between
+ * two samples and converted after the earlier one, as the polling task does.
+ * Like test_can_busload this compiles the unit directly because the native
+ * env ignores the CanDriver library.
+ */
+#include <unity.h>
+#include <cstdint>
+#include "can_clocksync.cpp"
+
+namespace
+{
+// Small LCG so jitter and frame times are the same on every host
+uint32_t g_seed = 1;
+uint32_t NextRandom()
+{
+  g_seed = g_seed * 1103515245U + 12345U;
+  return g_seed >> 16;
+}
+
+// -range..+range
+int64_t Jitter(int64_t range)
+{
+  return static_cast<int64_t>(NextRandom() % static_cast<uint32_t>(2 * range + 1)) - range;
+}
+
+constexpr int64_t kSamplePeriodUs = 250000;
+constexpr int64_t kJitterUs = 3;
+
+/** Free running TBC: base + (host - start) * (1 + ppm), truncated to 32 bits. */
+class Tbc
+{
+public:
+  Tbc(uint32_t base, int64_t startHostUs, double ppm) : base_(base), startUs_(startHostUs), ppm_(ppm) {}
+
+  int32_t DriftPpb() const { return static_cast<int32_t>(ppm_ * 1000.0); }
+
+  uint32_t At(int64_t hostUs) const
+  {
+    const double ticks = static_cast<double>(hostUs - startUs_) * (1.0 + ppm_ * 1e-6);
+    return base_ + static_cast<uint32_t>(static_cast<int64_t>(ticks));
+  }
+
+private:
+  uint32_t base_;
+  int64_t startUs_;
+  double ppm_;
+};
+
+/** Feeds samples and measures frame conversion error, split by window fill. */
+class Rig
+{
+public:
+  /** Run @p seconds of samples against @p tbc starting at host time @p hostUs. */
+  int64_t Run(const Tbc& tbc, int64_t hostUs, uint32_t seconds)
+  {
+    const int64_t endUs = hostUs + static_cast<int64_t>(seconds) * 1000000;
+    for (; hostUs < endUs; hostUs += kSamplePeriodUs)
+    {
+      sync.addSample(tbc.At(hostUs), hostUs + Jitter(kJitterUs));
+
+      CAN_CLOCKSYNC_STATS stats;
+      sync.getStats(stats);
+      for (int f = 0; f < 20; ++f)
+      {
+        const int64_t frameUs = hostUs + static_cast<int64_t>(NextRandom() % kSamplePeriodUs);
+        uint32_t converted = 0;
+        TEST_ASSERT_TRUE(sync.toHostUs(tbc.At(frameUs), converted));
+        const int32_t err = static_cast<int32_t>(converted - static_cast<uint32_t>(frameUs));
+        const uint32_t absErr = static_cast<uint32_t>(err < 0 ? -err : err);
+        uint32_t& worst = (stats.samples == CLOCKSYNC_SAMPLES) ? worstFullUs : worstFillingUs;
+        if (absErr > worst) worst = absErr;
+      }
+      if (stats.samples == CLOCKSYNC_SAMPLES)
+      {
+        const int32_t driftErr = stats.driftPpb - tbc.DriftPpb();
+        const uint32_t absDriftErr = static_cast<uint32_t>(driftErr < 0 ? -driftErr : driftErr);
+        if (absDriftErr > worstDriftErrPpb) worstDriftErrPpb = absDriftErr;
+        if (stats.residualUs > worstResidualUs) worstResidualUs = stats.residualUs;
+      }
+    }
+    return hostUs;
+  }
+
+  CANClockSync sync;
+  uint32_t worstFullUs = 0;    // conversions with a full 16-sample window
+  uint32_t worstFillingUs = 0; // conversions while the window refills after a start or resync
+  uint32_t worstResidualUs = 0;
+  uint32_t worstDriftErrPpb = 0; // |driftPpb - true drift| with a full window
+};
+
+// Bounds quoted in docs/can-and-dbc.md. With ±3 µs jitter one 16-sample fit has a
+// slope standard error of about 0.4 ppm, so the worst drift over a run is near 1.5 ppm.
+constexpr uint32_t kFullTolUs = 5;
+constexpr uint32_t kFillingTolUs = 8;
+constexpr uint32_t kResidualTolUs = 6;
+constexpr uint32_t kDriftTolPpb = 2000;
+
+// Host time well past 32 bits, so the low-32-bit result of toHostUs() wraps too
+constexpr int64_t kHostStartUs = 5000000000LL;
+}
+
+void setUp(void)
+{
+  g_seed = 1;
+}
+
+void tearDown(void) {}
+
+void test_invalid_until_first_sample(void)
+{
+  CANClockSync sync;
+  uint32_t hostUs = 123;
+  TEST_ASSERT_FALSE(sync.toHostUs(1000, hostUs));
+  TEST_ASSERT_EQUAL_UINT32(123, hostUs);
+  CAN_CLOCKSYNC_STATS stats;
+  sync.getStats(stats);
+  TEST_ASSERT_FALSE(stats.valid);
+  TEST_ASSERT_EQUAL_INT32(0, stats.driftPpb);
+
+  sync.addSample(1000, 7000);
+  TEST_ASSERT_TRUE(sync.toHostUs(1500, hostUs));
+  TEST_ASSERT_EQUAL_UINT32(7500, hostUs); // nominal rate until a second sample
+}
+
+void test_fast_tbc_across_wrap(void)
+{
+  // Wraps 20 s in; 47 ppm fast
+  Rig rig;
+  const Tbc tbc(0xFFFFFFFFU - 20000000U, kHostStartUs, 47.0);
+  rig.Run(tbc, kHostStartUs, 60);
+
+  CAN_CLOCKSYNC_STATS stats;
+  rig.sync.getStats(stats);
+  TEST_ASSERT_EQUAL_UINT32(240, stats.accepted);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.resyncs);
+  TEST_ASSERT_EQUAL_UINT8(CLOCKSYNC_SAMPLES, stats.samples);
+  TEST_ASSERT_TRUE(stats.driftPpb > 0);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kDriftTolPpb, rig.worstDriftErrPpb);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kFullTolUs, rig.worstFullUs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kFillingTolUs, rig.worstFillingUs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kResidualTolUs, rig.worstResidualUs);
+}
+
+void test_slow_tbc_and_reset(void)
+{
+  // 30 ppm slow, then the controller is reset and the TBC restarts from 0; the
+  // window refills from the first sample after the reset
+  Rig rig;
+  const Tbc before(0xFFFFFFFFU - 5000000U, kHostStartUs, -30.0);
+  const int64_t resetUs = rig.Run(before, kHostStartUs, 30);
+
+  CAN_CLOCKSYNC_STATS stats;
+  rig.sync.getStats(stats);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.resyncs);
+  TEST_ASSERT_TRUE(stats.driftPpb < 0);
+
+  const Tbc after(0, resetUs, -30.0);
+  rig.Run(after, resetUs, 30);
+  rig.sync.getStats(stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.resyncs);
+  TEST_ASSERT_EQUAL_UINT32(240, stats.accepted);
+  TEST_ASSERT_EQUAL_UINT8(CLOCKSYNC_SAMPLES, stats.samples);
+  TEST_ASSERT_TRUE(stats.driftPpb < 0);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kDriftTolPpb, rig.worstDriftErrPpb);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kFullTolUs, rig.worstFullUs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kFillingTolUs, rig.worstFillingUs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kResidualTolUs, rig.worstResidualUs);
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_invalid_until_first_sample);
+  RUN_TEST(test_fast_tbc_across_wrap);
+  RUN_TEST(test_slow_tbc_and_reset);
+  return UNITY_END();
+}
@@ -0,0 +1,156 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for GaugeAnimator: step response, stability and frame pacing.
+ *
+ * The animator is driven the way DashboardView does, one Step() per display
+ * frame, with time constants from 1 ms (far shorter than a 30 fps frame) to
+ * the dashboard's 80 ms and beyond.
+ */
+#include <unity.h>
+#include "GaugeAnimator.h"
+
+namespace
+{
+constexpr uint16_t kFps = 30;            // UI_ARC_ANIM_FPS
+constexpr uint32_t kFrameMs = 34;        // ceil(1000 / 30)
+constexpr int32_t kTarget = 1000;
+constexpr uint32_t kT0 = 5000;
+
+struct Response
+{
+  bool monotonic = true;
+  int32_t maxValue = INT32_MIN;
+  uint32_t settledAfterMs = UINT32_MAX;
+  uint32_t frames = 0;
+};
+
+// Step from 0 to kTarget, one Step() per frame for up to @p durationMs
+Response StepResponse(GaugeAnimator& anim, uint32_t durationMs)
+{
+  Response r;
+  anim.Jump(0);
+  anim.SetTarget(kTarget, kT0);
+  int32_t last = 0;
+  for (uint32_t t = kT0; t <= kT0 + durationMs; t += kFrameMs)
+  {
+    int32_t value = 0;
+    if (anim.Step(t, value))
+    {
+      ++r.frames;
+      if (value < last) r.monotonic = false;
+      if (value > r.maxValue) r.maxValue = value;
+      last = value;
+    }
+    if (anim.Settled() && r.settledAfterMs == UINT32_MAX) r.settledAfterMs = t - kT0;
+  }
+  return r;
+}
+
+void CheckConverges(uint16_t tauMs)
+{
+  GaugeAnimator anim(GaugeAnimator::Config{kFps, tauMs});
+  const Response r = StepResponse(anim, 10000);
+  TEST_ASSERT_TRUE(r.monotonic);
+  TEST_ASSERT_EQUAL_INT32(kTarget, r.maxValue);
+  TEST_ASSERT_TRUE(anim.Settled());
+  TEST_ASSERT_EQUAL_INT32(kTarget, anim.Value());
+  // Within a quarter unit of 1000 takes about 11 time constants, plus frame rounding
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(12U * tauMs + 2U * kFrameMs, r.settledAfterMs);
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_converges_at_tau_1ms(void)
+{
+  CheckConverges(1);
+}
+
+void test_converges_at_tau_10ms(void)
+{
+  CheckConverges(10);
+}
+
+void test_converges_at_tau_100ms(void)
+{
+  CheckConverges(100);
+}
+
+void test_converges_at_dashboard_tau(void)
+{
+  CheckConverges(80); // UI_ARC_ANIM_TAU_MS
+}
+
+void test_follows_the_closed_form_response(void)
+{
+  // x(t) = 1 - (1 + t/tau) e^(-t/tau): 3 frames = 102 ms at tau 100 gives 0.2716
+  GaugeAnimator anim(GaugeAnimator::Config{kFps, 100});
+  anim.Jump(0);
+  anim.SetTarget(kTarget, kT0);
+  int32_t value = 0;
+  TEST_ASSERT_TRUE(anim.Step(kT0, value)); // first frame is due at once and covers 34 ms
+  TEST_ASSERT_TRUE(anim.Step(kT0 + kFrameMs, value));
+  TEST_ASSERT_TRUE(anim.Step(kT0 + 2U * kFrameMs, value));
+  TEST_ASSERT_INT32_WITHIN(2, 272, value);
+}
+
+void test_zero_tau_is_clamped_not_divergent(void)
+{
+  GaugeAnimator anim(GaugeAnimator::Config{kFps, 0});
+  const Response r = StepResponse(anim, 1000);
+  TEST_ASSERT_TRUE(r.monotonic);
+  TEST_ASSERT_EQUAL_INT32(kTarget, r.maxValue);
+  TEST_ASSERT_EQUAL_UINT32(0, r.settledAfterMs); // a 34 ms frame covers 34 time constants
+}
+
+void test_long_stall_does_not_overshoot(void)
+{
+  GaugeAnimator anim(GaugeAnimator::Config{kFps, 10});
+  anim.Jump(-500);
+  anim.SetTarget(500, kT0);
+  int32_t value = 0;
+  anim.Step(kT0, value);
+  anim.Step(kT0 + 60000, value); // one frame after a minute without any
+  TEST_ASSERT_EQUAL_INT32(500, anim.Value());
+  TEST_ASSERT_TRUE(anim.Settled());
+}
+
+void test_frame_rate_caps_updates(void)
+{
+  GaugeAnimator anim(GaugeAnimator::Config{kFps, 100});
+  anim.Jump(0);
+  anim.SetTarget(kTarget, kT0);
+  uint32_t updates = 0;
+  for (uint32_t t = kT0; t < kT0 + 1000; ++t)
+  {
+    int32_t value = 0;
+    if (anim.Step(t, value)) ++updates;
+  }
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kFps, updates);
+  TEST_ASSERT_EQUAL_UINT32(kFrameMs - 1U, anim.MsToNextStep(kT0 + 29U * kFrameMs + 1U));
+}
+
+void test_zero_fps_jumps(void)
+{
+  GaugeAnimator anim(GaugeAnimator::Config{0, 100});
+  anim.SetTarget(kTarget, kT0);
+  TEST_ASSERT_TRUE(anim.Settled());
+  TEST_ASSERT_EQUAL_INT32(kTarget, anim.Value());
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, anim.MsToNextStep(kT0));
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_converges_at_tau_1ms);
+  RUN_TEST(test_converges_at_tau_10ms);
+  RUN_TEST(test_converges_at_tau_100ms);
+  RUN_TEST(test_converges_at_dashboard_tau);
+  RUN_TEST(test_follows_the_closed_form_response);
+  RUN_TEST(test_zero_tau_is_clamped_not_divergent);
+  RUN_TEST(test_long_stall_does_not_overshoot);
+  RUN_TEST(test_frame_rate_caps_updates);
+  RUN_TEST(test_zero_fps_jumps);
+  return UNITY_END();
+}
@@ -0,0 +1,299 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for HealthMonitor under jittery and lossy Cluster traffic.
+ *
+ * Frames are fed the way SystemController does (NotifyFrame with the receive
+ * stamp, CheckTimeout on every loop pass) on a VirtualClock, so minutes of
+ * 100 ms traffic run in a few milliseconds and every run is reproducible.
+ */
+#include <unity.h>
+#include "HealthMonitor.h"
+#include "EventQueue.h"
+#include "Clock.h"
+#include "common/MessageRouter.h"
+#include "harness/VirtualClock.h"
+
+namespace
+{
+constexpr uint32_t kCanId = 0x65;
+constexpr uint32_t kPeriodUs = 100000;
+constexpr uint32_t kLoopUs = 10000; // SystemController poll cadence in the simulation
+
+// Small LCG so the traffic pattern is the same on every host
+uint32_t g_seed = 1;
+uint32_t NextRandom()
+{
+  g_seed = g_seed * 1103515245U + 12345U;
+  return g_seed >> 16;
+}
+
+struct Counts
+{
+  uint32_t timeouts = 0;
+  uint32_t recoveries = 0;
+  uint32_t delivered = 0;
+  uint32_t minFramesBetween = UINT32_MAX; // delivered frames from a timeout to its recovery
+};
+
+class Rig
+{
+public:
+  Rig()
+  {
+    queue.Init(16);
+    router.Init(2);
+    monitor.SetExpectedPeriod(kCanId, kPeriodUs, 20);
+    monitor.SetStalenessPolicy(5, 8, 5);
+  }
+
+  void Frame()
+  {
+    const uint32_t ts = Clock::NowUs();
+    router.PublishCluster(Cluster_t{}, Clock::NowMs());
+    monitor.NotifyFrame(queue, kCanId, ts);
+    ++counts.delivered;
+    Drain_();
+  }
+
+  void AdvanceTo(uint64_t tUs)
+  {
+    while (clock.NowUs() + kLoopUs <= tUs)
+    {
+      clock.Advance(kLoopUs);
+      monitor.CheckTimeout(queue, router);
+      Drain_();
+    }
+    clock.AdvanceTo(tUs);
+  }
+
+  /** 100 ms traffic with +/- jitterUs around each nominal slot and dropPct loss. */
+  void Run(uint32_t frames, uint32_t jitterUs, uint32_t dropPct)
+  {
+    const uint64_t start = clock.NowUs();
+    for (uint32_t i = 1; i <= frames; ++i)
+    {
+      const int32_t offset = (jitterUs == 0) ? 0
+          : static_cast<int32_t>(NextRandom() % (2U * jitterUs + 1U)) - static_cast<int32_t>(jitterUs);
+      AdvanceTo(start + static_cast<uint64_t>(i) * kPeriodUs + offset);
+      if (NextRandom() % 100U >= dropPct) Frame();
+    }
+  }
+
+  VirtualClock clock;
+  EventQueue queue;
+  MessageRouter router;
+  HealthMonitor monitor;
+  Counts counts;
+
+private:
+  void Drain_()
+  {
+    Event e;
+    while (queue.Pop(e))
+    {
+      if (e.type == EventType::FrameTimeout)
+      {
+        ++counts.timeouts;
+        timeoutAt_ = counts.delivered;
+      }
+      else if (e.type == EventType::FrameRecovered)
+      {
+        ++counts.recoveries;
+        const uint32_t between = counts.delivered - timeoutAt_;
+        if (between < counts.minFramesBetween) counts.minFramesBetween = between;
+      }
+    }
+  }
+
+  uint32_t timeoutAt_ = 0;
+};
+}
+
+void setUp(void)
+{
+  g_seed = 1;
+}
+
+void tearDown(void) {}
+
+void test_ewma_and_histogram_track_exact_periods(void)
+{
+  Rig rig;
+  rig.Frame();
+  rig.AdvanceTo(rig.clock.NowUs() + 100000);
+  rig.Frame(); // seeds EWMA, min and max
+  rig.AdvanceTo(rig.clock.NowUs() + 110000);
+  rig.Frame(); // 10 ms late: deviation 10000 us lands in bucket 14 ([8192, 16384))
+
+  HealthMonitor::PeriodStats s;
+  TEST_ASSERT_TRUE(rig.monitor.GetPeriodStats(kCanId, s));
+  TEST_ASSERT_EQUAL_UINT32(3, s.frameCount);
+  TEST_ASSERT_EQUAL_UINT32(101250, s.ewmaPeriodUs); // 100000 + 10000 / 8
+  TEST_ASSERT_EQUAL_UINT32(100000, s.minPeriodUs);
+  TEST_ASSERT_EQUAL_UINT32(110000, s.maxPeriodUs);
+  TEST_ASSERT_EQUAL_UINT32(1, s.jitterHist[14]);
+  TEST_ASSERT_FALSE(s.drifting);
+}
+
+void test_ewma_settles_under_symmetric_jitter(void)
+{
+  Rig rig;
+  rig.Run(600, 40000, 0);
+
+  HealthMonitor::PeriodStats s;
+  TEST_ASSERT_TRUE(rig.monitor.GetPeriodStats(kCanId, s));
+  TEST_ASSERT_EQUAL_UINT32(600, s.frameCount);
+  TEST_ASSERT_UINT32_WITHIN(20000, kPeriodUs, s.ewmaPeriodUs);
+  TEST_ASSERT_FALSE(s.drifting);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(20000, s.minPeriodUs);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(180000, s.maxPeriodUs);
+
+  // Every interval after the seeding one is in exactly one bucket, none beyond 2^17 us
+  uint32_t total = 0;
+  for (std::size_t b = 0; b < HealthMonitor::kJitterBuckets; ++b)
+  {
+    total += s.jitterHist[b];
+    if (b > 17) TEST_ASSERT_EQUAL_UINT32(0, s.jitterHist[b]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(s.frameCount - 2U, total);
+}
+
+void test_slow_sender_is_flagged_as_drifting(void)
+{
+  Rig rig;
+  rig.Frame();
+  for (int i = 0; i < 40; ++i)
+  {
+    rig.AdvanceTo(rig.clock.NowUs() + 130000); // 30 % slow, tolerance is 20 %
+    rig.Frame();
+  }
+  TEST_ASSERT_TRUE(rig.monitor.IsDrifting(kCanId));
+}
+
+void test_n_of_m_misses_trigger_once(void)
+{
+  Rig rig;
+  rig.Run(20, 0, 0);
+  // Four consecutive gaps: 4 misses in the window of 8 is not enough
+  uint64_t t = rig.clock.NowUs();
+  rig.AdvanceTo(t + 5U * kPeriodUs);
+  rig.Frame();
+  TEST_ASSERT_EQUAL_UINT32(0, rig.counts.timeouts);
+  TEST_ASSERT_FALSE(rig.monitor.IsStale());
+
+  // A fifth miss inside the same 8 slots trips it, once, without waiting for a frame
+  t = rig.clock.NowUs();
+  rig.AdvanceTo(t + 2U * kPeriodUs);
+  TEST_ASSERT_EQUAL_UINT32(1, rig.counts.timeouts);
+  TEST_ASSERT_TRUE(rig.monitor.IsStale());
+  rig.AdvanceTo(t + 20U * kPeriodUs);
+  TEST_ASSERT_EQUAL_UINT32(1, rig.counts.timeouts);
+
+  // Recovery needs K = 5 on-time frames: the first frame after silence does not count
+  for (int i = 0; i < 5; ++i)
+  {
+    rig.AdvanceTo(rig.clock.NowUs() + kPeriodUs);
+    rig.Frame();
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, rig.counts.recoveries);
+  rig.AdvanceTo(rig.clock.NowUs() + kPeriodUs);
+  rig.Frame();
+  TEST_ASSERT_EQUAL_UINT32(1, rig.counts.recoveries);
+  TEST_ASSERT_FALSE(rig.monitor.IsStale());
+}
+
+void test_jitter_without_loss_never_degrades(void)
+{
+  Rig rig;
+  rig.Run(3000, 40000, 0); // 5 minutes of +/- 40 ms
+  TEST_ASSERT_EQUAL_UINT32(0, rig.counts.timeouts);
+}
+
+void test_moderate_loss_is_debounced(void)
+{
+  Rig rig;
+  rig.Run(3000, 40000, 20);
+  // Occasional Degraded episodes are allowed, flapping is not: every recovery
+  // needs the full on-time streak after the timeout
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(rig.counts.recoveries + 1U, rig.counts.timeouts);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(rig.counts.timeouts, rig.counts.recoveries);
+  if (rig.counts.recoveries != 0) TEST_ASSERT_GREATER_OR_EQUAL_UINT32(5, rig.counts.minFramesBetween);
+  TEST_ASSERT_LESS_THAN_UINT32(30, rig.counts.timeouts);
+}
+
+void test_heavy_loss_alternates_without_flapping(void)
+{
+  Rig rig;
+  rig.Run(3000, 40000, 40);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, rig.counts.timeouts);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, rig.counts.recoveries);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(5, rig.counts.minFramesBetween);
+}
+
+void test_burst_after_misses_does_not_dilute_window(void)
+{
+  Rig rig;
+  rig.Run(20, 0, 0);
+  // Five missed slots (deadlines at 1.5, 2.5, ... 5.5 periods), then the sender
+  // catches up with four frames back to back
+  rig.AdvanceTo(rig.clock.NowUs() + 5U * kPeriodUs + kPeriodUs / 2U + 10000U);
+  TEST_ASSERT_EQUAL_UINT32(1, rig.counts.timeouts);
+  for (int i = 0; i < 4; ++i)
+  {
+    rig.Frame();
+    rig.AdvanceTo(rig.clock.NowUs() + 1000);
+  }
+
+  // Only the first frame of the burst fills a slot: one shift, the 5 misses stay in the window
+  HealthMonitor::PeriodStats s;
+  TEST_ASSERT_TRUE(rig.monitor.GetPeriodStats(kCanId, s));
+  TEST_ASSERT_EQUAL_UINT8(5, s.missesInWindow);
+  TEST_ASSERT_EQUAL_UINT16(0, s.onTimeStreak);
+  TEST_ASSERT_TRUE(rig.monitor.IsStale());
+  TEST_ASSERT_EQUAL_UINT32(0, rig.counts.recoveries);
+}
+
+void test_duplicates_do_not_count_towards_recovery(void)
+{
+  Rig rig;
+  rig.Run(20, 0, 0);
+  rig.AdvanceTo(rig.clock.NowUs() + 20U * kPeriodUs);
+  TEST_ASSERT_TRUE(rig.monitor.IsStale());
+
+  // First frame after silence plus four on-time ones, each delivered twice 200 us apart:
+  // ten frames but only four on-time slots, below K = 5
+  for (int i = 0; i < 5; ++i)
+  {
+    rig.AdvanceTo(rig.clock.NowUs() + kPeriodUs);
+    rig.Frame();
+    rig.AdvanceTo(rig.clock.NowUs() + 200);
+    rig.Frame();
+  }
+  HealthMonitor::PeriodStats s;
+  TEST_ASSERT_TRUE(rig.monitor.GetPeriodStats(kCanId, s));
+  TEST_ASSERT_EQUAL_UINT16(4, s.onTimeStreak);
+  TEST_ASSERT_EQUAL_UINT32(0, rig.counts.recoveries);
+
+  // The fifth on-time slot recovers; its duplicate changes nothing
+  rig.AdvanceTo(rig.clock.NowUs() + kPeriodUs);
+  rig.Frame();
+  rig.AdvanceTo(rig.clock.NowUs() + 200);
+  rig.Frame();
+  TEST_ASSERT_EQUAL_UINT32(1, rig.counts.recoveries);
+  TEST_ASSERT_FALSE(rig.monitor.IsStale());
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_ewma_and_histogram_track_exact_periods);
+  RUN_TEST(test_ewma_settles_under_symmetric_jitter);
+  RUN_TEST(test_slow_sender_is_flagged_as_drifting);
+  RUN_TEST(test_n_of_m_misses_trigger_once);
+  RUN_TEST(test_jitter_without_loss_never_degrades);
+  RUN_TEST(test_moderate_loss_is_debounced);
+  RUN_TEST(test_heavy_loss_alternates_without_flapping);
+  RUN_TEST(test_burst_after_misses_does_not_dilute_window);
+  RUN_TEST(test_duplicates_do_not_count_towards_recovery);
+  return UNITY_END();
+}
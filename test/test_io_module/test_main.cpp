@@ -0,0 +1,207 @@
+/**
+ * @file test_main.cpp
+ * @brief 60 s indicator relay simulation through MessageRouter, IOModule and OutputEngine.
+ *
+ * Cluster frames are published every 100 ms (10 % of them dropped, plus a 2 s
+ * outage) and SystemStatus gates the outputs for one second, the way
+ * CanInterface and SystemController feed the router. The relay waveform is
+ * captured with OutputRecorder one virtual millisecond at a time.
+ */
+#include <unity.h>
+#include <vector>
+#include "IOModule.h"
+#include "common/MessageRouter.h"
+#include "OutputRecorder.h"
+
+namespace
+{
+constexpr uint8_t kLeft = IO_LEFT_RELAY_PIN;
+constexpr uint8_t kRight = IO_RIGHT_RELAY_PIN;
+constexpr uint32_t kEndMs = 60000;
+
+// Scenario: left from 1 s to 30 s, right from 10 s to 40 s (hazards in between),
+// no frames in (20 s, 22 s), outputs disabled from 25 s to 26 s
+constexpr uint32_t kOutageFromMs = 20000;
+constexpr uint32_t kOutageToMs = 22000;
+constexpr uint32_t kDisableFromMs = 25000;
+constexpr uint32_t kDisableToMs = 26000;
+
+struct Run
+{
+  std::vector<OutputRecorder::Edge> edges;
+  uint32_t updates = 0;
+  uint32_t commits = 0;
+};
+
+// @p gated: call Update() only when IsDue(), as SystemController does
+Run Simulate(bool gated)
+{
+  MessageRouter router;
+  router.Init(4);
+  OutputRecorder rec;
+  IOModule io;
+  io.Engine().SetBackend(&OutputRecorder::Commit, &rec);
+  TEST_ASSERT_TRUE(io.Init());
+  TEST_ASSERT_TRUE(io.Start(router));
+
+  MessageRouter::SystemStatus status{2, true};
+  router.PublishSystemStatus(status, 0);
+
+  Run run;
+  uint32_t seed = 1;
+  for (uint32_t t = 1; t < kEndMs; ++t)
+  {
+    rec.SetTimeMs(t);
+    if (t % 100 == 0 && !(t > kOutageFromMs && t < kOutageToMs))
+    {
+      seed = seed * 1103515245U + 12345U;
+      if ((seed >> 16) % 10U != 0U)
+      {
+        Cluster_t c{};
+        c.Left_Turn_Signal = (t > 1000 && t < 30000) ? 1 : 0;
+        c.Right_Turn_Signal = (t > 10000 && t < 40000) ? 1 : 0;
+        router.PublishCluster(c, t);
+      }
+    }
+    if (t == kDisableFromMs || t == kDisableToMs)
+    {
+      status.outputsEnabled = (t == kDisableToMs);
+      router.PublishSystemStatus(status, t);
+    }
+    if (!gated || io.IsDue(t))
+    {
+      io.Update(t);
+      ++run.updates;
+    }
+  }
+  io.Stop(router);
+  run.edges = rec.Edges();
+  run.commits = rec.Commits();
+  return run;
+}
+
+uint32_t CountEdges(const Run& run, uint8_t pin, uint32_t fromMs, uint32_t toMs)
+{
+  uint32_t n = 0;
+  for (const OutputRecorder::Edge& e : run.edges)
+  {
+    if (e.pin == pin && e.tMs >= fromMs && e.tMs < toMs) ++n;
+  }
+  return n;
+}
+
+bool LevelAt(const Run& run, uint8_t pin, uint32_t tMs)
+{
+  bool level = false;
+  for (const OutputRecorder::Edge& e : run.edges)
+  {
+    if (e.tMs > tMs) break;
+    if (e.pin == pin) level = e.level;
+  }
+  return level;
+}
+
+bool NeverRequested(const Cluster_t&)
+{
+  return false;
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_deadline_gating_keeps_the_waveform(void)
+{
+  const Run every = Simulate(false);
+  const Run gated = Simulate(true);
+
+  TEST_ASSERT_EQUAL_UINT32(every.edges.size(), gated.edges.size());
+  for (std::size_t i = 0; i < every.edges.size(); ++i)
+  {
+    TEST_ASSERT_EQUAL_UINT32(every.edges[i].tMs, gated.edges[i].tMs);
+    TEST_ASSERT_EQUAL_UINT8(every.edges[i].pin, gated.edges[i].pin);
+    TEST_ASSERT_EQUAL(every.edges[i].level, gated.edges[i].level);
+  }
+  TEST_ASSERT_EQUAL_UINT32(kEndMs - 1U, every.updates);
+  // Frames, toggles and staleness deadlines only: about 10 Update() calls per second
+  TEST_ASSERT_LESS_THAN_UINT32(kEndMs / 50U, gated.updates);
+}
+
+void test_indicators_blink_on_the_500ms_grid(void)
+{
+  const Run run = Simulate(true);
+  // Left alone from the first frame at 1.1 s until right joins at 10.1 s
+  uint32_t last = 0;
+  for (const OutputRecorder::Edge& e : run.edges)
+  {
+    if (e.tMs >= 10000) break;
+    TEST_ASSERT_EQUAL_UINT8(kLeft, e.pin);
+    if (last != 0) TEST_ASSERT_EQUAL_UINT32(500, e.tMs - last);
+    last = e.tMs;
+  }
+  TEST_ASSERT_EQUAL_UINT32(18, CountEdges(run, kLeft, 0, 10000));
+}
+
+void test_hazards_switch_on_the_same_commit(void)
+{
+  const Run run = Simulate(true);
+  uint32_t pairs = 0;
+  for (std::size_t i = 0; i < run.edges.size(); ++i)
+  {
+    const OutputRecorder::Edge& e = run.edges[i];
+    if (e.tMs <= 10100 || e.tMs >= 30000 || e.pin != kLeft) continue;
+    // While both are requested every left edge has a right twin in the same commit
+    TEST_ASSERT_TRUE(i + 1 < run.edges.size());
+    const OutputRecorder::Edge& twin = run.edges[i + 1];
+    TEST_ASSERT_EQUAL_UINT8(kRight, twin.pin);
+    TEST_ASSERT_EQUAL_UINT32(e.commit, twin.commit);
+    TEST_ASSERT_EQUAL(e.level, twin.level);
+    ++pairs;
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(20, pairs);
+}
+
+void test_outage_and_disable_force_outputs_off(void)
+{
+  const Run run = Simulate(true);
+  // The last frame before the outage is at 20.0 s at the latest: stale 1 s later, off until frames return
+  TEST_ASSERT_FALSE(LevelAt(run, kLeft, kOutageFromMs + 1100));
+  TEST_ASSERT_FALSE(LevelAt(run, kRight, kOutageFromMs + 1100));
+  TEST_ASSERT_EQUAL_UINT32(0, CountEdges(run, kLeft, kOutageFromMs + 1100, kOutageToMs));
+  TEST_ASSERT_EQUAL_UINT32(0, CountEdges(run, kRight, kOutageFromMs + 1100, kOutageToMs));
+  TEST_ASSERT_TRUE(LevelAt(run, kLeft, kOutageToMs + 100));
+
+  // Disabling drops both relays at once; they stay off for the whole window
+  TEST_ASSERT_FALSE(LevelAt(run, kLeft, kDisableFromMs));
+  TEST_ASSERT_FALSE(LevelAt(run, kRight, kDisableFromMs));
+  TEST_ASSERT_EQUAL_UINT32(0, CountEdges(run, kLeft, kDisableFromMs + 1, kDisableToMs));
+  TEST_ASSERT_EQUAL_UINT32(0, CountEdges(run, kRight, kDisableFromMs + 1, kDisableToMs));
+
+  // Nothing is requested after 40 s
+  TEST_ASSERT_FALSE(LevelAt(run, kLeft, kEndMs));
+  TEST_ASSERT_FALSE(LevelAt(run, kRight, kEndMs));
+  TEST_ASSERT_EQUAL_UINT32(0, CountEdges(run, kRight, 40200, kEndMs));
+}
+
+void test_init_rejects_zero_length_pulse_phases(void)
+{
+  OutputEngine engine;
+  const OutputEngine::Channel noOn[] = {OutputEngine::PulseTrain(5, &NeverRequested, 0, 100, 3, 500)};
+  const OutputEngine::Channel noOff[] = {OutputEngine::PulseTrain(5, &NeverRequested, 100, 0, 3, 500)};
+  const OutputEngine::Channel ok[] = {OutputEngine::PulseTrain(5, &NeverRequested, 100, 100, 3, 0)};
+  TEST_ASSERT_FALSE(engine.Init(noOn, 1));
+  TEST_ASSERT_FALSE(engine.Init(noOff, 1));
+  TEST_ASSERT_TRUE(engine.Init(ok, 1)); // a zero gap means one burst per request
+  TEST_ASSERT_FALSE(engine.SetGroupTiming(0, 0, 500));
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_deadline_gating_keeps_the_waveform);
+  RUN_TEST(test_indicators_blink_on_the_500ms_grid);
+  RUN_TEST(test_hazards_switch_on_the_same_commit);
+  RUN_TEST(test_outage_and_disable_force_outputs_off);
+  RUN_TEST(test_init_rejects_zero_length_pulse_phases);
+  return UNITY_END();
+}
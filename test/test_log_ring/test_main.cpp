@@ -0,0 +1,253 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for LogRing eviction, separators and arena wrap accounting.
+ *
+ * The view side is modelled as a std::string edited exactly the way
+ * DashboardView applies a LogRing::Change (cut UTF-8 characters from the
+ * head, optional '\n', append the line). After every append it must equal
+ * CopyText(), so a wrong cut count or separator flag shows up on the first
+ * line it happens on.
+ */
+#include <unity.h>
+#include <cstring>
+#include <deque>
+#include <string>
+#include "LogRing.h"
+
+namespace
+{
+// Small LCG so the line mix is the same on every host
+uint32_t g_seed = 1;
+uint32_t NextRandom()
+{
+  g_seed = g_seed * 1103515245U + 12345U;
+  return g_seed >> 16;
+}
+
+/** std::string stand-in for the log label, edited through Change only. */
+class MirroredView
+{
+public:
+  void Apply(const LogRing::Change& change)
+  {
+    // lv_label_cut_text() counts UTF-8 characters, not bytes
+    std::size_t pos = 0;
+    for (uint32_t n = 0; n < change.cutHeadChars; ++n)
+    {
+      TEST_ASSERT_TRUE_MESSAGE(pos < text.size(), "cut past the end of the view");
+      ++pos;
+      while (pos < text.size() && (static_cast<uint8_t>(text[pos]) & 0xC0U) == 0x80U) ++pos;
+    }
+    text.erase(0, pos);
+    if (change.separator) text += '\n';
+    text += change.text;
+  }
+
+  std::string text;
+};
+
+class Rig
+{
+public:
+  void Append(const char* line)
+  {
+    LogRing::Change change;
+    TEST_ASSERT_TRUE(ring.Append(line, change));
+    last = change;
+    view.Apply(change);
+    TEST_ASSERT_EQUAL_STRING(Copy().c_str(), view.text.c_str());
+  }
+
+  std::string Copy() const
+  {
+    char buf[LogRing::kArenaBytes];
+    ring.CopyText(buf, sizeof(buf));
+    return std::string(buf);
+  }
+
+  LogRing ring;
+  MirroredView view;
+  LogRing::Change last{};
+};
+
+std::string Repeat(char c, std::size_t n)
+{
+  return std::string(n, c);
+}
+}
+
+void setUp(void)
+{
+  g_seed = 1;
+}
+
+void tearDown(void) {}
+
+void test_lines_below_capacity_only_append(void)
+{
+  Rig rig;
+  rig.Append("first");
+  TEST_ASSERT_FALSE(rig.last.separator);
+  TEST_ASSERT_EQUAL_UINT32(0, rig.last.cutHeadChars);
+  rig.Append("second");
+  TEST_ASSERT_TRUE(rig.last.separator);
+  TEST_ASSERT_EQUAL_UINT32(0, rig.last.cutHeadChars);
+
+  TEST_ASSERT_EQUAL_UINT32(2, rig.ring.Size());
+  TEST_ASSERT_EQUAL_STRING("first", rig.ring.Line(0));
+  TEST_ASSERT_EQUAL_STRING("second", rig.ring.Line(1));
+  TEST_ASSERT_NULL(rig.ring.Line(2));
+  TEST_ASSERT_EQUAL_STRING("first\nsecond", rig.Copy().c_str());
+}
+
+void test_line_budget_evicts_oldest_with_its_separator(void)
+{
+  Rig rig;
+  char line[16];
+  for (std::size_t i = 0; i < LogRing::kMaxLines; ++i)
+  {
+    snprintf(line, sizeof(line), "line %u", static_cast<unsigned>(i));
+    rig.Append(line);
+  }
+  TEST_ASSERT_EQUAL_UINT32(LogRing::kMaxLines, rig.ring.Size());
+
+  // "line 0" (6 chars) plus the '\n' that followed it
+  rig.Append("line 10");
+  TEST_ASSERT_EQUAL_UINT32(7, rig.last.cutHeadChars);
+  TEST_ASSERT_TRUE(rig.last.separator);
+  TEST_ASSERT_EQUAL_UINT32(LogRing::kMaxLines, rig.ring.Size());
+  TEST_ASSERT_EQUAL_STRING("line 1", rig.ring.Line(0));
+  TEST_ASSERT_EQUAL_STRING("line 10", rig.ring.Line(LogRing::kMaxLines - 1U));
+}
+
+void test_utf8_lines_cut_by_characters(void)
+{
+  Rig rig;
+  rig.Append("\xC3\xA9t\xC3\xA9"); // "été": 5 bytes, 3 characters
+  for (std::size_t i = 1; i < LogRing::kMaxLines; ++i) rig.Append("x");
+  rig.Append("y");
+  TEST_ASSERT_EQUAL_UINT32(4, rig.last.cutHeadChars); // 3 characters + '\n'
+}
+
+void test_long_lines_truncate_without_splitting_utf8(void)
+{
+  Rig rig;
+  const std::string ascii = Repeat('a', LogRing::kMaxLineLen + 20U);
+  rig.Append(ascii.c_str());
+  TEST_ASSERT_EQUAL_UINT32(LogRing::kMaxLineLen, strlen(rig.ring.Line(0)));
+
+  // A 2-byte character straddling the limit is dropped whole
+  const std::string straddle = Repeat('b', LogRing::kMaxLineLen - 1U) + "\xC3\xA9";
+  rig.Append(straddle.c_str());
+  TEST_ASSERT_EQUAL_UINT32(LogRing::kMaxLineLen - 1U, strlen(rig.ring.Line(1)));
+}
+
+void test_newlines_in_a_line_become_spaces(void)
+{
+  Rig rig;
+  rig.Append("a\nb\rc");
+  TEST_ASSERT_EQUAL_STRING("a b c", rig.ring.Line(0));
+  TEST_ASSERT_EQUAL_UINT32(1, rig.ring.Size());
+}
+
+void test_null_and_empty_lines_are_rejected(void)
+{
+  LogRing ring;
+  LogRing::Change change;
+  TEST_ASSERT_FALSE(ring.Append(nullptr, change));
+  TEST_ASSERT_FALSE(ring.Append("", change));
+  TEST_ASSERT_EQUAL_UINT32(0, ring.Size());
+}
+
+void test_arena_wrap_keeps_lines_intact(void)
+{
+  Rig rig;
+  // Lengths chosen so writes regularly skip the arena tail and restart at offset 0;
+  // every stored line must still read back exactly, oldest first
+  static const std::size_t kLens[] = {LogRing::kMaxLineLen, 40, 7, LogRing::kMaxLineLen, 63, 1, 88};
+  std::deque<std::string> expected;
+  uint32_t wraps = 0;
+  for (int i = 0; i < 500; ++i)
+  {
+    const std::string line = Repeat(static_cast<char>('a' + i % 26), kLens[i % 7]);
+    const char* prevNewest = (rig.ring.Size() != 0) ? rig.ring.Line(rig.ring.Size() - 1U) : nullptr;
+    rig.Append(line.c_str());
+    if (prevNewest != nullptr && rig.ring.Line(rig.ring.Size() - 1U) < prevNewest) ++wraps;
+
+    expected.push_back(line);
+    if (expected.size() > LogRing::kMaxLines) expected.pop_front();
+    TEST_ASSERT_EQUAL_UINT32(expected.size(), rig.ring.Size());
+    for (std::size_t k = 0; k < expected.size(); ++k)
+    {
+      TEST_ASSERT_EQUAL_STRING(expected[k].c_str(), rig.ring.Line(k));
+    }
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(20, wraps); // about 28 KB through a 1 KB arena
+}
+
+void test_random_mix_keeps_view_in_sync(void)
+{
+  Rig rig;
+  char line[LogRing::kMaxLineLen + 32U];
+  for (int i = 0; i < 20000; ++i)
+  {
+    // 1..kMaxLineLen+20 bytes, some multi-byte characters, occasional embedded newline
+    const std::size_t len = 1U + NextRandom() % (LogRing::kMaxLineLen + 20U);
+    std::size_t n = 0;
+    while (n < len)
+    {
+      const uint32_t r = NextRandom() % 16U;
+      if (r == 0 && n + 2U <= len)
+      {
+        line[n++] = '\xC3';
+        line[n++] = '\xA4';
+      }
+      else
+      {
+        line[n++] = (r == 1) ? '\n' : static_cast<char>('a' + r);
+      }
+    }
+    line[n] = '\0';
+    rig.Append(line);
+  }
+  TEST_ASSERT_EQUAL_UINT32(LogRing::kMaxLines, rig.ring.Size());
+}
+
+void test_copy_text_truncates_to_capacity(void)
+{
+  Rig rig;
+  rig.Append("abcdef");
+  rig.Append("ghijkl");
+  char small[8];
+  TEST_ASSERT_EQUAL_UINT32(7, rig.ring.CopyText(small, sizeof(small)));
+  TEST_ASSERT_EQUAL_STRING("abcdef\n", small);
+  TEST_ASSERT_EQUAL_UINT32(0, rig.ring.CopyText(small, 0));
+}
+
+void test_clear_restarts_without_cut(void)
+{
+  Rig rig;
+  for (std::size_t i = 0; i < LogRing::kMaxLines; ++i) rig.Append("old");
+  rig.ring.Clear();
+  rig.view.text.clear();
+  rig.Append("new");
+  TEST_ASSERT_FALSE(rig.last.separator);
+  TEST_ASSERT_EQUAL_UINT32(0, rig.last.cutHeadChars);
+  TEST_ASSERT_EQUAL_UINT32(1, rig.ring.Size());
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_lines_below_capacity_only_append);
+  RUN_TEST(test_line_budget_evicts_oldest_with_its_separator);
+  RUN_TEST(test_utf8_lines_cut_by_characters);
+  RUN_TEST(test_long_lines_truncate_without_splitting_utf8);
+  RUN_TEST(test_newlines_in_a_line_become_spaces);
+  RUN_TEST(test_null_and_empty_lines_are_rejected);
+  RUN_TEST(test_arena_wrap_keeps_lines_intact);
+  RUN_TEST(test_random_mix_keeps_view_in_sync);
+  RUN_TEST(test_copy_text_truncates_to_capacity);
+  RUN_TEST(test_clear_restarts_without_cut);
+  return UNITY_END();
+}
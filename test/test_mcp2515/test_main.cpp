@@ -0,0 +1,267 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for the MCP2515 driver's RX servicing against a fake chip.
+ *
+ * The driver talks SPI to FakeMcp2515, a register-level model of the chip,
+ * and the test calls intHandler() itself where the interrupt task would.
+ * Frames are delivered at exact points of a readout through the fake's
+ * OnRelease hook, which is how the two RXB0/RXB1 orderings and the frames
+ * landing after a STATUS snapshot are set up. Like test_mcp2517fd this
+ * compiles the CanDriver units directly because the native env ignores the
+ * library.
+ */
+#include <unity.h>
+#include <cstdint>
+#include <vector>
+
+uint32_t micros();
+uint32_t millis();
+
+#include "mcp2515.cpp"
+#include "can_common.cpp"
+#include "can_busload.cpp"
+#include "harness/FakeMcp2515.h"
+
+uint32_t micros() { return 0; }
+uint32_t millis() { return 0; }
+
+namespace
+{
+constexpr uint8_t kCsPin = 5;
+constexpr uint8_t kIntPin = 4;
+
+using Frame = FakeMcp2515::Frame;
+
+Frame Std(uint16_t id)
+{
+  Frame f{};
+  f.id = id;
+  f.length = 8;
+  for (uint8_t i = 0; i < 8; ++i) f.data[i] = static_cast<uint8_t>(id + i);
+  return f;
+}
+
+/**
+ * Fake chip plus a 500 kbit/s driver: 0x1xx goes to RXB0 through RXF0 (and
+ * rolls over into RXB1 while RXB0 is full), 0x2xx goes to RXB1 through RXF2.
+ */
+class Rig
+{
+public:
+  Rig()
+  {
+    TEST_ASSERT_EQUAL_INT(500000, can.Init(500000, 16));
+    can.SetRXMask(MASK0, 0x700);
+    can.SetRXFilter(FILTER0, 0x100, false);
+    can.SetRXMask(MASK1, 0x700);
+    can.SetRXFilter(FILTER2, 0x200, false);
+    chip.ClearCounters();
+    HostTaskNotifies() = 0;
+  }
+
+  /** Frame ids the driver has queued for the application, oldest first. */
+  std::vector<uint32_t> Drain()
+  {
+    std::vector<uint32_t> ids;
+    CAN_FRAME frame;
+    while (can.get_rx_buff(frame)) ids.push_back(frame.id);
+    return ids;
+  }
+
+  FakeMcp2515 chip{kCsPin, kIntPin};
+  MCP2515 can{kCsPin, kIntPin};
+};
+
+bool IsRead(uint8_t instruction, uint8_t address, uint8_t at)
+{
+  return instruction == CAN_READ && address == at;
+}
+
+void AssertIds(const std::vector<uint32_t>& expected, const std::vector<uint32_t>& ids)
+{
+  TEST_ASSERT_EQUAL_UINT32(expected.size(), ids.size());
+  for (std::size_t i = 0; i < ids.size(); ++i) TEST_ASSERT_EQUAL_HEX32(expected[i], ids[i]);
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_single_frame_clears_only_its_flag(void)
+{
+  Rig rig;
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x101)));
+  TEST_ASSERT_EQUAL_INT(LOW, digitalRead(kIntPin));
+  rig.can.intHandler();
+
+  AssertIds({0x101}, rig.Drain());
+  // RX0IF as RXB0 is freed, then only TX/error flags at the end of the pass
+  TEST_ASSERT_EQUAL_UINT32(2, rig.chip.intfModifies.size());
+  TEST_ASSERT_EQUAL_HEX8(RX0IF, rig.chip.intfModifies[0].mask);
+  TEST_ASSERT_EQUAL_HEX8(0, rig.chip.intfModifies[1].mask & (RX0IF | RX1IF));
+  TEST_ASSERT_EQUAL_INT(HIGH, digitalRead(kIntPin));
+  TEST_ASSERT_EQUAL_UINT32(1, rig.can.rxFramesRead);
+}
+
+void test_rollover_pair_read_in_one_transaction_rxb0_first(void)
+{
+  Rig rig;
+  uint32_t reads = 0;
+  rig.chip.OnRelease = [&](uint8_t instruction, uint8_t address) {
+    if (IsRead(instruction, address, RXB0CTRL) || IsRead(instruction, address, RXB1CTRL)) ++reads;
+  };
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x101)));
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x102))); // RXB0 full: rolls over
+  TEST_ASSERT_EQUAL_HEX8(RX0IF | RX1IF, rig.chip.Register(CANINTF));
+  rig.can.intHandler();
+
+  // RXB0 held its frame while the second rolled over, so it is the older one
+  AssertIds({0x101, 0x102}, rig.Drain());
+  TEST_ASSERT_EQUAL_UINT32(1, reads);
+  TEST_ASSERT_EQUAL_HEX8(RX0IF | RX1IF, rig.chip.intfModifies[0].mask);
+}
+
+void test_rxb1_filled_before_rxb0_freed_goes_first(void)
+{
+  // A is read from RXB0. B arrives during that read and rolls over into RXB1
+  // (RXB0 is still flagged), then C lands in the freed RXB0. C is newer than
+  // B, so the next pass, which sees both buffers full, must dispatch B first.
+  Rig rig;
+  bool sentB = false;
+  bool sentC = false;
+  rig.chip.OnRelease = [&](uint8_t instruction, uint8_t address) {
+    if (!sentB && IsRead(instruction, address, RXB0CTRL))
+    {
+      sentB = rig.chip.Receive(Std(0x1B0));
+    }
+    else if (sentB && !sentC && instruction == CAN_BIT_MODIFY && address == CANINTF)
+    {
+      sentC = rig.chip.Receive(Std(0x1C0));
+    }
+  };
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x1A0)));
+  rig.can.intHandler();
+
+  TEST_ASSERT_TRUE(sentB && sentC);
+  AssertIds({0x1A0, 0x1B0, 0x1C0}, rig.Drain());
+  TEST_ASSERT_EQUAL_UINT32(0, rig.chip.dropped);
+}
+
+void test_rxb0_refilled_before_rxb1_keeps_rxb0_first(void)
+{
+  // A is read from RXB0 with RXB1 empty, and the STATUS check after freeing
+  // RXB0 still sees RXB1 empty. B then lands in RXB0 and C rolls over behind
+  // it into RXB1: this time RXB0 holds the older frame.
+  Rig rig;
+  bool cleared = false;
+  bool sent = false;
+  rig.chip.OnRelease = [&](uint8_t instruction, uint8_t address) {
+    if (!cleared && instruction == CAN_BIT_MODIFY && address == CANINTF)
+    {
+      cleared = true;
+    }
+    else if (cleared && !sent && instruction == CAN_STATUS)
+    {
+      sent = true;
+      TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x1B0)));
+      TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x1C0)));
+    }
+  };
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x1A0)));
+  rig.can.intHandler();
+
+  TEST_ASSERT_TRUE(sent);
+  AssertIds({0x1A0, 0x1B0, 0x1C0}, rig.Drain());
+}
+
+void test_frame_after_status_snapshot_is_not_cleared(void)
+{
+  // The pass's STATUS read sees RXB0 only; a frame for RXB1 lands right after
+  // it. Neither of the pass's CANINTF writes may clear RX1IF, or that frame
+  // would be overwritten unread by the next one.
+  Rig rig;
+  bool sent = false;
+  rig.chip.OnRelease = [&](uint8_t instruction, uint8_t) {
+    if (!sent && instruction == CAN_STATUS)
+    {
+      sent = true;
+      TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x201)));
+    }
+  };
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x101)));
+  rig.can.intHandler();
+
+  AssertIds({0x101, 0x201}, rig.Drain());
+  TEST_ASSERT_TRUE(rig.chip.intfModifies.size() >= 3);
+  TEST_ASSERT_EQUAL_HEX8(RX0IF, rig.chip.intfModifies[0].mask);
+  TEST_ASSERT_EQUAL_HEX8(0, rig.chip.intfModifies[1].mask & RX1IF);
+  TEST_ASSERT_EQUAL_HEX8(RX1IF, rig.chip.intfModifies[2].mask);
+  TEST_ASSERT_EQUAL_HEX8(0, rig.chip.Register(CANINTF) & (RX0IF | RX1IF));
+}
+
+void test_overflow_counted_and_cleared(void)
+{
+  Rig rig;
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x101)));
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x102)));
+  TEST_ASSERT_FALSE(rig.chip.Receive(Std(0x103))); // both buffers full
+  TEST_ASSERT_EQUAL_HEX8(RX1OVR, rig.chip.Register(EFLG));
+  rig.can.intHandler();
+
+  AssertIds({0x101, 0x102}, rig.Drain());
+  TEST_ASSERT_EQUAL_UINT32(1, rig.can.rxOverflows);
+  TEST_ASSERT_EQUAL_HEX8(0, rig.chip.Register(EFLG));
+}
+
+void test_without_bukt_second_frame_overflows_rxb0(void)
+{
+  Rig rig;
+  rig.can.setBuffer0RolloverBUKT(false);
+  TEST_ASSERT_EQUAL_HEX8(0, rig.chip.Register(RXB0CTRL) & RXB0BUKT);
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x101)));
+  TEST_ASSERT_FALSE(rig.chip.Receive(Std(0x102)));
+  rig.can.intHandler();
+
+  AssertIds({0x101}, rig.Drain());
+  TEST_ASSERT_EQUAL_UINT32(1, rig.can.rxOverflows);
+}
+
+void test_busy_int_line_requeues_the_handler(void)
+{
+  // A new frame as soon as RXB0 is freed keeps INT low through every pass
+  Rig rig;
+  uint16_t next = 0x110;
+  rig.chip.OnRelease = [&](uint8_t instruction, uint8_t address) {
+    if (instruction == CAN_BIT_MODIFY && address == CANINTF && (rig.chip.intfModifies.back().mask & RX0IF))
+    {
+      TEST_ASSERT_TRUE(rig.chip.Receive(Std(next++)));
+    }
+  };
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x100)));
+  rig.can.intHandler();
+
+  // Every pass ends with one CANINTF write for the TX and error flags
+  uint32_t passes = 0;
+  for (const FakeMcp2515::BitModify& m : rig.chip.intfModifies)
+  {
+    if (m.mask & ERRIF) ++passes;
+  }
+  TEST_ASSERT_EQUAL_UINT32(MCP_SERVICE_PASSES, passes);
+  TEST_ASSERT_EQUAL_UINT32(1, HostTaskNotifies());
+  TEST_ASSERT_EQUAL_INT(LOW, digitalRead(kIntPin));
+  TEST_ASSERT_EQUAL_UINT32(0, rig.chip.dropped);
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_single_frame_clears_only_its_flag);
+  RUN_TEST(test_rollover_pair_read_in_one_transaction_rxb0_first);
+  RUN_TEST(test_rxb1_filled_before_rxb0_freed_goes_first);
+  RUN_TEST(test_rxb0_refilled_before_rxb1_keeps_rxb0_first);
+  RUN_TEST(test_frame_after_status_snapshot_is_not_cleared);
+  RUN_TEST(test_overflow_counted_and_cleared);
+  RUN_TEST(test_without_bukt_second_frame_overflows_rxb0);
+  RUN_TEST(test_busy_int_line_requeues_the_handler);
+  return UNITY_END();
+}
@@ -0,0 +1,312 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for the MCP2517FD driver's FIFO servicing against a fake chip.
+ *
+ * The driver talks SPI to FakeMcp2517fd, a register-level model of the chip,
+ * and the test calls intHandler() itself where the firmware's polling task
+ * would. Like test_can_busload this compiles the CanDriver units directly
+ * because the native env ignores the library.
+ */
+#include <unity.h>
+#include <cstdint>
+
+uint32_t micros();
+uint32_t millis();
+
+#include "mcp2517fd.cpp"
+#include "can_common.cpp"
+#include "can_busload.cpp"
+#include "can_clocksync.cpp"
+#include "harness/FakeMcp2517fd.h"
+
+uint32_t micros() { return 0; }
+uint32_t millis() { return 0; }
+
+namespace
+{
+constexpr uint8_t kCsPin = 5;
+constexpr uint8_t kIntPin = 4;
+constexpr uint8_t kBulkFifo = 1;
+constexpr uint8_t kTxFifo = 2;
+
+using Frame = FakeMcp2517fd::Frame;
+
+Frame Std(uint32_t id)
+{
+  Frame f{};
+  f.id = id;
+  f.length = 8;
+  for (uint8_t i = 0; i < 8; ++i) f.data[i] = static_cast<uint8_t>(id + i);
+  return f;
+}
+
+/** Fake chip plus a classic 500 kbit/s driver with filter 0 taking every standard frame. */
+class Rig
+{
+public:
+  Rig() { Start_(); }
+
+  /**
+   * Two RX classes: filter 0 takes 0x100-0x1FF into the critical class 1 FIFO
+   * (FIFO3, 4 deep), filter 1 takes 0x200-0x2FF into the bulk FIFO.
+   */
+  explicit Rig(const uint8_t (&depths)[2])
+  {
+    can.setRXFifos(2, depths);
+    can.setFilterClass(0, 1);
+    Start_(false);
+    can._setFilterSpecific(0, 0x100, 0x700, false);
+    can._setFilterSpecific(1, 0x200, 0x700, false);
+    chip.ClearCounters();
+  }
+
+  /** Frame ids the driver has queued for the application, oldest first. */
+  std::vector<uint32_t> Drain()
+  {
+    std::vector<uint32_t> ids;
+    CAN_FRAME frame;
+    while (can.get_rx_buff(frame)) ids.push_back(frame.id);
+    return ids;
+  }
+
+  FakeMcp2517fd chip{kCsPin};
+  MCP2517FD can{kCsPin, kIntPin};
+
+private:
+  void Start_(bool acceptAll = true)
+  {
+    can.setHostTimestamps(false);
+    TEST_ASSERT_EQUAL_INT(500000, can.Init(500000, 40));
+    if (acceptAll) can._setFilterSpecific(0, 0, 0, false);
+    chip.ClearCounters();
+  }
+};
+
+constexpr uint8_t kTwoClasses[2] = {18, 4};
+constexpr uint8_t kCriticalFifo = 3;
+
+uint32_t CountUinc(const std::vector<FakeMcp2517fd::Uinc>& uincs, uint8_t fifo, uint8_t value)
+{
+  uint32_t n = 0;
+  for (const FakeMcp2517fd::Uinc& u : uincs)
+  {
+    if (u.fifo == fifo && u.value == value) ++n;
+  }
+  return n;
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_rx_readout_increments_once_per_object(void)
+{
+  Rig rig;
+  for (uint32_t id = 0x100; id < 0x105; ++id) TEST_ASSERT_TRUE(rig.chip.Receive(Std(id)));
+  rig.can.intHandler();
+
+  // One RAM burst for the five objects, then exactly one UINC each and nothing else on the FIFO
+  TEST_ASSERT_EQUAL_UINT32(1, rig.chip.ramReads);
+  TEST_ASSERT_EQUAL_UINT32(5, rig.chip.uincs.size());
+  TEST_ASSERT_EQUAL_UINT32(5, CountUinc(rig.chip.uincs, kBulkFifo, 0x01));
+  TEST_ASSERT_EQUAL_UINT8(0, rig.chip.Pending(kBulkFifo));
+
+  const std::vector<uint32_t> ids = rig.Drain();
+  TEST_ASSERT_EQUAL_UINT32(5, ids.size());
+  for (uint32_t i = 0; i < 5; ++i) TEST_ASSERT_EQUAL_HEX32(0x100 + i, ids[i]);
+}
+
+void test_rx_readout_split_at_the_ring_end_still_increments_once_per_object(void)
+{
+  Rig rig;
+  const uint8_t depth = rig.chip.Depth(kBulkFifo);
+  for (uint32_t i = 0; i < 10; ++i) rig.chip.Receive(Std(0x200 + i));
+  rig.can.intHandler();
+  rig.Drain();
+  rig.chip.ClearCounters();
+
+  // The next 12 objects start at index 10 of 18 and wrap: two bursts, still one UINC per object
+  TEST_ASSERT_EQUAL_UINT8(18, depth);
+  for (uint32_t i = 0; i < 12; ++i) TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x300 + i)));
+  rig.can.intHandler();
+
+  TEST_ASSERT_EQUAL_UINT32(2, rig.chip.ramReads);
+  TEST_ASSERT_EQUAL_UINT32(12, rig.chip.uincs.size());
+  TEST_ASSERT_EQUAL_UINT32(12, CountUinc(rig.chip.uincs, kBulkFifo, 0x01));
+  const std::vector<uint32_t> ids = rig.Drain();
+  TEST_ASSERT_EQUAL_UINT32(12, ids.size());
+  for (uint32_t i = 0; i < 12; ++i) TEST_ASSERT_EQUAL_HEX32(0x300 + i, ids[i]);
+  TEST_ASSERT_EQUAL_UINT32(22, rig.can.rxFramesRead);
+}
+
+void test_full_fifo_drains_in_one_pass(void)
+{
+  Rig rig;
+  const uint8_t depth = rig.chip.Depth(kBulkFifo);
+  for (uint32_t i = 0; i < depth; ++i) rig.chip.Receive(Std(0x400 + i));
+  TEST_ASSERT_FALSE(rig.chip.Receive(Std(0x4FF))); // overflows
+  rig.can.intHandler();
+
+  TEST_ASSERT_EQUAL_UINT32(depth, CountUinc(rig.chip.uincs, kBulkFifo, 0x01));
+  TEST_ASSERT_EQUAL_UINT32(depth, rig.Drain().size());
+  TEST_ASSERT_EQUAL_UINT32(1, rig.can.getRXOverflows(0));
+}
+
+void test_tx_batch_requests_transmit_once(void)
+{
+  Rig rig;
+  for (uint32_t i = 0; i < 5; ++i)
+  {
+    CAN_FRAME frame;
+    frame.id = 0x500 + i;
+    frame.extended = false;
+    frame.length = 8;
+    frame.data.uint64 = i;
+    TEST_ASSERT_TRUE(rig.can.sendFrame(frame));
+  }
+  rig.can.intHandler();
+
+  // One RAM write for the batch, a plain UINC per object and UINC|TXREQ on the last one only
+  TEST_ASSERT_EQUAL_UINT32(1, rig.chip.ramWrites);
+  TEST_ASSERT_EQUAL_UINT32(5, rig.chip.uincs.size());
+  TEST_ASSERT_EQUAL_UINT32(4, CountUinc(rig.chip.uincs, kTxFifo, 0x01));
+  TEST_ASSERT_EQUAL_UINT8(0x03, rig.chip.uincs.back().value);
+
+  const std::vector<Frame> sent = rig.chip.Transmit(kTxFifo);
+  TEST_ASSERT_EQUAL_UINT32(5, sent.size());
+  for (uint32_t i = 0; i < 5; ++i)
+  {
+    TEST_ASSERT_EQUAL_HEX32(0x500 + i, sent[i].id);
+    TEST_ASSERT_EQUAL_UINT8(i, sent[i].data[0]);
+  }
+}
+
+void test_tx_batch_split_at_the_ring_end_requests_once_per_write(void)
+{
+  Rig rig;
+  CAN_FRAME frame;
+  frame.extended = false;
+  frame.length = 1;
+  for (uint32_t i = 0; i < 5; ++i)
+  {
+    frame.id = 0x600 + i;
+    rig.can.sendFrame(frame);
+  }
+  rig.can.intHandler();
+  rig.chip.Transmit(kTxFifo);
+  rig.chip.ClearCounters();
+
+  // Six frames from object 5 of 9: a run of 4 to the end of the ring, then 2 from the start
+  TEST_ASSERT_EQUAL_UINT8(9, rig.chip.Depth(kTxFifo));
+  for (uint32_t i = 0; i < 6; ++i)
+  {
+    frame.id = 0x680 + i;
+    rig.can.sendFrame(frame);
+  }
+  rig.can.intHandler();
+
+  TEST_ASSERT_EQUAL_UINT32(2, rig.chip.ramWrites);
+  TEST_ASSERT_EQUAL_UINT32(6, rig.chip.uincs.size());
+  TEST_ASSERT_EQUAL_UINT32(rig.chip.ramWrites, CountUinc(rig.chip.uincs, kTxFifo, 0x03));
+  TEST_ASSERT_EQUAL_UINT8(0x03, rig.chip.uincs[3].value);
+  TEST_ASSERT_EQUAL_UINT8(0x03, rig.chip.uincs[5].value);
+  const std::vector<Frame> sent = rig.chip.Transmit(kTxFifo);
+  TEST_ASSERT_EQUAL_UINT32(6, sent.size());
+  for (uint32_t i = 0; i < 6; ++i) TEST_ASSERT_EQUAL_HEX32(0x680 + i, sent[i].id);
+}
+
+void test_critical_class_is_read_before_bulk(void)
+{
+  Rig rig(kTwoClasses);
+  for (uint32_t i = 0; i < 5; ++i) TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x200 + i)));
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x100)));
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x101)));
+  TEST_ASSERT_EQUAL_UINT8(2, rig.chip.Pending(kCriticalFifo));
+
+  // A critical and a bulk frame arrive while the first bulk snapshot is being handed back
+  bool injected = false;
+  rig.chip.OnUinc = [&](uint8_t fifo) {
+    if (fifo != kBulkFifo || injected) return;
+    injected = true;
+    rig.chip.Receive(Std(0x102));
+    rig.chip.Receive(Std(0x205));
+  };
+  rig.can.intHandler();
+
+  // Critical first; the late critical frame waits only for the bulk snapshot already read,
+  // then goes ahead of the late bulk frame
+  const uint32_t expected[] = {0x100, 0x101, 0x200, 0x201, 0x202, 0x203, 0x204, 0x102, 0x205};
+  const std::vector<uint32_t> ids = rig.Drain();
+  TEST_ASSERT_EQUAL_UINT32(9, ids.size());
+  for (uint32_t i = 0; i < 9; ++i) TEST_ASSERT_EQUAL_HEX32(expected[i], ids[i]);
+  TEST_ASSERT_EQUAL_UINT32(2, rig.chip.fifoStatusReads[kCriticalFifo]);
+  TEST_ASSERT_EQUAL_UINT32(2, rig.chip.fifoStatusReads[kBulkFifo]);
+}
+
+void test_readouts_per_poll_are_bounded(void)
+{
+  Rig rig;
+  // Every frame handed back is replaced by a new one, so the FIFO never runs dry
+  uint32_t nextId = 0x100;
+  rig.chip.Receive(Std(nextId++));
+  rig.chip.OnUinc = [&](uint8_t) { rig.chip.Receive(Std(nextId++)); };
+  rig.can.intHandler();
+
+  TEST_ASSERT_EQUAL_UINT32(FD_RX_SERVICE_PASSES, rig.chip.fifoStatusReads[kBulkFifo]);
+  TEST_ASSERT_EQUAL_UINT32(FD_RX_SERVICE_PASSES, rig.Drain().size());
+  TEST_ASSERT_EQUAL_UINT8(1, rig.chip.Pending(kBulkFifo));
+
+  // The next poll picks up where this one stopped, nothing is lost
+  rig.chip.OnUinc = nullptr;
+  rig.chip.ClearCounters();
+  rig.can.intHandler();
+  const std::vector<uint32_t> ids = rig.Drain();
+  TEST_ASSERT_EQUAL_UINT32(1, ids.size());
+  TEST_ASSERT_EQUAL_HEX32(0x100 + FD_RX_SERVICE_PASSES, ids[0]);
+  TEST_ASSERT_EQUAL_UINT32(1, rig.chip.fifoStatusReads[kBulkFifo]);
+}
+
+void test_filter_class_change_is_applied_by_the_polling_task(void)
+{
+  Rig rig(kTwoClasses);
+  TEST_ASSERT_EQUAL_HEX8(0x80 | kBulkFifo, rig.chip.FilterControl(1));
+
+  // No SPI from the calling task; disabled filters only remember their class
+  TEST_ASSERT_TRUE(rig.can.setFilterClass(1, 1));
+  TEST_ASSERT_TRUE(rig.can.setFilterClass(5, 1));
+  TEST_ASSERT_FALSE(rig.can.setFilterClass(FD_NUM_FILTERS, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, rig.chip.transactions);
+  TEST_ASSERT_EQUAL_HEX8(0x80 | kBulkFifo, rig.chip.FilterControl(1));
+
+  rig.can.intHandler();
+  TEST_ASSERT_EQUAL_HEX8(0x80 | kCriticalFifo, rig.chip.FilterControl(1));
+  TEST_ASSERT_EQUAL_HEX8(0x00, rig.chip.FilterControl(5));
+
+  TEST_ASSERT_TRUE(rig.chip.Receive(Std(0x2AA)));
+  TEST_ASSERT_EQUAL_UINT8(1, rig.chip.Pending(kCriticalFifo));
+  rig.can.intHandler();
+  const std::vector<uint32_t> ids = rig.Drain();
+  TEST_ASSERT_EQUAL_UINT32(1, ids.size());
+  TEST_ASSERT_EQUAL_HEX32(0x2AA, ids[0]);
+
+  // And back to the bulk FIFO the same way
+  TEST_ASSERT_TRUE(rig.can.setFilterClass(1, 0));
+  rig.can.intHandler();
+  TEST_ASSERT_EQUAL_HEX8(0x80 | kBulkFifo, rig.chip.FilterControl(1));
+  rig.chip.Receive(Std(0x2AB));
+  TEST_ASSERT_EQUAL_UINT8(1, rig.chip.Pending(kBulkFifo));
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_rx_readout_increments_once_per_object);
+  RUN_TEST(test_rx_readout_split_at_the_ring_end_still_increments_once_per_object);
+  RUN_TEST(test_full_fifo_drains_in_one_pass);
+  RUN_TEST(test_tx_batch_requests_transmit_once);
+  RUN_TEST(test_tx_batch_split_at_the_ring_end_requests_once_per_write);
+  RUN_TEST(test_critical_class_is_read_before_bulk);
+  RUN_TEST(test_readouts_per_poll_are_bounded);
+  RUN_TEST(test_filter_class_change_is_applied_by_the_polling_task);
+  return UNITY_END();
+}
@@ -0,0 +1,156 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for OutputEngine's commit path: one commit per pass, one write per bank.
+ *
+ * The default backend writes the GPIO W1TS/W1TC registers, which the host
+ * soc/gpio_struct.h replaces with write-counting stand-ins; OutputRecorder
+ * counts backend calls when a test installs it.
+ */
+#include <unity.h>
+#include "OutputEngine.h"
+#include "OutputRecorder.h"
+#include "soc/gpio_struct.h"
+
+namespace
+{
+constexpr uint32_t kT0 = 1000;
+
+bool g_request = false;
+bool Requested(const Cluster_t&) { return g_request; }
+
+// Publish the current request the way IOModule's Cluster callback does
+void Signal(OutputEngine& engine, bool on, uint32_t tMs)
+{
+  g_request = on;
+  engine.OnSignals(Cluster_t{}, tMs);
+}
+
+uint32_t TotalWrites()
+{
+  return GPIO.out_w1ts.writes + GPIO.out_w1tc.writes + GPIO.out1_w1ts.val.writes + GPIO.out1_w1tc.val.writes;
+}
+}
+
+void setUp(void)
+{
+  GPIO = gpio_dev_t{};
+  g_request = false;
+}
+
+void tearDown(void) {}
+
+void test_high_bank_pins_use_out1_registers(void)
+{
+  // Default indicator relays: GPIO 32 and 33, one phase group
+  const OutputEngine::Channel rows[] = {
+    OutputEngine::Blink(32, &Requested, 0),
+    OutputEngine::Blink(33, &Requested, 0),
+  };
+  OutputEngine engine;
+  engine.SetEnabled(true);
+  TEST_ASSERT_TRUE(engine.Init(rows, 2));
+  // Initial OFF: one clear write covering both pins, nothing in the low bank
+  TEST_ASSERT_EQUAL_UINT32(1, GPIO.out1_w1tc.val.writes);
+  TEST_ASSERT_EQUAL_HEX32(0x3, GPIO.out1_w1tc.val.val);
+  TEST_ASSERT_EQUAL_UINT32(1, TotalWrites());
+
+  Signal(engine, true, kT0);
+  engine.Update(kT0);
+  TEST_ASSERT_EQUAL_UINT32(1, GPIO.out1_w1ts.val.writes);
+  TEST_ASSERT_EQUAL_HEX32(0x3, GPIO.out1_w1ts.val.val);
+
+  // Every toggle of the pair is a single register write
+  for (uint32_t k = 1; k <= 10; ++k)
+  {
+    const uint32_t before = TotalWrites();
+    engine.Update(kT0 + k * 500U);
+    TEST_ASSERT_EQUAL_UINT32(before + 1U, TotalWrites());
+    Signal(engine, true, kT0 + k * 500U);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, GPIO.out_w1ts.writes);
+  TEST_ASSERT_EQUAL_UINT32(0, GPIO.out_w1tc.writes);
+}
+
+void test_mixed_banks_write_each_register_once(void)
+{
+  const OutputEngine::Channel rows[] = {
+    OutputEngine::Blink(5, &Requested, 0),
+    OutputEngine::Blink(33, &Requested, 0),
+    OutputEngine::Blink(18, &Requested, 0, false), // active low
+  };
+  OutputEngine engine;
+  engine.SetEnabled(true);
+  TEST_ASSERT_TRUE(engine.Init(rows, 3));
+  GPIO = gpio_dev_t{};
+
+  Signal(engine, true, kT0);
+  engine.Update(kT0);
+  // One pass switching three channels: low-bank set and clear, high-bank set
+  TEST_ASSERT_EQUAL_UINT32(1, GPIO.out_w1ts.writes);
+  TEST_ASSERT_EQUAL_HEX32(1U << 5, GPIO.out_w1ts.val);
+  TEST_ASSERT_EQUAL_UINT32(1, GPIO.out_w1tc.writes);
+  TEST_ASSERT_EQUAL_HEX32(1U << 18, GPIO.out_w1tc.val);
+  TEST_ASSERT_EQUAL_UINT32(1, GPIO.out1_w1ts.val.writes);
+  TEST_ASSERT_EQUAL_HEX32(1U << 1, GPIO.out1_w1ts.val.val);
+  TEST_ASSERT_EQUAL_UINT32(0, GPIO.out1_w1tc.val.writes);
+
+  engine.Update(kT0 + 500);
+  TEST_ASSERT_EQUAL_UINT32(2, GPIO.out_w1ts.writes);
+  TEST_ASSERT_EQUAL_HEX32(1U << 18, GPIO.out_w1ts.val);
+  TEST_ASSERT_EQUAL_UINT32(2, GPIO.out_w1tc.writes);
+  TEST_ASSERT_EQUAL_HEX32(1U << 5, GPIO.out_w1tc.val);
+  TEST_ASSERT_EQUAL_UINT32(1, GPIO.out1_w1tc.val.writes);
+  TEST_ASSERT_EQUAL_HEX32(1U << 1, GPIO.out1_w1tc.val.val);
+}
+
+void test_one_commit_per_pass(void)
+{
+  // Steady, two blink groups and a pulse train all switching in the same run
+  const OutputEngine::Channel rows[] = {
+    OutputEngine::Steady(4, &Requested),
+    OutputEngine::Blink(5, &Requested, 0),
+    OutputEngine::Blink(32, &Requested, 1),
+    OutputEngine::PulseTrain(33, &Requested, 50, 50, 3, 200),
+    OutputEngine::PulseTrain(19, &Requested, 30, 70, 0, 0, false),
+  };
+  OutputRecorder rec;
+  OutputEngine engine;
+  engine.SetBackend(&OutputRecorder::Commit, &rec);
+  engine.SetEnabled(true);
+  TEST_ASSERT_TRUE(engine.Init(rows, 5));
+  TEST_ASSERT_TRUE(engine.SetGroupTiming(1, 300, 200));
+  TEST_ASSERT_EQUAL_UINT32(1, rec.Commits());
+
+  uint32_t passesWithEdges = 0;
+  for (uint32_t t = kT0; t < kT0 + 5000; ++t)
+  {
+    if (t % 100 == 0) Signal(engine, t < kT0 + 4000, t);
+    if (!engine.IsDue(t)) continue;
+    rec.SetTimeMs(t);
+    const uint32_t commits = rec.Commits();
+    const std::size_t edges = rec.Edges().size();
+    engine.Update(t);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(commits + 1U, rec.Commits());
+    // A commit is only made when some pin actually changes
+    TEST_ASSERT_EQUAL(rec.Edges().size() != edges, rec.Commits() != commits);
+    if (rec.Commits() != commits) ++passesWithEdges;
+  }
+  TEST_ASSERT_EQUAL_UINT32(passesWithEdges + 1U, rec.Commits());
+  TEST_ASSERT_GREATER_THAN_UINT32(50, passesWithEdges);
+
+  // Release at 4 s: every channel off in that single pass
+  for (uint8_t pin : {4, 5, 32, 33})
+  {
+    TEST_ASSERT_FALSE(rec.Level(pin));
+  }
+  TEST_ASSERT_TRUE(rec.Level(19)); // active low, off
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_high_bank_pins_use_out1_registers);
+  RUN_TEST(test_mixed_banks_write_each_register_once);
+  RUN_TEST(test_one_commit_per_pass);
+  return UNITY_END();
+}
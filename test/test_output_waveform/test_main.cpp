@@ -0,0 +1,171 @@
+/**
+ * @file test_main.cpp
+ * @brief Pin waveforms recorded with OutputRecorder: hazard phase sync and pulse-train timing.
+ *
+ * The engine runs one virtual millisecond at a time with Update() called only
+ * when IsDue(), as in the firmware, so every edge time below is what the relay
+ * would see on the target.
+ */
+#include <unity.h>
+#include <vector>
+#include "OutputEngine.h"
+#include "OutputRecorder.h"
+
+namespace
+{
+constexpr uint32_t kT0 = 1000;
+constexpr uint8_t kLeft = 32;
+constexpr uint8_t kRight = 33;
+constexpr uint8_t kBuzzer = 25;
+
+bool g_left = false;
+bool g_right = false;
+bool g_buzzer = false;
+bool LeftRequested(const Cluster_t&) { return g_left; }
+bool RightRequested(const Cluster_t&) { return g_right; }
+bool BuzzerRequested(const Cluster_t&) { return g_buzzer; }
+
+class Bench
+{
+public:
+  Bench(const OutputEngine::Channel* rows, uint8_t count)
+  {
+    engine.SetBackend(&OutputRecorder::Commit, &rec);
+    engine.SetEnabled(true);
+    TEST_ASSERT_TRUE(engine.Init(rows, count));
+  }
+
+  /** Run to @p endMs, publishing the current requests every 100 ms like the Cluster frame. */
+  void RunTo(uint32_t endMs)
+  {
+    for (; now_ < endMs; ++now_)
+    {
+      if (now_ % 100 == 0) engine.OnSignals(Cluster_t{}, now_);
+      rec.SetTimeMs(now_);
+      if (engine.IsDue(now_)) engine.Update(now_);
+    }
+  }
+
+  std::vector<OutputRecorder::Edge> EdgesOf(uint8_t pin) const
+  {
+    std::vector<OutputRecorder::Edge> out;
+    for (const OutputRecorder::Edge& e : rec.Edges())
+    {
+      if (e.pin == pin) out.push_back(e);
+    }
+    return out;
+  }
+
+  OutputEngine engine;
+  OutputRecorder rec;
+
+private:
+  uint32_t now_ = kT0;
+};
+
+void CheckEdges(const std::vector<OutputRecorder::Edge>& edges, const uint32_t* times, std::size_t n)
+{
+  TEST_ASSERT_EQUAL_UINT32(n, edges.size());
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    TEST_ASSERT_EQUAL_UINT32(times[i], edges[i].tMs);
+    TEST_ASSERT_EQUAL(i % 2 == 0, edges[i].level); // on, off, on, ...
+  }
+}
+}
+
+void setUp(void)
+{
+  g_left = false;
+  g_right = false;
+  g_buzzer = false;
+}
+
+void tearDown(void) {}
+
+void test_hazards_switch_on_one_commit(void)
+{
+  const OutputEngine::Channel rows[] = {
+    OutputEngine::Blink(kLeft, &LeftRequested, 0),
+    OutputEngine::Blink(kRight, &RightRequested, 0),
+  };
+  Bench bench(rows, 2);
+
+  // Left indicator first, hazards join 1.3 s later: the group restarts in phase
+  g_left = true;
+  bench.RunTo(kT0 + 1300);
+  g_right = true;
+  bench.RunTo(kT0 + 4000);
+
+  const std::vector<OutputRecorder::Edge> left = bench.EdgesOf(kLeft);
+  const std::vector<OutputRecorder::Edge> right = bench.EdgesOf(kRight);
+  // Restarting the group keeps left on and re-anchors its grid at 2.3 s
+  const uint32_t leftTimes[] = {1000, 1500, 2000, 2800, 3300, 3800, 4300, 4800};
+  CheckEdges(left, leftTimes, sizeof(leftTimes) / sizeof(leftTimes[0]));
+  const uint32_t rightTimes[] = {2300, 2800, 3300, 3800, 4300, 4800};
+  CheckEdges(right, rightTimes, sizeof(rightTimes) / sizeof(rightTimes[0]));
+
+  // After the join every right edge has a left twin on the same commit
+  for (std::size_t i = 1; i < right.size(); ++i)
+  {
+    const OutputRecorder::Edge& twin = left[i + 2];
+    TEST_ASSERT_EQUAL_UINT32(twin.tMs, right[i].tMs);
+    TEST_ASSERT_EQUAL_UINT32(twin.commit, right[i].commit);
+    TEST_ASSERT_EQUAL(twin.level, right[i].level);
+  }
+}
+
+void test_pulse_train_bursts_and_gaps(void)
+{
+  // 3 pulses of 50 ms on / 100 ms off, then a 400 ms gap, repeating
+  const OutputEngine::Channel rows[] = {
+    OutputEngine::PulseTrain(kBuzzer, &BuzzerRequested, 50, 100, 3, 400),
+  };
+  Bench bench(rows, 1);
+  g_buzzer = true;
+  bench.RunTo(kT0 + 1600);
+
+  const uint32_t times[] = {
+    1000, 1050, 1150, 1200, 1300, 1350, // burst 1
+    1750, 1800, 1900, 1950, 2050, 2100, // burst 2, 400 ms after the last pulse ended
+    2500, 2550,                         // burst 3 under way
+  };
+  CheckEdges(bench.EdgesOf(kBuzzer), times, sizeof(times) / sizeof(times[0]));
+}
+
+void test_pulse_train_single_burst_and_release(void)
+{
+  const OutputEngine::Channel rows[] = {
+    OutputEngine::PulseTrain(kBuzzer, &BuzzerRequested, 20, 30, 2, 0),    // one burst per request
+    OutputEngine::PulseTrain(kLeft, &LeftRequested, 100, 100, 0, 0, false), // endless, active low
+  };
+  Bench bench(rows, 2);
+  g_buzzer = true;
+  g_left = true;
+  bench.RunTo(kT0 + 450);
+  g_left = false;
+  bench.RunTo(kT0 + 1000);
+
+  const uint32_t buzzer[] = {1000, 1020, 1050, 1070};
+  CheckEdges(bench.EdgesOf(kBuzzer), buzzer, sizeof(buzzer) / sizeof(buzzer[0]));
+
+  // Endless train until the request drops with the 1500 ms frame
+  const std::vector<OutputRecorder::Edge> lamp = bench.EdgesOf(kLeft);
+  const uint32_t lampTimes[] = {1000, 1100, 1200, 1300, 1400, 1500};
+  TEST_ASSERT_EQUAL_UINT32(6, lamp.size());
+  for (std::size_t i = 0; i < lamp.size(); ++i)
+  {
+    TEST_ASSERT_EQUAL_UINT32(lampTimes[i], lamp[i].tMs);
+    TEST_ASSERT_EQUAL(i % 2 != 0, lamp[i].level); // active low: on drives the pin low
+  }
+  TEST_ASSERT_TRUE(bench.rec.Level(kLeft));
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_hazards_switch_on_one_commit);
+  RUN_TEST(test_pulse_train_bursts_and_gaps);
+  RUN_TEST(test_pulse_train_single_burst_and_release);
+  return UNITY_END();
+}
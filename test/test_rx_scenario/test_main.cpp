@@ -0,0 +1,468 @@
+/**
+ * @file test_main.cpp
+ * @brief Discrete-event scenarios for the RX staleness and relay path on virtual time.
+ *
+ * The sender, the CAN receive callback and the processing task are scheduled
+ * on an EventScheduler: frames are stamped with Clock and pushed to the
+ * EventQueue the way CanInterface does, and a 1 ms task (main.cpp's
+ * ProcessingTask) dispatches them through the board's SystemTransitions table
+ * into MessageRouter/HealthMonitor, polls CheckTimeout() in Active/Degraded and
+ * runs IOModule at its deadlines. The relay waveform is captured with
+ * OutputRecorder, so staleness and indicator timing are checked together.
+ * Hours of traffic run in a few seconds.
+ */
+#include <unity.h>
+#include <vector>
+#include "HealthMonitor.h"
+#include "EventQueue.h"
+#include "Clock.h"
+#include "IOModule.h"
+#include "SystemTransitions.h"
+#include "OutputRecorder.h"
+#include "common/MessageRouter.h"
+#include "harness/VirtualClock.h"
+#include "harness/EventScheduler.h"
+
+namespace
+{
+constexpr uint32_t kPeriodUs = 100000;
+constexpr uint64_t kTaskPeriodUs = 1000; // vTaskDelay(1) at the board's 1 kHz tick
+constexpr uint64_t kMs = 1000;
+constexpr uint64_t kSec = 1000000;
+constexpr uint8_t kLeft = IO_LEFT_RELAY_PIN;
+constexpr uint8_t kRight = IO_RIGHT_RELAY_PIN;
+
+struct StateChange
+{
+  uint64_t tUs;
+  SystemState to;
+};
+
+/** Cluster sender at 100 ms; every field is optional. */
+struct SenderConfig
+{
+  uint32_t jitterUs = 0;          // delivery offset within +/- jitterUs of the nominal slot
+  uint64_t outageFromUs = 0;      // frames due in [outageFromUs, outageToUs) are lost
+  uint64_t outageToUs = 0;
+  uint64_t holdEveryUs = 0;       // every holdEveryUs a gateway holds frames for holdUs...
+  uint64_t holdUs = 0;            // ...and releases them back to back, 1 ms apart
+  uint64_t holdOffsetUs = 0;      // start of the first hold
+  uint32_t duplicateGapUs = 0;    // every frame delivered a second time this much later
+  bool left = false;              // indicator requests carried in every frame
+  bool right = false;
+};
+
+class RxWorld
+{
+public:
+  RxWorld() : sched(clock)
+  {
+    queue.Init(64);
+    router.Init(4);
+    // SystemController::RunBootSequence health policy
+    monitor.SetTimeoutMs(1500);
+    monitor.SetExpectedPeriod(Cluster_CANID, kPeriodUs, 20);
+    monitor.SetStalenessPolicy(5, 8, 5);
+
+    io.Engine().SetBackend(&OutputRecorder::Commit, &relays);
+    io.Init();
+    io.Start(router);
+
+    // CAN, then display/LVGL/touch/UI report ready: Boot -> DisplayInit -> WaitingForData
+    Dispatch_(Event::MakeInitOk(Subsystem::CAN));
+    Dispatch_(Event::MakeInitOk(Subsystem::UI));
+
+    sched.Every(clock.NowUs() + kTaskPeriodUs, [this]() {
+      ProcessingTask_();
+      return kTaskPeriodUs;
+    });
+  }
+
+  ~RxWorld() { io.Stop(router); }
+
+  void StartSender(const SenderConfig& cfg)
+  {
+    sender_ = cfg;
+    const uint64_t start = clock.NowUs();
+    sched.Every(start + kPeriodUs, [this, start]() {
+      SendSlot_(clock.NowUs() - start);
+      return static_cast<uint64_t>(kPeriodUs);
+    });
+  }
+
+  /** Time of the @p n-th (0-based) entry into @p state, or 0. */
+  uint64_t Entered(SystemState state, uint32_t n = 0) const
+  {
+    for (const StateChange& c : changes)
+    {
+      if (c.to == state && n-- == 0) return c.tUs;
+    }
+    return 0;
+  }
+
+  uint32_t Count(SystemState state) const
+  {
+    uint32_t n = 0;
+    for (const StateChange& c : changes) n += (c.to == state) ? 1U : 0U;
+    return n;
+  }
+
+  std::vector<OutputRecorder::Edge> EdgesOf(uint8_t pin) const
+  {
+    std::vector<OutputRecorder::Edge> out;
+    for (const OutputRecorder::Edge& e : relays.Edges())
+    {
+      if (e.pin == pin) out.push_back(e);
+    }
+    return out;
+  }
+
+  VirtualClock clock;
+  EventScheduler sched;
+  EventQueue queue;
+  MessageRouter router;
+  HealthMonitor monitor;
+  IOModule io;
+  OutputRecorder relays;
+  SystemState state = SystemState::Boot;
+  std::vector<StateChange> changes;
+  std::vector<uint64_t> firstFrameAt; // delivery time of each slot's first copy
+  uint32_t framesHandled = 0;
+
+private:
+  void SendSlot_(uint64_t sinceStartUs)
+  {
+    const uint64_t now = clock.NowUs();
+    if (now >= sender_.outageFromUs && now < sender_.outageToUs) return;
+
+    uint64_t deliverAt = now;
+    if (sender_.jitterUs != 0)
+    {
+      seed_ = seed_ * 1103515245U + 12345U;
+      const uint32_t offset = (seed_ >> 16) % (2U * sender_.jitterUs + 1U);
+      deliverAt = now + offset - sender_.jitterUs;
+    }
+    if (sender_.holdEveryUs != 0 && sinceStartUs >= sender_.holdOffsetUs)
+    {
+      const uint64_t intoHold = (sinceStartUs - sender_.holdOffsetUs) % sender_.holdEveryUs;
+      if (intoHold < sender_.holdUs)
+      {
+        // Queued in the gateway; released in send order right before the hold ends
+        const uint64_t releaseAt = now - intoHold + sender_.holdUs - 10 * kMs;
+        deliverAt = releaseAt + (intoHold / kPeriodUs) * kMs;
+      }
+    }
+
+    Cluster_t cluster{};
+    cluster.Left_Turn_Signal = sender_.left ? 1 : 0;
+    cluster.Right_Turn_Signal = sender_.right ? 1 : 0;
+    sched.At(deliverAt, [this, cluster]() {
+      firstFrameAt.push_back(clock.NowUs());
+      ReceiveFrame_(cluster);
+    });
+    if (sender_.duplicateGapUs != 0)
+    {
+      sched.At(deliverAt + sender_.duplicateGapUs, [this, cluster]() { ReceiveFrame_(cluster); });
+    }
+  }
+
+  // CanInterface::CanMsgHandler: Clock::CaptureUs() falls back to Clock on a virtual source
+  void ReceiveFrame_(const Cluster_t& cluster)
+  {
+    queue.PushFromISR(Event::MakeClusterFrame(cluster, Clock::CaptureUs(0)));
+  }
+
+  // main.cpp ProcessingTask: dispatch events, SystemController::Update, IO at its deadlines
+  void ProcessingTask_()
+  {
+    Event e;
+    while (queue.Pop(e))
+    {
+      Dispatch_(e);
+    }
+    if (state == SystemState::Active || state == SystemState::Degraded)
+    {
+      monitor.CheckTimeout(queue, router);
+    }
+    const uint32_t nowMs = Clock::NowMs();
+    if (io.IsDue(nowMs))
+    {
+      relays.SetTimeMs(nowMs);
+      io.Update(nowMs);
+    }
+  }
+
+  // SystemController::Dispatch with the boot already complete (guards pass)
+  void Dispatch_(const Event& event)
+  {
+    SystemTransition cell;
+    if (!SystemTransitions::Lookup(state, event.type, cell) || cell.guard == TransitionGuard::Ignore)
+    {
+      return;
+    }
+    TransitionTo_(cell.target);
+    if (cell.action == TransitionAction::ConsumeFrame)
+    {
+      router.PublishCluster(event.payload.clusterData, Clock::NowMs());
+      monitor.NotifyFrame(queue, Cluster_CANID, event.rxTimestampUs);
+      ++framesHandled;
+    }
+  }
+
+  // SystemController::TransitionTo: publish SystemStatus, run the entry handler's health part
+  void TransitionTo_(SystemState to)
+  {
+    if (to == state) return;
+    state = to;
+    changes.push_back(StateChange{clock.NowUs(), to});
+    MessageRouter::SystemStatus status{static_cast<uint8_t>(to), SystemTransitions::OutputsEnabled(to)};
+    router.PublishSystemStatus(status, Clock::NowMs());
+    if (to == SystemState::WaitingForData) monitor.Reset();
+  }
+
+  SenderConfig sender_;
+  uint32_t seed_ = 1;
+};
+
+/** Every relay half period equals the 500 ms blink grid and levels alternate. */
+void AssertBlinkGrid(const std::vector<OutputRecorder::Edge>& edges, uint32_t fromMs, uint32_t toMs)
+{
+  const OutputRecorder::Edge* prev = nullptr;
+  for (const OutputRecorder::Edge& e : edges)
+  {
+    if (e.tMs < fromMs || e.tMs > toMs) continue;
+    if (prev != nullptr)
+    {
+      TEST_ASSERT_EQUAL_UINT32(500, e.tMs - prev->tMs);
+      TEST_ASSERT_TRUE(e.level != prev->level);
+    }
+    prev = &e;
+  }
+}
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_scheduler_runs_events_in_time_then_fifo_order(void)
+{
+  VirtualClock clock;
+  EventScheduler sched(clock);
+  std::vector<int> order;
+  const uint64_t t0 = clock.NowUs();
+  sched.At(t0 + 300, [&]() { order.push_back(3); });
+  sched.At(t0 + 100, [&]() { order.push_back(1); });
+  sched.At(t0 + 100, [&]() { order.push_back(2); });
+  sched.At(t0 + 100, [&]() { sched.After(50, [&]() { order.push_back(25); }); });
+  sched.RunUntil(t0 + 200);
+
+  TEST_ASSERT_EQUAL_UINT32(3, order.size());
+  TEST_ASSERT_EQUAL_INT(1, order[0]);
+  TEST_ASSERT_EQUAL_INT(2, order[1]);
+  TEST_ASSERT_EQUAL_INT(25, order[2]);
+  TEST_ASSERT_EQUAL_UINT64(t0 + 200, Clock::NowUs64());
+
+  sched.RunFor(1000);
+  TEST_ASSERT_EQUAL_UINT32(4, order.size());
+  TEST_ASSERT_TRUE(sched.Idle());
+}
+
+void test_first_frame_activates_and_relay_blinks_on_grid(void)
+{
+  RxWorld w;
+  TEST_ASSERT_EQUAL_INT(static_cast<int>(SystemState::WaitingForData), static_cast<int>(w.state));
+  SenderConfig cfg;
+  cfg.left = true;
+  w.StartSender(cfg);
+  w.sched.RunFor(10 * kSec);
+
+  // Outputs stay gated until the first frame moves WaitingForData -> Active
+  const uint64_t active = w.Entered(SystemState::Active);
+  TEST_ASSERT_UINT32_WITHIN(kMs, 0, active - w.firstFrameAt[0]);
+  const std::vector<OutputRecorder::Edge> left = w.EdgesOf(kLeft);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(19, left.size());
+  TEST_ASSERT_TRUE(left[0].level);
+  TEST_ASSERT_UINT32_WITHIN(1, static_cast<uint32_t>(active / kMs), left[0].tMs);
+  AssertBlinkGrid(left, 0, UINT32_MAX);
+  TEST_ASSERT_EQUAL_UINT32(0, w.EdgesOf(kRight).size());
+}
+
+void test_outage_degrades_once_and_recovers_after_k_frames(void)
+{
+  RxWorld w;
+  const uint64_t start = w.clock.NowUs();
+  SenderConfig cfg;
+  cfg.outageFromUs = start + 10 * kSec;
+  cfg.outageToUs = start + 13 * kSec;
+  cfg.left = true;
+  w.StartSender(cfg);
+  w.sched.RunUntil(start + 25 * kSec);
+
+  TEST_ASSERT_EQUAL_UINT32(1, w.Count(SystemState::Degraded));
+  TEST_ASSERT_EQUAL_UINT32(2, w.Count(SystemState::Active));
+  // 5th missed slot: the last frame came 100 ms before the outage, its slot expired
+  // 150 ms later and one more every 100 ms, so the fifth miss is at +450 ms
+  TEST_ASSERT_UINT32_WITHIN(2 * kMs, 450 * kMs, w.Entered(SystemState::Degraded) - cfg.outageFromUs);
+  // First frame back is late by definition, the next 5 rebuild the on-time streak
+  TEST_ASSERT_UINT32_WITHIN(2 * kMs, 500 * kMs, w.Entered(SystemState::Active, 1) - cfg.outageToUs);
+  TEST_ASSERT_FALSE(w.monitor.IsStale());
+
+  // Relay: Degraded keeps outputs enabled, IOModule's own 1 s input timeout drops the
+  // relay, and blinking restarts with the first frame back (not with recovery)
+  const uint32_t lastFrameMs = static_cast<uint32_t>((cfg.outageFromUs - 100 * kMs) / kMs);
+  const uint32_t backMs = static_cast<uint32_t>(cfg.outageToUs / kMs);
+  const std::vector<OutputRecorder::Edge> left = w.EdgesOf(kLeft);
+  bool sawRestart = false;
+  for (std::size_t i = 0; i < left.size(); ++i)
+  {
+    const OutputRecorder::Edge& e = left[i];
+    if (e.tMs > lastFrameMs + 1001U && e.tMs < backMs) TEST_FAIL_MESSAGE("relay switched during the outage");
+    if (e.tMs >= backMs && !sawRestart)
+    {
+      sawRestart = true;
+      TEST_ASSERT_TRUE(e.level);
+      TEST_ASSERT_UINT32_WITHIN(1, backMs, e.tMs);
+      TEST_ASSERT_FALSE(left[i - 1].level); // dropped by the input timeout
+      TEST_ASSERT_LESS_OR_EQUAL_UINT32(lastFrameMs + 1001U, left[i - 1].tMs);
+    }
+  }
+  TEST_ASSERT_TRUE(sawRestart);
+  AssertBlinkGrid(left, backMs, UINT32_MAX);
+}
+
+void test_jittered_sender_never_degrades_and_hazards_stay_in_step(void)
+{
+  RxWorld w;
+  SenderConfig cfg;
+  cfg.jitterUs = 40000; // +/- 40 % of the period
+  cfg.left = true;
+  cfg.right = true;
+  w.StartSender(cfg);
+  w.sched.RunFor(600 * kSec);
+
+  TEST_ASSERT_EQUAL_UINT32(1, w.Count(SystemState::Active));
+  TEST_ASSERT_EQUAL_UINT32(0, w.Count(SystemState::Degraded));
+  TEST_ASSERT_UINT32_WITHIN(1, 6000, w.framesHandled);
+
+  // The blink grid is timer driven: frame jitter never moves an edge, and both
+  // indicators switch on the same register write
+  const std::vector<OutputRecorder::Edge> left = w.EdgesOf(kLeft);
+  const std::vector<OutputRecorder::Edge> right = w.EdgesOf(kRight);
+  AssertBlinkGrid(left, 0, UINT32_MAX);
+  TEST_ASSERT_EQUAL_UINT32(left.size(), right.size());
+  for (std::size_t i = 0; i < left.size(); ++i)
+  {
+    TEST_ASSERT_EQUAL_UINT32(left[i].commit, right[i].commit);
+    TEST_ASSERT_EQUAL(left[i].level, right[i].level);
+  }
+}
+
+void test_short_gateway_holds_never_degrade(void)
+{
+  RxWorld w;
+  SenderConfig cfg;
+  cfg.holdEveryUs = 10 * kSec;
+  cfg.holdUs = 350 * kMs; // 4 frames queued, 3 slots missed, then released as a burst
+  cfg.holdOffsetUs = 5 * kSec;
+  cfg.left = true;
+  w.StartSender(cfg);
+  w.sched.RunFor(600 * kSec);
+
+  TEST_ASSERT_EQUAL_UINT32(0, w.Count(SystemState::Degraded));
+  TEST_ASSERT_UINT32_WITHIN(1, 6000, w.framesHandled);
+  AssertBlinkGrid(w.EdgesOf(kLeft), 0, UINT32_MAX);
+}
+
+void test_burst_after_long_hold_does_not_recover_early(void)
+{
+  RxWorld w;
+  const uint64_t start = w.clock.NowUs();
+  SenderConfig cfg;
+  cfg.holdEveryUs = 100 * kSec;
+  cfg.holdUs = 600 * kMs; // 6 frames queued: 5 misses degrade, then a 6-frame burst
+  cfg.holdOffsetUs = 10 * kSec;
+  w.StartSender(cfg);
+  w.sched.RunUntil(start + 20 * kSec);
+
+  const uint64_t holdFrom = start + 10 * kSec;
+  const uint64_t releaseAt = holdFrom + cfg.holdUs - 10 * kMs;
+  TEST_ASSERT_EQUAL_UINT32(1, w.Count(SystemState::Degraded));
+  TEST_ASSERT_UINT32_WITHIN(2 * kMs, 450 * kMs, w.Entered(SystemState::Degraded) - holdFrom);
+  // The burst fills one slot; recovery still takes 5 on-time slots after it
+  const uint64_t recovered = w.Entered(SystemState::Active, 1);
+  TEST_ASSERT_GREATER_THAN_UINT32(releaseAt, recovered);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(500 * kMs, recovered - releaseAt);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(600 * kMs, recovered - releaseAt);
+}
+
+// Left relay edges and Degraded/Active times of the 10 s..13 s outage run
+struct OutageRun
+{
+  std::vector<OutputRecorder::Edge> left;
+  uint64_t degradedAt;
+  uint64_t recoveredAt;
+  uint32_t framesHandled;
+};
+
+OutageRun RunOutage(uint32_t duplicateGapUs)
+{
+  RxWorld w;
+  const uint64_t start = w.clock.NowUs();
+  SenderConfig cfg;
+  cfg.outageFromUs = start + 10 * kSec;
+  cfg.outageToUs = start + 13 * kSec;
+  cfg.duplicateGapUs = duplicateGapUs;
+  cfg.left = true;
+  w.StartSender(cfg);
+  w.sched.RunUntil(start + 20 * kSec);
+  return OutageRun{w.EdgesOf(kLeft), w.Entered(SystemState::Degraded) - start,
+                   w.Entered(SystemState::Active, 1) - start, w.framesHandled};
+}
+
+void test_duplicated_frames_change_nothing_but_the_frame_count(void)
+{
+  const OutageRun single = RunOutage(0);
+  const OutageRun doubled = RunOutage(150); // e.g. a retransmission after a lost ACK
+
+  TEST_ASSERT_EQUAL_UINT32(2U * single.framesHandled, doubled.framesHandled);
+  TEST_ASSERT_EQUAL_UINT64(single.degradedAt, doubled.degradedAt);
+  TEST_ASSERT_EQUAL_UINT64(single.recoveredAt, doubled.recoveredAt);
+  TEST_ASSERT_EQUAL_UINT32(single.left.size(), doubled.left.size());
+  for (std::size_t i = 0; i < single.left.size(); ++i)
+  {
+    TEST_ASSERT_EQUAL_UINT32(single.left[i].tMs, doubled.left[i].tMs);
+    TEST_ASSERT_EQUAL(single.left[i].level, doubled.left[i].level);
+  }
+}
+
+void test_hour_of_clean_traffic_never_degrades(void)
+{
+  RxWorld w;
+  w.StartSender(SenderConfig());
+  w.sched.RunFor(3600 * kSec);
+
+  TEST_ASSERT_EQUAL_UINT32(1, w.Count(SystemState::Active));
+  TEST_ASSERT_EQUAL_UINT32(0, w.Count(SystemState::Degraded));
+  TEST_ASSERT_UINT32_WITHIN(1, 36000, w.framesHandled);
+  TEST_ASSERT_EQUAL_UINT32(0, w.relays.Edges().size());
+
+  HealthMonitor::PeriodStats s;
+  TEST_ASSERT_TRUE(w.monitor.GetPeriodStats(Cluster_CANID, s));
+  TEST_ASSERT_EQUAL_UINT32(kPeriodUs, s.ewmaPeriodUs);
+  TEST_ASSERT_EQUAL_UINT32(kPeriodUs, s.minPeriodUs);
+  TEST_ASSERT_EQUAL_UINT32(kPeriodUs, s.maxPeriodUs);
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_scheduler_runs_events_in_time_then_fifo_order);
+  RUN_TEST(test_first_frame_activates_and_relay_blinks_on_grid);
+  RUN_TEST(test_outage_degrades_once_and_recovers_after_k_frames);
+  RUN_TEST(test_jittered_sender_never_degrades_and_hazards_stay_in_step);
+  RUN_TEST(test_short_gateway_holds_never_degrade);
+  RUN_TEST(test_burst_after_long_hold_does_not_recover_early);
+  RUN_TEST(test_duplicated_frames_change_nothing_but_the_frame_count);
+  RUN_TEST(test_hour_of_clean_traffic_never_degrades);
+  return UNITY_END();
+}
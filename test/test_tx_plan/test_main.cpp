@@ -0,0 +1,220 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for TxPlan offset staggering and deadline order.
+ *
+ * TxPlan is the part of TxScheduler without esp_timer, tasks or a bus, so the
+ * tests call PopDue() the way the transmit task does, at whatever "now" they
+ * choose: on time, late by a random amount, or after a long stall.
+ */
+#include <unity.h>
+#include <vector>
+#include "tx/TxPlan.h"
+
+namespace
+{
+// Small LCG so tables and lateness are the same on every host
+uint32_t g_seed = 1;
+uint32_t NextRandom()
+{
+  g_seed = g_seed * 1103515245U + 12345U;
+  return g_seed >> 16;
+}
+
+// Classic 8-byte frames incl. worst case stuffing, as CANBusLoad::classicFrameBits counts them
+constexpr uint32_t kStd8Bits = 135;
+constexpr uint32_t kExt8Bits = 160;
+
+constexpr int64_t kStartUs = 1000000;
+
+/** Mixed body-bus table: periods 10..1000 ms, every row automatic. */
+std::vector<TxPlan::Row> MixedTable(uint16_t count)
+{
+  static const uint16_t kPeriods[] = {10, 20, 50, 100, 100, 200, 500, 1000};
+  std::vector<TxPlan::Row> rows(count);
+  for (uint16_t i = 0; i < count; ++i)
+  {
+    rows[i].id = 0x100U + i;
+    rows[i].periodMs = kPeriods[NextRandom() % 8U];
+    rows[i].offsetMs = TxPlan::kAutoOffset;
+    rows[i].frameBits = (NextRandom() % 4U == 0) ? kExt8Bits : kStd8Bits;
+  }
+  return rows;
+}
+}
+
+void setUp(void)
+{
+  g_seed = 1;
+}
+
+void tearDown(void) {}
+
+void test_rejects_bad_tables(void)
+{
+  TxPlan plan;
+  TxPlan::Row row{0x100, 10, TxPlan::kAutoOffset, kStd8Bits};
+  TEST_ASSERT_FALSE(plan.Init(nullptr, 1));
+  TEST_ASSERT_FALSE(plan.Init(&row, 0));
+  row.periodMs = 0;
+  TEST_ASSERT_FALSE(plan.Init(&row, 1));
+  row.periodMs = 10;
+  row.offsetMs = 10;
+  TEST_ASSERT_FALSE(plan.Init(&row, 1));
+  row.offsetMs = -2;
+  TEST_ASSERT_FALSE(plan.Init(&row, 1));
+  row.offsetMs = 9;
+  TEST_ASSERT_TRUE(plan.Init(&row, 1));
+}
+
+void test_offsets_in_range_and_fixed_offsets_kept(void)
+{
+  std::vector<TxPlan::Row> rows = MixedTable(64);
+  rows[3].offsetMs = 7;
+  rows[3].periodMs = 20;
+  rows[40].offsetMs = 0;
+  TxPlan plan;
+  TEST_ASSERT_TRUE(plan.Init(rows.data(), static_cast<uint16_t>(rows.size())));
+
+  for (uint16_t i = 0; i < rows.size(); ++i)
+  {
+    TEST_ASSERT_LESS_THAN_UINT32(rows[i].periodMs, plan.OffsetMs(i));
+  }
+  TEST_ASSERT_EQUAL_UINT32(7, plan.OffsetMs(3));
+  TEST_ASSERT_EQUAL_UINT32(0, plan.OffsetMs(40));
+  TEST_ASSERT_EQUAL_UINT32(0, plan.OffsetMs(1000)); // out of range index
+}
+
+void test_staggered_peak_not_above_aligned(void)
+{
+  for (uint16_t count : {1, 2, 8, 64, 300})
+  {
+    std::vector<TxPlan::Row> rows = MixedTable(count);
+    TxPlan plan;
+    TEST_ASSERT_TRUE(plan.Init(rows.data(), count));
+    uint32_t aligned = 0;
+    uint32_t staggered = 0;
+    plan.GetStaggerPeaks(aligned, staggered);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(aligned, staggered);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, staggered);
+  }
+
+  // Ten 10 ms messages fit one per slot: the peak falls from ten frames to one
+  std::vector<TxPlan::Row> rows(10, TxPlan::Row{0, 10, TxPlan::kAutoOffset, kStd8Bits});
+  for (uint16_t i = 0; i < rows.size(); ++i) rows[i].id = 0x200U + i;
+  TxPlan plan;
+  TEST_ASSERT_TRUE(plan.Init(rows.data(), static_cast<uint16_t>(rows.size())));
+  uint32_t aligned = 0;
+  uint32_t staggered = 0;
+  plan.GetStaggerPeaks(aligned, staggered);
+  TEST_ASSERT_EQUAL_UINT32(10U * kStd8Bits, aligned);
+  TEST_ASSERT_EQUAL_UINT32(kStd8Bits, staggered);
+}
+
+void test_late_wakeups_do_not_drift_the_grid(void)
+{
+  std::vector<TxPlan::Row> rows = MixedTable(40);
+  const uint16_t count = static_cast<uint16_t>(rows.size());
+  TxPlan plan;
+  TEST_ASSERT_TRUE(plan.Init(rows.data(), count));
+  plan.Start(kStartUs);
+
+  // Wake up 0..4 ms after each deadline (shorter than any period): every message
+  // must still be released once per cycle, for exactly its grid deadline
+  std::vector<int64_t> releases(count, 0);
+  int64_t nowUs = kStartUs;
+  while (nowUs < kStartUs + 60LL * 1000000)
+  {
+    nowUs = plan.NextDueUs() + static_cast<int64_t>(NextRandom() % 4000U);
+    uint16_t idx;
+    int64_t dueUs;
+    uint32_t missed;
+    while (plan.PopDue(nowUs, idx, dueUs, missed))
+    {
+      const int64_t gridUs = kStartUs + static_cast<int64_t>(plan.OffsetMs(idx)) * 1000 +
+                             releases[idx] * static_cast<int64_t>(rows[idx].periodMs) * 1000;
+      TEST_ASSERT_TRUE(dueUs == gridUs);
+      TEST_ASSERT_EQUAL_UINT32(0, missed);
+      ++releases[idx];
+    }
+  }
+  for (uint16_t i = 0; i < count; ++i)
+  {
+    // 60 s of cycles, give or take the one in flight
+    const int64_t expected = 60000 / rows[i].periodMs;
+    TEST_ASSERT_TRUE(releases[i] >= expected - 1 && releases[i] <= expected + 1);
+  }
+}
+
+void test_stall_skips_missed_cycles(void)
+{
+  const TxPlan::Row row{0x100, 10, 3, kStd8Bits};
+  TxPlan plan;
+  TEST_ASSERT_TRUE(plan.Init(&row, 1));
+  plan.Start(kStartUs);
+
+  uint16_t idx;
+  int64_t dueUs;
+  uint32_t missed;
+  TEST_ASSERT_FALSE(plan.PopDue(kStartUs + 2999, idx, dueUs, missed));
+  TEST_ASSERT_TRUE(plan.PopDue(kStartUs + 3000, idx, dueUs, missed));
+  TEST_ASSERT_EQUAL_UINT32(0, missed);
+
+  // Stalled from 13 ms to 47.5 ms: one send for the 13 ms deadline, 23/33/43 dropped
+  TEST_ASSERT_TRUE(plan.PopDue(kStartUs + 47500, idx, dueUs, missed));
+  TEST_ASSERT_EQUAL_UINT32(13000, static_cast<uint32_t>(dueUs - kStartUs));
+  TEST_ASSERT_EQUAL_UINT32(3, missed);
+  TEST_ASSERT_FALSE(plan.PopDue(kStartUs + 47500, idx, dueUs, missed));
+
+  // Back on the original grid
+  TEST_ASSERT_EQUAL_UINT32(53000, static_cast<uint32_t>(plan.NextDueUs() - kStartUs));
+
+  // A stall ending exactly on a grid point: the frame sent now covers that point too
+  TEST_ASSERT_TRUE(plan.PopDue(kStartUs + 73000, idx, dueUs, missed));
+  TEST_ASSERT_EQUAL_UINT32(53000, static_cast<uint32_t>(dueUs - kStartUs));
+  TEST_ASSERT_EQUAL_UINT32(2, missed);
+  TEST_ASSERT_EQUAL_UINT32(83000, static_cast<uint32_t>(plan.NextDueUs() - kStartUs));
+}
+
+void test_equal_deadlines_release_in_id_order(void)
+{
+  // Same period and fixed offset, table order unrelated to the IDs
+  static const uint32_t kIds[] = {0x3A0, 0x120, 0x7FF, 0x001, 0x455, 0x121, 0x300};
+  std::vector<TxPlan::Row> rows;
+  for (uint32_t id : kIds) rows.push_back(TxPlan::Row{id, 20, 5, kStd8Bits});
+  // One message with another period shares every second deadline
+  rows.push_back(TxPlan::Row{0x200, 40, 5, kStd8Bits});
+
+  TxPlan plan;
+  TEST_ASSERT_TRUE(plan.Init(rows.data(), static_cast<uint16_t>(rows.size())));
+  plan.Start(kStartUs);
+
+  for (int cycle = 0; cycle < 6; ++cycle)
+  {
+    const int64_t nowUs = kStartUs + 5000 + cycle * 20000;
+    uint32_t prevId = 0;
+    uint32_t released = 0;
+    uint16_t idx;
+    int64_t dueUs;
+    uint32_t missed;
+    while (plan.PopDue(nowUs, idx, dueUs, missed))
+    {
+      TEST_ASSERT_TRUE(dueUs == nowUs);
+      if (released != 0) TEST_ASSERT_GREATER_THAN_UINT32(prevId, rows[idx].id);
+      prevId = rows[idx].id;
+      ++released;
+    }
+    TEST_ASSERT_EQUAL_UINT32((cycle % 2 == 0) ? 8U : 7U, released);
+  }
+}
+
+int main(int, char**)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_rejects_bad_tables);
+  RUN_TEST(test_offsets_in_range_and_fixed_offsets_kept);
+  RUN_TEST(test_staggered_peak_not_above_aligned);
+  RUN_TEST(test_late_wakeups_do_not_drift_the_grid);
+  RUN_TEST(test_stall_skips_missed_cycles);
+  RUN_TEST(test_equal_deadlines_release_in_id_order);
+  return UNITY_END();
+}